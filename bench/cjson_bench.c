@@ -0,0 +1,1088 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+/*
+ * Throughput benchmark for cJSON.
+ *
+ * Without arguments it runs on generated documents that resemble the usual JSON benchmark corpora
+ * (twitter.json, canada.json and citm_catalog.json) plus deeply nested, escape heavy and NDJSON input.
+ * Files given on the command line are benchmarked as well, files ending in ".ndjson" line by line.
+ *
+ * Every result is printed as one JSON object per line:
+ * {"corpus":"canada","documents":1,"bytes":2090234,"operation":"parse","iterations":52,"seconds":0.51,
+ *  "mb_per_s":213.1,"allocations_per_document":111231,"bytes_per_document":5234890,"peak_bytes":5023900}
+ * where MB are 10^6 bytes of JSON input (also for the CBOR operations, so they compare with the text ones) and the
+ * allocation numbers come from one extra pass with cJSON_StartStats.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../cJSON.h"
+#include "../cJSON_Utils.h"
+#include "../cJSON_CBOR.h"
+#include "../cJSON_Writer.h"
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} text_buffer;
+
+typedef struct
+{
+    char *text;
+    size_t length;
+    cJSON *tree;
+    cJSON *copy; /* for comparing */
+    cJSON *modified; /* target of the patches */
+    cJSON *patches;
+    cJSON *packed; /* parsed with pack_numbers */
+    unsigned char *cbor;
+    size_t cbor_length;
+} document;
+
+typedef struct
+{
+    const char *name;
+    document *documents;
+    size_t count;
+    size_t bytes;
+    char *scratch; /* for minifying */
+} corpus;
+
+typedef double (*operation_function)(corpus * const input);
+typedef void (*setup_function)(corpus * const input);
+
+typedef struct
+{
+    const char *name;
+    operation_function run;
+    /* run before and after all passes of the operation if not NULL, neither is counted or timed */
+    setup_function prepare;
+    setup_function finish;
+} operation;
+
+static unsigned long random_state = 1;
+
+static unsigned long next_random(void)
+{
+    random_state = (random_state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return (random_state >> 16) & 0x7FFF;
+}
+
+static void *checked_malloc(size_t size)
+{
+    void *pointer = malloc(size);
+    if (pointer == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return pointer;
+}
+
+static void append_length(text_buffer * const buffer, const char * const string, size_t length)
+{
+    if ((buffer->length + length + 1) > buffer->capacity)
+    {
+        char *new_data = NULL;
+        size_t new_capacity = (buffer->capacity == 0) ? 4096 : buffer->capacity;
+        while ((buffer->length + length + 1) > new_capacity)
+        {
+            new_capacity *= 2;
+        }
+        new_data = (char*)checked_malloc(new_capacity);
+        if (buffer->data != NULL)
+        {
+            memcpy(new_data, buffer->data, buffer->length);
+            free(buffer->data);
+        }
+        buffer->data = new_data;
+        buffer->capacity = new_capacity;
+    }
+
+    memcpy(buffer->data + buffer->length, string, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+static void append(text_buffer * const buffer, const char * const string)
+{
+    append_length(buffer, string, strlen(string));
+}
+
+static void append_number(text_buffer * const buffer, unsigned long number)
+{
+    char digits[32];
+    sprintf(digits, "%lu", number);
+    append(buffer, digits);
+}
+
+static void append_double(text_buffer * const buffer, double number)
+{
+    char digits[64];
+    sprintf(digits, "%.15f", number);
+    append(buffer, digits);
+}
+
+static void append_word(text_buffer * const buffer)
+{
+    static const char *const words[] = { "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do" };
+    append(buffer, words[next_random() % (sizeof(words) / sizeof(words[0]))]);
+}
+
+/* looks like the statuses in twitter.json: medium sized objects, many keys, some non-ASCII text */
+static void generate_twitter(text_buffer * const buffer)
+{
+    static const char japanese[] = "\xe5\x90\x8d\xe5\x89\x8d:\xe5\x89\x8d\xe7\x94\xb0\xe3\x81\x82\xe3\x82\x86\xe3\x81\xbf";
+    size_t status = 0;
+
+    append(buffer, "{\"statuses\":[");
+    for (status = 0; status < 400; status++)
+    {
+        unsigned long id = 505874924UL + (unsigned long)status;
+        if (status > 0)
+        {
+            append(buffer, ",");
+        }
+        append(buffer, "{\"metadata\":{\"result_type\":\"recent\",\"iso_language_code\":\"ja\"},\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\",\"id\":");
+        append_number(buffer, id);
+        append(buffer, ",\"id_str\":\"");
+        append_number(buffer, id);
+        append(buffer, "\",\"text\":\"@aym0566x \\n\\n");
+        append(buffer, japanese);
+        append(buffer, " ");
+        append_word(buffer);
+        append(buffer, " ");
+        append_word(buffer);
+        append(buffer, "\",\"source\":\"<a href=\\\"http://twitter.com/download/iphone\\\" rel=\\\"nofollow\\\">Twitter for iPhone</a>\",\"truncated\":0,\"in_reply_to_status_id\":null,\"user\":{\"id\":");
+        append_number(buffer, next_random() * 1000UL);
+        append(buffer, ",\"name\":\"");
+        append(buffer, japanese);
+        append(buffer, "\",\"screen_name\":\"");
+        append_word(buffer);
+        append_number(buffer, next_random());
+        append(buffer, "\",\"location\":\"\",\"description\":\"");
+        append_word(buffer);
+        append(buffer, " ");
+        append_word(buffer);
+        append(buffer, " ");
+        append_word(buffer);
+        append(buffer, "\",\"url\":null,\"entities\":{\"description\":{\"urls\":[]}},\"protected\":0,\"followers_count\":");
+        append_number(buffer, next_random());
+        append(buffer, ",\"friends_count\":");
+        append_number(buffer, next_random());
+        append(buffer, ",\"listed_count\":0,\"created_at\":\"Mon Feb 18 13:25:37 +0000 2013\",\"favourites_count\":235,\"utc_offset\":null,\"time_zone\":null,\"geo_enabled\":0,\"verified\":0,\"statuses_count\":1769,\"lang\":\"en\",\"profile_background_color\":\"C0DEED\",");
+        append(buffer, "\"profile_image_url\":\"http://pbs.twimg.com/profile_images/497760886795153410/LDjAwR_y_normal.jpeg\",\"default_profile\":1},\"geo\":null,\"coordinates\":null,\"place\":null,\"contributors\":null,\"retweet_count\":0,\"favorite_count\":0,\"entities\":{\"hashtags\":[],\"symbols\":[],\"urls\":[],\"user_mentions\":[{\"screen_name\":\"aym0566x\",\"name\":\"");
+        append(buffer, japanese);
+        append(buffer, "\",\"id\":1186275104,\"id_str\":\"1186275104\",\"indices\":[0,9]}]},\"favorited\":0,\"retweeted\":0,\"lang\":\"ja\"}");
+    }
+    append(buffer, "],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924095815681,\"query\":\"%E4%B8%80\",\"count\":100}}");
+}
+
+/* looks like canada.json: long arrays of coordinate pairs with many significant digits */
+static void generate_canada(text_buffer * const buffer)
+{
+    size_t ring = 0;
+    size_t point = 0;
+
+    append(buffer, "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[");
+    for (ring = 0; ring < 480; ring++)
+    {
+        append(buffer, (ring > 0) ? ",[" : "[");
+        for (point = 0; point < 100; point++)
+        {
+            append(buffer, (point > 0) ? ",[" : "[");
+            append_double(buffer, -141.0 + (double)next_random() / 300.0);
+            append(buffer, ",");
+            append_double(buffer, 41.0 + (double)next_random() / 800.0);
+            append(buffer, "]");
+        }
+        append(buffer, "]");
+    }
+    append(buffer, "]}}]}");
+}
+
+/* looks like citm_catalog.json: big objects keyed by ids and lots of small integers */
+static void generate_citm(text_buffer * const buffer)
+{
+    size_t index = 0;
+
+    append(buffer, "{\"areaNames\":{");
+    for (index = 0; index < 200; index++)
+    {
+        append(buffer, (index > 0) ? ",\"" : "\"");
+        append_number(buffer, 205705993UL + index);
+        append(buffer, "\":\"Arri\xc3\xa8re-sc\xc3\xa8ne ");
+        append_word(buffer);
+        append(buffer, "\"");
+    }
+    append(buffer, "},\"events\":{");
+    for (index = 0; index < 400; index++)
+    {
+        append(buffer, (index > 0) ? ",\"" : "\"");
+        append_number(buffer, 138586341UL + index);
+        append(buffer, "\":{\"description\":null,\"id\":");
+        append_number(buffer, 138586341UL + index);
+        append(buffer, ",\"logo\":\"/images/UE0AAAAACEKo6QAAAAZDSVRN\",\"name\":\"");
+        append_word(buffer);
+        append(buffer, " ");
+        append_word(buffer);
+        append(buffer, "\",\"subTopicIds\":[337184269,337184283],\"subjectCode\":null,\"subtitle\":null,\"topicIds\":[324846099,107888604]}");
+    }
+    append(buffer, "},\"performances\":[");
+    for (index = 0; index < 1200; index++)
+    {
+        size_t price = 0;
+        append(buffer, (index > 0) ? ",{" : "{");
+        append(buffer, "\"eventId\":");
+        append_number(buffer, 138586341UL + (index % 400));
+        append(buffer, ",\"id\":");
+        append_number(buffer, 339887544UL + index);
+        append(buffer, ",\"logo\":null,\"name\":null,\"prices\":[");
+        for (price = 0; price < 3; price++)
+        {
+            append(buffer, (price > 0) ? ",{\"amount\":" : "{\"amount\":");
+            append_number(buffer, 1000UL * next_random());
+            append(buffer, ",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":");
+            append_number(buffer, 338937295UL + price);
+            append(buffer, "}");
+        }
+        append(buffer, "],\"seatCategories\":[{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]},{\"areaId\":205705998,\"blockIds\":[]}],\"seatCategoryId\":338937295}],\"seatMapImage\":null,\"start\":");
+        append_number(buffer, 1372701600UL + index);
+        append(buffer, "000,\"venueCode\":\"PLEYEL_PLEYEL\"}");
+    }
+    append(buffer, "],\"venueNames\":{\"PLEYEL_PLEYEL\":\"Salle Pleyel\"}}");
+}
+
+/* arrays nested close to the nesting limit with a small object on every level */
+static void generate_nested(text_buffer * const buffer)
+{
+    size_t chain = 0;
+    size_t depth = 0;
+    size_t max_depth = (CJSON_NESTING_LIMIT > 800) ? 800 : (CJSON_NESTING_LIMIT - 2);
+
+    append(buffer, "[");
+    for (chain = 0; chain < 60; chain++)
+    {
+        append(buffer, (chain > 0) ? "," : "");
+        for (depth = 0; depth < max_depth; depth++)
+        {
+            append(buffer, "[{\"level\":");
+            append_number(buffer, depth);
+            append(buffer, "},");
+        }
+        append(buffer, "1");
+        for (depth = 0; depth < max_depth; depth++)
+        {
+            append(buffer, "]");
+        }
+    }
+    append(buffer, "]");
+}
+
+/* strings full of escape sequences, including surrogate pairs */
+static void generate_escapes(text_buffer * const buffer)
+{
+    size_t index = 0;
+
+    append(buffer, "[");
+    for (index = 0; index < 5000; index++)
+    {
+        append(buffer, (index > 0) ? ",\"" : "\"");
+        append(buffer, "line\\nbreak \\\"quoted\\\"\\ttab back\\\\slash \\/ \\u00e9\\u4e2d\\ud83d\\ude00 control\\u0001 ");
+        append_word(buffer);
+        append(buffer, "\"");
+    }
+    append(buffer, "]");
+}
+
+/* many small independent records, one per line */
+static void generate_ndjson(text_buffer * const buffer)
+{
+    size_t index = 0;
+
+    for (index = 0; index < 5000; index++)
+    {
+        append(buffer, "{\"id\":");
+        append_number(buffer, index);
+        append(buffer, ",\"user\":\"");
+        append_word(buffer);
+        append_number(buffer, next_random());
+        append(buffer, "\",\"timestamp\":");
+        append_number(buffer, 1500000000UL + index);
+        append(buffer, ",\"score\":");
+        append_double(buffer, (double)next_random() / 32768.0);
+        append(buffer, ",\"active\":1,\"tags\":[\"");
+        append_word(buffer);
+        append(buffer, "\",\"");
+        append_word(buffer);
+        append(buffer, "\"]}\n");
+    }
+}
+
+static char *read_file(const char * const filename, size_t * const length)
+{
+    FILE *file = NULL;
+    long size = 0;
+    char *content = NULL;
+
+    file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    if ((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0) || (fseek(file, 0, SEEK_SET) != 0))
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    content = (char*)checked_malloc((size_t)size + 1);
+    if (fread(content, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(content);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    content[size] = '\0';
+    *length = (size_t)size;
+
+    return content;
+}
+
+/* make some changes so there is something to diff */
+static void modify_tree(cJSON * const item, unsigned long * const counter)
+{
+    cJSON *child = NULL;
+
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        (*counter)++;
+        if (cJSON_IsNumber(child) && ((*counter % 7) == 0))
+        {
+            cJSON_SetNumberValue(child, child->valuedouble + 1);
+        }
+        else if (cJSON_IsString(child) && ((*counter % 11) == 0))
+        {
+            cJSON_SetValuestring(child, "changed");
+        }
+        modify_tree(child, counter);
+    }
+
+    if (cJSON_IsObject(item) && ((*counter % 5) == 0))
+    {
+        cJSON_AddTrueToObject(item, "added");
+    }
+}
+
+static cJSON *parse_packed(const char * const text, size_t length)
+{
+    cJSON_ParseOptions options;
+    memset(&options, 0, sizeof(options));
+    options.pack_numbers = 1;
+
+    return cJSON_ParseWithOptions(text, length, &options, NULL);
+}
+
+static void add_document(corpus * const input, const char * const text, size_t length)
+{
+    document *current = NULL;
+    unsigned long counter = 0;
+
+    current = &input->documents[input->count];
+    current->text = (char*)checked_malloc(length + 1);
+    memcpy(current->text, text, length);
+    current->text[length] = '\0';
+    current->length = length;
+
+    current->tree = cJSON_ParseWithLength(current->text, length);
+    if (current->tree == NULL)
+    {
+        fprintf(stderr, "%s: document %lu can't be parsed\n", input->name, (unsigned long)input->count);
+        exit(EXIT_FAILURE);
+    }
+    current->copy = cJSON_Duplicate(current->tree, 1);
+    current->modified = cJSON_Duplicate(current->tree, 1);
+    modify_tree(current->modified, &counter);
+    current->patches = cJSONUtils_GeneratePatchesCaseSensitive(current->tree, current->modified);
+    if ((current->copy == NULL) || (current->modified == NULL) || (current->patches == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    current->packed = parse_packed(current->text, length);
+    if (current->packed == NULL)
+    {
+        fprintf(stderr, "%s: document %lu can't be parsed packed\n", input->name, (unsigned long)input->count);
+        exit(EXIT_FAILURE);
+    }
+    current->cbor = cJSON_PrintCBOR(current->tree, &current->cbor_length);
+    if (current->cbor == NULL)
+    {
+        fprintf(stderr, "%s: document %lu can't be encoded as CBOR\n", input->name, (unsigned long)input->count);
+        exit(EXIT_FAILURE);
+    }
+
+    input->bytes += length;
+    input->count++;
+}
+
+static void load_corpus(corpus * const input, const char * const name, const char * const text, size_t length, cJSON_bool lines)
+{
+    size_t maximum_count = 1;
+    size_t start = 0;
+    size_t index = 0;
+
+    memset(input, '\0', sizeof(corpus));
+    input->name = name;
+
+    if (lines)
+    {
+        for (index = 0; index < length; index++)
+        {
+            maximum_count += (text[index] == '\n') ? 1 : 0;
+        }
+    }
+    input->documents = (document*)checked_malloc(maximum_count * sizeof(document));
+
+    if (!lines)
+    {
+        add_document(input, text, length);
+    }
+    else
+    {
+        for (index = 0; index <= length; index++)
+        {
+            if ((index == length) || (text[index] == '\n'))
+            {
+                if (index > start)
+                {
+                    add_document(input, text + start, index - start);
+                }
+                start = index + 1;
+            }
+        }
+    }
+
+    input->scratch = (char*)checked_malloc(length + 1);
+}
+
+static void free_corpus(corpus * const input)
+{
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        free(input->documents[index].text);
+        cJSON_Delete(input->documents[index].tree);
+        cJSON_Delete(input->documents[index].copy);
+        cJSON_Delete(input->documents[index].modified);
+        cJSON_Delete(input->documents[index].patches);
+        cJSON_Delete(input->documents[index].packed);
+        cJSON_free(input->documents[index].cbor);
+    }
+    free(input->documents);
+    free(input->scratch);
+}
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / (double)CLOCKS_PER_SEC;
+}
+
+static void check(cJSON_bool success, const char * const what)
+{
+    if (!success)
+    {
+        fprintf(stderr, "%s failed\n", what);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static double run_parse(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *tree = cJSON_ParseWithLength(input->documents[index].text, input->documents[index].length);
+        check(tree != NULL, "parsing");
+        cJSON_Delete(tree);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_parse_reused(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+    cJSON_Parser *parser = cJSON_Parser_Create(NULL);
+
+    check(parser != NULL, "creating a parser");
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *tree = cJSON_Parser_Parse(parser, input->documents[index].text, input->documents[index].length, NULL);
+        check(tree != NULL, "parsing");
+        cJSON_Parser_Release(parser, tree);
+    }
+    cJSON_Parser_Delete(parser);
+
+    return seconds_since(start);
+}
+
+/* parse_cached is parse with a cache that the first pass has filled already */
+static void enable_cache(corpus * const input)
+{
+    check(cJSON_EnableCache(1048576, 4096), "enabling the cache");
+    run_parse(input);
+}
+
+static void disable_cache(corpus * const input)
+{
+    (void)input;
+    cJSON_DisableCache();
+}
+
+/* one pool for the whole corpus, like a program that parses records of the same shape */
+static double run_parse_pooled(corpus * const input)
+{
+    cJSON_ParseOptions options;
+    clock_t start = 0;
+    double seconds = 0;
+    size_t index = 0;
+
+    memset(&options, 0, sizeof(options));
+    options.key_pool = cJSON_KeyPool_Create();
+    check(options.key_pool != NULL, "creating a key pool");
+    start = clock();
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *tree = cJSON_ParseWithOptions(input->documents[index].text, input->documents[index].length, &options, NULL);
+        check(tree != NULL, "parsing");
+        cJSON_Delete(tree);
+    }
+    seconds = seconds_since(start);
+    cJSON_KeyPool_Delete(options.key_pool);
+
+    return seconds;
+}
+
+static double run_print(corpus * const input, cJSON_bool format)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        char *printed = format ? cJSON_Print(input->documents[index].tree) : cJSON_PrintUnformatted(input->documents[index].tree);
+        check(printed != NULL, "printing");
+        cJSON_free(printed);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_print_formatted(corpus * const input)
+{
+    return run_print(input, 1);
+}
+
+static double run_print_unformatted(corpus * const input)
+{
+    return run_print(input, 0);
+}
+
+static double run_parse_packed(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *tree = parse_packed(input->documents[index].text, input->documents[index].length);
+        check(tree != NULL, "parsing packed");
+        cJSON_Delete(tree);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_print_packed(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        char *printed = cJSON_PrintUnformatted(input->documents[index].packed);
+        check(printed != NULL, "printing packed");
+        cJSON_free(printed);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_print_reused(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+    cJSON_Printer *printer = cJSON_Printer_Create(0);
+
+    check(printer != NULL, "creating a printer");
+    for (index = 0; index < input->count; index++)
+    {
+        check(cJSON_Printer_Print(printer, input->documents[index].tree, NULL) != NULL, "printing");
+    }
+    cJSON_Printer_Delete(printer);
+
+    return seconds_since(start);
+}
+
+static double run_print_cbor(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        unsigned char *encoded = cJSON_PrintCBOR(input->documents[index].tree, NULL);
+        check(encoded != NULL, "encoding CBOR");
+        cJSON_free(encoded);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_parse_cbor(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *tree = cJSON_ParseCBOR(input->documents[index].cbor, input->documents[index].cbor_length);
+        check(tree != NULL, "decoding CBOR");
+        cJSON_Delete(tree);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_minify(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        memcpy(input->scratch, input->documents[index].text, input->documents[index].length + 1);
+        cJSON_Minify(input->scratch);
+    }
+
+    return seconds_since(start);
+}
+
+/* builds a new tree with the usual create functions, like an encoder that prints a response */
+static cJSON *build_tree(const cJSON * const item)
+{
+    const cJSON *child = NULL;
+    cJSON *built = NULL;
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_False:
+        case cJSON_True:
+            return cJSON_CreateBool(cJSON_IsTrue(item));
+        case cJSON_NULL:
+            return cJSON_CreateNull();
+        case cJSON_Number:
+            return cJSON_CreateNumber(item->valuedouble);
+        case cJSON_String:
+            return cJSON_CreateString(item->valuestring);
+        default:
+            break;
+    }
+
+    built = cJSON_IsArray(item) ? cJSON_CreateArray() : cJSON_CreateObject();
+    check(built != NULL, "building");
+    cJSON_ArrayForEach(child, item)
+    {
+        cJSON *built_child = build_tree(child);
+        check(built_child != NULL, "building");
+        if (cJSON_IsArray(item))
+        {
+            check(cJSON_AddItemToArray(built, built_child), "building");
+        }
+        else
+        {
+            check(cJSON_AddItemToObject(built, child->string, built_child), "building");
+        }
+    }
+
+    return built;
+}
+
+/* writes the same values with the streaming writer */
+static void write_tree(cJSON_Writer * const writer, const cJSON * const item)
+{
+    const cJSON *child = NULL;
+    cJSON_bool success = 0;
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_False:
+        case cJSON_True:
+            success = cJSON_Writer_Bool(writer, cJSON_IsTrue(item));
+            break;
+        case cJSON_NULL:
+            success = cJSON_Writer_Null(writer);
+            break;
+        case cJSON_Number:
+            success = cJSON_Writer_Number(writer, item->valuedouble);
+            break;
+        case cJSON_String:
+            success = cJSON_Writer_String(writer, item->valuestring);
+            break;
+        case cJSON_Array:
+            success = cJSON_Writer_BeginArray(writer);
+            cJSON_ArrayForEach(child, item)
+            {
+                write_tree(writer, child);
+            }
+            success = success && cJSON_Writer_EndArray(writer);
+            break;
+        default:
+            success = cJSON_Writer_BeginObject(writer);
+            cJSON_ArrayForEach(child, item)
+            {
+                success = success && cJSON_Writer_Key(writer, child->string);
+                write_tree(writer, child);
+            }
+            success = success && cJSON_Writer_EndObject(writer);
+            break;
+    }
+    check(success, "writing");
+}
+
+static double run_build_print(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *built = build_tree(input->documents[index].tree);
+        char *printed = cJSON_PrintUnformatted(built);
+        check(printed != NULL, "printing");
+        cJSON_free(printed);
+        cJSON_Delete(built);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_write(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+    cJSON_Writer *writer = cJSON_Writer_Create(0);
+
+    check(writer != NULL, "creating a writer");
+    for (index = 0; index < input->count; index++)
+    {
+        check(cJSON_Writer_Reset(writer), "resetting the writer");
+        write_tree(writer, input->documents[index].tree);
+        check(cJSON_Writer_Finish(writer), "writing");
+    }
+    cJSON_Writer_Delete(writer);
+
+    return seconds_since(start);
+}
+
+static double run_duplicate(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *duplicate = cJSON_Duplicate(input->documents[index].tree, 1);
+        check(duplicate != NULL, "duplicating");
+        cJSON_Delete(duplicate);
+    }
+
+    return seconds_since(start);
+}
+
+static double run_compare(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        check(cJSON_Compare(input->documents[index].tree, input->documents[index].copy, 1), "comparing");
+    }
+
+    return seconds_since(start);
+}
+
+static double run_generate_patches(corpus * const input)
+{
+    clock_t start = clock();
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *patches = cJSONUtils_GeneratePatchesCaseSensitive(input->documents[index].tree, input->documents[index].modified);
+        check(patches != NULL, "generating patches");
+        cJSON_Delete(patches);
+    }
+
+    return seconds_since(start);
+}
+
+/* only the patching is timed, not making the copy that is patched */
+static double run_apply_patches(corpus * const input)
+{
+    double seconds = 0;
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *target = cJSON_Duplicate(input->documents[index].tree, 1);
+        clock_t start = 0;
+        check(target != NULL, "duplicating");
+
+        start = clock();
+        check(cJSONUtils_ApplyPatchesCaseSensitive(target, input->documents[index].patches) == 0, "applying patches");
+        seconds += seconds_since(start);
+
+        cJSON_Delete(target);
+    }
+
+    return seconds;
+}
+
+static void sort_objects(cJSON * const item)
+{
+    cJSON *child = NULL;
+
+    if (cJSON_IsObject(item))
+    {
+        cJSONUtils_SortObjectCaseSensitive(item);
+    }
+    cJSON_ArrayForEach(child, item)
+    {
+        sort_objects(child);
+    }
+}
+
+/* only the sorting is timed, not making the copy that is sorted */
+static double run_sort_objects(corpus * const input)
+{
+    double seconds = 0;
+    size_t index = 0;
+
+    for (index = 0; index < input->count; index++)
+    {
+        cJSON *target = cJSON_Duplicate(input->documents[index].tree, 1);
+        clock_t start = 0;
+        check(target != NULL, "duplicating");
+
+        start = clock();
+        sort_objects(target);
+        seconds += seconds_since(start);
+
+        cJSON_Delete(target);
+    }
+
+    return seconds;
+}
+
+static void benchmark(FILE * const output, corpus * const input, const operation * const current, double minimum_seconds)
+{
+    cJSON_Stats stats;
+    double seconds = 0;
+    unsigned long iterations = 0;
+
+    if (current->prepare != NULL)
+    {
+        current->prepare(input);
+    }
+
+    /* warm up and count the allocations */
+    cJSON_StartStats(&stats);
+    current->run(input);
+    cJSON_StopStats();
+
+    while ((seconds < minimum_seconds) || (iterations == 0))
+    {
+        seconds += current->run(input);
+        iterations++;
+    }
+
+    if (current->finish != NULL)
+    {
+        current->finish(input);
+    }
+
+    fprintf(output, "{\"corpus\":\"%s\",\"documents\":%lu,\"bytes\":%lu,\"operation\":\"%s\",\"iterations\":%lu,\"seconds\":%.4f,\"mb_per_s\":%.2f,\"allocations_per_document\":%.1f,\"bytes_per_document\":%.1f,\"peak_bytes\":%lu}\n",
+        input->name,
+        (unsigned long)input->count,
+        (unsigned long)input->bytes,
+        current->name,
+        iterations,
+        seconds,
+        (seconds > 0) ? ((double)input->bytes * (double)iterations / seconds / 1e6) : 0.0,
+        (double)stats.allocations / (double)input->count,
+        (double)stats.allocated_bytes / (double)input->count,
+        (unsigned long)stats.peak_live_bytes);
+    fflush(output);
+}
+
+static void run_corpus(FILE * const output, corpus * const input, double minimum_seconds)
+{
+    static const operation operations[] =
+    {
+        { "parse", run_parse, NULL, NULL },
+        { "parse_reused", run_parse_reused, NULL, NULL },
+        { "parse_cached", run_parse, enable_cache, disable_cache },
+        { "parse_pooled", run_parse_pooled, NULL, NULL },
+        { "print_formatted", run_print_formatted, NULL, NULL },
+        { "print_unformatted", run_print_unformatted, NULL, NULL },
+        { "print_reused", run_print_reused, NULL, NULL },
+        { "build_print", run_build_print, NULL, NULL },
+        { "write", run_write, NULL, NULL },
+        { "parse_packed", run_parse_packed, NULL, NULL },
+        { "print_packed", run_print_packed, NULL, NULL },
+        { "print_cbor", run_print_cbor, NULL, NULL },
+        { "parse_cbor", run_parse_cbor, NULL, NULL },
+        { "minify", run_minify, NULL, NULL },
+        { "duplicate", run_duplicate, NULL, NULL },
+        { "compare", run_compare, NULL, NULL },
+        { "generate_patches", run_generate_patches, NULL, NULL },
+        { "apply_patches", run_apply_patches, NULL, NULL },
+        { "sort_objects", run_sort_objects, NULL, NULL }
+    };
+    size_t index = 0;
+
+    for (index = 0; index < (sizeof(operations) / sizeof(operations[0])); index++)
+    {
+        benchmark(output, input, &operations[index], minimum_seconds);
+    }
+}
+
+static void run_generated(FILE * const output, const char * const name, void (*generate)(text_buffer * const), cJSON_bool lines, double minimum_seconds)
+{
+    text_buffer buffer = { NULL, 0, 0 };
+    corpus input;
+
+    random_state = 1;
+    generate(&buffer);
+    load_corpus(&input, name, buffer.data, buffer.length, lines);
+    free(buffer.data);
+
+    run_corpus(output, &input, minimum_seconds);
+    free_corpus(&input);
+}
+
+static int usage(const char * const program)
+{
+    fprintf(stderr, "usage: %s [-t minimum seconds per operation] [-o output file] [file.json|file.ndjson ...]\n", program);
+    return EXIT_FAILURE;
+}
+
+int CJSON_CDECL main(int argc, char **argv)
+{
+    FILE *output = stdout;
+    double minimum_seconds = 0.5;
+    int argument = 1;
+    cJSON_bool files_given = 0;
+
+    for (argument = 1; (argument < argc) && (argv[argument][0] == '-'); argument++)
+    {
+        if ((strcmp(argv[argument], "-t") == 0) && ((argument + 1) < argc))
+        {
+            minimum_seconds = atof(argv[++argument]);
+        }
+        else if ((strcmp(argv[argument], "-o") == 0) && ((argument + 1) < argc))
+        {
+            output = fopen(argv[++argument], "w");
+            if (output == NULL)
+            {
+                fprintf(stderr, "can't open %s\n", argv[argument]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    for (; argument < argc; argument++)
+    {
+        size_t length = 0;
+        size_t name_length = strlen(argv[argument]);
+        char *content = read_file(argv[argument], &length);
+        corpus input;
+        if (content == NULL)
+        {
+            fprintf(stderr, "can't read %s\n", argv[argument]);
+            return EXIT_FAILURE;
+        }
+
+        load_corpus(&input, argv[argument], content, length, (name_length > 7) && (strcmp(argv[argument] + name_length - 7, ".ndjson") == 0));
+        free(content);
+        run_corpus(output, &input, minimum_seconds);
+        free_corpus(&input);
+        files_given = 1;
+    }
+
+    if (!files_given)
+    {
+        run_generated(output, "twitter", generate_twitter, 0, minimum_seconds);
+        run_generated(output, "canada", generate_canada, 0, minimum_seconds);
+        run_generated(output, "citm_catalog", generate_citm, 0, minimum_seconds);
+        run_generated(output, "nested", generate_nested, 0, minimum_seconds);
+        run_generated(output, "escapes", generate_escapes, 0, minimum_seconds);
+        run_generated(output, "ndjson", generate_ndjson, 1, minimum_seconds);
+    }
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    return EXIT_SUCCESS;
+}
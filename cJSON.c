@@ -185,1699 +185,5587 @@ static void * CJSON_CDECL internal_realloc(void *pointer, size_t size)
 
 static internal_hooks global_hooks = { internal_malloc, internal_free, internal_realloc };
 
-static unsigned char* cJSON_strdup(const unsigned char* string, const internal_hooks * const hooks)
+/* Allocation statistics and the side table of items are kept per thread if the compiler supports thread local
+ * storage. */
+#ifndef CJSON_THREAD_LOCAL
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_THREADS__)
+#define CJSON_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+#define CJSON_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define CJSON_THREAD_LOCAL __declspec(thread)
+#else
+#define CJSON_THREAD_LOCAL
+#endif
+#endif
+
+typedef struct
 {
-    size_t length = 0;
-    unsigned char *copy = NULL;
+    const void *pointer; /* NULL for an empty slot */
+    size_t size;
+} allocation_record;
 
-    if (string == NULL)
+typedef struct
+{
+    cJSON_Stats *stats; /* NULL if nothing is counted */
+    allocation_record *records; /* open addressing table of live allocations, hashed by address */
+    size_t record_count;
+    size_t record_capacity;
+    internal_hooks hooks; /* used for the table itself */
+} stats_collector;
+
+static CJSON_THREAD_LOCAL stats_collector collector = { NULL, NULL, 0, 0, { NULL, NULL, NULL } };
+
+/* the allocator behind the counting hooks while they are installed */
+static internal_hooks counted_hooks = { internal_malloc, internal_free, internal_realloc };
+
+/* The number of threads that count allocations, the counting hooks are installed while it isn't 0. */
+#if defined(__GNUC__) || defined(__clang__)
+#define increment_counter(counter) __sync_add_and_fetch(counter, 1)
+#define decrement_counter(counter) __sync_sub_and_fetch(counter, 1)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define increment_counter(counter) _InterlockedIncrement(counter)
+#define decrement_counter(counter) _InterlockedDecrement(counter)
+#else
+#define increment_counter(counter) (++*(counter))
+#define decrement_counter(counter) (--*(counter))
+#endif
+static volatile long counting_threads = 0;
+
+static size_t hash_pointer(const void * const pointer)
+{
+    size_t address = (size_t)pointer;
+
+    /* allocations are aligned, so the low bits don't carry much information */
+    return (address >> 4) ^ (address >> 11);
+}
+
+static size_t find_record_slot(const allocation_record * const records, const size_t capacity, const void * const pointer)
+{
+    size_t slot = hash_pointer(pointer) & (capacity - 1);
+
+    while ((records[slot].pointer != NULL) && (records[slot].pointer != pointer))
     {
-        return NULL;
+        slot = (slot + 1) & (capacity - 1);
     }
 
-    length = strlen((const char*)string) + sizeof("");
-    copy = (unsigned char*)hooks->allocate(length);
-    if (copy == NULL)
+    return slot;
+}
+
+static void add_allocation_record(const void * const pointer, const size_t size)
+{
+    size_t slot = 0;
+
+    if ((collector.record_count + 1) * 2 > collector.record_capacity)
     {
-        return NULL;
+        size_t new_capacity = (collector.record_capacity == 0) ? 256 : (collector.record_capacity * 2);
+        allocation_record *new_records = (allocation_record*)collector.hooks.allocate(new_capacity * sizeof(allocation_record));
+        size_t old_slot = 0;
+        if (new_records == NULL)
+        {
+            /* the allocation is still counted, but its size won't be subtracted when it is freed */
+            return;
+        }
+        memset(new_records, '\0', new_capacity * sizeof(allocation_record));
+        for (old_slot = 0; old_slot < collector.record_capacity; old_slot++)
+        {
+            if (collector.records[old_slot].pointer != NULL)
+            {
+                new_records[find_record_slot(new_records, new_capacity, collector.records[old_slot].pointer)] = collector.records[old_slot];
+            }
+        }
+        if (collector.records != NULL)
+        {
+            collector.hooks.deallocate(collector.records);
+        }
+        collector.records = new_records;
+        collector.record_capacity = new_capacity;
     }
-    memcpy(copy, string, length);
 
-    return copy;
+    slot = find_record_slot(collector.records, collector.record_capacity, pointer);
+    if (collector.records[slot].pointer == NULL)
+    {
+        collector.record_count++;
+    }
+    collector.records[slot].pointer = pointer;
+    collector.records[slot].size = size;
 }
 
-CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
+/* returns the size of a counted allocation and forgets it, 0 if it was allocated before counting started */
+static size_t remove_allocation_record(const void * const pointer)
 {
-    if (hooks == NULL)
+    size_t mask = collector.record_capacity - 1;
+    size_t slot = 0;
+    size_t next = 0;
+    size_t size = 0;
+
+    if (collector.record_count == 0)
     {
-        /* Reset hooks */
-        global_hooks.allocate = malloc;
-        global_hooks.deallocate = free;
-        global_hooks.reallocate = realloc;
-        return;
+        return 0;
     }
 
-    global_hooks.allocate = malloc;
-    if (hooks->malloc_fn != NULL)
+    slot = find_record_slot(collector.records, collector.record_capacity, pointer);
+    if (collector.records[slot].pointer == NULL)
     {
-        global_hooks.allocate = hooks->malloc_fn;
+        return 0;
     }
+    size = collector.records[slot].size;
+    collector.records[slot].pointer = NULL;
+    collector.record_count--;
 
-    global_hooks.deallocate = free;
-    if (hooks->free_fn != NULL)
+    /* move following records of the same cluster back so lookups don't stop at the hole */
+    for (next = (slot + 1) & mask; collector.records[next].pointer != NULL; next = (next + 1) & mask)
     {
-        global_hooks.deallocate = hooks->free_fn;
+        size_t home = hash_pointer(collector.records[next].pointer) & mask;
+        /* move it if its home slot isn't cyclically between the hole and its current slot */
+        if (((next > slot) && ((home <= slot) || (home > next))) || ((next < slot) && ((home <= slot) && (home > next))))
+        {
+            collector.records[slot] = collector.records[next];
+            collector.records[next].pointer = NULL;
+            slot = next;
+        }
     }
 
-    /* use realloc only if both free and malloc are used */
-    global_hooks.reallocate = NULL;
-    if ((global_hooks.allocate == malloc) && (global_hooks.deallocate == free))
+    return size;
+}
+
+static void count_allocation(const void * const pointer, const size_t size)
+{
+    cJSON_Stats *stats = collector.stats;
+
+    stats->allocations++;
+    stats->allocated_bytes += size;
+    stats->live_bytes += size;
+    if (stats->live_bytes > stats->peak_live_bytes)
     {
-        global_hooks.reallocate = realloc;
+        stats->peak_live_bytes = stats->live_bytes;
     }
+    add_allocation_record(pointer, size);
 }
 
-/* Internal constructor. */
-static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
+static void count_deallocation(const void * const pointer)
 {
-    cJSON* node = (cJSON*)hooks->allocate(sizeof(cJSON));
-    if (node)
+    collector.stats->deallocations++;
+    collector.stats->live_bytes -= remove_allocation_record(pointer);
+}
+
+static void * CJSON_CDECL counting_allocate(size_t size)
+{
+    void *pointer = counted_hooks.allocate(size);
+
+    if ((collector.stats != NULL) && (pointer != NULL))
     {
-        memset(node, '\0', sizeof(cJSON));
+        count_allocation(pointer, size);
     }
 
-    return node;
+    return pointer;
 }
 
-/* Delete a cJSON structure. */
-CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+static void CJSON_CDECL counting_deallocate(void *pointer)
 {
-    cJSON *next = NULL;
-    while (item != NULL)
+    if ((collector.stats != NULL) && (pointer != NULL))
     {
-        next = item->next;
-        if (!(item->type & cJSON_IsReference) && (item->child != NULL))
-        {
-            cJSON_Delete(item->child);
-        }
-        if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
-        {
-            global_hooks.deallocate(item->valuestring);
-            item->valuestring = NULL;
-        }
-        if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+        count_deallocation(pointer);
+    }
+
+    counted_hooks.deallocate(pointer);
+}
+
+static void * CJSON_CDECL counting_reallocate(void *pointer, size_t size)
+{
+    void *new_pointer = counted_hooks.reallocate(pointer, size);
+
+    if ((collector.stats != NULL) && (new_pointer != NULL))
+    {
+        if (pointer != NULL)
         {
-            global_hooks.deallocate(item->string);
-            item->string = NULL;
+            count_deallocation(pointer);
         }
-        global_hooks.deallocate(item);
-        item = next;
+        count_allocation(new_pointer, size);
     }
+
+    return new_pointer;
 }
 
-/* get the decimal point character of the current locale */
-static unsigned char get_decimal_point(void)
+/* put the counting functions in front of the current allocator */
+static void install_counting_hooks(void)
 {
-#ifdef ENABLE_LOCALES
-    struct lconv *lconv = localeconv();
-    return (unsigned char) lconv->decimal_point[0];
-#else
-    return '.';
-#endif
+    counted_hooks = global_hooks;
+    global_hooks.allocate = counting_allocate;
+    global_hooks.deallocate = counting_deallocate;
+    global_hooks.reallocate = (counted_hooks.reallocate != NULL) ? counting_reallocate : NULL;
 }
 
-typedef struct
+/* give the allocator its place back once no thread counts anymore */
+static void remove_counting_hooks(void)
 {
-    const unsigned char *content;
-    size_t length;
-    size_t offset;
-    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
-    internal_hooks hooks;
-} parse_buffer;
-
-/* check if the given size is left to read in a given parse buffer (starting with 1) */
-#define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
-/* check if the buffer can be accessed at the given index (starting with 0) */
-#define can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
-#define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
-/* get a pointer to the buffer at the position */
-#define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+    global_hooks = counted_hooks;
+}
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+CJSON_PUBLIC(void) cJSON_StartStats(cJSON_Stats *stats)
 {
-    double number = 0;
-    unsigned char *after_end = NULL;
-    unsigned char *number_c_string;
-    unsigned char decimal_point = get_decimal_point();
-    size_t i = 0;
-    size_t number_string_length = 0;
-    cJSON_bool has_decimal_point = false;
+    cJSON_StopStats();
 
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if (stats == NULL)
     {
-        return false;
+        return;
     }
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; can_access_at_index(input_buffer, i); i++)
+    if (increment_counter(&counting_threads) == 1)
     {
-        switch (buffer_at_offset(input_buffer)[i])
-        {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '+':
-            case '-':
-            case 'e':
-            case 'E':
-                number_string_length++;
-                break;
+        install_counting_hooks();
+    }
 
-            case '.':
-                number_string_length++;
-                has_decimal_point = true;
-                break;
+    memset(stats, '\0', sizeof(cJSON_Stats));
+    collector.hooks = counted_hooks;
+    collector.stats = stats;
+}
 
-            default:
-                goto loop_end;
-        }
-    }
-loop_end:
-    /* malloc for temporary buffer, add 1 for '\0' */
-    number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
-    if (number_c_string == NULL)
+CJSON_PUBLIC(void) cJSON_StopStats(void)
+{
+    if (collector.stats == NULL)
     {
-        return false; /* allocation failure */
+        return;
     }
 
-    memcpy(number_c_string, buffer_at_offset(input_buffer), number_string_length);
-    number_c_string[number_string_length] = '\0';
-
-    if (has_decimal_point)
+    collector.stats = NULL;
+    if (decrement_counter(&counting_threads) == 0)
     {
-        for (i = 0; i < number_string_length; i++)
-        {
-            if (number_c_string[i] == '.')
-            {
-                /* replace '.' with the decimal point of the current locale (for strtod) */
-                number_c_string[i] = decimal_point;
-            }
-        }
+        remove_counting_hooks();
     }
-
-    number = strtod((const char*)number_c_string, (char**)&after_end);
-    if (number_c_string == after_end)
+    if (collector.records != NULL)
     {
-        /* free the temporary buffer */
-        input_buffer->hooks.deallocate(number_c_string);
-        return false; /* parse_error */
+        collector.hooks.deallocate(collector.records);
+        collector.records = NULL;
     }
+    collector.record_count = 0;
+    collector.record_capacity = 0;
+}
 
-    item->valuedouble = number;
+/* Item cache: deleted nodes and short strings are kept per thread and handed out again instead of
+ * allocating new ones. Strings are kept by their length, not the size of their allocation, which isn't known:
+ * a string of length n is at least n + 1 bytes large, so it can hold any other string of that length. */
+#define CACHE_STRING_SIZES 64
 
-    /* use saturation in case of overflow */
-    if (number >= INT_MAX)
-    {
-        item->valueint = INT_MAX;
-    }
-    else if (number <= (double)INT_MIN)
+typedef struct
+{
+    size_t max_nodes; /* 0 if the cache is off */
+    size_t max_strings; /* per size */
+    cJSON *nodes; /* linked through next */
+    size_t node_count;
+    char **strings; /* max_strings slots for every size from 1 to CACHE_STRING_SIZES */
+    size_t string_counts[CACHE_STRING_SIZES];
+    cJSON_CacheStats stats;
+} item_cache;
+
+static CJSON_THREAD_LOCAL item_cache cache = { 0, 0, NULL, 0, NULL, { 0 }, { 0, 0, 0, 0, 0, 0 } };
+
+static cJSON *cached_node(void)
+{
+    cJSON *node = cache.nodes;
+
+    if (cache.max_nodes == 0)
     {
-        item->valueint = INT_MIN;
+        return NULL;
     }
-    else
+    if (node == NULL)
     {
-        item->valueint = (int)number;
+        cache.stats.node_misses++;
+        return NULL;
     }
 
-    item->type = cJSON_Number;
+    cache.nodes = node->next;
+    cache.node_count--;
+    cache.stats.node_hits++;
 
-    input_buffer->offset += (size_t)(after_end - number_c_string);
-    /* free the temporary buffer */
-    input_buffer->hooks.deallocate(number_c_string);
-    return true;
+    return node;
 }
 
-/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
-CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
+static void free_node(cJSON * const node)
 {
-    if (number >= INT_MAX)
+    if (cache.node_count < cache.max_nodes)
     {
-        object->valueint = INT_MAX;
+        node->next = cache.nodes;
+        cache.nodes = node;
+        cache.node_count++;
+        return;
     }
-    else if (number <= (double)INT_MIN)
+
+    global_hooks.deallocate(node);
+}
+
+/* a string of at least size bytes */
+static unsigned char *allocate_string(const size_t size)
+{
+    size_t index = size - 1;
+
+    if (cache.max_strings == 0)
     {
-        object->valueint = INT_MIN;
+        return (unsigned char*)global_hooks.allocate(size);
     }
-    else
+
+    /* only strings of the same length are used, so buffers don't drift to shorter lengths */
+    if ((index < CACHE_STRING_SIZES) && (cache.string_counts[index] > 0))
     {
-        object->valueint = (int)number;
+        cache.string_counts[index]--;
+        cache.stats.string_hits++;
+        return (unsigned char*)cache.strings[(index * cache.max_strings) + cache.string_counts[index]];
     }
+    cache.stats.string_misses++;
 
-    return object->valuedouble = number;
+    return (unsigned char*)global_hooks.allocate(size);
 }
 
-/* Note: when passing a NULL valuestring, cJSON_SetValuestring treats this as an error and return NULL */
-CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
+static void free_string(char * const string)
 {
-    char *copy = NULL;
-    size_t v1_len;
-    size_t v2_len;
-    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
-    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
+    size_t index = 0;
+
+    if (cache.max_strings != 0)
     {
-        return NULL;
+        while ((index < CACHE_STRING_SIZES) && (string[index] != '\0'))
+        {
+            index++;
+        }
+        /* the string plus its terminator fit, so at least index + 1 bytes are allocated */
+        if ((index < CACHE_STRING_SIZES) && (cache.string_counts[index] < cache.max_strings))
+        {
+            cache.strings[(index * cache.max_strings) + cache.string_counts[index]] = string;
+            cache.string_counts[index]++;
+            return;
+        }
     }
-    /* return NULL if the object is corrupted or valuestring is NULL */
-    if (object->valuestring == NULL || valuestring == NULL)
+
+    global_hooks.deallocate(string);
+}
+
+static void clear_cache(void)
+{
+    size_t index = 0;
+    size_t slot = 0;
+    cJSON *next = NULL;
+
+    while (cache.nodes != NULL)
     {
-        return NULL;
+        next = cache.nodes->next;
+        global_hooks.deallocate(cache.nodes);
+        cache.nodes = next;
     }
+    cache.node_count = 0;
 
-    v1_len = strlen(valuestring);
-    v2_len = strlen(object->valuestring);
-
-    if (v1_len <= v2_len)
+    if (cache.strings != NULL)
     {
-        /* strcpy does not handle overlapping string: [X1, X2] [Y1, Y2] => X2 < Y1 or Y2 < X1 */
-        if (!( valuestring + v1_len < object->valuestring || object->valuestring + v2_len < valuestring ))
+        for (index = 0; index < CACHE_STRING_SIZES; index++)
         {
-            return NULL;
+            for (slot = 0; slot < cache.string_counts[index]; slot++)
+            {
+                global_hooks.deallocate(cache.strings[(index * cache.max_strings) + slot]);
+            }
+            cache.string_counts[index] = 0;
         }
-        strcpy(object->valuestring, valuestring);
-        return object->valuestring;
     }
-    copy = (char*) cJSON_strdup((const unsigned char*)valuestring, &global_hooks);
-    if (copy == NULL)
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_EnableCache(size_t max_nodes, size_t max_strings)
+{
+    char **strings = NULL;
+
+    cJSON_DisableCache();
+
+    if ((max_strings != 0) && (max_strings <= ((size_t)-1 / sizeof(char*) / CACHE_STRING_SIZES)))
     {
-        return NULL;
+        strings = (char**)global_hooks.allocate(max_strings * CACHE_STRING_SIZES * sizeof(char*));
     }
-    if (object->valuestring != NULL)
+    if ((max_strings != 0) && (strings == NULL))
     {
-        cJSON_free(object->valuestring);
+        return false;
     }
-    object->valuestring = copy;
 
-    return copy;
+    memset(&cache.stats, '\0', sizeof(cache.stats));
+    cache.strings = strings;
+    cache.max_strings = max_strings;
+    cache.max_nodes = max_nodes;
+
+    return true;
 }
 
-typedef struct
+CJSON_PUBLIC(void) cJSON_DisableCache(void)
 {
-    unsigned char *buffer;
-    size_t length;
-    size_t offset;
-    size_t depth; /* current nesting depth (for formatted printing) */
-    cJSON_bool noalloc;
-    cJSON_bool format; /* is this print a formatted print */
-    internal_hooks hooks;
-} printbuffer;
+    clear_cache();
+    if (cache.strings != NULL)
+    {
+        global_hooks.deallocate(cache.strings);
+        cache.strings = NULL;
+    }
+    cache.max_nodes = 0;
+    cache.max_strings = 0;
+}
 
-/* realloc printbuffer if necessary to have at least "needed" bytes more */
-static unsigned char* ensure(printbuffer * const p, size_t needed)
+CJSON_PUBLIC(void) cJSON_GetCacheStats(cJSON_CacheStats *stats)
 {
-    unsigned char *newbuffer = NULL;
-    size_t newsize = 0;
+    size_t index = 0;
 
-    if ((p == NULL) || (p->buffer == NULL))
+    if (stats == NULL)
     {
-        return NULL;
+        return;
     }
 
-    if ((p->length > 0) && (p->offset >= p->length))
+    *stats = cache.stats;
+    stats->cached_nodes = cache.node_count;
+    stats->cached_strings = 0;
+    for (index = 0; index < CACHE_STRING_SIZES; index++)
     {
-        /* make sure that offset is valid */
-        return NULL;
+        stats->cached_strings += cache.string_counts[index];
     }
+}
 
-    if (needed > INT_MAX)
+static unsigned char* cJSON_strdup(const unsigned char* string, const internal_hooks * const hooks)
+{
+    size_t length = 0;
+    unsigned char *copy = NULL;
+
+    if (string == NULL)
     {
-        /* sizes bigger than INT_MAX are currently not supported */
         return NULL;
     }
 
-    needed += p->offset + 1;
-    if (needed <= p->length)
+    length = strlen((const char*)string) + sizeof("");
+    copy = (hooks->allocate == global_hooks.allocate) ? allocate_string(length) : (unsigned char*)hooks->allocate(length);
+    if (copy == NULL)
     {
-        return p->buffer + p->offset;
-    }
-
-    if (p->noalloc) {
         return NULL;
     }
+    memcpy(copy, string, length);
 
-    /* calculate new buffer size */
-    if (needed > (INT_MAX / 2))
+    return copy;
+}
+
+CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
+{
+    /* cached items have to be freed by the allocator they came from */
+    clear_cache();
+
+    if (hooks == NULL)
     {
-        /* overflow of int, use INT_MAX if possible */
-        if (needed <= INT_MAX)
-        {
-            newsize = INT_MAX;
-        }
-        else
+        /* Reset hooks */
+        global_hooks.allocate = malloc;
+        global_hooks.deallocate = free;
+        global_hooks.reallocate = realloc;
+        if (counting_threads != 0)
         {
-            return NULL;
+            install_counting_hooks();
         }
+        return;
     }
-    else
+
+    global_hooks.allocate = malloc;
+    if (hooks->malloc_fn != NULL)
     {
-        newsize = needed * 2;
+        global_hooks.allocate = hooks->malloc_fn;
     }
 
-    if (p->hooks.reallocate != NULL)
+    global_hooks.deallocate = free;
+    if (hooks->free_fn != NULL)
     {
-        /* reallocate with realloc if available */
-        newbuffer = (unsigned char*)p->hooks.reallocate(p->buffer, newsize);
-        if (newbuffer == NULL)
-        {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
-
-            return NULL;
-        }
+        global_hooks.deallocate = hooks->free_fn;
     }
-    else
-    {
-        /* otherwise reallocate manually */
-        newbuffer = (unsigned char*)p->hooks.allocate(newsize);
-        if (!newbuffer)
-        {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
 
-            return NULL;
-        }
+    /* use realloc only if both free and malloc are used */
+    global_hooks.reallocate = NULL;
+    if ((global_hooks.allocate == malloc) && (global_hooks.deallocate == free))
+    {
+        global_hooks.reallocate = realloc;
+    }
 
-        memcpy(newbuffer, p->buffer, p->offset + 1);
-        p->hooks.deallocate(p->buffer);
+    if (counting_threads != 0)
+    {
+        install_counting_hooks();
     }
-    p->length = newsize;
-    p->buffer = newbuffer;
+}
 
-    return newbuffer + p->offset;
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic push
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+/* helper function to cast away const */
+static void* cast_away_const(const void* string)
+{
+    return (void*)string;
 }
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic pop
+#endif
 
-/* calculate the new length of the string in a printbuffer and update the offset */
-static void update_offset(printbuffer * const buffer)
+/* Information about items that doesn't fit into the cJSON struct is kept in a side table keyed by address:
+ * parent links of trees passed to cJSON_TrackParents, hashes cached by cJSON_CacheHashes and where items
+ * parsed with track_source are in the source map of their document. Like the allocation statistics, the
+ * table is kept per thread, so threads that work on trees of their own never touch the same table. */
+#define NODE_PARENT_TRACKED 1
+#define NODE_HASH_CACHED 2
+
+typedef struct
 {
-    const unsigned char *buffer_pointer = NULL;
-    if ((buffer == NULL) || (buffer->buffer == NULL))
+    const cJSON *item; /* NULL for an empty slot */
+    const cJSON *parent; /* NULL for roots */
+    cJSON_HashValue hash;
+    struct source_map *source; /* NULL if item has no source range */
+    size_t source_entry; /* the entry of item in source */
+    unsigned char flags;
+} node_info;
+
+static CJSON_THREAD_LOCAL node_info *node_infos = NULL;
+static CJSON_THREAD_LOCAL size_t node_info_count = 0;
+static CJSON_THREAD_LOCAL size_t node_info_capacity = 0;
+
+static size_t find_node_slot(const node_info * const infos, const size_t capacity, const cJSON * const item)
+{
+    size_t slot = hash_pointer(item) & (capacity - 1);
+
+    while ((infos[slot].item != NULL) && (infos[slot].item != item))
     {
-        return;
+        slot = (slot + 1) & (capacity - 1);
     }
-    buffer_pointer = buffer->buffer + buffer->offset;
 
-    buffer->offset += strlen((const char*)buffer_pointer);
+    return slot;
 }
 
-/* securely comparison of floating-point variables */
-static cJSON_bool compare_double(double a, double b)
+static node_info *find_node_info(const cJSON * const item)
 {
-    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
-    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+    size_t slot = 0;
+
+    if ((node_info_count == 0) || (item == NULL))
+    {
+        return NULL;
+    }
+
+    slot = find_node_slot(node_infos, node_info_capacity, item);
+    return (node_infos[slot].item != NULL) ? &node_infos[slot] : NULL;
 }
 
-/* Render the number nicely from the given item into a string. */
-static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+/* Returns the (possibly new) entry of item. Pointers to other entries are invalid afterwards. */
+static node_info *add_node_info(const cJSON * const item)
 {
-    unsigned char *output_pointer = NULL;
-    double d = item->valuedouble;
-    int length = 0;
-    size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
+    size_t slot = 0;
 
-    if (output_buffer == NULL)
+    if ((node_info_count + 1) * 2 > node_info_capacity)
     {
-        return false;
+        size_t new_capacity = (node_info_capacity == 0) ? 64 : (node_info_capacity * 2);
+        node_info *new_infos = (node_info*)global_hooks.allocate(new_capacity * sizeof(node_info));
+        size_t old_slot = 0;
+        if (new_infos == NULL)
+        {
+            return NULL;
+        }
+        memset(new_infos, '\0', new_capacity * sizeof(node_info));
+        for (old_slot = 0; old_slot < node_info_capacity; old_slot++)
+        {
+            if (node_infos[old_slot].item != NULL)
+            {
+                new_infos[find_node_slot(new_infos, new_capacity, node_infos[old_slot].item)] = node_infos[old_slot];
+            }
+        }
+        if (node_infos != NULL)
+        {
+            global_hooks.deallocate(node_infos);
+        }
+        node_infos = new_infos;
+        node_info_capacity = new_capacity;
     }
 
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
-    {
-        length = sprintf((char*)number_buffer, "null");
-    }
-    else if(d == (double)item->valueint)
+    slot = find_node_slot(node_infos, node_info_capacity, item);
+    if (node_infos[slot].item == NULL)
     {
-        length = sprintf((char*)number_buffer, "%d", item->valueint);
+        memset(&node_infos[slot], '\0', sizeof(node_info));
+        node_infos[slot].item = item;
+        node_info_count++;
     }
-    else
-    {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char*)number_buffer, "%1.15g", d);
 
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
-        {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char*)number_buffer, "%1.17g", d);
-        }
-    }
+    return &node_infos[slot];
+}
 
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+/* Called for every item that is deleted, works like remove_allocation_record. */
+static void remove_node_info(const cJSON * const item)
+{
+    size_t mask = node_info_capacity - 1;
+    size_t slot = 0;
+    size_t next = 0;
+
+    slot = find_node_slot(node_infos, node_info_capacity, item);
+    if (node_infos[slot].item == NULL)
     {
-        return false;
+        return;
     }
+    node_infos[slot].item = NULL;
+    node_info_count--;
 
-    /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
+    if (node_info_count == 0)
     {
-        return false;
+        /* nothing is tracked anymore */
+        global_hooks.deallocate(node_infos);
+        node_infos = NULL;
+        node_info_capacity = 0;
+        return;
     }
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    for (next = (slot + 1) & mask; node_infos[next].item != NULL; next = (next + 1) & mask)
     {
-        if (number_buffer[i] == decimal_point)
+        size_t home = hash_pointer(node_infos[next].item) & mask;
+        if (((next > slot) && ((home <= slot) || (home > next))) || ((next < slot) && ((home <= slot) && (home > next))))
         {
-            output_pointer[i] = '.';
-            continue;
+            node_infos[slot] = node_infos[next];
+            node_infos[next].item = NULL;
+            slot = next;
         }
-
-        output_pointer[i] = number_buffer[i];
     }
-    output_pointer[i] = '\0';
+}
 
-    output_buffer->offset += (size_t)length;
+static cJSON_bool track_item(const cJSON * const item, const cJSON * const parent)
+{
+    node_info *info = add_node_info(item);
+
+    if (info == NULL)
+    {
+        return false;
+    }
+    info->parent = parent;
+    info->flags |= NODE_PARENT_TRACKED;
 
     return true;
 }
 
-/* parse 4 digit hexadecimal number */
-static unsigned parse_hex4(const unsigned char * const input)
+/* Parent links: once a container is tracked, everything that is linked below it
+ * by the add/insert/replace functions is tracked as well. The tree is walked without recursion,
+ * the way back up follows the links that were just recorded. */
+static cJSON_bool track_subtree(const cJSON * const root, const cJSON * const root_parent)
 {
-    unsigned int h = 0;
-    size_t i = 0;
+    const cJSON *item = root;
+    const cJSON *parent = root_parent;
 
-    for (i = 0; i < 4; i++)
+    for (;;)
     {
-        /* parse digit */
-        if ((input[i] >= '0') && (input[i] <= '9'))
-        {
-            h += (unsigned int) input[i] - '0';
-        }
-        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        if (!track_item(item, parent))
         {
-            h += (unsigned int) 10 + input[i] - 'A';
+            return false;
         }
-        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+
+        /* the children of a reference belong to the referenced tree, shared ones to the tree they were copied from */
+        if (!(item->type & (cJSON_IsReference | cJSON_IsShared)) && (item->child != NULL))
         {
-            h += (unsigned int) 10 + input[i] - 'a';
+            parent = item;
+            item = item->child;
+            continue;
         }
-        else /* invalid */
+
+        /* continue with the next sibling of item or of the closest item above it that has one */
+        while ((item != root) && (item->next == NULL))
         {
-            return 0;
+            item = parent;
+            parent = find_node_info(item)->parent;
         }
-
-        if (i < 3)
+        if (item == root)
         {
-            /* shift left to make place for the next nibble */
-            h = h << 4;
+            return true;
         }
+        item = item->next;
     }
-
-    return h;
 }
 
-/* converts a UTF-16 literal to UTF-8
- * A literal can be one or two sequences of the form \uXXXX */
-static unsigned char utf16_literal_to_utf8(const unsigned char * const input_pointer, const unsigned char * const input_end, unsigned char **output_pointer)
+/* Called whenever an item is linked below a parent. If the table can't grow,
+ * the links below item are missing and cJSON_GetParent returns NULL for them. */
+static void link_parent(const cJSON * const parent, const cJSON * const item)
 {
-    long unsigned int codepoint = 0;
-    unsigned int first_code = 0;
-    const unsigned char *first_sequence = input_pointer;
-    unsigned char utf8_length = 0;
-    unsigned char utf8_position = 0;
-    unsigned char sequence_length = 0;
-    unsigned char first_byte_mark = 0;
+    node_info *info = NULL;
 
-    if ((input_end - first_sequence) < 6)
+    if (node_info_count == 0)
     {
-        /* input ends unexpectedly */
-        goto fail;
+        return;
     }
 
-    /* get the first utf16 sequence */
-    first_code = parse_hex4(first_sequence + 2);
+    info = find_node_info(parent);
+    if ((info != NULL) && (info->flags & NODE_PARENT_TRACKED))
+    {
+        track_subtree(item, parent);
+        return;
+    }
 
-    /* check that the code is valid */
-    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+    /* a cached hash has to know its parent to invalidate it */
+    info = find_node_info(item);
+    if (info != NULL)
     {
-        goto fail;
+        info->parent = parent;
     }
+}
 
-    /* UTF16 surrogate pair */
-    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+/* A detached item becomes the root of its own tree. */
+static void unlink_parent(const cJSON * const item)
+{
+    node_info *info = find_node_info(item);
+
+    if (info != NULL)
     {
-        const unsigned char *second_sequence = first_sequence + 6;
-        unsigned int second_code = 0;
-        sequence_length = 12; /* \uXXXX\uXXXX */
+        info->parent = NULL;
+    }
+}
 
-        if ((input_end - second_sequence) < 6)
-        {
-            /* input ends unexpectedly */
-            goto fail;
-        }
+CJSON_PUBLIC(cJSON_bool) cJSON_TrackParents(cJSON *item)
+{
+    const node_info *info = NULL;
+    const cJSON *parent = NULL;
 
-        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
-        {
-            /* missing second half of the surrogate pair */
-            goto fail;
-        }
+    if (item == NULL)
+    {
+        return false;
+    }
 
-        /* get the second utf16 sequence */
-        second_code = parse_hex4(second_sequence + 2);
-        /* check that the code is valid */
-        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+    /* an item that is already known keeps its parent */
+    info = find_node_info(item);
+    if (info != NULL)
+    {
+        parent = info->parent;
+    }
+
+    return track_subtree(item, parent);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetParent(const cJSON *item)
+{
+    const node_info *info = find_node_info(item);
+
+    if ((info == NULL) || !(info->flags & NODE_PARENT_TRACKED))
+    {
+        return NULL;
+    }
+
+    return (cJSON*)cast_away_const(info->parent);
+}
+
+/* Packed arrays keep their numbers in valuestring and the count in valueint instead of one child per number. */
+static double *packed_numbers(const cJSON * const item)
+{
+    return (double*)(void*)item->valuestring;
+}
+
+static char *duplicate_packed(const cJSON * const item)
+{
+    size_t size = (size_t)item->valueint * sizeof(double);
+    char *copy = (char*)global_hooks.allocate(size);
+
+    if (copy != NULL)
+    {
+        memcpy(copy, item->valuestring, size);
+    }
+
+    return copy;
+}
+
+/* With CJSON_INLINE_STRINGS, strings shorter than INLINE_STRING_SIZE are kept in the valuedouble of their item,
+ * which strings don't use, instead of a separate allocation. valuestring points there, so they read like any other string. */
+#define INLINE_STRING_SIZE sizeof(double)
+
+static cJSON_bool has_inline_string(const cJSON * const item)
+{
+#if CJSON_INLINE_STRINGS
+    return (item->valuestring != NULL) && (item->valuestring == (const char*)(const void*)&item->valuedouble);
+#else
+    (void)item;
+    return false;
+#endif
+}
+
+/* Does a string of length bytes go into its item? */
+static cJSON_bool fits_inline(const size_t length)
+{
+#if CJSON_INLINE_STRINGS
+    return length < INLINE_STRING_SIZE;
+#else
+    (void)length;
+    return false;
+#endif
+}
+
+/* The empty inline storage of item. */
+static char *inline_string(cJSON * const item)
+{
+    memset(&item->valuedouble, '\0', INLINE_STRING_SIZE);
+
+    return (char*)(void*)&item->valuedouble;
+}
+
+/* A copy of the string of length bytes for item, inline if it is short enough. */
+static char *store_string(cJSON * const item, const char * const string, const size_t length)
+{
+    char *copy = NULL;
+
+    if (fits_inline(length))
+    {
+        copy = inline_string(item);
+    }
+    else
+    {
+        copy = (char*)allocate_string(length + sizeof(""));
+        if (copy == NULL)
         {
-            /* invalid second half of the surrogate pair */
-            goto fail;
+            return NULL;
         }
+    }
+    memcpy(copy, string, length);
+    copy[length] = '\0';
 
+    return copy;
+}
 
-        /* calculate the unicode codepoint from the surrogate pair */
-        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+/* The valuestring of item for its copy */
+static char *duplicate_value(const cJSON * const item, cJSON * const copy)
+{
+    if (item->type & cJSON_IsPacked)
+    {
+        return duplicate_packed(item);
     }
-    else
+    if (has_inline_string(item))
     {
-        sequence_length = 6; /* \uXXXX */
-        codepoint = first_code;
+        return store_string(copy, item->valuestring, strlen(item->valuestring));
     }
 
-    /* encode as UTF-8
-     * takes at maximum 4 bytes to encode:
-     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
-    if (codepoint < 0x80)
+    return (char*)cJSON_strdup((const unsigned char*)item->valuestring, &global_hooks);
+}
+
+/* valueint of a number, saturated in case of overflow */
+static int number_to_int(const double number)
+{
+    if (number >= INT_MAX)
     {
-        /* normal ascii, encoding 0xxxxxxx */
-        utf8_length = 1;
+        return INT_MAX;
     }
-    else if (codepoint < 0x800)
+    if (number <= (double)INT_MIN)
     {
-        /* two bytes, encoding 110xxxxx 10xxxxxx */
-        utf8_length = 2;
-        first_byte_mark = 0xC0; /* 11000000 */
+        return INT_MIN;
     }
-    else if (codepoint < 0x10000)
+
+    return (int)number;
+}
+
+/* Arrays and objects are parsed, printed, duplicated, hashed and compared with a stack of frames instead of
+ * recursion, so the nesting depth doesn't depend on the size of the C stack. The first frames are kept on the
+ * C stack, deeper ones on the heap. */
+#define INLINE_STACK_DEPTH 32
+
+/* Returns the stack with room for at least 'needed' elements of 'size' bytes, NULL if out of memory
+ * (the old stack is kept in that case). inline_stack is the initial stack if it isn't on the heap, it isn't freed. */
+static void *grow_stack(void * const stack, size_t * const capacity, const size_t needed, const size_t size, const void * const inline_stack)
+{
+    void *grown = NULL;
+    size_t new_capacity = (*capacity > 0) ? *capacity : 16;
+
+    if (needed <= *capacity)
     {
-        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 3;
-        first_byte_mark = 0xE0; /* 11100000 */
+        return stack;
     }
-    else if (codepoint <= 0x10FFFF)
+
+    while (new_capacity < needed)
     {
-        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
-        utf8_length = 4;
-        first_byte_mark = 0xF0; /* 11110000 */
+        new_capacity *= 2;
     }
-    else
+    if (new_capacity > (((size_t)-1) / size))
     {
-        /* invalid unicode codepoint */
-        goto fail;
+        return NULL; /* overflow */
     }
 
-    /* encode as utf8 */
-    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    grown = global_hooks.allocate(new_capacity * size);
+    if (grown == NULL)
     {
-        /* 10xxxxxx */
-        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
-        codepoint >>= 6;
+        return NULL;
     }
-    /* encode first byte */
-    if (utf8_length > 1)
+    if (stack != NULL)
     {
-        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+        memcpy(grown, stack, *capacity * size);
+        if (stack != inline_stack)
+        {
+            global_hooks.deallocate(stack);
+        }
     }
-    else
+    *capacity = new_capacity;
+
+    return grown;
+}
+
+/* Structural hashes: four independent 32 bit FNV-1a lanes, each finished with the murmur3 mixer. */
+static const unsigned long hash_primes[4] = { 16777619UL, 2654435761UL, 2246822519UL, 3266489917UL };
+static const unsigned long hash_seeds[4] = { 2166136261UL, 2654435769UL, 2246822507UL, 3266489909UL };
+
+static void hash_bytes(cJSON_HashValue * const state, const unsigned char *bytes, size_t length)
+{
+    size_t lane = 0;
+
+    for (; length > 0; (void)bytes++, length--)
     {
-        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+        for (lane = 0; lane < 4; lane++)
+        {
+            state->words[lane] = ((state->words[lane] ^ *bytes) * hash_primes[lane]) & 0xFFFFFFFFUL;
+        }
     }
+}
 
-    *output_pointer += utf8_length;
+static void hash_word(cJSON_HashValue * const state, const unsigned long word)
+{
+    unsigned char bytes[4];
 
-    return sequence_length;
+    bytes[0] = (unsigned char)(word & 0xFF);
+    bytes[1] = (unsigned char)((word >> 8) & 0xFF);
+    bytes[2] = (unsigned char)((word >> 16) & 0xFF);
+    bytes[3] = (unsigned char)((word >> 24) & 0xFF);
+    hash_bytes(state, bytes, sizeof(bytes));
+}
 
-fail:
-    return 0;
+static void hash_start(cJSON_HashValue * const state, const unsigned long tag)
+{
+    memcpy(state->words, hash_seeds, sizeof(state->words));
+    hash_word(state, tag);
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+static void hash_finish(cJSON_HashValue * const state)
 {
-    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
-    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
-    unsigned char *output = NULL;
+    size_t lane = 0;
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+    for (lane = 0; lane < 4; lane++)
     {
-        goto fail;
+        unsigned long word = state->words[lane];
+        word ^= word >> 16;
+        word = (word * 0x85EBCA6BUL) & 0xFFFFFFFFUL;
+        word ^= word >> 13;
+        word = (word * 0xC2B2AE35UL) & 0xFFFFFFFFUL;
+        word ^= word >> 16;
+        state->words[lane] = word;
     }
+}
+
+/* numbers are split into sign, exponent and mantissa so the hash doesn't depend on the byte order */
+static void hash_number(cJSON_HashValue * const state, const double number)
+{
+    double mantissa = 0;
+    double high = 0;
+    int exponent = 0;
 
+    if (isnan(number) || isinf(number))
     {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
-        {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
-            {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
-                {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
-            }
-            input_end++;
-        }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        hash_word(state, isnan(number) ? 1UL : ((number > 0) ? 2UL : 3UL));
+        return;
+    }
+    if (number == 0)
+    {
+        /* 0 and -0 are equal */
+        hash_word(state, 0);
+        return;
+    }
+
+    mantissa = frexp(fabs(number), &exponent);
+    high = floor(mantissa * 4294967296.0);
+    hash_word(state, (number < 0) ? 5UL : 4UL);
+    hash_word(state, (unsigned long)(long)exponent & 0xFFFFFFFFUL);
+    hash_word(state, (unsigned long)high);
+    hash_word(state, (unsigned long)((mantissa * 4294967296.0 - high) * 2097152.0));
+}
+
+typedef struct
+{
+    const cJSON *item; /* the array or object */
+    cJSON_HashValue hash; /* arrays: the hash so far */
+    unsigned long sums[4]; /* objects: the sum of the member hashes, so their order doesn't matter */
+    unsigned long count; /* objects: the number of members */
+    cJSON_bool store; /* the hashes of item and its children are stored */
+} hash_frame;
+
+static void store_hash(const cJSON * const item, const cJSON * const parent, const cJSON_HashValue * const hash)
+{
+    node_info *info = add_node_info(item);
+
+    if (info != NULL)
+    {
+        info->hash = *hash;
+        info->flags |= NODE_HASH_CACHED;
+        if (parent != NULL)
         {
-            goto fail; /* string ended unexpectedly */
+            info->parent = parent;
         }
+    }
+}
 
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
+/* Add the hash of a child to the frame of its array or object. */
+static void hash_child(hash_frame * const frame, const cJSON * const child, const cJSON_HashValue * const value)
+{
+    cJSON_HashValue member;
+    size_t lane = 0;
+
+    if ((frame->item->type & 0xFF) == cJSON_Array)
+    {
+        hash_bytes(&frame->hash, (const unsigned char*)value->words, sizeof(value->words));
+        return;
+    }
+
+    hash_start(&member, 0);
+    if (child->string != NULL)
+    {
+        hash_bytes(&member, (const unsigned char*)child->string, strlen(child->string) + sizeof(""));
+    }
+    hash_bytes(&member, (const unsigned char*)value->words, sizeof(value->words));
+    hash_finish(&member);
+    for (lane = 0; lane < 4; lane++)
+    {
+        frame->sums[lane] = (frame->sums[lane] + member.words[lane]) & 0xFFFFFFFFUL;
+    }
+    frame->count++;
+}
+
+/* The hash of the array or object of a frame after its last child. */
+static void finish_frame_hash(hash_frame * const frame, cJSON_HashValue * const value)
+{
+    size_t lane = 0;
+
+    if ((frame->item->type & 0xFF) == cJSON_Object)
+    {
+        for (lane = 0; lane < 4; lane++)
         {
-            goto fail; /* allocation failure */
+            hash_word(&frame->hash, frame->sums[lane]);
         }
+        hash_word(&frame->hash, frame->count & 0xFFFFFFFFUL);
     }
+    hash_finish(&frame->hash);
+    *value = frame->hash;
+}
 
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
-    {
-        if (*input_pointer != '\\')
+/* Hash root into hash, using and refreshing cached hashes. Hashes are stored if store is set or an item already has
+ * an entry. Fails if the tree is nested CJSON_CIRCULAR_LIMIT levels deep. */
+static cJSON_bool hash_item(const cJSON * const root, const cJSON_bool store, cJSON_HashValue * const hash)
+{
+    hash_frame inline_frames[INLINE_STACK_DEPTH];
+    hash_frame *frames = inline_frames;
+    hash_frame *frame = NULL;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t count = 0;
+    const cJSON *current = root;
+    const cJSON *parent = NULL;
+    node_info *info = NULL;
+    cJSON_HashValue value;
+    cJSON_bool store_current = false;
+    cJSON_bool success = false;
+
+    for (;;)
+    {
+        /* hash current into value, arrays and objects with children get a frame and are finished after their last child */
+        info = find_node_info(current);
+        if ((info != NULL) && (info->flags & NODE_HASH_CACHED))
         {
-            *output_pointer++ = *input_pointer++;
+            value = info->hash;
         }
-        /* escape sequence */
         else
         {
-            unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
+            if (count >= CJSON_CIRCULAR_LIMIT)
             {
-                goto fail;
+                goto cleanup; /* too deep to hash */
             }
+            store_current = ((count > 0) ? frames[count - 1].store : store) || (info != NULL);
 
-            switch (input_pointer[1])
+            /* deferred items are hashed by their content, not their text */
+            if (current->type & cJSON_IsDeferred)
             {
-                case 'b':
-                    *output_pointer++ = '\b';
+                cJSON_Expand((cJSON*)cast_away_const(current));
+            }
+
+            hash_start(&value, (unsigned long)(current->type & 0xFF));
+            switch (current->type & 0xFF)
+            {
+                case cJSON_Number:
+                    hash_number(&value, current->valuedouble);
+                    hash_finish(&value);
                     break;
-                case 'f':
-                    *output_pointer++ = '\f';
+
+                case cJSON_String:
+                case cJSON_Raw:
+                    if (current->valuestring != NULL)
+                    {
+                        hash_bytes(&value, (const unsigned char*)current->valuestring, strlen(current->valuestring) + sizeof(""));
+                    }
+                    hash_finish(&value);
                     break;
-                case 'n':
-                    *output_pointer++ = '\n';
-                    break;
-                case 'r':
-                    *output_pointer++ = '\r';
-                    break;
-                case 't':
-                    *output_pointer++ = '\t';
-                    break;
-                case '\"':
-                case '\\':
-                case '/':
-                    *output_pointer++ = input_pointer[1];
+
+                case cJSON_Array:
+                case cJSON_Object:
+                    if (current->type & cJSON_IsPacked)
+                    {
+                        /* packed numbers are hashed like the items they stand for */
+                        const double *numbers = packed_numbers(current);
+                        int index = 0;
+                        for (index = 0; index < current->valueint; index++)
+                        {
+                            cJSON_HashValue number_hash;
+                            hash_start(&number_hash, (unsigned long)cJSON_Number);
+                            hash_number(&number_hash, numbers[index]);
+                            hash_finish(&number_hash);
+                            hash_bytes(&value, (const unsigned char*)number_hash.words, sizeof(number_hash.words));
+                        }
+                    }
+                    grown = grow_stack(frames, &capacity, count + 1, sizeof(hash_frame), inline_frames);
+                    if (grown == NULL)
+                    {
+                        goto cleanup;
+                    }
+                    frames = (hash_frame*)grown;
+                    frame = &frames[count];
+                    memset(frame, '\0', sizeof(hash_frame));
+                    frame->item = current;
+                    frame->hash = value;
+                    frame->store = store_current;
+                    if (current->child != NULL)
+                    {
+                        count++;
+                        current = current->child;
+                        continue;
+                    }
+                    /* empty, finished right away */
+                    finish_frame_hash(frame, &value);
                     break;
 
-                /* UTF-16 literal */
-                case 'u':
-                    sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
-                    if (sequence_length == 0)
-                    {
-                        /* failed to convert UTF16-literal to UTF-8 */
-                        goto fail;
-                    }
+                default:
+                    hash_finish(&value);
                     break;
+            }
+            if (store_current)
+            {
+                store_hash(current, (count > 0) ? frames[count - 1].item : NULL, &value);
+            }
+        }
 
-                default:
-                    goto fail;
+        /* value is the hash of current, add it to the arrays and objects above */
+        for (;;)
+        {
+            if (count == 0)
+            {
+                *hash = value;
+                success = true;
+                goto cleanup;
+            }
+            frame = &frames[count - 1];
+            hash_child(frame, current, &value);
+            if (current->next != NULL)
+            {
+                current = current->next;
+                break;
+            }
+
+            /* that was the last child */
+            finish_frame_hash(frame, &value);
+            current = frame->item;
+            count--;
+            if (frame->store)
+            {
+                parent = (count > 0) ? frames[count - 1].item : NULL;
+                store_hash(current, parent, &value);
             }
-            input_pointer += sequence_length;
         }
     }
 
-    /* zero terminate the output */
-    *output_pointer = '\0';
+cleanup:
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate(frames);
+    }
 
-    item->type = cJSON_String;
-    item->valuestring = (char*)output;
+    return success;
+}
 
-    input_buffer->offset = (size_t) (input_end - input_buffer->content);
-    input_buffer->offset++;
+/* Forget the cached hashes of item and everything above it. */
+static void invalidate_hashes(const cJSON * const item)
+{
+    node_info *info = find_node_info(item);
 
-    return true;
+    /* if a hash isn't cached, the ones above it aren't either */
+    while ((info != NULL) && (info->flags & NODE_HASH_CACHED))
+    {
+        info->flags = (unsigned char)(info->flags & ~NODE_HASH_CACHED);
+        info = find_node_info(info->parent);
+    }
+}
 
-fail:
-    if (output != NULL)
+/* Returns true and the cached hash of item if it has one that is still valid. */
+static cJSON_bool get_cached_hash(const cJSON * const item, cJSON_HashValue * const hash)
+{
+    const node_info *info = find_node_info(item);
+
+    if ((info == NULL) || !(info->flags & NODE_HASH_CACHED))
     {
-        input_buffer->hooks.deallocate(output);
-        output = NULL;
+        return false;
     }
 
-    if (input_pointer != NULL)
+    *hash = info->hash;
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_HashValue) cJSON_Hash(const cJSON *item)
+{
+    cJSON_HashValue hash;
+
+    if ((item == NULL) || !hash_item(item, false, &hash))
     {
-        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+        memset(&hash, '\0', sizeof(hash));
     }
 
-    return false;
+    return hash;
 }
 
-/* Render the cstring provided to an escaped version that can be printed. */
-static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
+CJSON_PUBLIC(cJSON_bool) cJSON_CacheHashes(const cJSON *item)
 {
-    const unsigned char *input_pointer = NULL;
-    unsigned char *output = NULL;
-    unsigned char *output_pointer = NULL;
-    size_t output_length = 0;
-    /* numbers of additional characters needed for escaping */
-    size_t escape_characters = 0;
+    cJSON_HashValue hash;
 
-    if (output_buffer == NULL)
+    if (item == NULL)
     {
         return false;
     }
 
-    /* empty string */
-    if (input == NULL)
+    return hash_item(item, true, &hash) && get_cached_hash(item, &hash);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_GetCachedHash(const cJSON *item, cJSON_HashValue *hash)
+{
+    if ((item == NULL) || (hash == NULL))
     {
-        output = ensure(output_buffer, sizeof("\"\""));
-        if (output == NULL)
-        {
-            return false;
-        }
-        strcpy((char*)output, "\"\"");
+        return false;
+    }
 
-        return true;
+    return get_cached_hash(item, hash);
+}
+
+/* Source tracking: every value parsed with track_source gets an entry with its byte range in a
+ * copy of the input. Entries live in a side table per document so the cJSON struct stays as is. */
+#define NO_SOURCE_ENTRY ((size_t)-1)
+
+typedef struct
+{
+    const cJSON *item; /* NULL after the item was deleted */
+    size_t start;
+    size_t end;
+    size_t parent; /* entry of the enclosing array/object */
+    cJSON_bool dirty; /* the item or something below it was changed */
+} source_entry;
+
+/* The source map belongs to its root and is freed with it. The items find their entry through node_info. */
+typedef struct source_map
+{
+    const cJSON *root;
+    unsigned char *text;
+    source_entry *entries;
+    size_t count;
+    size_t capacity;
+    size_t current; /* entry of the array/object that is being parsed */
+} source_map;
+
+/* Forget a node_info entry that doesn't hold anything anymore. */
+static void drop_node_info(const cJSON * const item, const node_info * const info)
+{
+    if ((info->flags == 0) && (info->source == NULL))
+    {
+        remove_node_info(item);
     }
+}
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+static void free_source_map(source_map * const map)
+{
+    size_t entry = 0;
+
+    /* the items that are still alive lose their entries */
+    for (entry = 0; entry < map->count; entry++)
     {
-        switch (*input_pointer)
+        node_info *info = find_node_info(map->entries[entry].item);
+        if ((info != NULL) && (info->source == map))
         {
-            case '\"':
-            case '\\':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t':
-                /* one character escape sequence */
-                escape_characters++;
-                break;
-            default:
-                if (*input_pointer < 32)
-                {
-                    /* UTF-16 escape sequence uXXXX */
-                    escape_characters += 5;
-                }
-                break;
+            info->source = NULL;
+            drop_node_info(map->entries[entry].item, info);
         }
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
 
-    output = ensure(output_buffer, output_length + sizeof("\"\""));
-    if (output == NULL)
+    if (map->text != NULL)
     {
-        return false;
+        global_hooks.deallocate(map->text);
     }
-
-    /* no characters have to be escaped */
-    if (escape_characters == 0)
+    if (map->entries != NULL)
     {
-        output[0] = '\"';
-        memcpy(output + 1, input, output_length);
-        output[output_length + 1] = '\"';
-        output[output_length + 2] = '\0';
-
-        return true;
+        global_hooks.deallocate(map->entries);
     }
+    global_hooks.deallocate(map);
+}
 
-    output[0] = '\"';
-    output_pointer = output + 1;
-    /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+static cJSON_bool add_source_entry(source_map * const map, const cJSON * const item, const size_t start, size_t * const index)
+{
+    if (map->count == map->capacity)
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        size_t new_capacity = (map->capacity == 0) ? 64 : (map->capacity * 2);
+        source_entry *new_entries = (source_entry*)global_hooks.allocate(new_capacity * sizeof(source_entry));
+        if (new_entries == NULL)
         {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
+            return false;
         }
-        else
+        if (map->entries != NULL)
         {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
-            {
-                case '\\':
-                    *output_pointer = '\\';
-                    break;
-                case '\"':
-                    *output_pointer = '\"';
-                    break;
-                case '\b':
-                    *output_pointer = 'b';
-                    break;
-                case '\f':
-                    *output_pointer = 'f';
-                    break;
-                case '\n':
-                    *output_pointer = 'n';
-                    break;
-                case '\r':
-                    *output_pointer = 'r';
-                    break;
-                case '\t':
-                    *output_pointer = 't';
-                    break;
-                default:
-                    /* escape and print as unicode codepoint */
-                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
-                    output_pointer += 4;
-                    break;
-            }
+            memcpy(new_entries, map->entries, map->count * sizeof(source_entry));
+            global_hooks.deallocate(map->entries);
         }
+        map->entries = new_entries;
+        map->capacity = new_capacity;
     }
-    output[output_length + 1] = '\"';
-    output[output_length + 2] = '\0';
+
+    map->entries[map->count].item = item;
+    map->entries[map->count].start = start;
+    map->entries[map->count].end = start;
+    map->entries[map->count].parent = map->current;
+    map->entries[map->count].dirty = false;
+    *index = map->count;
+    map->count++;
 
     return true;
 }
 
-/* Invoke print_string_ptr (which is useful) on an item. */
-static cJSON_bool print_string(const cJSON * const item, printbuffer * const p)
+/* Let every item of a parsed document find its entry. */
+static cJSON_bool register_source_entries(source_map * const map)
 {
-    return print_string_ptr((unsigned char*)item->valuestring, p);
-}
-
-/* Predeclare these prototypes. */
-static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer);
-static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
-static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
+    size_t entry = 0;
 
-/* Utility to jump whitespace and cr/lf */
-static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
-{
-    if ((buffer == NULL) || (buffer->content == NULL))
+    for (entry = 0; entry < map->count; entry++)
     {
-        return NULL;
+        node_info *info = add_node_info(map->entries[entry].item);
+        if (info == NULL)
+        {
+            return false;
+        }
+        info->source = map;
+        info->source_entry = entry;
     }
 
-    if (cannot_access_at_index(buffer, 0))
-    {
-        return buffer;
-    }
+    return true;
+}
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
-    {
-       buffer->offset++;
-    }
+static size_t find_source_entry(const source_map * const map, const cJSON * const item)
+{
+    const node_info *info = find_node_info(item);
 
-    if (buffer->offset == buffer->length)
+    if ((info == NULL) || (info->source != map))
     {
-        buffer->offset--;
+        return NO_SOURCE_ENTRY;
     }
 
-    return buffer;
+    return info->source_entry;
 }
 
-/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
-static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+/* Mark an item and everything above it as changed: cached hashes are dropped
+ * and the item isn't copied from the input anymore. */
+static void mark_dirty(const cJSON * const item)
 {
-    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    const node_info *info = NULL;
+    source_map *map = NULL;
+    size_t entry = NO_SOURCE_ENTRY;
+
+    if ((node_info_count == 0) || (item == NULL))
     {
-        return NULL;
+        return;
     }
 
-    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    invalidate_hashes(item);
+
+    info = find_node_info(item);
+    if ((info == NULL) || (info->source == NULL))
     {
-        buffer->offset += 3;
+        return;
     }
 
-    return buffer;
+    /* if an entry is dirty, all of its parents are as well */
+    map = info->source;
+    entry = info->source_entry;
+    while ((entry != NO_SOURCE_ENTRY) && !map->entries[entry].dirty)
+    {
+        map->entries[entry].dirty = true;
+        entry = map->entries[entry].parent;
+    }
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+/* Called for every item that is deleted, so a new item at the same address can't inherit its entry. */
+static void forget_source(const cJSON * const item)
 {
-    size_t buffer_length;
+    node_info *info = find_node_info(item);
 
-    if (NULL == value)
+    if ((info == NULL) || (info->source == NULL))
     {
-        return NULL;
+        return;
     }
 
-    /* Adding null character size due to require_null_terminated. */
-    buffer_length = strlen(value) + sizeof("");
+    if (info->source->root == item)
+    {
+        free_source_map(info->source);
+        return;
+    }
 
-    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+    info->source->entries[info->source_entry].item = NULL;
+    info->source = NULL;
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+CJSON_PUBLIC(void) cJSON_MarkDirty(const cJSON *item)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
-    cJSON *item = NULL;
+    mark_dirty(item);
+}
 
-    /* reset error position */
-    global_error.json = NULL;
-    global_error.position = 0;
+CJSON_PUBLIC(cJSON_bool) cJSON_GetSourceRange(const cJSON *item, size_t *start, size_t *end)
+{
+    const node_info *info = find_node_info(item);
 
-    if (value == NULL || 0 == buffer_length)
+    if ((info == NULL) || (info->source == NULL))
     {
-        goto fail;
+        return false;
     }
 
-    buffer.content = (const unsigned char*)value;
-    buffer.length = buffer_length;
-    buffer.offset = 0;
-    buffer.hooks = global_hooks;
-
-    item = cJSON_New_Item(&global_hooks);
-    if (item == NULL) /* memory fail */
+    if (start != NULL)
     {
-        goto fail;
+        *start = info->source->entries[info->source_entry].start;
     }
-
-    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    if (end != NULL)
     {
-        /* parse failure. ep is set. */
-        goto fail;
+        *end = info->source->entries[info->source_entry].end;
     }
 
-    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-    if (require_null_terminated)
-    {
-        buffer_skip_whitespace(&buffer);
-        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
+    return true;
+}
+
+/* Internal constructor. */
+static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
+{
+    cJSON* node = (hooks->allocate == global_hooks.allocate) ? cached_node() : NULL;
+    if (node == NULL)
+    {
+        node = (cJSON*)hooks->allocate(sizeof(cJSON));
+    }
+    if (node)
+    {
+        memset(node, '\0', sizeof(cJSON));
+        if (collector.stats != NULL)
         {
-            goto fail;
+            collector.stats->nodes_created++;
         }
     }
-    if (return_parse_end)
+
+    return node;
+}
+
+/* Structural sharing: items flagged with cJSON_IsShared point to children that belong to a share group, which
+ * is kept in their valuestring (arrays and objects don't use it otherwise). The group holds the list of children
+ * it was made for and with it everything below, so items copied from that list can share their children as well.
+ * It counts the items that use it and the last one of them deletes the list. */
+typedef struct
+{
+    cJSON *children;
+    size_t owners;
+} share_group;
+
+static share_group *get_share_group(const cJSON * const item)
+{
+    return (share_group*)(void*)item->valuestring;
+}
+
+/* Let go of the shared children of item. Returns the list of its group if item was its last owner, the caller
+ * deletes it, and NULL otherwise. */
+static cJSON *release_shared(cJSON * const item)
+{
+    share_group *group = get_share_group(item);
+    cJSON *children = NULL;
+
+    item->type &= ~cJSON_IsShared;
+    item->valuestring = NULL;
+    item->child = NULL;
+
+    group->owners--;
+    if (group->owners == 0)
     {
-        *return_parse_end = (const char*)buffer_at_offset(&buffer);
+        children = group->children;
+        global_hooks.deallocate(group);
     }
 
-    return item;
+    return children;
+}
 
-fail:
-    if (item != NULL)
+/* What a cJSON_Parser keeps from one document to the next. */
+struct cJSON_Parser
+{
+    cJSON_ParseOptions options;
+    cJSON *free_nodes; /* linked through next */
+    unsigned char *scratch; /* for numbers */
+    size_t scratch_size;
+};
+
+/* Free the strings of an item and the item itself, but not its children. */
+static void delete_item(cJSON * const item, cJSON_Parser * const parser)
+{
+    if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL) && !has_inline_string(item))
     {
-        cJSON_Delete(item);
+        /* the numbers of a packed array aren't a string */
+        if (item->type & cJSON_IsPacked)
+        {
+            global_hooks.deallocate(item->valuestring);
+        }
+        else
+        {
+            free_string(item->valuestring);
+        }
+        item->valuestring = NULL;
     }
-
-    if (value != NULL)
+    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
     {
-        error local_error;
-        local_error.json = (const unsigned char*)value;
-        local_error.position = 0;
+        free_string(item->string);
+        item->string = NULL;
+    }
+    if (parser != NULL)
+    {
+        item->next = parser->free_nodes;
+        parser->free_nodes = item;
+    }
+    else
+    {
+        free_node(item);
+    }
+}
 
-        if (buffer.offset < buffer.length)
+/* Delete a cJSON structure, its nodes are kept in the free list of parser if it isn't NULL.
+ * Children are deleted before their parent without recursion: the parents wait in a list linked through prev. */
+static void delete_items(cJSON *item, cJSON_Parser * const parser)
+{
+    cJSON *parents = NULL;
+    cJSON *next = NULL;
+    while (item != NULL)
+    {
+        next = item->next;
+        if (node_info_count != 0)
         {
-            local_error.position = buffer.offset;
+            forget_source(item);
         }
-        else if (buffer.length > 0)
+        /* forgetting the source of a root may have emptied the table */
+        if (node_info_count != 0)
         {
-            local_error.position = buffer.length - 1;
+            remove_node_info(item);
         }
-
-        if (return_parse_end != NULL)
+        if (item->type & cJSON_IsShared)
         {
-            *return_parse_end = (const char*)local_error.json + local_error.position;
+            /* the children of the group are deleted with its last owner */
+            item->child = release_shared(item);
+        }
+        if (!(item->type & cJSON_IsReference) && (item->child != NULL))
+        {
+            next = item->child;
+            item->child = NULL;
+            item->prev = parents;
+            parents = item;
+        }
+        else
+        {
+            delete_item(item, parser);
         }
 
-        global_error = local_error;
+        /* the last child was deleted, continue after its parent */
+        while ((next == NULL) && (parents != NULL))
+        {
+            item = parents;
+            parents = item->prev;
+            next = item->next;
+            delete_item(item, parser);
+        }
+        item = next;
     }
-
-    return NULL;
-}
-
-/* Default options for cJSON_Parse */
-CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
-{
-    return cJSON_ParseWithOpts(value, 0, 0);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
 {
-    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+    delete_items(item, NULL);
 }
 
-#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
-
-static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
+/* A copy of item that shares its children. group is the group that keeps item alive if item belongs to a shared
+ * list, the copy uses it unless item has a group of its own. Other items get a new group, which flags them too. */
+static cJSON *share_item(cJSON * const item, share_group *group)
 {
-    static const size_t default_buffer_size = 256;
-    printbuffer buffer[1];
-    unsigned char *printed = NULL;
-
-    memset(buffer, 0, sizeof(buffer));
+    cJSON *copy = NULL;
 
-    /* create buffer */
-    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
-    buffer->length = default_buffer_size;
-    buffer->format = format;
-    buffer->hooks = *hooks;
-    if (buffer->buffer == NULL)
+    /* the children of a reference belong to another tree, the copy owns copies of them like cJSON_Duplicate's */
+    if (item->type & cJSON_IsReference)
     {
-        goto fail;
+        return cJSON_Duplicate(item, true);
     }
 
-    /* print the value */
-    if (!print_value(item, buffer))
+    copy = cJSON_New_Item(&global_hooks);
+    if (copy == NULL)
     {
-        goto fail;
+        return NULL;
     }
-    update_offset(buffer);
 
-    /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
+    copy->type = item->type & ~cJSON_IsShared;
+    copy->valueint = item->valueint;
+    copy->valuedouble = item->valuedouble;
+    if ((item->valuestring != NULL) && !(item->type & cJSON_IsShared))
     {
-        printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
-        if (printed == NULL) {
+        copy->valuestring = duplicate_value(item, copy);
+        if (copy->valuestring == NULL)
+        {
             goto fail;
         }
-        buffer->buffer = NULL;
     }
-    else /* otherwise copy the JSON over to a new buffer */
+    if (item->string != NULL)
     {
-        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
-        if (printed == NULL)
+        copy->string = (item->type & cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((const unsigned char*)item->string, &global_hooks);
+        if (copy->string == NULL)
         {
             goto fail;
         }
-        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
-        printed[buffer->offset] = '\0'; /* just to be sure */
+    }
 
-        /* free the buffer */
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
+    /* the children are shared last, so a failure above doesn't have to release them */
+    if (item->child != NULL)
+    {
+        if (item->type & cJSON_IsShared)
+        {
+            group = get_share_group(item);
+        }
+        else if (group == NULL)
+        {
+            group = (share_group*)global_hooks.allocate(sizeof(share_group));
+            if (group == NULL)
+            {
+                goto fail;
+            }
+            group->children = item->child;
+            group->owners = 1;
+            item->valuestring = (char*)(void*)group;
+            item->type |= cJSON_IsShared;
+        }
+        group->owners++;
+        copy->child = item->child;
+        copy->valuestring = (char*)(void*)group;
+        copy->type |= cJSON_IsShared;
     }
 
-    return printed;
+    return copy;
 
 fail:
-    if (buffer->buffer != NULL)
+    cJSON_Delete(copy);
+
+    return NULL;
+}
+
+/* Replace the shared children of item with copies that share the grandchildren. */
+static cJSON_bool unshare_children(cJSON * const item)
+{
+    share_group *group = get_share_group(item);
+    cJSON *head = NULL;
+    cJSON *tail = NULL;
+    cJSON *child = NULL;
+
+    if ((group->owners == 1) && (group->children == item->child))
     {
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
+        /* everyone else let go of the children already */
+        global_hooks.deallocate(group);
+        item->valuestring = NULL;
+        item->type &= ~cJSON_IsShared;
+        return true;
     }
 
-    if (printed != NULL)
+    for (child = item->child; child != NULL; child = child->next)
     {
-        hooks->deallocate(printed);
-        printed = NULL;
+        cJSON *copy = share_item(child, group);
+        if (copy == NULL)
+        {
+            cJSON_Delete(head);
+            return false;
+        }
+        if (head == NULL)
+        {
+            head = copy;
+        }
+        else
+        {
+            tail->next = copy;
+            copy->prev = tail;
+        }
+        tail = copy;
     }
+    head->prev = tail;
 
-    return NULL;
-}
+    /* the copies hold the group if they need anything in it */
+    cJSON_Delete(release_shared(item));
 
-/* Render a cJSON item/entity/structure to text. */
-CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item)
-{
-    return (char*)print(item, true, &global_hooks);
+    item->child = head;
+    /* like expanded children, the copies aren't known to the hash cache */
+    mark_dirty(item);
+    for (child = head; child != NULL; child = child->next)
+    {
+        link_parent(item, child);
+    }
+
+    return true;
 }
 
-CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
+/* Called before the children of item are changed. */
+static cJSON_bool own_children(cJSON * const item)
 {
-    return (char*)print(item, false, &global_hooks);
+    return (item->type & cJSON_IsShared) ? unshare_children(item) : true;
 }
 
-CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
+/* own_children for functions that get a pointer to one of the children, returns what it points to afterwards. */
+static cJSON *own_child(cJSON * const parent, cJSON * const child)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    cJSON *current = NULL;
+    size_t index = 0;
 
-    if (prebuffer < 0)
+    if (!(parent->type & cJSON_IsShared))
     {
-        return NULL;
+        return child;
     }
 
-    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
-    if (!p.buffer)
+    for (current = parent->child; (current != NULL) && (current != child); current = current->next)
     {
-        return NULL;
+        index++;
+    }
+    if (current == NULL)
+    {
+        /* not a child, let the caller fail */
+        return child;
     }
 
-    p.length = (size_t)prebuffer;
-    p.offset = 0;
-    p.noalloc = false;
-    p.format = fmt;
-    p.hooks = global_hooks;
-
-    if (!print_value(item, &p))
+    if (!own_children(parent))
     {
-        global_hooks.deallocate(p.buffer);
-        p.buffer = NULL;
         return NULL;
     }
 
-    return (char*)p.buffer;
+    for (current = parent->child; index > 0; index--)
+    {
+        current = current->next;
+    }
+
+    return current;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
+/* get the decimal point character of the current locale */
+static unsigned char get_decimal_point(void)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+#ifdef ENABLE_LOCALES
+    struct lconv *lconv = localeconv();
+    return (unsigned char) lconv->decimal_point[0];
+#else
+    return '.';
+#endif
+}
 
-    if ((length < 0) || (buffer == NULL))
+typedef struct
+{
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+    size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
+    internal_hooks hooks;
+    size_t defer_depth; /* Arrays/objects at this depth or deeper are kept as raw text, 0 to disable. */
+    source_map *source; /* records the range of every parsed value if not NULL */
+    cJSON_bool pack_numbers; /* store arrays of numbers packed */
+    cJSON_Parser *parser; /* nodes and scratch space are reused from it if not NULL */
+    size_t max_depth; /* how deeply arrays/objects may be nested, 0 for CJSON_NESTING_LIMIT */
+    cJSON_KeyPool *key_pool; /* object keys are interned here if not NULL */
+    cJSON_bool track_parents; /* every parsed item is linked to its parent like by cJSON_TrackParents */
+} parse_buffer;
+
+static size_t nesting_limit(const parse_buffer * const input_buffer)
+{
+    return (input_buffer->max_depth != 0) ? input_buffer->max_depth : CJSON_NESTING_LIMIT;
+}
+
+/* check if the given size is left to read in a given parse buffer (starting with 1) */
+#define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
+/* check if the buffer can be accessed at the given index (starting with 0) */
+#define can_access_at_index(buffer, index) ((buffer != NULL) && (((buffer)->offset + index) < (buffer)->length))
+#define cannot_access_at_index(buffer, index) (!can_access_at_index(buffer, index))
+/* get a pointer to the buffer at the position */
+#define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
+
+/* Nodes come from the free list of the parser if there is one. */
+static cJSON *new_parsed_item(parse_buffer * const input_buffer)
+{
+    cJSON_Parser *parser = input_buffer->parser;
+    cJSON *node = NULL;
+
+    if ((parser == NULL) || (parser->free_nodes == NULL))
     {
-        return false;
+        return cJSON_New_Item(&input_buffer->hooks);
     }
 
-    p.buffer = (unsigned char*)buffer;
-    p.length = (size_t)length;
-    p.offset = 0;
-    p.noalloc = true;
-    p.format = format;
-    p.hooks = global_hooks;
+    node = parser->free_nodes;
+    parser->free_nodes = node->next;
+    memset(node, '\0', sizeof(cJSON));
+    if (collector.stats != NULL)
+    {
+        collector.stats->nodes_created++;
+    }
 
-    return print_value(item, &p);
+    return node;
 }
 
-/* Parser core - when encountering text, process appropriately. */
-static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer)
+/* Temporary space of at least size bytes, the scratch space of the parser if there is one. */
+static unsigned char *get_scratch(parse_buffer * const input_buffer, const size_t size)
 {
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    cJSON_Parser *parser = input_buffer->parser;
+    unsigned char *scratch = NULL;
+
+    if (parser == NULL)
     {
-        return false; /* no input */
+        return (unsigned char*)input_buffer->hooks.allocate(size);
     }
 
-    /* parse the different types of values */
-    /* null */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    if (size > parser->scratch_size)
     {
-        item->type = cJSON_NULL;
-        input_buffer->offset += 4;
-        return true;
+        scratch = (unsigned char*)input_buffer->hooks.allocate(size * 2);
+        if (scratch == NULL)
+        {
+            return NULL;
+        }
+        if (parser->scratch != NULL)
+        {
+            input_buffer->hooks.deallocate(parser->scratch);
+        }
+        parser->scratch = scratch;
+        parser->scratch_size = size * 2;
     }
-    /* false */
-    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+
+    return parser->scratch;
+}
+
+static void release_scratch(parse_buffer * const input_buffer, unsigned char * const scratch)
+{
+    if (input_buffer->parser == NULL)
+    {
+        input_buffer->hooks.deallocate(scratch);
+    }
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+{
+    double number = 0;
+    unsigned char *after_end = NULL;
+    unsigned char *number_c_string;
+    unsigned char decimal_point = get_decimal_point();
+    size_t i = 0;
+    size_t number_string_length = 0;
+    cJSON_bool has_decimal_point = false;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false;
+    }
+
+    /* copy the number into a temporary buffer and replace '.' with the decimal point
+     * of the current locale (for strtod)
+     * This also takes care of '\0' not necessarily being available for marking the end of the input */
+    for (i = 0; can_access_at_index(input_buffer, i); i++)
+    {
+        switch (buffer_at_offset(input_buffer)[i])
+        {
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+            case '+':
+            case '-':
+            case 'e':
+            case 'E':
+                number_string_length++;
+                break;
+
+            case '.':
+                number_string_length++;
+                has_decimal_point = true;
+                break;
+
+            default:
+                goto loop_end;
+        }
+    }
+loop_end:
+    /* get a temporary buffer, add 1 for '\0' */
+    number_c_string = get_scratch(input_buffer, number_string_length + 1);
+    if (number_c_string == NULL)
+    {
+        return false; /* allocation failure */
+    }
+
+    memcpy(number_c_string, buffer_at_offset(input_buffer), number_string_length);
+    number_c_string[number_string_length] = '\0';
+
+    if (has_decimal_point)
+    {
+        for (i = 0; i < number_string_length; i++)
+        {
+            if (number_c_string[i] == '.')
+            {
+                /* replace '.' with the decimal point of the current locale (for strtod) */
+                number_c_string[i] = decimal_point;
+            }
+        }
+    }
+
+    number = strtod((const char*)number_c_string, (char**)&after_end);
+    if (number_c_string == after_end)
+    {
+        /* free the temporary buffer */
+        release_scratch(input_buffer, number_c_string);
+        return false; /* parse_error */
+    }
+
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    if (number >= INT_MAX)
+    {
+        item->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        item->valueint = INT_MIN;
+    }
+    else
+    {
+        item->valueint = (int)number;
+    }
+
+    item->type = cJSON_Number;
+
+    input_buffer->offset += (size_t)(after_end - number_c_string);
+    /* free the temporary buffer */
+    release_scratch(input_buffer, number_c_string);
+    return true;
+}
+
+/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
+CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
+{
+    if (has_inline_string(object))
+    {
+        /* the number goes where the string is */
+        char *copy = (char*)cJSON_strdup((const unsigned char*)object->valuestring, &global_hooks);
+        if (copy == NULL)
+        {
+            return object->valuedouble;
+        }
+        object->valuestring = copy;
+    }
+
+    if (number >= INT_MAX)
+    {
+        object->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        object->valueint = INT_MIN;
+    }
+    else
+    {
+        object->valueint = (int)number;
+    }
+
+    mark_dirty(object);
+
+    return object->valuedouble = number;
+}
+
+CJSON_PUBLIC(int) cJSON_SetBoolHelper(cJSON *object, cJSON_bool boolValue)
+{
+    if ((object == NULL) || !(object->type & (cJSON_False | cJSON_True)))
+    {
+        return cJSON_Invalid;
+    }
+
+    object->type = (object->type & ~(cJSON_False | cJSON_True)) | (boolValue ? cJSON_True : cJSON_False);
+    mark_dirty(object);
+
+    return object->type;
+}
+
+/* Note: when passing a NULL valuestring, cJSON_SetValuestring treats this as an error and return NULL */
+CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
+{
+    char *copy = NULL;
+    size_t v1_len;
+    size_t v2_len;
+    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
+    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
+    {
+        return NULL;
+    }
+    /* return NULL if the object is corrupted or valuestring is NULL */
+    if (object->valuestring == NULL || valuestring == NULL)
+    {
+        return NULL;
+    }
+
+    v1_len = strlen(valuestring);
+    v2_len = strlen(object->valuestring);
+
+    /* an inline string can grow up to the size of its storage */
+    if ((v1_len <= v2_len) || (has_inline_string(object) && (v1_len < INLINE_STRING_SIZE)))
+    {
+        /* strcpy does not handle overlapping string: [X1, X2] [Y1, Y2] => X2 < Y1 or Y2 < X1 */
+        if (!( valuestring + v1_len < object->valuestring || object->valuestring + ((v1_len > v2_len) ? v1_len : v2_len) < valuestring ))
+        {
+            return NULL;
+        }
+        strcpy(object->valuestring, valuestring);
+        mark_dirty(object);
+        return object->valuestring;
+    }
+    copy = (char*) cJSON_strdup((const unsigned char*)valuestring, &global_hooks);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    if ((object->valuestring != NULL) && !has_inline_string(object))
+    {
+        cJSON_free(object->valuestring);
+    }
+    object->valuestring = copy;
+    mark_dirty(object);
+
+    return copy;
+}
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+    size_t depth; /* current nesting depth (for formatted printing) */
+    cJSON_bool noalloc;
+    cJSON_bool format; /* is this print a formatted print */
+    internal_hooks hooks;
+    const source_map *source; /* unchanged items are copied from here if not NULL */
+} printbuffer;
+
+/* realloc printbuffer if necessary to have at least "needed" bytes more */
+static unsigned char* ensure(printbuffer * const p, size_t needed)
+{
+    unsigned char *newbuffer = NULL;
+    size_t newsize = 0;
+
+    if ((p == NULL) || (p->buffer == NULL))
+    {
+        return NULL;
+    }
+
+    if ((p->length > 0) && (p->offset >= p->length))
+    {
+        /* make sure that offset is valid */
+        return NULL;
+    }
+
+    if (needed > INT_MAX)
+    {
+        /* sizes bigger than INT_MAX are currently not supported */
+        return NULL;
+    }
+
+    needed += p->offset + 1;
+    if (needed <= p->length)
+    {
+        return p->buffer + p->offset;
+    }
+
+    if (p->noalloc) {
+        return NULL;
+    }
+
+    /* calculate new buffer size */
+    if (needed > (INT_MAX / 2))
+    {
+        /* overflow of int, use INT_MAX if possible */
+        if (needed <= INT_MAX)
+        {
+            newsize = INT_MAX;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        newsize = needed * 2;
+    }
+
+    if (collector.stats != NULL)
+    {
+        collector.stats->buffer_reallocations++;
+    }
+
+    if (p->hooks.reallocate != NULL)
+    {
+        /* reallocate with realloc if available */
+        newbuffer = (unsigned char*)p->hooks.reallocate(p->buffer, newsize);
+        if (newbuffer == NULL)
+        {
+            p->hooks.deallocate(p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+    }
+    else
+    {
+        /* otherwise reallocate manually */
+        newbuffer = (unsigned char*)p->hooks.allocate(newsize);
+        if (!newbuffer)
+        {
+            p->hooks.deallocate(p->buffer);
+            p->length = 0;
+            p->buffer = NULL;
+
+            return NULL;
+        }
+
+        memcpy(newbuffer, p->buffer, p->offset + 1);
+        p->hooks.deallocate(p->buffer);
+    }
+    p->length = newsize;
+    p->buffer = newbuffer;
+
+    return newbuffer + p->offset;
+}
+
+/* calculate the new length of the string in a printbuffer and update the offset */
+static void update_offset(printbuffer * const buffer)
+{
+    const unsigned char *buffer_pointer = NULL;
+    if ((buffer == NULL) || (buffer->buffer == NULL))
+    {
+        return;
+    }
+    buffer_pointer = buffer->buffer + buffer->offset;
+
+    buffer->offset += strlen((const char*)buffer_pointer);
+}
+
+/* securely comparison of floating-point variables */
+static cJSON_bool compare_double(double a, double b)
+{
+    double maxVal = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return (fabs(a - b) <= maxVal * DBL_EPSILON);
+}
+
+/* Render the number nicely into a string, integer is the saturated valueint of it. */
+static cJSON_bool print_double(const double d, const int integer, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    int length = 0;
+    size_t i = 0;
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
+    unsigned char decimal_point = get_decimal_point();
+    double test = 0.0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
+    {
+        length = sprintf((char*)number_buffer, "null");
+    }
+    else if(d == (double)integer)
+    {
+        length = sprintf((char*)number_buffer, "%d", integer);
+    }
+    else
+    {
+        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
+        length = sprintf((char*)number_buffer, "%1.15g", d);
+
+        /* Check whether the original double can be recovered */
+        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
+        {
+            /* If not, print with 17 decimal places of precision */
+            length = sprintf((char*)number_buffer, "%1.17g", d);
+        }
+    }
+
+    /* sprintf failed or buffer overrun occurred */
+    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    {
+        return false;
+    }
+
+    /* reserve appropriate space in the output */
+    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    /* copy the printed number to the output and replace locale
+     * dependent decimal point with '.' */
+    for (i = 0; i < ((size_t)length); i++)
+    {
+        if (number_buffer[i] == decimal_point)
+        {
+            output_pointer[i] = '.';
+            continue;
+        }
+
+        output_pointer[i] = number_buffer[i];
+    }
+    output_pointer[i] = '\0';
+
+    output_buffer->offset += (size_t)length;
+
+    return true;
+}
+
+/* Render the number nicely from the given item into a string. */
+static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    return print_double(item->valuedouble, item->valueint, output_buffer);
+}
+
+/* parse 4 digit hexadecimal number */
+static unsigned parse_hex4(const unsigned char * const input)
+{
+    unsigned int h = 0;
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        /* parse digit */
+        if ((input[i] >= '0') && (input[i] <= '9'))
+        {
+            h += (unsigned int) input[i] - '0';
+        }
+        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        {
+            h += (unsigned int) 10 + input[i] - 'A';
+        }
+        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        {
+            h += (unsigned int) 10 + input[i] - 'a';
+        }
+        else /* invalid */
+        {
+            return 0;
+        }
+
+        if (i < 3)
+        {
+            /* shift left to make place for the next nibble */
+            h = h << 4;
+        }
+    }
+
+    return h;
+}
+
+/* converts a UTF-16 literal to UTF-8
+ * A literal can be one or two sequences of the form \uXXXX */
+static unsigned char utf16_literal_to_utf8(const unsigned char * const input_pointer, const unsigned char * const input_end, unsigned char **output_pointer)
+{
+    long unsigned int codepoint = 0;
+    unsigned int first_code = 0;
+    const unsigned char *first_sequence = input_pointer;
+    unsigned char utf8_length = 0;
+    unsigned char utf8_position = 0;
+    unsigned char sequence_length = 0;
+    unsigned char first_byte_mark = 0;
+
+    if ((input_end - first_sequence) < 6)
+    {
+        /* input ends unexpectedly */
+        goto fail;
+    }
+
+    /* get the first utf16 sequence */
+    first_code = parse_hex4(first_sequence + 2);
+
+    /* check that the code is valid */
+    if (((first_code >= 0xDC00) && (first_code <= 0xDFFF)))
+    {
+        goto fail;
+    }
+
+    /* UTF16 surrogate pair */
+    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    {
+        const unsigned char *second_sequence = first_sequence + 6;
+        unsigned int second_code = 0;
+        sequence_length = 12; /* \uXXXX\uXXXX */
+
+        if ((input_end - second_sequence) < 6)
+        {
+            /* input ends unexpectedly */
+            goto fail;
+        }
+
+        if ((second_sequence[0] != '\\') || (second_sequence[1] != 'u'))
+        {
+            /* missing second half of the surrogate pair */
+            goto fail;
+        }
+
+        /* get the second utf16 sequence */
+        second_code = parse_hex4(second_sequence + 2);
+        /* check that the code is valid */
+        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        {
+            /* invalid second half of the surrogate pair */
+            goto fail;
+        }
+
+
+        /* calculate the unicode codepoint from the surrogate pair */
+        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+    }
+    else
+    {
+        sequence_length = 6; /* \uXXXX */
+        codepoint = first_code;
+    }
+
+    /* encode as UTF-8
+     * takes at maximum 4 bytes to encode:
+     * 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx */
+    if (codepoint < 0x80)
+    {
+        /* normal ascii, encoding 0xxxxxxx */
+        utf8_length = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        /* two bytes, encoding 110xxxxx 10xxxxxx */
+        utf8_length = 2;
+        first_byte_mark = 0xC0; /* 11000000 */
+    }
+    else if (codepoint < 0x10000)
+    {
+        /* three bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 3;
+        first_byte_mark = 0xE0; /* 11100000 */
+    }
+    else if (codepoint <= 0x10FFFF)
+    {
+        /* four bytes, encoding 1110xxxx 10xxxxxx 10xxxxxx 10xxxxxx */
+        utf8_length = 4;
+        first_byte_mark = 0xF0; /* 11110000 */
+    }
+    else
+    {
+        /* invalid unicode codepoint */
+        goto fail;
+    }
+
+    /* encode as utf8 */
+    for (utf8_position = (unsigned char)(utf8_length - 1); utf8_position > 0; utf8_position--)
+    {
+        /* 10xxxxxx */
+        (*output_pointer)[utf8_position] = (unsigned char)((codepoint | 0x80) & 0xBF);
+        codepoint >>= 6;
+    }
+    /* encode first byte */
+    if (utf8_length > 1)
+    {
+        (*output_pointer)[0] = (unsigned char)((codepoint | first_byte_mark) & 0xFF);
+    }
+    else
+    {
+        (*output_pointer)[0] = (unsigned char)(codepoint & 0x7F);
+    }
+
+    *output_pointer += utf8_length;
+
+    return sequence_length;
+
+fail:
+    return 0;
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. Short strings are stored inline if may_inline is set. */
+static cJSON_bool parse_string_content(cJSON * const item, parse_buffer * const input_buffer, const cJSON_bool may_inline)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
+    unsigned char *output_pointer = NULL;
+    unsigned char *output = NULL;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    {
+        /* calculate approximate size of the output (overestimate) */
+        size_t allocation_length = 0;
+        size_t skipped_bytes = 0;
+        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+        {
+            /* is escape sequence */
+            if (input_end[0] == '\\')
+            {
+                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+                {
+                    /* prevent buffer overflow when last input character is a backslash */
+                    goto fail;
+                }
+                skipped_bytes++;
+                input_end++;
+            }
+            input_end++;
+        }
+        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+        {
+            goto fail; /* string ended unexpectedly */
+        }
+
+        /* This is at most how much we need for the output */
+        allocation_length = (size_t) (input_end - input_pointer) - skipped_bytes;
+        output = (may_inline && fits_inline(allocation_length)) ? (unsigned char*)inline_string(item) : allocate_string(allocation_length + sizeof(""));
+        if (output == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+    }
+
+    output_pointer = output;
+    /* loop through the string literal */
+    while (input_pointer < input_end)
+    {
+        if (*input_pointer != '\\')
+        {
+            *output_pointer++ = *input_pointer++;
+        }
+        /* escape sequence */
+        else
+        {
+            unsigned char sequence_length = 2;
+            if ((input_end - input_pointer) < 1)
+            {
+                goto fail;
+            }
+
+            switch (input_pointer[1])
+            {
+                case 'b':
+                    *output_pointer++ = '\b';
+                    break;
+                case 'f':
+                    *output_pointer++ = '\f';
+                    break;
+                case 'n':
+                    *output_pointer++ = '\n';
+                    break;
+                case 'r':
+                    *output_pointer++ = '\r';
+                    break;
+                case 't':
+                    *output_pointer++ = '\t';
+                    break;
+                case '\"':
+                case '\\':
+                case '/':
+                    *output_pointer++ = input_pointer[1];
+                    break;
+
+                /* UTF-16 literal */
+                case 'u':
+                    sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
+                    if (sequence_length == 0)
+                    {
+                        /* failed to convert UTF16-literal to UTF-8 */
+                        goto fail;
+                    }
+                    break;
+
+                default:
+                    goto fail;
+            }
+            input_pointer += sequence_length;
+        }
+    }
+
+    /* zero terminate the output */
+    *output_pointer = '\0';
+
+    item->type = cJSON_String;
+    item->valuestring = (char*)output;
+
+    input_buffer->offset = (size_t) (input_end - input_buffer->content);
+    input_buffer->offset++;
+
+    return true;
+
+fail:
+    if ((output != NULL) && (output != (unsigned char*)(void*)&item->valuedouble))
+    {
+        input_buffer->hooks.deallocate(output);
+        output = NULL;
+    }
+
+    if (input_pointer != NULL)
+    {
+        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+    }
+
+    return false;
+}
+
+static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+{
+    return parse_string_content(item, input_buffer, true);
+}
+
+/* Render the cstring provided to an escaped version that can be printed. */
+static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
+{
+    const unsigned char *input_pointer = NULL;
+    unsigned char *output = NULL;
+    unsigned char *output_pointer = NULL;
+    size_t output_length = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    /* empty string */
+    if (input == NULL)
+    {
+        output = ensure(output_buffer, sizeof("\"\""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        strcpy((char*)output, "\"\"");
+
+        return true;
+    }
+
+    /* set "flag" to 1 if something needs to be escaped */
+    for (input_pointer = input; *input_pointer; input_pointer++)
+    {
+        switch (*input_pointer)
+        {
+            case '\"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+                /* one character escape sequence */
+                escape_characters++;
+                break;
+            default:
+                if (*input_pointer < 32)
+                {
+                    /* UTF-16 escape sequence uXXXX */
+                    escape_characters += 5;
+                }
+                break;
+        }
+    }
+    output_length = (size_t)(input_pointer - input) + escape_characters;
+
+    output = ensure(output_buffer, output_length + sizeof("\"\""));
+    if (output == NULL)
+    {
+        return false;
+    }
+
+    /* no characters have to be escaped */
+    if (escape_characters == 0)
+    {
+        output[0] = '\"';
+        memcpy(output + 1, input, output_length);
+        output[output_length + 1] = '\"';
+        output[output_length + 2] = '\0';
+
+        return true;
+    }
+
+    output[0] = '\"';
+    output_pointer = output + 1;
+    /* copy the string */
+    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    {
+        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        {
+            /* normal character, copy */
+            *output_pointer = *input_pointer;
+        }
+        else
+        {
+            /* character needs to be escaped */
+            *output_pointer++ = '\\';
+            switch (*input_pointer)
+            {
+                case '\\':
+                    *output_pointer = '\\';
+                    break;
+                case '\"':
+                    *output_pointer = '\"';
+                    break;
+                case '\b':
+                    *output_pointer = 'b';
+                    break;
+                case '\f':
+                    *output_pointer = 'f';
+                    break;
+                case '\n':
+                    *output_pointer = 'n';
+                    break;
+                case '\r':
+                    *output_pointer = 'r';
+                    break;
+                case '\t':
+                    *output_pointer = 't';
+                    break;
+                default:
+                    /* escape and print as unicode codepoint */
+                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
+                    output_pointer += 4;
+                    break;
+            }
+        }
+    }
+    output[output_length + 1] = '\"';
+    output[output_length + 2] = '\0';
+
+    return true;
+}
+
+/* Invoke print_string_ptr (which is useful) on an item. */
+static cJSON_bool print_string(const cJSON * const item, printbuffer * const p)
+{
+    return print_string_ptr((unsigned char*)item->valuestring, p);
+}
+
+/* Predeclare these prototypes. */
+static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool parse_deferred(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool validate_nested(parse_buffer * const input_buffer);
+static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer);
+static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
+static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
+
+/* Utility to jump whitespace and cr/lf */
+static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL))
+    {
+        return NULL;
+    }
+
+    if (cannot_access_at_index(buffer, 0))
+    {
+        return buffer;
+    }
+
+    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    {
+       buffer->offset++;
+    }
+
+    if (buffer->offset == buffer->length)
+    {
+        buffer->offset--;
+    }
+
+    return buffer;
+}
+
+/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
+static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    {
+        return NULL;
+    }
+
+    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        buffer->offset += 3;
+    }
+
+    return buffer;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    size_t buffer_length;
+
+    if (NULL == value)
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    buffer_length = strlen(value) + sizeof("");
+
+    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    cJSON_ParseOptions options = { 0, 0, 0, 0, 0, 0, 0 };
+    options.require_null_terminated = require_null_terminated;
+
+    return cJSON_ParseWithOptions(value, buffer_length, &options, return_parse_end);
+}
+
+/* Parse an object - create a new root, and populate. Nodes are reused from parser if it isn't NULL. */
+static cJSON *parse_document(const char * const value, const size_t buffer_length, const cJSON_ParseOptions * const options, const char ** const return_parse_end, cJSON_Parser * const parser)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0 };
+    cJSON *item = NULL;
+    source_map *map = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.parser = parser;
+    if (options != NULL)
+    {
+        buffer.defer_depth = options->defer_depth;
+        buffer.pack_numbers = options->pack_numbers;
+        buffer.max_depth = options->max_depth;
+        buffer.key_pool = options->key_pool;
+        buffer.track_parents = options->track_parents;
+    }
+
+    if ((options != NULL) && options->track_source)
+    {
+        map = (source_map*)global_hooks.allocate(sizeof(source_map));
+        if (map == NULL)
+        {
+            goto fail;
+        }
+        memset(map, '\0', sizeof(source_map));
+        map->current = NO_SOURCE_ENTRY;
+        buffer.source = map;
+    }
+
+    item = new_parsed_item(&buffer);
+    if ((item == NULL) || (buffer.track_parents && !track_item(item, NULL))) /* memory fail */
+    {
+        goto fail;
+    }
+
+    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    {
+        /* parse failure. ep is set. */
+        goto fail;
+    }
+
+    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
+    if ((options != NULL) && options->require_null_terminated)
+    {
+        buffer_skip_whitespace(&buffer);
+        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
+        {
+            goto fail;
+        }
+    }
+
+    if (map != NULL)
+    {
+        /* keep a copy of the input up to the end of the root value */
+        size_t text_length = map->entries[0].end;
+        map->text = (unsigned char*)global_hooks.allocate(text_length + sizeof(""));
+        if ((map->text == NULL) || !register_source_entries(map))
+        {
+            goto fail;
+        }
+        memcpy(map->text, value, text_length);
+        map->text[text_length] = '\0';
+        map->root = item;
+    }
+
+    if (return_parse_end)
+    {
+        *return_parse_end = (const char*)buffer_at_offset(&buffer);
+    }
+
+    return item;
+
+fail:
+    if (map != NULL)
+    {
+        free_source_map(map);
+    }
+
+    if (item != NULL)
+    {
+        delete_items(item, parser);
+    }
+
+    if (value != NULL)
+    {
+        error local_error;
+        local_error.json = (const unsigned char*)value;
+        local_error.position = 0;
+
+        if (buffer.offset < buffer.length)
+        {
+            local_error.position = buffer.offset;
+        }
+        else if (buffer.length > 0)
+        {
+            local_error.position = buffer.length - 1;
+        }
+
+        if (return_parse_end != NULL)
+        {
+            *return_parse_end = (const char*)local_error.json + local_error.position;
+        }
+
+        global_error = local_error;
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithOptions(const char *value, size_t buffer_length, const cJSON_ParseOptions *options, const char **return_parse_end)
+{
+    return parse_document(value, buffer_length, options, return_parse_end, NULL);
+}
+
+CJSON_PUBLIC(cJSON_Parser *) cJSON_Parser_Create(const cJSON_ParseOptions *options)
+{
+    cJSON_Parser *parser = (cJSON_Parser*)global_hooks.allocate(sizeof(cJSON_Parser));
+    if (parser == NULL)
+    {
+        return NULL;
+    }
+    memset(parser, '\0', sizeof(cJSON_Parser));
+
+    if (options != NULL)
+    {
+        parser->options = *options;
+    }
+
+    return parser;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_Parser_Parse(cJSON_Parser *parser, const char *value, size_t buffer_length, const char **return_parse_end)
+{
+    if (parser == NULL)
+    {
+        return NULL;
+    }
+
+    return parse_document(value, buffer_length, &parser->options, return_parse_end, parser);
+}
+
+CJSON_PUBLIC(void) cJSON_Parser_Release(cJSON_Parser *parser, cJSON *item)
+{
+    delete_items(item, parser);
+}
+
+CJSON_PUBLIC(void) cJSON_Parser_Delete(cJSON_Parser *parser)
+{
+    cJSON *next = NULL;
+
+    if (parser == NULL)
+    {
+        return;
+    }
+
+    while (parser->free_nodes != NULL)
+    {
+        next = parser->free_nodes->next;
+        global_hooks.deallocate(parser->free_nodes);
+        parser->free_nodes = next;
+    }
+    if (parser->scratch != NULL)
+    {
+        global_hooks.deallocate(parser->scratch);
+    }
+    global_hooks.deallocate(parser);
+}
+
+/* Key pools: the names are stored in blocks that are only freed with the pool,
+ * an open addressing table finds them by their hash. */
+#define KEY_POOL_BLOCK_SIZE 4096
+
+typedef struct key_pool_block
+{
+    struct key_pool_block *next;
+    size_t used;
+    size_t size; /* the names follow the block header */
+} key_pool_block;
+
+typedef struct
+{
+    const char *key; /* NULL for an empty slot */
+    size_t length;
+    size_t hash;
+} key_pool_entry;
+
+struct cJSON_KeyPool
+{
+    key_pool_entry *entries;
+    size_t capacity; /* a power of two */
+    size_t count;
+    key_pool_block *blocks; /* the first one is filled next */
+};
+
+static size_t hash_key_bytes(const unsigned char *key, size_t length)
+{
+    size_t hash = 5381;
+
+    for (; length > 0; key++, length--)
+    {
+        hash = (hash * 33) ^ (size_t)*key;
+    }
+
+    return hash;
+}
+
+/* Copy a name of length bytes into the blocks of pool. */
+static char *store_key(cJSON_KeyPool * const pool, const unsigned char * const key, const size_t length)
+{
+    key_pool_block *block = pool->blocks;
+    char *copy = NULL;
+
+    if ((block == NULL) || ((block->size - block->used) <= length))
+    {
+        size_t size = (length >= KEY_POOL_BLOCK_SIZE) ? (length + 1) : KEY_POOL_BLOCK_SIZE;
+        if (size > ((size_t)-1 - sizeof(key_pool_block)))
+        {
+            return NULL;
+        }
+        block = (key_pool_block*)global_hooks.allocate(sizeof(key_pool_block) + size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->used = 0;
+        block->size = size;
+        if ((size > KEY_POOL_BLOCK_SIZE) && (pool->blocks != NULL))
+        {
+            /* a large name gets a block of its own, the current one is filled further */
+            block->next = pool->blocks->next;
+            pool->blocks->next = block;
+        }
+        else
+        {
+            block->next = pool->blocks;
+            pool->blocks = block;
+        }
+    }
+
+    copy = (char*)(block + 1) + block->used;
+    memcpy(copy, key, length);
+    copy[length] = '\0';
+    block->used += length + 1;
+
+    return copy;
+}
+
+static cJSON_bool grow_key_pool(cJSON_KeyPool * const pool)
+{
+    size_t capacity = (pool->capacity == 0) ? 64 : (pool->capacity * 2);
+    key_pool_entry *entries = NULL;
+    size_t index = 0;
+
+    if (capacity > ((size_t)-1 / sizeof(key_pool_entry)))
+    {
+        return false;
+    }
+    entries = (key_pool_entry*)global_hooks.allocate(capacity * sizeof(key_pool_entry));
+    if (entries == NULL)
+    {
+        return false;
+    }
+    memset(entries, '\0', capacity * sizeof(key_pool_entry));
+
+    for (index = 0; index < pool->capacity; index++)
+    {
+        if (pool->entries[index].key != NULL)
+        {
+            size_t slot = pool->entries[index].hash & (capacity - 1);
+            while (entries[slot].key != NULL)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            entries[slot] = pool->entries[index];
+        }
+    }
+
+    if (pool->entries != NULL)
+    {
+        global_hooks.deallocate(pool->entries);
+    }
+    pool->entries = entries;
+    pool->capacity = capacity;
+
+    return true;
+}
+
+/* The copy of the name of length bytes in pool, it is added if it isn't there yet. NULL if out of memory. */
+static const char *intern_key(cJSON_KeyPool * const pool, const unsigned char * const key, const size_t length)
+{
+    const size_t hash = hash_key_bytes(key, length);
+    key_pool_entry *entry = NULL;
+    size_t slot = 0;
+
+    /* at most three quarters of the slots are used */
+    if (((pool->count + 1) * 4 > pool->capacity * 3) && !grow_key_pool(pool))
+    {
+        return NULL;
+    }
+
+    slot = hash & (pool->capacity - 1);
+    for (entry = &pool->entries[slot]; entry->key != NULL; entry = &pool->entries[slot])
+    {
+        if ((entry->hash == hash) && (entry->length == length) && (memcmp(entry->key, key, length) == 0))
+        {
+            return entry->key;
+        }
+        slot = (slot + 1) & (pool->capacity - 1);
+    }
+
+    entry->key = store_key(pool, key, length);
+    if (entry->key == NULL)
+    {
+        return NULL;
+    }
+    entry->length = length;
+    entry->hash = hash;
+    pool->count++;
+
+    return entry->key;
+}
+
+CJSON_PUBLIC(cJSON_KeyPool *) cJSON_KeyPool_Create(void)
+{
+    cJSON_KeyPool *pool = (cJSON_KeyPool*)global_hooks.allocate(sizeof(cJSON_KeyPool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    memset(pool, '\0', sizeof(cJSON_KeyPool));
+
+    return pool;
+}
+
+CJSON_PUBLIC(const char *) cJSON_KeyPool_Intern(cJSON_KeyPool *pool, const char *key)
+{
+    if ((pool == NULL) || (key == NULL))
+    {
+        return NULL;
+    }
+
+    return intern_key(pool, (const unsigned char*)key, strlen(key));
+}
+
+CJSON_PUBLIC(size_t) cJSON_KeyPool_GetCount(const cJSON_KeyPool *pool)
+{
+    return (pool != NULL) ? pool->count : 0;
+}
+
+CJSON_PUBLIC(void) cJSON_KeyPool_Delete(cJSON_KeyPool *pool)
+{
+    key_pool_block *next = NULL;
+
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    while (pool->blocks != NULL)
+    {
+        next = pool->blocks->next;
+        global_hooks.deallocate(pool->blocks);
+        pool->blocks = next;
+    }
+    if (pool->entries != NULL)
+    {
+        global_hooks.deallocate(pool->entries);
+    }
+    global_hooks.deallocate(pool);
+}
+
+/* Parse the name of an object member into the key pool of input_buffer, item gets it as a constant string. */
+static cJSON_bool parse_pooled_key(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *end = buffer_at_offset(input_buffer) + 1;
+    const unsigned char * const buffer_end = input_buffer->content + input_buffer->length;
+    const cJSON_bool quoted = can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"');
+    const char *key = NULL;
+
+    /* names without escape sequences are interned straight from the input */
+    if (quoted)
+    {
+        while ((end < buffer_end) && (*end != '\"') && (*end != '\\') && (*end != '\0'))
+        {
+            end++;
+        }
+    }
+    if (quoted && (end < buffer_end) && (*end == '\"'))
+    {
+        key = intern_key(input_buffer->key_pool, buffer_at_offset(input_buffer) + 1, (size_t)(end - buffer_at_offset(input_buffer)) - 1);
+        if (key == NULL)
+        {
+            return false;
+        }
+        input_buffer->offset = (size_t)(end - input_buffer->content) + 1;
+    }
+    else
+    {
+        if (!parse_string_content(item, input_buffer, false))
+        {
+            return false;
+        }
+        key = intern_key(input_buffer->key_pool, (const unsigned char*)item->valuestring, strlen(item->valuestring));
+        free_string(item->valuestring);
+        item->valuestring = NULL;
+        if (key == NULL)
+        {
+            return false;
+        }
+    }
+
+    item->string = (char*)cast_away_const(key);
+    item->type = cJSON_StringIsConst;
+
+    return true;
+}
+
+/* Default options for cJSON_Parse */
+CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
+{
+    return cJSON_ParseWithOpts(value, 0, 0);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+#define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
+
+/* Unformatted printing of a tracked document copies unchanged items from the input. */
+static void use_source_map(printbuffer * const p, const cJSON * const item)
+{
+    const node_info *info = NULL;
+
+    if (p->format)
+    {
+        return;
+    }
+
+    info = find_node_info(item);
+    if (info != NULL)
+    {
+        p->source = info->source;
+    }
+}
+
+static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer buffer[1];
+    unsigned char *printed = NULL;
+
+    memset(buffer, 0, sizeof(buffer));
+
+    /* create buffer */
+    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
+    buffer->length = default_buffer_size;
+    buffer->format = format;
+    buffer->hooks = *hooks;
+    use_source_map(buffer, item);
+    if (buffer->buffer == NULL)
+    {
+        goto fail;
+    }
+
+    /* print the value */
+    if (!print_value(item, buffer))
+    {
+        goto fail;
+    }
+    update_offset(buffer);
+
+    /* check if reallocate is available */
+    if (hooks->reallocate != NULL)
+    {
+        printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
+        if (printed == NULL) {
+            goto fail;
+        }
+        buffer->buffer = NULL;
+    }
+    else /* otherwise copy the JSON over to a new buffer */
+    {
+        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
+        if (printed == NULL)
+        {
+            goto fail;
+        }
+        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
+        printed[buffer->offset] = '\0'; /* just to be sure */
+
+        /* free the buffer */
+        hooks->deallocate(buffer->buffer);
+        buffer->buffer = NULL;
+    }
+
+    return printed;
+
+fail:
+    if (buffer->buffer != NULL)
+    {
+        hooks->deallocate(buffer->buffer);
+        buffer->buffer = NULL;
+    }
+
+    if (printed != NULL)
+    {
+        hooks->deallocate(printed);
+        printed = NULL;
+    }
+
+    return NULL;
+}
+
+/* Render a cJSON item/entity/structure to text. */
+CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item)
+{
+    return (char*)print(item, true, &global_hooks);
+}
+
+CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
+{
+    return (char*)print(item, false, &global_hooks);
+}
+
+/* A cJSON_Printer keeps its output buffer from one document to the next. */
+struct cJSON_Printer
+{
+    unsigned char *buffer;
+    size_t length;
+    cJSON_bool format;
+};
+
+CJSON_PUBLIC(cJSON_Printer *) cJSON_Printer_Create(cJSON_bool format)
+{
+    cJSON_Printer *printer = (cJSON_Printer*)global_hooks.allocate(sizeof(cJSON_Printer));
+    if (printer == NULL)
+    {
+        return NULL;
+    }
+    memset(printer, '\0', sizeof(cJSON_Printer));
+    printer->format = format;
+
+    return printer;
+}
+
+CJSON_PUBLIC(const char *) cJSON_Printer_Print(cJSON_Printer *printer, const cJSON *item, size_t *length)
+{
+    static const size_t default_buffer_size = 256;
+    printbuffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0 };
+    cJSON_bool printed = false;
+
+    if ((printer == NULL) || (item == NULL))
+    {
+        return NULL;
+    }
+
+    if (printer->buffer == NULL)
+    {
+        printer->buffer = (unsigned char*)global_hooks.allocate(default_buffer_size);
+        if (printer->buffer == NULL)
+        {
+            return NULL;
+        }
+        printer->length = default_buffer_size;
+    }
+
+    buffer.buffer = printer->buffer;
+    buffer.length = printer->length;
+    buffer.format = printer->format;
+    buffer.hooks = global_hooks;
+    use_source_map(&buffer, item);
+
+    printed = print_value(item, &buffer);
+    /* the buffer may have grown, or been freed if growing failed */
+    printer->buffer = buffer.buffer;
+    printer->length = buffer.length;
+    if (!printed)
+    {
+        return NULL;
+    }
+    update_offset(&buffer);
+
+    if (length != NULL)
+    {
+        *length = buffer.offset;
+    }
+
+    return (const char*)printer->buffer;
+}
+
+CJSON_PUBLIC(void) cJSON_Printer_Delete(cJSON_Printer *printer)
+{
+    if (printer == NULL)
+    {
+        return;
+    }
+
+    if (printer->buffer != NULL)
+    {
+        global_hooks.deallocate(printer->buffer);
+    }
+    global_hooks.deallocate(printer);
+}
+
+CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0 };
+
+    if (prebuffer < 0)
+    {
+        return NULL;
+    }
+
+    p.buffer = (unsigned char*)global_hooks.allocate((size_t)prebuffer);
+    if (!p.buffer)
+    {
+        return NULL;
+    }
+
+    p.length = (size_t)prebuffer;
+    p.offset = 0;
+    p.noalloc = false;
+    p.format = fmt;
+    p.hooks = global_hooks;
+    use_source_map(&p, item);
+
+    if (!print_value(item, &p))
+    {
+        global_hooks.deallocate(p.buffer);
+        p.buffer = NULL;
+        return NULL;
+    }
+
+    return (char*)p.buffer;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
+{
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0 };
+
+    if ((length < 0) || (buffer == NULL))
+    {
+        return false;
+    }
+
+    p.buffer = (unsigned char*)buffer;
+    p.length = (size_t)length;
+    p.offset = 0;
+    p.noalloc = true;
+    p.format = format;
+    p.hooks = global_hooks;
+    use_source_map(&p, item);
+
+    return print_value(item, &p);
+}
+
+/* Keep the text of an array or object in a raw item so it can be parsed later by cJSON_Expand.
+ * No items are created, the text is only checked with the grammar of cJSON_Validate. */
+static cJSON_bool parse_deferred(cJSON * const item, parse_buffer * const input_buffer)
+{
+    size_t start = input_buffer->offset;
+    size_t length = 0;
+
+    if (!validate_nested(input_buffer))
+    {
+        return false;
+    }
+
+    length = input_buffer->offset - start;
+    item->valuestring = (char*)input_buffer->hooks.allocate(length + sizeof(""));
+    if (item->valuestring == NULL)
+    {
+        return false; /* allocation failure */
+    }
+    memcpy(item->valuestring, input_buffer->content + start, length);
+    item->valuestring[length] = '\0';
+    item->type = cJSON_Raw | cJSON_IsDeferred;
+
+    return true;
+}
+
+/* Replace the numbers of a packed array by one child per number. */
+static cJSON_bool unpack_numbers(cJSON * const item)
+{
+    const double *numbers = packed_numbers(item);
+    cJSON *head = NULL;
+    cJSON *tail = NULL;
+    cJSON *child = NULL;
+    int index = 0;
+
+    for (index = 0; index < item->valueint; index++)
+    {
+        child = cJSON_CreateNumber(numbers[index]);
+        if (child == NULL)
+        {
+            cJSON_Delete(head);
+            return false;
+        }
+        if (head == NULL)
+        {
+            head = child;
+        }
+        else
+        {
+            tail->next = child;
+            child->prev = tail;
+        }
+        tail = child;
+    }
+    if (head != NULL)
+    {
+        head->prev = tail;
+    }
+
+    global_hooks.deallocate(item->valuestring);
+    item->valuestring = NULL;
+    item->valueint = 0;
+    item->child = head;
+    item->type = cJSON_Array | (item->type & cJSON_StringIsConst);
+    mark_dirty(item);
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        link_parent(item, child);
+    }
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Expand(cJSON *item)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0 };
+    cJSON expanded;
+    cJSON *child = NULL;
+
+    if (item == NULL)
+    {
+        return false;
+    }
+    if (item->type & cJSON_IsShared)
+    {
+        return unshare_children(item);
+    }
+    if (item->type & cJSON_IsPacked)
+    {
+        return unpack_numbers(item);
+    }
+    if (!(item->type & cJSON_IsDeferred))
+    {
+        return true;
+    }
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+
+    memset(&expanded, '\0', sizeof(expanded));
+    buffer.content = (const unsigned char*)item->valuestring;
+    buffer.length = strlen(item->valuestring);
+    buffer.hooks = global_hooks;
+    /* only expand one level, nested containers are deferred again */
+    buffer.defer_depth = 1;
+    /* the text was checked against the limit of the tree when it was skipped */
+    buffer.max_depth = (size_t)-1;
+
+    if (!parse_value(&expanded, &buffer) || (buffer.offset != buffer.length))
+    {
+        if (expanded.child != NULL)
+        {
+            cJSON_Delete(expanded.child);
+        }
+        return false;
+    }
+
+    /* a reference doesn't own the text but it will own the new children */
+    if (!(item->type & cJSON_IsReference))
+    {
+        global_hooks.deallocate(item->valuestring);
+    }
+    item->valuestring = NULL;
+    item->child = expanded.child;
+    item->type = expanded.type | (item->type & cJSON_StringIsConst);
+    /* the new children aren't tracked, so changes to them couldn't be noticed */
+    mark_dirty(item);
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        link_parent(item, child);
+    }
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseDeferred(const cJSON *item, size_t max_depth)
+{
+    cJSON_ParseOptions options;
+
+    if ((item == NULL) || !(item->type & cJSON_IsDeferred) || (item->valuestring == NULL))
+    {
+        return NULL;
+    }
+
+    memset(&options, '\0', sizeof(options));
+    options.require_null_terminated = true;
+    /* without a limit of its own the one the text was checked against when it was skipped applies */
+    options.max_depth = (max_depth != 0) ? max_depth : (size_t)-1;
+
+    return cJSON_ParseWithOptions(item->valuestring, strlen(item->valuestring) + sizeof(""), &options, NULL);
+}
+
+/* Parser core - when encountering text, process appropriately. */
+static cJSON_bool parse_value_content(cJSON * const item, parse_buffer * const input_buffer)
+{
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    /* parse the different types of values */
+    /* null */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        item->type = cJSON_NULL;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
     {
         item->type = cJSON_False;
         input_buffer->offset += 5;
         return true;
     }
-    /* true */
-    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        item->type = cJSON_True;
+        item->valueint = 1;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* string */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        return parse_string(item, input_buffer);
+    }
+    /* number */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        return parse_number(item, input_buffer);
+    }
+    /* array or object below the deferral depth */
+    if ((input_buffer->defer_depth != 0) && (input_buffer->depth >= input_buffer->defer_depth)
+            && can_access_at_index(input_buffer, 0)
+            && ((buffer_at_offset(input_buffer)[0] == '[') || (buffer_at_offset(input_buffer)[0] == '{')))
+    {
+        return parse_deferred(item, input_buffer);
+    }
+    /* array */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return parse_array(item, input_buffer);
+    }
+    /* object */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return parse_object(item, input_buffer);
+    }
+
+    return false;
+}
+
+static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer)
+{
+    source_map *map = NULL;
+    size_t parent = 0;
+    size_t entry = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->source == NULL))
+    {
+        return parse_value_content(item, input_buffer);
+    }
+
+    /* remember where the value starts and ends, nested values get this entry as parent */
+    map = input_buffer->source;
+    parent = map->current;
+    if (!add_source_entry(map, item, input_buffer->offset, &entry))
+    {
+        return false;
+    }
+    map->current = entry;
+    if (!parse_value_content(item, input_buffer))
+    {
+        return false;
+    }
+    map->current = parent;
+    map->entries[entry].end = input_buffer->offset;
+
+    return true;
+}
+
+/* The source entry of an item that wasn't changed since it was parsed, NO_SOURCE_ENTRY if there is none. */
+static size_t unchanged_source(const cJSON * const item, const printbuffer * const output_buffer)
+{
+    size_t entry = NO_SOURCE_ENTRY;
+
+    if (output_buffer->source != NULL)
+    {
+        entry = find_source_entry(output_buffer->source, item);
+        if ((entry != NO_SOURCE_ENTRY) && output_buffer->source->entries[entry].dirty)
+        {
+            entry = NO_SOURCE_ENTRY;
+        }
+    }
+
+    return entry;
+}
+
+/* Print the text of a deferred item like the array or object it holds, without expanding the item. */
+static cJSON_bool print_deferred(const cJSON * const item, printbuffer * const output_buffer)
+{
+    const size_t length = strlen(item->valuestring);
+    unsigned char *output = NULL;
+
+    if (output_buffer->format)
+    {
+        cJSON *parsed = cJSON_ParseWithLength(item->valuestring, length);
+        if (parsed != NULL)
+        {
+            cJSON_bool printed = print_value(parsed, output_buffer);
+            cJSON_Delete(parsed);
+            return printed;
+        }
+        /* the text is only checked when expanding, keep it as it is if it can't be parsed here */
+    }
+
+    output = ensure(output_buffer, length + sizeof(""));
+    if (output == NULL)
+    {
+        return false;
+    }
+    memcpy(output, item->valuestring, length + sizeof(""));
+    cJSON_Minify((char*)output);
+
+    return true;
+}
+
+/* Render a value to text. */
+static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output = NULL;
+    size_t entry = NO_SOURCE_ENTRY;
+
+    if ((item == NULL) || (output_buffer == NULL))
+    {
+        return false;
+    }
+
+    entry = unchanged_source(item, output_buffer);
+    if (entry != NO_SOURCE_ENTRY)
+    {
+        /* unchanged since it was parsed, copy the input without its whitespace */
+        const source_map *map = output_buffer->source;
+        size_t length = map->entries[entry].end - map->entries[entry].start;
+        output = ensure(output_buffer, length + sizeof(""));
+        if (output == NULL)
+        {
+            return false;
+        }
+        memcpy(output, map->text + map->entries[entry].start, length);
+        output[length] = '\0';
+        cJSON_Minify((char*)output);
+        return true;
+    }
+
+    switch ((item->type) & 0xFF)
+    {
+        case cJSON_NULL:
+            output = ensure(output_buffer, 5);
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "null");
+            return true;
+
+        case cJSON_False:
+            output = ensure(output_buffer, 6);
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "false");
+            return true;
+
+        case cJSON_True:
+            output = ensure(output_buffer, 5);
+            if (output == NULL)
+            {
+                return false;
+            }
+            strcpy((char*)output, "true");
+            return true;
+
+        case cJSON_Number:
+            return print_number(item, output_buffer);
+
+        case cJSON_Raw:
+        {
+            size_t raw_length = 0;
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            if (item->type & cJSON_IsDeferred)
+            {
+                return print_deferred(item, output_buffer);
+            }
+
+            raw_length = strlen(item->valuestring) + sizeof("");
+            output = ensure(output_buffer, raw_length);
+            if (output == NULL)
+            {
+                return false;
+            }
+            memcpy(output, item->valuestring, raw_length);
+            return true;
+        }
+
+        case cJSON_String:
+            return print_string(item, output_buffer);
+
+        case cJSON_Array:
+            return print_array(item, output_buffer);
+
+        case cJSON_Object:
+            return print_object(item, output_buffer);
+
+        default:
+            return false;
+    }
+}
+
+/* Parse the elements of an array into packed numbers, input_buffer is at the first of them. Fails without
+ * moving input_buffer if one of them isn't a number, the array is parsed into items then. */
+static cJSON_bool parse_packed_numbers(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const size_t start = input_buffer->offset;
+    double *numbers = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    cJSON number;
+
+    for (;;)
+    {
+        memset(&number, '\0', sizeof(number));
+        if (cannot_access_at_index(input_buffer, 0)
+                || ((buffer_at_offset(input_buffer)[0] != '-') && ((buffer_at_offset(input_buffer)[0] < '0') || (buffer_at_offset(input_buffer)[0] > '9')))
+                || !parse_number(&number, input_buffer))
+        {
+            goto fail;
+        }
+
+        if (count == capacity)
+        {
+            double *new_numbers = NULL;
+            capacity = (capacity == 0) ? 8 : capacity * 2;
+            if (capacity > INT_MAX)
+            {
+                goto fail;
+            }
+            new_numbers = (double*)input_buffer->hooks.allocate(capacity * sizeof(double));
+            if (new_numbers == NULL)
+            {
+                goto fail;
+            }
+            if (numbers != NULL)
+            {
+                memcpy(new_numbers, numbers, count * sizeof(double));
+                input_buffer->hooks.deallocate(numbers);
+            }
+            numbers = new_numbers;
+        }
+        numbers[count++] = number.valuedouble;
+
+        buffer_skip_whitespace(input_buffer);
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ','))
+        {
+            break;
+        }
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+    }
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ']'))
+    {
+        goto fail; /* not only numbers or no end of array */
+    }
+    input_buffer->offset++;
+
+    item->type = cJSON_Array | cJSON_IsPacked | (item->type & cJSON_StringIsConst);
+    item->valuestring = (char*)numbers;
+    item->valueint = (int)count;
+
+    return true;
+
+fail:
+    if (numbers != NULL)
+    {
+        input_buffer->hooks.deallocate(numbers);
+    }
+    input_buffer->offset = start;
+
+    return false;
+}
+
+typedef struct
+{
+    cJSON *item; /* the array or object */
+    cJSON *last; /* its last child so far, NULL before the first one */
+    unsigned char end; /* ']' or '}' */
+    size_t entry; /* source entry of item, NO_SOURCE_ENTRY if the caller records it */
+    size_t parent; /* source entry that is current again after item */
+} parse_frame;
+
+/* Parse the array or object at the input into root, including everything nested in it. */
+static cJSON_bool parse_nested(cJSON * const root, parse_buffer * const input_buffer)
+{
+    parse_frame inline_frames[INLINE_STACK_DEPTH];
+    parse_frame *frames = inline_frames;
+    parse_frame *frame = NULL;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t count = 0;
+    const size_t limit = nesting_limit(input_buffer);
+    const size_t start_depth = input_buffer->depth;
+    source_map * const map = input_buffer->source;
+    cJSON *current = root;
+    size_t entry = NO_SOURCE_ENTRY;
+    size_t parent = NO_SOURCE_ENTRY;
+    cJSON_bool success = false;
+    cJSON_bool parsed = false;
+    int key_flags = 0;
+    unsigned char end = '\0';
+
+    for (;;)
+    {
+        /* current starts at the input, it is either root or the value of a member */
+        end = can_access_at_index(input_buffer, 0) ? buffer_at_offset(input_buffer)[0] : '\0';
+        end = (end == '[') ? ']' : ((end == '{') ? '}' : '\0');
+        if ((current != root) && (end != '\0') && (input_buffer->defer_depth != 0) && (input_buffer->depth >= input_buffer->defer_depth))
+        {
+            end = '\0'; /* kept as raw text */
+        }
+
+        if (end == '\0')
+        {
+            /* the value sets the type, a pooled name stays constant */
+            key_flags = current->type & cJSON_StringIsConst;
+            parsed = parse_value_content(current, input_buffer);
+            current->type |= key_flags;
+            if (!parsed)
+            {
+                goto cleanup;
+            }
+            if (entry != NO_SOURCE_ENTRY)
+            {
+                map->current = parent;
+                map->entries[entry].end = input_buffer->offset;
+            }
+        }
+        else
+        {
+            if (input_buffer->depth >= limit)
+            {
+                goto cleanup; /* to deeply nested */
+            }
+            input_buffer->depth++;
+
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0))
+            {
+                input_buffer->offset--;
+                goto cleanup;
+            }
+
+            if ((buffer_at_offset(input_buffer)[0] == end)
+                    || ((end == ']') && input_buffer->pack_numbers && (map == NULL) && parse_packed_numbers(current, input_buffer)))
+            {
+                /* empty or packed, it already ends here */
+                if (!(current->type & cJSON_IsPacked))
+                {
+                    current->type = ((end == ']') ? cJSON_Array : cJSON_Object) | (current->type & cJSON_StringIsConst);
+                    input_buffer->offset++;
+                }
+                input_buffer->depth--;
+                if (entry != NO_SOURCE_ENTRY)
+                {
+                    map->current = parent;
+                    map->entries[entry].end = input_buffer->offset;
+                }
+            }
+            else
+            {
+                grown = grow_stack(frames, &capacity, count + 1, sizeof(parse_frame), inline_frames);
+                if (grown == NULL)
+                {
+                    goto cleanup;
+                }
+                frames = (parse_frame*)grown;
+                frame = &frames[count++];
+                frame->item = current;
+                frame->last = NULL;
+                frame->end = end;
+                frame->entry = entry;
+                frame->parent = parent;
+
+                /* step back to character in front of the first element */
+                input_buffer->offset--;
+            }
+        }
+
+        /* close the arrays and objects that end here */
+        for (;;)
+        {
+            if (count == 0)
+            {
+                success = true;
+                goto cleanup;
+            }
+            frame = &frames[count - 1];
+            if (frame->last == NULL)
+            {
+                break; /* it was just opened */
+            }
+
+            buffer_skip_whitespace(input_buffer);
+            if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','))
+            {
+                break;
+            }
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != frame->end))
+            {
+                goto cleanup; /* expected end of array or object */
+            }
+
+            input_buffer->depth--;
+            frame->item->child->prev = frame->last;
+            frame->item->type = ((frame->end == ']') ? cJSON_Array : cJSON_Object) | (frame->item->type & cJSON_StringIsConst);
+            input_buffer->offset++;
+            if (frame->entry != NO_SOURCE_ENTRY)
+            {
+                map->current = frame->parent;
+                map->entries[frame->entry].end = input_buffer->offset;
+            }
+            count--;
+        }
+
+        /* allocate next item */
+        current = new_parsed_item(input_buffer);
+        if (current == NULL)
+        {
+            goto cleanup; /* allocation failure */
+        }
+
+        /* attach next item to list */
+        if (frame->last == NULL)
+        {
+            /* start the linked list */
+            frame->item->child = current;
+        }
+        else
+        {
+            /* add to the end and advance */
+            frame->last->next = current;
+            current->prev = frame->last;
+        }
+        frame->last = current;
+        if (input_buffer->track_parents && !track_item(current, frame->item))
+        {
+            goto cleanup; /* allocation failure */
+        }
+
+        if (frame->end == '}')
+        {
+            if (cannot_access_at_index(input_buffer, 1))
+            {
+                goto cleanup; /* nothing comes after the comma */
+            }
+
+            /* parse the name of the child */
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            if (input_buffer->key_pool != NULL)
+            {
+                if (!parse_pooled_key(current, input_buffer))
+                {
+                    goto cleanup; /* failed to parse name */
+                }
+            }
+            else
+            {
+                if (!parse_string_content(current, input_buffer, false))
+                {
+                    goto cleanup; /* failed to parse name */
+                }
+
+                /* swap valuestring and string, because we parsed the name */
+                current->string = current->valuestring;
+                current->valuestring = NULL;
+            }
+            buffer_skip_whitespace(input_buffer);
+
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+            {
+                goto cleanup; /* invalid object */
+            }
+        }
+
+        /* the value follows */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+
+        /* remember where the value starts and ends, nested values get this entry as parent */
+        entry = NO_SOURCE_ENTRY;
+        if (map != NULL)
+        {
+            parent = map->current;
+            if (!add_source_entry(map, current, input_buffer->offset, &entry))
+            {
+                goto cleanup;
+            }
+            map->current = entry;
+        }
+    }
+
+cleanup:
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate(frames);
+    }
+    if (!success)
+    {
+        input_buffer->depth = start_depth;
+        if (root->child != NULL)
+        {
+            cJSON_Delete(root->child);
+            root->child = NULL;
+        }
+    }
+
+    return success;
+}
+
+/* Build an array from input text. */
+static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '['))
+    {
+        return false; /* not an array */
+    }
+
+    return parse_nested(item, input_buffer);
+}
+
+/* The opening bracket of an array or object, packed numbers are printed with it. */
+static cJSON_bool print_opening(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if ((item->type & 0xFF) == cJSON_Object)
+    {
+        length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
+        output_pointer = ensure(output_buffer, length + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+
+        *output_pointer++ = '{';
+        output_buffer->depth++;
+        if (output_buffer->format)
+        {
+            *output_pointer++ = '\n';
+        }
+        output_buffer->offset += length;
+
+        return true;
+    }
+
+    output_pointer = ensure(output_buffer, 1);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+
+    *output_pointer = '[';
+    output_buffer->offset++;
+    output_buffer->depth++;
+
+    /* packed numbers are printed in one loop, without an item for each of them */
+    if (item->type & cJSON_IsPacked)
+    {
+        const double *numbers = packed_numbers(item);
+        int index = 0;
+
+        length = (size_t) (output_buffer->format ? 2 : 1);
+        for (index = 0; index < item->valueint; index++)
+        {
+            if (index != 0)
+            {
+                output_pointer = ensure(output_buffer, length + 1);
+                if (output_pointer == NULL)
+                {
+                    return false;
+                }
+                *output_pointer++ = ',';
+                if(output_buffer->format)
+                {
+                    *output_pointer++ = ' ';
+                }
+                *output_pointer = '\0';
+                output_buffer->offset += length;
+            }
+            if (!print_double(numbers[index], number_to_int(numbers[index]), output_buffer))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static cJSON_bool print_closing(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+
+    if ((item->type & 0xFF) == cJSON_Object)
+    {
+        output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        if (output_buffer->format)
+        {
+            size_t i;
+            for (i = 0; i < (output_buffer->depth - 1); i++)
+            {
+                *output_pointer++ = '\t';
+            }
+        }
+        *output_pointer++ = '}';
+    }
+    else
+    {
+        output_pointer = ensure(output_buffer, 2);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        *output_pointer++ = ']';
+    }
+    *output_pointer = '\0';
+    output_buffer->depth--;
+
+    return true;
+}
+
+/* The indentation, name and colon in front of the value of an object member. */
+static cJSON_bool print_member_name(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if (output_buffer->format)
+    {
+        size_t i;
+        output_pointer = ensure(output_buffer, output_buffer->depth);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        for (i = 0; i < output_buffer->depth; i++)
+        {
+            *output_pointer++ = '\t';
+        }
+        output_buffer->offset += output_buffer->depth;
+    }
+
+    /* print key */
+    if (!print_string_ptr((unsigned char*)item->string, output_buffer))
+    {
+        return false;
+    }
+    update_offset(output_buffer);
+
+    length = (size_t) (output_buffer->format ? 2 : 1);
+    output_pointer = ensure(output_buffer, length);
+    if (output_pointer == NULL)
+    {
+        return false;
+    }
+    *output_pointer++ = ':';
+    if (output_buffer->format)
+    {
+        *output_pointer++ = '\t';
+    }
+    output_buffer->offset += length;
+
+    return true;
+}
+
+/* What follows an element of parent: a comma if it isn't the last one and a line break in formatted objects. */
+static cJSON_bool print_separator(const cJSON * const parent, const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    size_t length = 0;
+
+    if ((parent->type & 0xFF) == cJSON_Object)
+    {
+        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(item->next ? 1 : 0));
+        output_pointer = ensure(output_buffer, length + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        if (item->next)
+        {
+            *output_pointer++ = ',';
+        }
+
+        if (output_buffer->format)
+        {
+            *output_pointer++ = '\n';
+        }
+        *output_pointer = '\0';
+        output_buffer->offset += length;
+
+        return true;
+    }
+
+    if (item->next)
+    {
+        length = (size_t) (output_buffer->format ? 2 : 1);
+        output_pointer = ensure(output_buffer, length + 1);
+        if (output_pointer == NULL)
+        {
+            return false;
+        }
+        *output_pointer++ = ',';
+        if(output_buffer->format)
+        {
+            *output_pointer++ = ' ';
+        }
+        *output_pointer = '\0';
+        output_buffer->offset += length;
+    }
+
+    return true;
+}
+
+typedef struct
+{
+    const cJSON *item; /* the array or object */
+    const cJSON *next; /* the child that is printed next, NULL after the last one */
+} print_frame;
+
+/* Render an array or object and everything nested in it. */
+static cJSON_bool print_nested(const cJSON * const root, printbuffer * const output_buffer)
+{
+    print_frame inline_frames[INLINE_STACK_DEPTH];
+    print_frame *frames = inline_frames;
+    print_frame *frame = NULL;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t count = 0;
+    const cJSON *current = root;
+    cJSON_bool success = false;
+
+    for (;;)
+    {
+        /* current is an array or object that starts here */
+        grown = grow_stack(frames, &capacity, count + 1, sizeof(print_frame), inline_frames);
+        if (grown == NULL)
+        {
+            goto cleanup;
+        }
+        frames = (print_frame*)grown;
+        if (!print_opening(current, output_buffer))
+        {
+            goto cleanup;
+        }
+        frame = &frames[count++];
+        frame->item = current;
+        frame->next = current->child;
+
+        /* print children until one of them is an array or object */
+        for (;;)
+        {
+            frame = &frames[count - 1];
+            current = frame->next;
+            if (current == NULL)
+            {
+                if (!print_closing(frame->item, output_buffer))
+                {
+                    goto cleanup;
+                }
+                count--;
+                if (count == 0)
+                {
+                    success = true;
+                    goto cleanup;
+                }
+                /* continue after the array or object in its parent */
+                frame = &frames[count - 1];
+                current = frame->next;
+                update_offset(output_buffer);
+            }
+            else
+            {
+                if (((frame->item->type & 0xFF) == cJSON_Object) && !print_member_name(current, output_buffer))
+                {
+                    goto cleanup;
+                }
+                if ((((current->type & 0xFF) == cJSON_Array) || ((current->type & 0xFF) == cJSON_Object))
+                        && (unchanged_source(current, output_buffer) == NO_SOURCE_ENTRY))
+                {
+                    break;
+                }
+                if (!print_value(current, output_buffer))
+                {
+                    goto cleanup;
+                }
+                update_offset(output_buffer);
+            }
+
+            if (!print_separator(frame->item, current, output_buffer))
+            {
+                goto cleanup;
+            }
+            frame->next = current->next;
+        }
+    }
+
+cleanup:
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate(frames);
+    }
+
+    return success;
+}
+
+/* Render an array to text */
+static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer)
+{
+    if ((output_buffer == NULL) || ((item->type & 0xFF) != cJSON_Array))
+    {
+        return false;
+    }
+
+    return print_nested(item, output_buffer);
+}
+
+/* Build an object from the text. */
+static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    {
+        return false; /* not an object */
+    }
+
+    return parse_nested(item, input_buffer);
+}
+
+/* Render an object to text. */
+static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
+{
+    if ((output_buffer == NULL) || ((item->type & 0xFF) != cJSON_Object))
+    {
+        return false;
+    }
+
+    return print_nested(item, output_buffer);
+}
+
+/* Validation without building a tree.
+ * This follows RFC 8259 strictly, which is a subset of what parse_value accepts:
+ * whitespace is limited to space, tab, CR and LF, numbers must match the JSON
+ * number grammar, strings must be valid UTF-8 without unescaped control characters
+ * and \u escapes must consist of four hex digits. */
+static cJSON_bool validate_value(parse_buffer * const input_buffer);
+
+/* strict JSON whitespace */
+static void validate_skip_whitespace(parse_buffer * const buffer)
+{
+    while (can_access_at_index(buffer, 0))
+    {
+        switch (buffer_at_offset(buffer)[0])
+        {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                buffer->offset++;
+                break;
+
+            default:
+                return;
+        }
+    }
+}
+
+/* check that a buffer position is a hexadecimal digit */
+static cJSON_bool is_hex_digit(const unsigned char character)
+{
+    return ((character >= '0') && (character <= '9'))
+        || ((character >= 'A') && (character <= 'F'))
+        || ((character >= 'a') && (character <= 'f'));
+}
+
+/* returns the length of the UTF-8 sequence at the start of input, 0 if it is invalid */
+static size_t validate_utf8_sequence(const unsigned char * const input, const size_t available)
+{
+    unsigned char lower_bound = 0x80;
+    unsigned char upper_bound = 0xBF;
+    size_t sequence_length = 0;
+    size_t i = 0;
+
+    if (input[0] < 0x80)
+    {
+        return 1;
+    }
+
+    if ((input[0] >= 0xC2) && (input[0] <= 0xDF))
+    {
+        sequence_length = 2;
+    }
+    else if ((input[0] >= 0xE0) && (input[0] <= 0xEF))
+    {
+        sequence_length = 3;
+        if (input[0] == 0xE0)
+        {
+            /* overlong encoding */
+            lower_bound = 0xA0;
+        }
+        else if (input[0] == 0xED)
+        {
+            /* UTF-16 surrogates */
+            upper_bound = 0x9F;
+        }
+    }
+    else if ((input[0] >= 0xF0) && (input[0] <= 0xF4))
+    {
+        sequence_length = 4;
+        if (input[0] == 0xF0)
+        {
+            /* overlong encoding */
+            lower_bound = 0x90;
+        }
+        else if (input[0] == 0xF4)
+        {
+            /* beyond U+10FFFF */
+            upper_bound = 0x8F;
+        }
+    }
+    else
+    {
+        /* continuation byte, overlong two byte sequence or out of range */
+        return 0;
+    }
+
+    if (available < sequence_length)
+    {
+        return 0;
+    }
+
+    /* the second byte carries the additional restrictions */
+    if ((input[1] < lower_bound) || (input[1] > upper_bound))
+    {
+        return 0;
+    }
+
+    for (i = 2; i < sequence_length; i++)
+    {
+        if ((input[i] < 0x80) || (input[i] > 0xBF))
+        {
+            return 0;
+        }
+    }
+
+    return sequence_length;
+}
+
+/* validate a \uXXXX escape (or a surrogate pair of them), input_pointer points to the backslash */
+static size_t validate_utf16_literal(const unsigned char * const input_pointer, const unsigned char * const input_end)
+{
+    unsigned int first_code = 0;
+    unsigned int second_code = 0;
+    size_t i = 0;
+
+    if ((input_end - input_pointer) < 6)
+    {
+        return 0;
+    }
+    for (i = 2; i < 6; i++)
+    {
+        if (!is_hex_digit(input_pointer[i]))
+        {
+            return 0;
+        }
+    }
+
+    first_code = parse_hex4(input_pointer + 2);
+    if ((first_code >= 0xDC00) && (first_code <= 0xDFFF))
+    {
+        /* lone second half of a surrogate pair */
+        return 0;
+    }
+    if ((first_code < 0xD800) || (first_code > 0xDBFF))
+    {
+        return 6;
+    }
+
+    /* first half of a surrogate pair, the second half has to follow */
+    if (((input_end - input_pointer) < 12) || (input_pointer[6] != '\\') || (input_pointer[7] != 'u'))
     {
-        item->type = cJSON_True;
-        item->valueint = 1;
-        input_buffer->offset += 4;
-        return true;
+        return 0;
     }
-    /* string */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    for (i = 8; i < 12; i++)
     {
-        return parse_string(item, input_buffer);
+        if (!is_hex_digit(input_pointer[i]))
+        {
+            return 0;
+        }
     }
-    /* number */
-    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+
+    second_code = parse_hex4(input_pointer + 8);
+    if ((second_code < 0xDC00) || (second_code > 0xDFFF))
     {
-        return parse_number(item, input_buffer);
+        return 0;
     }
-    /* array */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+
+    return 12;
+}
+
+static cJSON_bool validate_string(parse_buffer * const input_buffer)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = input_buffer->content + input_buffer->length;
+    size_t sequence_length = 0;
+
+    while (input_pointer < input_end)
     {
-        return parse_array(item, input_buffer);
+        if (*input_pointer == '\"')
+        {
+            input_buffer->offset = (size_t)(input_pointer - input_buffer->content) + 1;
+            return true;
+        }
+
+        if (*input_pointer < 32)
+        {
+            /* control characters have to be escaped */
+            goto fail;
+        }
+
+        if (*input_pointer == '\\')
+        {
+            if ((input_end - input_pointer) < 2)
+            {
+                goto fail;
+            }
+
+            switch (input_pointer[1])
+            {
+                case 'b':
+                case 'f':
+                case 'n':
+                case 'r':
+                case 't':
+                case '\"':
+                case '\\':
+                case '/':
+                    sequence_length = 2;
+                    break;
+
+                case 'u':
+                    sequence_length = validate_utf16_literal(input_pointer, input_end);
+                    break;
+
+                default:
+                    sequence_length = 0;
+                    break;
+            }
+        }
+        else
+        {
+            sequence_length = validate_utf8_sequence(input_pointer, (size_t)(input_end - input_pointer));
+        }
+
+        if (sequence_length == 0)
+        {
+            goto fail;
+        }
+        input_pointer += sequence_length;
     }
-    /* object */
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+
+fail:
+    if (input_pointer > input_end)
     {
-        return parse_object(item, input_buffer);
+        input_pointer = input_end;
     }
+    input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
 
     return false;
 }
 
-/* Render a value to text. */
-static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer)
+/* number = [ minus ] int [ frac ] [ exp ] */
+static cJSON_bool validate_number(parse_buffer * const input_buffer)
 {
-    unsigned char *output = NULL;
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '-'))
+    {
+        input_buffer->offset++;
+    }
 
-    if ((item == NULL) || (output_buffer == NULL))
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return false;
+    }
+    if (buffer_at_offset(input_buffer)[0] == '0')
+    {
+        /* leading zeroes are not permitted */
+        input_buffer->offset++;
+    }
+    else if ((buffer_at_offset(input_buffer)[0] >= '1') && (buffer_at_offset(input_buffer)[0] <= '9'))
+    {
+        while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))
+        {
+            input_buffer->offset++;
+        }
+    }
+    else
     {
         return false;
     }
 
-    switch ((item->type) & 0xFF)
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '.'))
     {
-        case cJSON_NULL:
-            output = ensure(output_buffer, 5);
-            if (output == NULL)
+        input_buffer->offset++;
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] < '0') || (buffer_at_offset(input_buffer)[0] > '9'))
+        {
+            return false;
+        }
+        while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))
+        {
+            input_buffer->offset++;
+        }
+    }
+
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == 'e') || (buffer_at_offset(input_buffer)[0] == 'E')))
+    {
+        input_buffer->offset++;
+        if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '+') || (buffer_at_offset(input_buffer)[0] == '-')))
+        {
+            input_buffer->offset++;
+        }
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] < '0') || (buffer_at_offset(input_buffer)[0] > '9'))
+        {
+            return false;
+        }
+        while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))
+        {
+            input_buffer->offset++;
+        }
+    }
+
+    return true;
+}
+
+/* a member name followed by ':' */
+static cJSON_bool validate_key(parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"') || !validate_string(input_buffer))
+    {
+        return false;
+    }
+    validate_skip_whitespace(input_buffer);
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+    {
+        return false;
+    }
+    input_buffer->offset++;
+    validate_skip_whitespace(input_buffer);
+
+    return true;
+}
+
+/* Validates the array or object at the current offset. The closing brackets of the open arrays
+ * and objects are kept on a stack instead of recursing, so the depth is only limited by
+ * nesting_limit (counted from input_buffer->depth). */
+static cJSON_bool validate_nested(parse_buffer * const input_buffer)
+{
+    unsigned char inline_stack[INLINE_STACK_DEPTH];
+    unsigned char *stack = inline_stack;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t count = 0;
+    const size_t limit = nesting_limit(input_buffer);
+    cJSON_bool success = false;
+    unsigned char current = '\0';
+
+    for (;;)
+    {
+        /* at the start of a value */
+        if (cannot_access_at_index(input_buffer, 0))
+        {
+            goto cleanup;
+        }
+        current = buffer_at_offset(input_buffer)[0];
+        if ((current == '[') || (current == '{'))
+        {
+            if ((input_buffer->depth + count) >= limit)
             {
-                return false;
+                goto cleanup; /* to deeply nested */
             }
-            strcpy((char*)output, "null");
-            return true;
+            grown = grow_stack(stack, &capacity, count + 1, sizeof(unsigned char), inline_stack);
+            if (grown == NULL)
+            {
+                goto cleanup;
+            }
+            stack = (unsigned char*)grown;
+            stack[count++] = (current == '[') ? ']' : '}';
 
-        case cJSON_False:
-            output = ensure(output_buffer, 6);
-            if (output == NULL)
+            input_buffer->offset++;
+            validate_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != stack[count - 1]))
             {
-                return false;
+                /* not empty, continue with the first member or element */
+                if ((stack[count - 1] == '}') && !validate_key(input_buffer))
+                {
+                    goto cleanup;
+                }
+                continue;
             }
-            strcpy((char*)output, "false");
-            return true;
+        }
+        else if (!validate_value(input_buffer))
+        {
+            goto cleanup;
+        }
 
-        case cJSON_True:
-            output = ensure(output_buffer, 5);
-            if (output == NULL)
+        /* after a value: close the arrays and objects that end here or continue with the next entry */
+        for (;;)
+        {
+            validate_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0))
             {
-                return false;
+                goto cleanup;
             }
-            strcpy((char*)output, "true");
-            return true;
+            current = buffer_at_offset(input_buffer)[0];
+            if (current == stack[count - 1])
+            {
+                input_buffer->offset++;
+                count--;
+                if (count == 0)
+                {
+                    success = true;
+                    goto cleanup;
+                }
+                continue;
+            }
+            if (current != ',')
+            {
+                goto cleanup;
+            }
+            input_buffer->offset++;
+            validate_skip_whitespace(input_buffer);
+            if ((stack[count - 1] == '}') && !validate_key(input_buffer))
+            {
+                goto cleanup;
+            }
+            break;
+        }
+    }
 
-        case cJSON_Number:
-            return print_number(item, output_buffer);
+cleanup:
+    if (stack != inline_stack)
+    {
+        global_hooks.deallocate(stack);
+    }
 
-        case cJSON_Raw:
-        {
-            size_t raw_length = 0;
-            if (item->valuestring == NULL)
+    return success;
+}
+
+static cJSON_bool validate_value(parse_buffer * const input_buffer)
+{
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        return false;
+    }
+
+    switch (buffer_at_offset(input_buffer)[0])
+    {
+        case 'n':
+            if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
             {
-                return false;
+                input_buffer->offset += 4;
+                return true;
             }
+            return false;
 
-            raw_length = strlen(item->valuestring) + sizeof("");
-            output = ensure(output_buffer, raw_length);
-            if (output == NULL)
+        case 'f':
+            if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
             {
-                return false;
+                input_buffer->offset += 5;
+                return true;
             }
-            memcpy(output, item->valuestring, raw_length);
-            return true;
-        }
+            return false;
 
-        case cJSON_String:
-            return print_string(item, output_buffer);
+        case 't':
+            if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+            {
+                input_buffer->offset += 4;
+                return true;
+            }
+            return false;
 
-        case cJSON_Array:
-            return print_array(item, output_buffer);
+        case '\"':
+            return validate_string(input_buffer);
 
-        case cJSON_Object:
-            return print_object(item, output_buffer);
+        case '[':
+        case '{':
+            return validate_nested(input_buffer);
 
         default:
+            return validate_number(input_buffer);
+    }
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Validate(const char *value, size_t buffer_length, const char **error_at)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0, 0, 0, 0, 0 };
+
+    if (error_at != NULL)
+    {
+        *error_at = value;
+    }
+
+    if ((value == NULL) || (buffer_length == 0))
+    {
+        return false;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+
+    skip_utf8_bom(&buffer);
+    validate_skip_whitespace(&buffer);
+    if (!validate_value(&buffer))
+    {
+        goto fail;
+    }
+    validate_skip_whitespace(&buffer);
+
+    /* nothing but an optional zero terminator may follow the value */
+    if (can_access_at_index(&buffer, 0) && (buffer_at_offset(&buffer)[0] != '\0'))
+    {
+        goto fail;
+    }
+
+    if (error_at != NULL)
+    {
+        *error_at = NULL;
+    }
+
+    return true;
+
+fail:
+    if (error_at != NULL)
+    {
+        if (buffer.offset >= buffer.length)
+        {
+            buffer.offset = buffer.length - 1;
+        }
+        *error_at = (const char*)buffer_at_offset(&buffer);
+    }
+
+    return false;
+}
+
+/* Canonical printing (RFC 8785, JSON Canonicalization Scheme): no whitespace, object members sorted by
+ * the UTF-16 code units of their keys, numbers in the shortest form that reads back exactly, formatted like
+ * ECMAScript does, and only the escapes that are required. The tree isn't modified, members are sorted in a
+ * temporary index per object. The output goes through a small buffer to a write callback. */
+#define CANONICAL_CHUNK_SIZE 512
+/* objects up to this size are sorted without allocating */
+#define CANONICAL_SMALL_OBJECT 16
+
+typedef struct
+{
+    unsigned char buffer[CANONICAL_CHUNK_SIZE];
+    size_t used;
+    cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length);
+    void *context;
+    cJSON_bool failed;
+} canonical_writer;
+
+static cJSON_bool flush_canonical(canonical_writer * const writer)
+{
+    if (!writer->failed && (writer->used > 0) && !writer->write(writer->context, (const char*)writer->buffer, writer->used))
+    {
+        writer->failed = true;
+    }
+    writer->used = 0;
+
+    return !writer->failed;
+}
+
+static cJSON_bool write_canonical(canonical_writer * const writer, const unsigned char * const data, const size_t length)
+{
+    if (writer->failed)
+    {
+        return false;
+    }
+
+    if (length > (CANONICAL_CHUNK_SIZE - writer->used))
+    {
+        if (!flush_canonical(writer))
+        {
             return false;
+        }
+        if (length >= CANONICAL_CHUNK_SIZE)
+        {
+            /* big enough to be written directly */
+            if (!writer->write(writer->context, (const char*)data, length))
+            {
+                writer->failed = true;
+            }
+            return !writer->failed;
+        }
     }
+
+    memcpy(writer->buffer + writer->used, data, length);
+    writer->used += length;
+
+    return true;
 }
 
-/* Build an array from input text. */
-static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer)
+/* the next UTF-16 code unit of a UTF-8 string, the low surrogate of a pair is kept in 'pending' */
+static unsigned long next_utf16_unit(const unsigned char ** const string, unsigned long * const pending)
 {
-    cJSON *head = NULL; /* head of the linked list */
-    cJSON *current_item = NULL;
+    const unsigned char *input = *string;
+    unsigned long codepoint = 0;
+    size_t length = 0;
+    size_t i = 0;
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    if (*pending != 0)
     {
-        return false; /* to deeply nested */
+        codepoint = *pending;
+        *pending = 0;
+        return codepoint;
     }
-    input_buffer->depth++;
 
-    if (buffer_at_offset(input_buffer)[0] != '[')
+    if (input[0] == '\0')
     {
-        /* not an array */
-        goto fail;
+        return 0;
     }
 
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    length = validate_utf8_sequence(input, 4);
+    if (length <= 1)
     {
-        /* empty array */
-        goto success;
+        /* ASCII, invalid bytes are compared by their value */
+        *string = input + 1;
+        return input[0];
     }
 
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    codepoint = (unsigned long)input[0] & (0x7FUL >> length);
+    for (i = 1; i < length; i++)
     {
-        input_buffer->offset--;
-        goto fail;
+        codepoint = (codepoint << 6) | ((unsigned long)input[i] & 0x3F);
     }
+    *string = input + length;
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+    if (codepoint < 0x10000)
     {
-        /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
+        return codepoint;
+    }
 
-        /* attach next item to list */
-        if (head == NULL)
-        {
-            /* start the linked list */
-            current_item = head = new_item;
-        }
-        else
+    codepoint -= 0x10000;
+    *pending = 0xDC00 | (codepoint & 0x3FF);
+    return 0xD800 | (codepoint >> 10);
+}
+
+static int compare_utf16(const unsigned char *a, const unsigned char *b)
+{
+    unsigned long a_pending = 0;
+    unsigned long b_pending = 0;
+
+    for (;;)
+    {
+        unsigned long a_unit = next_utf16_unit(&a, &a_pending);
+        unsigned long b_unit = next_utf16_unit(&b, &b_pending);
+        if (a_unit != b_unit)
         {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
+            return (a_unit < b_unit) ? -1 : 1;
         }
-
-        /* parse next value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
+        if (a_unit == 0)
         {
-            goto fail; /* failed to parse value */
+            return 0;
         }
-        buffer_skip_whitespace(input_buffer);
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+}
+
+static cJSON_bool print_canonical_string(const unsigned char *input, canonical_writer * const writer)
+{
+    const unsigned char *run = NULL;
 
-    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    if (input == NULL)
     {
-        goto fail; /* expected end of array */
+        return false;
     }
 
-success:
-    input_buffer->depth--;
-
-    if (head != NULL) {
-        head->prev = current_item;
+    if (!write_canonical(writer, (const unsigned char*)"\"", 1))
+    {
+        return false;
     }
+    for (run = input; *input != '\0';)
+    {
+        unsigned char escape[7];
+        size_t escape_length = 2;
+        size_t sequence_length = 0;
 
-    item->type = cJSON_Array;
-    item->child = head;
-
-    input_buffer->offset++;
-
-    return true;
+        if ((*input >= 32) && (*input != '\"') && (*input != '\\'))
+        {
+            /* JCS requires well formed strings */
+            sequence_length = validate_utf8_sequence(input, 4);
+            if (sequence_length == 0)
+            {
+                return false;
+            }
+            input += sequence_length;
+            continue;
+        }
 
-fail:
-    if (head != NULL)
-    {
-        cJSON_Delete(head);
+        escape[0] = '\\';
+        switch (*input)
+        {
+            case '\"':
+            case '\\':
+                escape[1] = *input;
+                break;
+            case '\b':
+                escape[1] = 'b';
+                break;
+            case '\f':
+                escape[1] = 'f';
+                break;
+            case '\n':
+                escape[1] = 'n';
+                break;
+            case '\r':
+                escape[1] = 'r';
+                break;
+            case '\t':
+                escape[1] = 't';
+                break;
+            default:
+                sprintf((char*)escape + 1, "u%04x", *input);
+                escape_length = 6;
+                break;
+        }
+        if (!write_canonical(writer, run, (size_t)(input - run)) || !write_canonical(writer, escape, escape_length))
+        {
+            return false;
+        }
+        input++;
+        run = input;
     }
 
-    return false;
+    return write_canonical(writer, run, (size_t)(input - run)) && write_canonical(writer, (const unsigned char*)"\"", 1);
 }
 
-/* Render an array to text */
-static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer)
+/* Number::toString of ECMAScript: the shortest digits that read back as the same double,
+ * plain notation for decimal exponents from -6 to 20, exponential notation otherwise. */
+static cJSON_bool print_canonical_number(const double number, canonical_writer * const writer)
 {
-    unsigned char *output_pointer = NULL;
+    unsigned char printed[32];
+    unsigned char digits[20];
+    unsigned char output[40];
+    unsigned char decimal_point = get_decimal_point();
+    size_t digit_count = 0;
     size_t length = 0;
-    cJSON *current_element = item->child;
+    size_t i = 0;
+    double test = 0;
+    int precision = 0;
+    int exponent = 0;
+    const unsigned char *position = NULL;
 
-    if (output_buffer == NULL)
+    if (isnan(number) || isinf(number))
     {
+        /* not representable in JSON */
         return false;
     }
 
-    /* Compose the output array. */
-    /* opening square bracket */
-    output_pointer = ensure(output_buffer, 1);
-    if (output_pointer == NULL)
+    if (number == 0)
     {
-        return false;
+        /* -0 too */
+        return write_canonical(writer, (const unsigned char*)"0", 1);
     }
 
-    *output_pointer = '[';
-    output_buffer->offset++;
-    output_buffer->depth++;
+    for (precision = 1; precision <= 17; precision++)
+    {
+        sprintf((char*)printed, "%.*e", precision - 1, number);
+        if ((sscanf((char*)printed, "%lg", &test) == 1) && (test == number))
+        {
+            break;
+        }
+    }
 
-    while (current_element != NULL)
+    /* collect the digits and the exponent of d.ddde+xx */
+    position = printed;
+    if (*position == '-')
+    {
+        output[length++] = '-';
+        position++;
+    }
+    for (; (*position != 'e') && (*position != '\0'); position++)
     {
-        if (!print_value(current_element, output_buffer))
+        if ((*position >= '0') && (*position <= '9'))
+        {
+            digits[digit_count++] = *position;
+        }
+        else if (*position != decimal_point)
         {
             return false;
         }
-        update_offset(output_buffer);
-        if (current_element->next)
+    }
+    if ((*position != 'e') || (sscanf((const char*)position + 1, "%d", &exponent) != 1))
+    {
+        return false;
+    }
+    while ((digit_count > 1) && (digits[digit_count - 1] == '0'))
+    {
+        digit_count--;
+    }
+
+    /* 'exponent' + 1 digits are before the decimal point */
+    exponent++;
+    if (((int)digit_count <= exponent) && (exponent <= 21))
+    {
+        /* integer */
+        memcpy(output + length, digits, digit_count);
+        length += digit_count;
+        for (i = digit_count; i < (size_t)exponent; i++)
+        {
+            output[length++] = '0';
+        }
+    }
+    else if ((exponent > 0) && (exponent <= 21))
+    {
+        memcpy(output + length, digits, (size_t)exponent);
+        length += (size_t)exponent;
+        output[length++] = '.';
+        memcpy(output + length, digits + exponent, digit_count - (size_t)exponent);
+        length += digit_count - (size_t)exponent;
+    }
+    else if ((exponent > -6) && (exponent <= 0))
+    {
+        output[length++] = '0';
+        output[length++] = '.';
+        for (i = 0; i < (size_t)-exponent; i++)
         {
-            length = (size_t) (output_buffer->format ? 2 : 1);
-            output_pointer = ensure(output_buffer, length + 1);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            *output_pointer++ = ',';
-            if(output_buffer->format)
-            {
-                *output_pointer++ = ' ';
-            }
-            *output_pointer = '\0';
-            output_buffer->offset += length;
+            output[length++] = '0';
+        }
+        memcpy(output + length, digits, digit_count);
+        length += digit_count;
+    }
+    else
+    {
+        output[length++] = digits[0];
+        if (digit_count > 1)
+        {
+            output[length++] = '.';
+            memcpy(output + length, digits + 1, digit_count - 1);
+            length += digit_count - 1;
         }
-        current_element = current_element->next;
+        length += (size_t)sprintf((char*)output + length, "e%c%d", (exponent > 0) ? '+' : '-', (exponent > 0) ? (exponent - 1) : (1 - exponent));
     }
 
-    output_pointer = ensure(output_buffer, 2);
-    if (output_pointer == NULL)
+    return write_canonical(writer, output, length);
+}
+
+/* stable merge sort of the members by their keys, equal keys make it fail */
+static cJSON_bool sort_members(const cJSON **members, const cJSON **buffer, const size_t count, int (*compare)(const unsigned char *a, const unsigned char *b))
+{
+    size_t middle = count / 2;
+    size_t left = 0;
+    size_t right = middle;
+    size_t output = 0;
+
+    if (count < 2)
+    {
+        return true;
+    }
+    if (!sort_members(members, buffer, middle, compare) || !sort_members(members + middle, buffer, count - middle, compare))
     {
         return false;
     }
-    *output_pointer++ = ']';
-    *output_pointer = '\0';
-    output_buffer->depth--;
+
+    while ((left < middle) && (right < count))
+    {
+        int difference = compare((const unsigned char*)members[left]->string, (const unsigned char*)members[right]->string);
+        if (difference == 0)
+        {
+            /* duplicate keys have no canonical form */
+            return false;
+        }
+        buffer[output++] = (difference < 0) ? members[left++] : members[right++];
+    }
+    while (left < middle)
+    {
+        buffer[output++] = members[left++];
+    }
+    while (right < count)
+    {
+        buffer[output++] = members[right++];
+    }
+    memcpy((void*)members, (const void*)buffer, count * sizeof(const cJSON*));
 
     return true;
 }
 
-/* Build an object from the text. */
-static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer)
+typedef struct
 {
-    cJSON *head = NULL; /* linked list head */
-    cJSON *current_item = NULL;
+    const cJSON *item; /* the array or object */
+    const cJSON *next; /* arrays: the element that is printed next */
+    size_t members; /* objects: where their sorted members start in the member stack */
+    size_t count; /* objects: the number of members */
+    size_t index; /* objects: the member that is printed next */
+} canonical_frame;
+
+/* Put the members of an object sorted by key on top of the member stack, with room to sort them above. */
+static cJSON_bool push_sorted_members(const cJSON * const item, const cJSON *** const stack, size_t * const capacity, size_t * const used, const cJSON ** const inline_stack, size_t * const count)
+{
+    const cJSON **members = NULL;
+    const cJSON *child = NULL;
+    void *grown = NULL;
+    size_t index = 0;
 
-    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    *count = 0;
+    for (child = item->child; child != NULL; child = child->next)
     {
-        return false; /* to deeply nested */
+        if (child->string == NULL)
+        {
+            return false;
+        }
+        (*count)++;
     }
-    input_buffer->depth++;
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '{'))
+    if (*count > ((((size_t)-1) / 2) - *used))
     {
-        goto fail; /* not an object */
+        return false; /* overflow */
     }
-
-    input_buffer->offset++;
-    buffer_skip_whitespace(input_buffer);
-    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    grown = grow_stack(*stack, capacity, *used + (2 * *count), sizeof(const cJSON*), inline_stack);
+    if (grown == NULL)
     {
-        goto success; /* empty object */
+        return false;
     }
+    *stack = (const cJSON**)grown;
 
-    /* check if we skipped to the end of the buffer */
-    if (cannot_access_at_index(input_buffer, 0))
+    members = *stack + *used;
+    for (child = item->child, index = 0; child != NULL; child = child->next, index++)
     {
-        input_buffer->offset--;
-        goto fail;
+        members[index] = child;
     }
+    if (!sort_members(members, members + *count, *count, compare_utf16))
+    {
+        return false;
+    }
+    *used += *count;
+
+    return true;
+}
 
-    /* step back to character in front of the first element */
-    input_buffer->offset--;
-    /* loop through the comma separated array elements */
-    do
+/* Print a value that isn't an array or object. */
+static cJSON_bool print_canonical_scalar(const cJSON * const item, canonical_writer * const writer)
+{
+    switch (item->type & 0xFF)
     {
-        /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
-        if (new_item == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
+        case cJSON_NULL:
+            return write_canonical(writer, (const unsigned char*)"null", 4);
 
-        /* attach next item to list */
-        if (head == NULL)
-        {
-            /* start the linked list */
-            current_item = head = new_item;
-        }
-        else
+        case cJSON_False:
+            return write_canonical(writer, (const unsigned char*)"false", 5);
+
+        case cJSON_True:
+            return write_canonical(writer, (const unsigned char*)"true", 4);
+
+        case cJSON_Number:
+            return print_canonical_number(item->valuedouble, writer);
+
+        case cJSON_String:
+            return print_canonical_string((const unsigned char*)item->valuestring, writer);
+
+        default:
+            /* raw JSON can't be canonicalized */
+            return false;
+    }
+}
+
+/* Canonical printing keeps a stack of frames for the arrays and objects and one of their sorted members,
+ * it fails below CJSON_CIRCULAR_LIMIT. */
+static cJSON_bool print_canonical_value(const cJSON * const root, canonical_writer * const writer)
+{
+    canonical_frame inline_frames[INLINE_STACK_DEPTH];
+    const cJSON *inline_members[2 * CANONICAL_SMALL_OBJECT];
+    canonical_frame *frames = inline_frames;
+    canonical_frame *frame = NULL;
+    const cJSON **members = inline_members;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t member_capacity = 2 * CANONICAL_SMALL_OBJECT;
+    size_t member_count = 0;
+    size_t count = 0;
+    const cJSON *current = root;
+    cJSON_bool success = false;
+
+    for (;;)
+    {
+        if (count >= CJSON_CIRCULAR_LIMIT)
         {
-            /* add to the end and advance */
-            current_item->next = new_item;
-            new_item->prev = current_item;
-            current_item = new_item;
+            goto cleanup; /* too deep to print */
         }
-
-        if (cannot_access_at_index(input_buffer, 1))
+        if ((current->type & cJSON_IsDeferred) && !cJSON_Expand((cJSON*)cast_away_const(current)))
         {
-            goto fail; /* nothing comes after the comma */
+            goto cleanup;
         }
 
-        /* parse the name of the child */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_string(current_item, input_buffer))
+        if (((current->type & 0xFF) == cJSON_Array) || ((current->type & 0xFF) == cJSON_Object))
         {
-            goto fail; /* failed to parse name */
+            grown = grow_stack(frames, &capacity, count + 1, sizeof(canonical_frame), inline_frames);
+            if (grown == NULL)
+            {
+                goto cleanup;
+            }
+            frames = (canonical_frame*)grown;
+            frame = &frames[count];
+            frame->item = current;
+            frame->next = current->child;
+            frame->members = member_count;
+            frame->count = 0;
+            frame->index = 0;
+
+            if ((current->type & 0xFF) == cJSON_Object)
+            {
+                if (!push_sorted_members(current, &members, &member_capacity, &member_count, inline_members, &frame->count)
+                        || !write_canonical(writer, (const unsigned char*)"{", 1))
+                {
+                    goto cleanup;
+                }
+            }
+            else
+            {
+                if (!write_canonical(writer, (const unsigned char*)"[", 1))
+                {
+                    goto cleanup;
+                }
+                if (current->type & cJSON_IsPacked)
+                {
+                    const double *numbers = packed_numbers(current);
+                    int index = 0;
+                    for (index = 0; index < current->valueint; index++)
+                    {
+                        if (((index > 0) && !write_canonical(writer, (const unsigned char*)",", 1)) || !print_canonical_number(numbers[index], writer))
+                        {
+                            goto cleanup;
+                        }
+                    }
+                }
+            }
+            count++;
         }
-        buffer_skip_whitespace(input_buffer);
-
-        /* swap valuestring and string, because we parsed the name */
-        current_item->string = current_item->valuestring;
-        current_item->valuestring = NULL;
-
-        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        else if (!print_canonical_scalar(current, writer))
         {
-            goto fail; /* invalid object */
+            goto cleanup;
         }
 
-        /* parse the value */
-        input_buffer->offset++;
-        buffer_skip_whitespace(input_buffer);
-        if (!parse_value(current_item, input_buffer))
+        /* continue with the next element or member, the arrays and objects without one are closed */
+        for (;;)
         {
-            goto fail; /* failed to parse value */
+            if (count == 0)
+            {
+                success = true;
+                goto cleanup;
+            }
+            frame = &frames[count - 1];
+            if ((frame->item->type & 0xFF) == cJSON_Array)
+            {
+                current = frame->next;
+                if (current != NULL)
+                {
+                    if ((current != frame->item->child) && !write_canonical(writer, (const unsigned char*)",", 1))
+                    {
+                        goto cleanup;
+                    }
+                    frame->next = current->next;
+                    break;
+                }
+                if (!write_canonical(writer, (const unsigned char*)"]", 1))
+                {
+                    goto cleanup;
+                }
+            }
+            else
+            {
+                if (frame->index < frame->count)
+                {
+                    current = members[frame->members + frame->index];
+                    if (((frame->index > 0) && !write_canonical(writer, (const unsigned char*)",", 1))
+                        || !print_canonical_string((const unsigned char*)current->string, writer)
+                        || !write_canonical(writer, (const unsigned char*)":", 1))
+                    {
+                        goto cleanup;
+                    }
+                    frame->index++;
+                    break;
+                }
+                if (!write_canonical(writer, (const unsigned char*)"}", 1))
+                {
+                    goto cleanup;
+                }
+                member_count = frame->members;
+            }
+            count--;
         }
-        buffer_skip_whitespace(input_buffer);
     }
-    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
 
-    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+cleanup:
+    if (frames != inline_frames)
     {
-        goto fail; /* expected end of object */
+        global_hooks.deallocate(frames);
     }
-
-success:
-    input_buffer->depth--;
-
-    if (head != NULL) {
-        head->prev = current_item;
-    }
-
-    item->type = cJSON_Object;
-    item->child = head;
-
-    input_buffer->offset++;
-    return true;
-
-fail:
-    if (head != NULL)
+    if (members != inline_members)
     {
-        cJSON_Delete(head);
+        global_hooks.deallocate((void*)members);
     }
 
-    return false;
+    return success;
 }
 
-/* Render an object to text. */
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintCanonicalToCallback(const cJSON *item, cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length), void *context)
 {
-    unsigned char *output_pointer = NULL;
-    size_t length = 0;
-    cJSON *current_item = item->child;
+    canonical_writer *writer = NULL;
+    cJSON_bool success = false;
 
-    if (output_buffer == NULL)
+    if ((item == NULL) || (write == NULL))
     {
         return false;
     }
 
-    /* Compose the output: */
-    length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
-    output_pointer = ensure(output_buffer, length + 1);
-    if (output_pointer == NULL)
+    writer = (canonical_writer*)global_hooks.allocate(sizeof(canonical_writer));
+    if (writer == NULL)
     {
         return false;
     }
+    writer->used = 0;
+    writer->write = write;
+    writer->context = context;
+    writer->failed = false;
 
-    *output_pointer++ = '{';
-    output_buffer->depth++;
-    if (output_buffer->format)
-    {
-        *output_pointer++ = '\n';
-    }
-    output_buffer->offset += length;
-
-    while (current_item)
-    {
-        if (output_buffer->format)
-        {
-            size_t i;
-            output_pointer = ensure(output_buffer, output_buffer->depth);
-            if (output_pointer == NULL)
-            {
-                return false;
-            }
-            for (i = 0; i < output_buffer->depth; i++)
-            {
-                *output_pointer++ = '\t';
-            }
-            output_buffer->offset += output_buffer->depth;
-        }
-
-        /* print key */
-        if (!print_string_ptr((unsigned char*)current_item->string, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
+    success = print_canonical_value(item, writer) && flush_canonical(writer);
+    global_hooks.deallocate(writer);
 
-        length = (size_t) (output_buffer->format ? 2 : 1);
-        output_pointer = ensure(output_buffer, length);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        *output_pointer++ = ':';
-        if (output_buffer->format)
-        {
-            *output_pointer++ = '\t';
-        }
-        output_buffer->offset += length;
+    return success;
+}
 
-        /* print value */
-        if (!print_value(current_item, output_buffer))
-        {
-            return false;
-        }
-        update_offset(output_buffer);
+static cJSON_bool CJSON_CDECL append_to_printbuffer(void *context, const char *data, size_t length)
+{
+    printbuffer * const buffer = (printbuffer*)context;
+    unsigned char *output = ensure(buffer, length);
 
-        /* print comma if not last */
-        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
-        output_pointer = ensure(output_buffer, length + 1);
-        if (output_pointer == NULL)
-        {
-            return false;
-        }
-        if (current_item->next)
-        {
-            *output_pointer++ = ',';
-        }
+    if (output == NULL)
+    {
+        return false;
+    }
+    memcpy(output, data, length);
+    buffer->offset += length;
+    output[length] = '\0';
 
-        if (output_buffer->format)
-        {
-            *output_pointer++ = '\n';
-        }
-        *output_pointer = '\0';
-        output_buffer->offset += length;
+    return true;
+}
 
-        current_item = current_item->next;
-    }
+CJSON_PUBLIC(char *) cJSON_PrintCanonical(const cJSON *item)
+{
+    printbuffer buffer = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0 };
 
-    output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
-    if (output_pointer == NULL)
+    buffer.buffer = (unsigned char*)global_hooks.allocate(256);
+    if (buffer.buffer == NULL)
     {
-        return false;
+        return NULL;
     }
-    if (output_buffer->format)
+    buffer.length = 256;
+    buffer.hooks = global_hooks;
+    buffer.buffer[0] = '\0';
+
+    if (!cJSON_PrintCanonicalToCallback(item, append_to_printbuffer, &buffer))
     {
-        size_t i;
-        for (i = 0; i < (output_buffer->depth - 1); i++)
+        if (buffer.buffer != NULL)
         {
-            *output_pointer++ = '\t';
+            global_hooks.deallocate(buffer.buffer);
         }
+        return NULL;
     }
-    *output_pointer++ = '}';
-    *output_pointer = '\0';
-    output_buffer->depth--;
 
-    return true;
+    return (char*)buffer.buffer;
 }
 
 /* Get Array size/item / object item. */
@@ -1891,6 +5779,15 @@ CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
         return 0;
     }
 
+    if ((array->type & cJSON_IsDeferred) && !cJSON_Expand((cJSON*)cast_away_const(array)))
+    {
+        return 0;
+    }
+    if (array->type & cJSON_IsPacked)
+    {
+        return array->valueint;
+    }
+
     child = array->child;
 
     while(child != NULL)
@@ -1904,6 +5801,65 @@ CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
     return (int)size;
 }
 
+CJSON_PUBLIC(const double *) cJSON_GetDoubleArray(const cJSON *array, int *count)
+{
+    if ((array == NULL) || !(array->type & cJSON_IsPacked))
+    {
+        return NULL;
+    }
+
+    if (count != NULL)
+    {
+        *count = array->valueint;
+    }
+
+    return packed_numbers(array);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_GetPackedNumber(const cJSON *array, int index, double *number)
+{
+    const cJSON *item = NULL;
+
+    if ((array == NULL) || (index < 0) || (number == NULL))
+    {
+        return false;
+    }
+
+    if (array->type & cJSON_IsPacked)
+    {
+        if (index >= array->valueint)
+        {
+            return false;
+        }
+        *number = packed_numbers(array)[index];
+        return true;
+    }
+
+    item = cJSON_GetArrayItem(array, index);
+    if (!cJSON_IsNumber(item))
+    {
+        return false;
+    }
+    *number = item->valuedouble;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetFirstChild(const cJSON *item)
+{
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    if ((item->type & (cJSON_IsDeferred | cJSON_IsPacked)) && !cJSON_Expand((cJSON*)cast_away_const(item)))
+    {
+        return NULL;
+    }
+
+    return item->child;
+}
+
 static cJSON* get_array_item(const cJSON *array, size_t index)
 {
     cJSON *current_child = NULL;
@@ -1913,6 +5869,11 @@ static cJSON* get_array_item(const cJSON *array, size_t index)
         return NULL;
     }
 
+    if ((array->type & (cJSON_IsDeferred | cJSON_IsPacked)) && !cJSON_Expand((cJSON*)cast_away_const(array)))
+    {
+        return NULL;
+    }
+
     current_child = array->child;
     while ((current_child != NULL) && (index > 0))
     {
@@ -1923,6 +5884,17 @@ static cJSON* get_array_item(const cJSON *array, size_t index)
     return current_child;
 }
 
+/* Expand an item that is handed out by the getters, it stays raw if its text is broken. */
+static cJSON *expand_accessed(cJSON * const item)
+{
+    if ((item != NULL) && (item->type & cJSON_IsDeferred))
+    {
+        cJSON_Expand(item);
+    }
+
+    return item;
+}
+
 CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
 {
     if (index < 0)
@@ -1930,7 +5902,7 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
         return NULL;
     }
 
-    return get_array_item(array, (size_t)index);
+    return expand_accessed(get_array_item(array, (size_t)index));
 }
 
 static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
@@ -1942,17 +5914,22 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
         return NULL;
     }
 
+    if ((object->type & cJSON_IsDeferred) && !cJSON_Expand((cJSON*)cast_away_const(object)))
+    {
+        return NULL;
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
+        while ((current_element != NULL) && (current_element->string != NULL) && (current_element->string != name) && (strcmp(name, current_element->string) != 0))
         {
             current_element = current_element->next;
         }
     }
     else
     {
-        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
+        while ((current_element != NULL) && (current_element->string != name) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
         {
             current_element = current_element->next;
         }
@@ -1967,17 +5944,17 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
 
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string)
 {
-    return get_object_item(object, string, false);
+    return expand_accessed(get_object_item(object, string, false));
 }
 
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string)
 {
-    return get_object_item(object, string, true);
+    return expand_accessed(get_object_item(object, string, true));
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
 {
-    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+    return get_object_item(object, string, false) ? 1 : 0;
 }
 
 /* Utility for array list handling. */
@@ -1996,6 +5973,12 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
         return NULL;
     }
 
+    /* a reference can't share the numbers of a packed array, they are freed when it is expanded */
+    if ((item->type & cJSON_IsPacked) && !cJSON_Expand((cJSON*)cast_away_const(item)))
+    {
+        return NULL;
+    }
+
     reference = cJSON_New_Item(hooks);
     if (reference == NULL)
     {
@@ -2004,7 +5987,12 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
-    reference->type |= cJSON_IsReference;
+    if (item->type & cJSON_IsShared)
+    {
+        /* the share group stays with item */
+        reference->valuestring = NULL;
+    }
+    reference->type = (reference->type | cJSON_IsReference) & ~cJSON_IsShared;
     reference->next = reference->prev = NULL;
     return reference;
 }
@@ -2018,6 +6006,11 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
         return false;
     }
 
+    if (((array->type & (cJSON_IsDeferred | cJSON_IsPacked)) && !cJSON_Expand(array)) || !own_children(array))
+    {
+        return false;
+    }
+
     child = array->child;
     /*
      * To find the last item in array quickly, we use prev in array
@@ -2038,6 +6031,8 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
             array->child->prev = item;
         }
     }
+    mark_dirty(array);
+    link_parent(array, item);
 
     return true;
 }
@@ -2048,21 +6043,6 @@ CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item)
     return add_item_to_array(array, item);
 }
 
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic push
-#endif
-#ifdef __GNUC__
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-/* helper function to cast away const */
-static void* cast_away_const(const void* string)
-{
-    return (void*)string;
-}
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic pop
-#endif
-
 
 static cJSON_bool add_item_to_object(cJSON * const object, const char * const string, cJSON * const item, const internal_hooks * const hooks, const cJSON_bool constant_key)
 {
@@ -2242,38 +6222,49 @@ CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * c
 
 CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
 {
+    cJSON *detached = NULL;
+
     if ((parent == NULL) || (item == NULL) || (item != parent->child && item->prev == NULL))
     {
         return NULL;
     }
 
-    if (item != parent->child)
+    /* if parent shares its children, its own copy of item is detached */
+    detached = own_child(parent, item);
+    if (detached == NULL)
+    {
+        return NULL;
+    }
+
+    if (detached != parent->child)
     {
         /* not the first element */
-        item->prev->next = item->next;
+        detached->prev->next = detached->next;
     }
-    if (item->next != NULL)
+    if (detached->next != NULL)
     {
         /* not the last element */
-        item->next->prev = item->prev;
+        detached->next->prev = detached->prev;
     }
 
-    if (item == parent->child)
+    if (detached == parent->child)
     {
         /* first element */
-        parent->child = item->next;
+        parent->child = detached->next;
     }
-    else if (item->next == NULL)
+    else if (detached->next == NULL)
     {
         /* last element */
-        parent->child->prev = item->prev;
+        parent->child->prev = detached->prev;
     }
 
     /* make sure the detached item doesn't point anywhere anymore */
-    item->prev = NULL;
-    item->next = NULL;
+    detached->prev = NULL;
+    detached->next = NULL;
+    mark_dirty(parent);
+    unlink_parent(detached);
 
-    return item;
+    return detached;
 }
 
 CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromArray(cJSON *array, int which)
@@ -2330,6 +6321,11 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
     {
         return add_item_to_array(array, newitem);
     }
+    after_inserted = own_child(array, after_inserted);
+    if (after_inserted == NULL)
+    {
+        return false;
+    }
 
     if (after_inserted != array->child && after_inserted->prev == NULL) {
         /* return false if after_inserted is a corrupted array item */
@@ -2347,11 +6343,15 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
     {
         newitem->prev->next = newitem;
     }
+    mark_dirty(array);
+    link_parent(array, newitem);
     return true;
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON * const item, cJSON * replacement)
 {
+    cJSON *replaced = NULL;
+
     if ((parent == NULL) || (parent->child == NULL) || (replacement == NULL) || (item == NULL))
     {
         return false;
@@ -2362,14 +6362,21 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         return true;
     }
 
-    replacement->next = item->next;
-    replacement->prev = item->prev;
+    /* if parent shares its children, its own copy of item is replaced */
+    replaced = own_child(parent, item);
+    if (replaced == NULL)
+    {
+        return false;
+    }
+
+    replacement->next = replaced->next;
+    replacement->prev = replaced->prev;
 
     if (replacement->next != NULL)
     {
         replacement->next->prev = replacement;
     }
-    if (parent->child == item)
+    if (parent->child == replaced)
     {
         if (parent->child->prev == parent->child)
         {
@@ -2392,9 +6399,11 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         }
     }
 
-    item->next = NULL;
-    item->prev = NULL;
-    cJSON_Delete(item);
+    replaced->next = NULL;
+    replaced->prev = NULL;
+    cJSON_Delete(replaced);
+    mark_dirty(parent);
+    link_parent(parent, replacement);
 
     return true;
 }
@@ -2519,7 +6528,7 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string)
     if(item)
     {
         item->type = cJSON_String;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+        item->valuestring = (string != NULL) ? store_string(item, string, strlen(string)) : NULL;
         if(!item->valuestring)
         {
             cJSON_Delete(item);
@@ -2763,6 +6772,87 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int co
     return a;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_CreatePackedArray(const double *numbers, int count)
+{
+    cJSON *a = NULL;
+    size_t size = 0;
+
+    if ((count < 0) || ((numbers == NULL) && (count != 0)))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+    /* an empty array has nothing to pack */
+    if ((a == NULL) || (count == 0))
+    {
+        return a;
+    }
+
+    size = (size_t)count * sizeof(double);
+    a->valuestring = (char*)global_hooks.allocate(size);
+    if (a->valuestring == NULL)
+    {
+        cJSON_Delete(a);
+        return NULL;
+    }
+    memcpy(a->valuestring, numbers, size);
+    a->valueint = count;
+    a->type |= cJSON_IsPacked;
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_PackArray(cJSON *array)
+{
+    const cJSON *child = NULL;
+    double *numbers = NULL;
+    size_t count = 0;
+
+    if ((array == NULL) || ((array->type & cJSON_IsDeferred) && !cJSON_Expand(array)))
+    {
+        return false;
+    }
+    if (!cJSON_IsArray(array) || (array->type & cJSON_IsReference))
+    {
+        return false;
+    }
+    if ((array->type & cJSON_IsPacked) || (array->child == NULL))
+    {
+        return true;
+    }
+
+    for (child = array->child; child != NULL; child = child->next)
+    {
+        if (!cJSON_IsNumber(child) || (count == INT_MAX))
+        {
+            return false;
+        }
+        count++;
+    }
+
+    numbers = (double*)global_hooks.allocate(count * sizeof(double));
+    if (numbers == NULL)
+    {
+        return false;
+    }
+    count = 0;
+    for (child = array->child; child != NULL; child = child->next)
+    {
+        numbers[count++] = child->valuedouble;
+    }
+
+    /* other owners of shared children keep them */
+    cJSON_Delete((array->type & cJSON_IsShared) ? release_shared(array) : array->child);
+    array->child = NULL;
+    array->valuestring = (char*)numbers;
+    array->valueint = (int)count;
+    array->type = (array->type & ~cJSON_IsShared) | cJSON_IsPacked;
+    mark_dirty(array);
+
+    return true;
+}
+
 /* Duplication */
 cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse);
 
@@ -2771,31 +6861,22 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
     return cJSON_Duplicate_rec(item, 0, recurse );
 }
 
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
+/* Copy an item without its children. */
+static cJSON *duplicate_item(const cJSON * const item)
 {
-    cJSON *newitem = NULL;
-    cJSON *child = NULL;
-    cJSON *next = NULL;
-    cJSON *newchild = NULL;
-
-    /* Bail on bad ptr */
-    if (!item)
-    {
-        goto fail;
-    }
-    /* Create new item */
-    newitem = cJSON_New_Item(&global_hooks);
+    cJSON *newitem = cJSON_New_Item(&global_hooks);
     if (!newitem)
     {
-        goto fail;
+        return NULL;
     }
     /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
+    newitem->type = item->type & ~(cJSON_IsReference | cJSON_IsShared);
     newitem->valueint = item->valueint;
     newitem->valuedouble = item->valuedouble;
-    if (item->valuestring)
+    /* the valuestring of a shared item holds its share group */
+    if (item->valuestring && !(item->type & cJSON_IsShared))
     {
-        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
+        newitem->valuestring = duplicate_value(item, newitem);
         if (!newitem->valuestring)
         {
             goto fail;
@@ -2803,60 +6884,147 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
     }
     if (item->string)
     {
-        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
-        if (!newitem->string)
-        {
-            goto fail;
-        }
+        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
+        if (!newitem->string)
+        {
+            goto fail;
+        }
+    }
+
+    return newitem;
+
+fail:
+    cJSON_Delete(newitem);
+
+    return NULL;
+}
+
+typedef struct
+{
+    const cJSON *next; /* the child of the original that is copied next */
+    cJSON *copy; /* the copy of its parent */
+    cJSON *last; /* the last child of copy so far */
+} duplicate_frame;
+
+/* depth is the depth of item, copying fails below CJSON_CIRCULAR_LIMIT because circular references end up there. */
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
+{
+    duplicate_frame inline_frames[INLINE_STACK_DEPTH];
+    duplicate_frame *frames = inline_frames;
+    duplicate_frame *frame = NULL;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t count = 0;
+    cJSON *newitem = NULL;
+    cJSON *newchild = NULL;
+
+    /* Bail on bad ptr */
+    if (!item)
+    {
+        return NULL;
     }
+    newitem = duplicate_item(item);
     /* If non-recursive, then we're done! */
-    if (!recurse)
+    if ((newitem == NULL) || !recurse || (item->child == NULL))
     {
         return newitem;
     }
-    /* Walk the ->next chain for the child. */
-    child = item->child;
-    while (child != NULL)
+
+    frame = &frames[count++];
+    frame->next = item->child;
+    frame->copy = newitem;
+    frame->last = NULL;
+    while (count > 0)
     {
-        if(depth >= CJSON_CIRCULAR_LIMIT) {
+        frame = &frames[count - 1];
+        item = frame->next;
+        if (item == NULL)
+        {
+            /* all children are copied */
+            if (frame->last != NULL)
+            {
+                frame->copy->child->prev = frame->last;
+            }
+            count--;
+            continue;
+        }
+        frame->next = item->next;
+
+        if ((depth + count) > CJSON_CIRCULAR_LIMIT)
+        {
             goto fail;
         }
-        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
-        if (!newchild)
+        newchild = duplicate_item(item);
+        if (newchild == NULL)
         {
             goto fail;
         }
-        if (next != NULL)
+        if (frame->last != NULL)
         {
             /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-            next->next = newchild;
-            newchild->prev = next;
-            next = newchild;
+            frame->last->next = newchild;
+            newchild->prev = frame->last;
         }
         else
         {
             /* Set newitem->child and move to it */
-            newitem->child = newchild;
-            next = newchild;
+            frame->copy->child = newchild;
+        }
+        frame->last = newchild;
+
+        /* copy the children of the new child before its siblings */
+        if (item->child != NULL)
+        {
+            grown = grow_stack(frames, &capacity, count + 1, sizeof(duplicate_frame), inline_frames);
+            if (grown == NULL)
+            {
+                goto fail;
+            }
+            frames = (duplicate_frame*)grown;
+            frame = &frames[count++];
+            frame->next = item->child;
+            frame->copy = newchild;
+            frame->last = NULL;
         }
-        child = child->next;
     }
-    if (newitem && newitem->child)
+
+    if (frames != inline_frames)
     {
-        newitem->child->prev = newchild;
+        global_hooks.deallocate(frames);
     }
 
     return newitem;
 
 fail:
-    if (newitem != NULL)
+    if (frames != inline_frames)
     {
-        cJSON_Delete(newitem);
+        global_hooks.deallocate(frames);
     }
+    cJSON_Delete(newitem);
 
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_DuplicateShared(cJSON *item)
+{
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    return share_item(item, NULL);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Unshare(cJSON *item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return own_children(item);
+}
+
 static void skip_oneline_comment(char **input)
 {
     *input += static_strlen("//");
@@ -3024,6 +7192,12 @@ CJSON_PUBLIC(cJSON_bool) cJSON_IsString(const cJSON * const item)
     return (item->type & 0xFF) == cJSON_String;
 }
 
+/* Deferred items keep the text of an array or object, it starts with its opening bracket. */
+static cJSON_bool is_deferred(const cJSON * const item, const char bracket)
+{
+    return (item->type & cJSON_IsDeferred) && (item->valuestring != NULL) && (item->valuestring[0] == bracket);
+}
+
 CJSON_PUBLIC(cJSON_bool) cJSON_IsArray(const cJSON * const item)
 {
     if (item == NULL)
@@ -3031,7 +7205,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_IsArray(const cJSON * const item)
         return false;
     }
 
-    return (item->type & 0xFF) == cJSON_Array;
+    return ((item->type & 0xFF) == cJSON_Array) || is_deferred(item, '[');
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_IsObject(const cJSON * const item)
@@ -3041,7 +7215,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_IsObject(const cJSON * const item)
         return false;
     }
 
-    return (item->type & 0xFF) == cJSON_Object;
+    return ((item->type & 0xFF) == cJSON_Object) || is_deferred(item, '{');
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
@@ -3051,15 +7225,269 @@ CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
         return false;
     }
 
-    return (item->type & 0xFF) == cJSON_Raw;
+    return ((item->type & 0xFF) == cJSON_Raw) && !(item->type & cJSON_IsDeferred);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+/* Objects with up to this many members are compared without a hash table. */
+#define SMALL_OBJECT_MEMBERS 8
+
+typedef struct
+{
+    const cJSON *b_member; /* first member of b with this key, NULL for an empty slot */
+    const cJSON *a_member; /* first member of a with this key, NULL until one is found */
+} member_slot;
+
+static size_t hash_key(const unsigned char *key, const cJSON_bool case_sensitive)
+{
+    size_t hash = 5381;
+
+    for (; *key != '\0'; key++)
+    {
+        hash = (hash * 33) ^ (size_t)(case_sensitive ? *key : tolower(*key));
+    }
+
+    return hash;
+}
+
+static member_slot *find_member_slot(member_slot * const slots, const size_t capacity, const char * const key, const cJSON_bool case_sensitive)
+{
+    size_t slot = hash_key((const unsigned char*)key, case_sensitive) & (capacity - 1);
+
+    while (slots[slot].b_member != NULL)
+    {
+        const unsigned char *existing = (const unsigned char*)slots[slot].b_member->string;
+        if ((case_sensitive ? strcmp(key, (const char*)existing) : case_insensitive_strcmp((const unsigned char*)key, existing)) == 0)
+        {
+            break;
+        }
+        slot = (slot + 1) & (capacity - 1);
+    }
+
+    return &slots[slot];
+}
+
+typedef struct
+{
+    const cJSON *a; /* the arrays or objects that are compared */
+    const cJSON *b;
+    const cJSON *a_next; /* the next element or member of a */
+    const cJSON *b_next; /* the next element of b, or the next member of b in the second pass */
+    member_slot *slots; /* objects with many members: the members of b by key, NULL otherwise */
+    size_t capacity;
+    cJSON_bool second_pass; /* objects: the members of b are looked up in a */
+} compare_frame;
+
+/* Prepare comparing the members of two objects. Large objects get a temporary hash table of the members of b,
+ * small ones (or if the table can't be allocated) are searched directly. */
+static cJSON_bool start_compare_objects(compare_frame * const frame, const cJSON_bool case_sensitive)
+{
+    member_slot *slot = NULL;
+    const cJSON *member = NULL;
+    size_t a_count = 0;
+    size_t b_count = 0;
+    size_t capacity = 1;
+
+    cJSON_ArrayForEach(member, frame->a)
+    {
+        if (member->string == NULL)
+        {
+            return false;
+        }
+        a_count++;
+    }
+    cJSON_ArrayForEach(member, frame->b)
+    {
+        if (member->string == NULL)
+        {
+            return false;
+        }
+        b_count++;
+    }
+
+    if ((a_count <= SMALL_OBJECT_MEMBERS) && (b_count <= SMALL_OBJECT_MEMBERS))
+    {
+        return true;
+    }
+
+    while (capacity < (b_count * 2))
+    {
+        capacity *= 2;
+    }
+    frame->slots = (member_slot*)global_hooks.allocate(capacity * sizeof(member_slot));
+    if (frame->slots == NULL)
+    {
+        return true;
+    }
+    memset(frame->slots, '\0', capacity * sizeof(member_slot));
+    frame->capacity = capacity;
+
+    cJSON_ArrayForEach(member, frame->b)
+    {
+        slot = find_member_slot(frame->slots, capacity, member->string, case_sensitive);
+        if (slot->b_member == NULL)
+        {
+            slot->b_member = member;
+        }
+    }
+
+    return true;
+}
+
+/* The next pair of children of a frame that have to be equal, *a_item is NULL after the last one.
+ * Returns false if the arrays or objects differ in length or keys.
+ * Every member of a is paired with the first member of b that has the same key and the other way around.
+ * Compare is symmetric, so the second pass only has to pair members with duplicate keys. */
+static cJSON_bool next_compare_pair(compare_frame * const frame, const cJSON_bool case_sensitive, const cJSON ** const a_item, const cJSON ** const b_item)
+{
+    member_slot *slot = NULL;
+    const cJSON *member = NULL;
+    const cJSON *partner = NULL;
+    cJSON_bool first = false;
+
+    *a_item = NULL;
+    *b_item = NULL;
+
+    if ((frame->a->type & 0xFF) == cJSON_Array)
+    {
+        if ((frame->a_next == NULL) || (frame->b_next == NULL))
+        {
+            /* one of the arrays is longer than the other */
+            return frame->a_next == frame->b_next;
+        }
+        *a_item = frame->a_next;
+        *b_item = frame->b_next;
+        frame->a_next = frame->a_next->next;
+        frame->b_next = frame->b_next->next;
+        return true;
+    }
+
+    if (!frame->second_pass)
+    {
+        member = frame->a_next;
+        if (member != NULL)
+        {
+            frame->a_next = member->next;
+            if (frame->slots != NULL)
+            {
+                slot = find_member_slot(frame->slots, frame->capacity, member->string, case_sensitive);
+                partner = slot->b_member;
+                if ((partner != NULL) && (slot->a_member == NULL))
+                {
+                    slot->a_member = member;
+                }
+            }
+            else
+            {
+                partner = get_object_item(frame->b, member->string, case_sensitive);
+            }
+            if (partner == NULL)
+            {
+                return false;
+            }
+            *a_item = member;
+            *b_item = partner;
+            return true;
+        }
+        frame->second_pass = true;
+        frame->b_next = frame->b->child;
+    }
+
+    while (frame->b_next != NULL)
+    {
+        member = frame->b_next;
+        frame->b_next = member->next;
+        if (frame->slots != NULL)
+        {
+            slot = find_member_slot(frame->slots, frame->capacity, member->string, case_sensitive);
+            partner = slot->a_member;
+            first = (slot->b_member == member);
+        }
+        else
+        {
+            partner = get_object_item(frame->a, member->string, case_sensitive);
+            first = (get_object_item(frame->b, member->string, case_sensitive) == member);
+        }
+        if (partner == NULL)
+        {
+            /* key is missing in a */
+            return false;
+        }
+        if (!first)
+        {
+            *a_item = member;
+            *b_item = partner;
+            return true;
+        }
+    }
+
+    return true;
+}
+
+static cJSON_bool compare_packed(const cJSON * const a, const cJSON * const b)
 {
-    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+    const double *a_numbers = packed_numbers(a);
+    const double *b_numbers = packed_numbers(b);
+    int index = 0;
+
+    if (a->valueint != b->valueint)
     {
         return false;
     }
+    for (index = 0; index < a->valueint; index++)
+    {
+        if (!compare_double(a_numbers[index], b_numbers[index]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* A packed array is compared to a linked one number by number, without expanding it. */
+static cJSON_bool compare_packed_to_items(const cJSON * const packed, const cJSON * const array)
+{
+    const double *numbers = packed_numbers(packed);
+    const cJSON *element = array->child;
+    int index = 0;
+
+    for (index = 0; index < packed->valueint; index++, element = element->next)
+    {
+        if ((element == NULL) || ((element->type & 0xFF) != cJSON_Number) || !compare_double(numbers[index], element->valuedouble))
+        {
+            return false;
+        }
+    }
+
+    return element == NULL;
+}
+
+#define COMPARE_UNEQUAL 0
+#define COMPARE_EQUAL 1
+#define COMPARE_CHILDREN 2 /* equal if their children are */
+
+/* Compare a and b without looking at their children. */
+static int compare_values(const cJSON * const a, const cJSON * const b)
+{
+    if ((a == NULL) || (b == NULL))
+    {
+        return COMPARE_UNEQUAL;
+    }
+
+    /* deferred items have to be compared by their content, not their text */
+    if ((a->type & cJSON_IsDeferred) && !cJSON_Expand((cJSON*)cast_away_const(a)))
+    {
+        return COMPARE_UNEQUAL;
+    }
+    if ((b->type & cJSON_IsDeferred) && !cJSON_Expand((cJSON*)cast_away_const(b)))
+    {
+        return COMPARE_UNEQUAL;
+    }
+
+    if ((a->type & 0xFF) != (b->type & 0xFF))
+    {
+        return COMPARE_UNEQUAL;
+    }
 
     /* check if type is valid */
     switch (a->type & 0xFF)
@@ -3075,13 +7503,24 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * cons
             break;
 
         default:
-            return false;
+            return COMPARE_UNEQUAL;
     }
 
     /* identical objects are equal */
     if (a == b)
     {
-        return true;
+        return COMPARE_EQUAL;
+    }
+
+    /* subtrees with equal cached hashes are treated as equal without looking at them */
+    if (node_info_count != 0)
+    {
+        cJSON_HashValue a_hash;
+        cJSON_HashValue b_hash;
+        if (get_cached_hash(a, &a_hash) && get_cached_hash(b, &b_hash) && (memcmp(a_hash.words, b_hash.words, sizeof(a_hash.words)) == 0))
+        {
+            return COMPARE_EQUAL;
+        }
     }
 
     switch (a->type & 0xFF)
@@ -3090,93 +7529,137 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * cons
         case cJSON_False:
         case cJSON_True:
         case cJSON_NULL:
-            return true;
+            return COMPARE_EQUAL;
 
         case cJSON_Number:
-            if (compare_double(a->valuedouble, b->valuedouble))
-            {
-                return true;
-            }
-            return false;
+            return compare_double(a->valuedouble, b->valuedouble) ? COMPARE_EQUAL : COMPARE_UNEQUAL;
 
         case cJSON_String:
         case cJSON_Raw:
             if ((a->valuestring == NULL) || (b->valuestring == NULL))
             {
-                return false;
-            }
-            if (strcmp(a->valuestring, b->valuestring) == 0)
-            {
-                return true;
+                return COMPARE_UNEQUAL;
             }
 
-            return false;
+            return (strcmp(a->valuestring, b->valuestring) == 0) ? COMPARE_EQUAL : COMPARE_UNEQUAL;
 
         case cJSON_Array:
-        {
-            cJSON *a_element = a->child;
-            cJSON *b_element = b->child;
-
-            for (; (a_element != NULL) && (b_element != NULL);)
+            if (a->type & b->type & cJSON_IsPacked)
             {
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
-
-                a_element = a_element->next;
-                b_element = b_element->next;
+                return compare_packed(a, b) ? COMPARE_EQUAL : COMPARE_UNEQUAL;
             }
-
-            /* one of the arrays is longer than the other */
-            if (a_element != b_element) {
-                return false;
+            if (a->type & cJSON_IsPacked)
+            {
+                return compare_packed_to_items(a, b) ? COMPARE_EQUAL : COMPARE_UNEQUAL;
             }
-
-            return true;
-        }
+            if (b->type & cJSON_IsPacked)
+            {
+                return compare_packed_to_items(b, a) ? COMPARE_EQUAL : COMPARE_UNEQUAL;
+            }
+            return COMPARE_CHILDREN;
 
         case cJSON_Object:
+            return COMPARE_CHILDREN;
+
+        default:
+            return COMPARE_UNEQUAL;
+    }
+}
+
+/* Compare two trees with a stack of frames for the arrays and objects that are compared, fails below
+ * CJSON_CIRCULAR_LIMIT. */
+static cJSON_bool compare_items(const cJSON * const a_root, const cJSON * const b_root, const cJSON_bool case_sensitive)
+{
+    compare_frame inline_frames[INLINE_STACK_DEPTH];
+    compare_frame *frames = inline_frames;
+    compare_frame *frame = NULL;
+    void *grown = NULL;
+    size_t capacity = INLINE_STACK_DEPTH;
+    size_t count = 0;
+    const cJSON *a = a_root;
+    const cJSON *b = b_root;
+    cJSON_bool equal = false;
+
+    for (;;)
+    {
+        if (count >= CJSON_CIRCULAR_LIMIT)
         {
-            cJSON *a_element = NULL;
-            cJSON *b_element = NULL;
-            cJSON_ArrayForEach(a_element, a)
-            {
-                /* TODO This has O(n^2) runtime, which is horrible! */
-                b_element = get_object_item(b, a_element->string, case_sensitive);
-                if (b_element == NULL)
-                {
-                    return false;
-                }
+            goto cleanup; /* too deep to compare */
+        }
+        switch (compare_values(a, b))
+        {
+            case COMPARE_EQUAL:
+                break;
 
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
+            case COMPARE_CHILDREN:
+                grown = grow_stack(frames, &capacity, count + 1, sizeof(compare_frame), inline_frames);
+                if (grown == NULL)
                 {
-                    return false;
+                    goto cleanup;
                 }
-            }
-
-            /* doing this twice, once on a and b to prevent true comparison if a subset of b
-             * TODO: Do this the proper way, this is just a fix for now */
-            cJSON_ArrayForEach(b_element, b)
-            {
-                a_element = get_object_item(a, b_element->string, case_sensitive);
-                if (a_element == NULL)
+                frames = (compare_frame*)grown;
+                frame = &frames[count];
+                memset(frame, '\0', sizeof(compare_frame));
+                frame->a = a;
+                frame->b = b;
+                frame->a_next = a->child;
+                frame->b_next = b->child;
+                count++;
+                if (((a->type & 0xFF) == cJSON_Object) && !start_compare_objects(frame, case_sensitive))
                 {
-                    return false;
+                    goto cleanup;
                 }
+                break;
 
-                if (!cJSON_Compare(b_element, a_element, case_sensitive))
-                {
-                    return false;
-                }
-            }
+            default:
+                goto cleanup;
+        }
 
-            return true;
+        /* continue with the next pair of children, the arrays and objects without one are equal */
+        for (;;)
+        {
+            if (count == 0)
+            {
+                equal = true;
+                goto cleanup;
+            }
+            frame = &frames[count - 1];
+            if (!next_compare_pair(frame, case_sensitive, &a, &b))
+            {
+                goto cleanup;
+            }
+            if (a != NULL)
+            {
+                break;
+            }
+            if (frame->slots != NULL)
+            {
+                global_hooks.deallocate(frame->slots);
+            }
+            count--;
         }
+    }
 
-        default:
-            return false;
+cleanup:
+    while (count > 0)
+    {
+        count--;
+        if (frames[count].slots != NULL)
+        {
+            global_hooks.deallocate(frames[count].slots);
+        }
+    }
+    if (frames != inline_frames)
+    {
+        global_hooks.deallocate(frames);
     }
+
+    return equal;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+{
+    return compare_items(a, b, case_sensitive);
 }
 
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size)
@@ -98,6 +98,9 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+#define cJSON_IsDeferred 1024
+#define cJSON_IsShared 2048
+#define cJSON_IsPacked 4096
 
 /* The cJSON structure: */
 typedef struct cJSON
@@ -131,12 +134,55 @@ typedef struct cJSON_Hooks
 
 typedef int cJSON_bool;
 
-/* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them.
- * This is to prevent stack overflows. */
+/* Allocation statistics, see cJSON_StartStats */
+typedef struct cJSON_Stats
+{
+    size_t allocations; /* calls to malloc/realloc that succeeded */
+    size_t deallocations;
+    size_t allocated_bytes; /* total of all allocations */
+    size_t live_bytes; /* allocated since counting started and not freed yet */
+    size_t peak_live_bytes;
+    size_t buffer_reallocations; /* how often a print buffer had to grow */
+    size_t nodes_created;
+} cJSON_Stats;
+
+/* Counters of the item cache of the current thread, see cJSON_EnableCache */
+typedef struct cJSON_CacheStats
+{
+    size_t node_hits; /* nodes taken from the cache */
+    size_t node_misses; /* nodes that had to be allocated while the cache was on */
+    size_t string_hits;
+    size_t string_misses;
+    size_t cached_nodes; /* currently kept */
+    size_t cached_strings;
+} cJSON_CacheStats;
+
+/* Structural hash, see cJSON_Hash. Four 32 bit words, stored in unsigned long for C89. */
+typedef struct cJSON_HashValue
+{
+    unsigned long words[4];
+} cJSON_HashValue;
+
+/* Parse or print many documents without setting up everything again, see cJSON_Parser_Create. Opaque. */
+typedef struct cJSON_Parser cJSON_Parser;
+typedef struct cJSON_Printer cJSON_Printer;
+
+/* A table of object keys that parsed trees share, see cJSON_KeyPool_Create. Opaque. */
+typedef struct cJSON_KeyPool cJSON_KeyPool;
+
+/* Limits how deeply nested arrays/objects can be before cJSON rejects to parse them, unless the max_depth
+ * parse option says otherwise. Parsing doesn't use the C stack for nesting, this only bounds the memory it takes. */
 #ifndef CJSON_NESTING_LIMIT
 #define CJSON_NESTING_LIMIT 1000
 #endif
 
+/* If cJSON is built with CJSON_INLINE_STRINGS set to 1, string values shorter than sizeof(double) are stored in
+ * the valuedouble of their item instead of a separate allocation. valuestring points there, so it must only be
+ * changed through cJSON_SetValuestring and never be freed, reallocated or kept after cJSON_Delete. */
+#ifndef CJSON_INLINE_STRINGS
+#define CJSON_INLINE_STRINGS 0
+#endif
+
 /* Limits the length of circular references can be before cJSON rejects to parse them.
  * This is to prevent stack overflows. */
 #ifndef CJSON_CIRCULAR_LIMIT
@@ -148,6 +194,20 @@ CJSON_PUBLIC(const char*) cJSON_Version(void);
 
 /* Supply malloc, realloc and free functions to cJSON */
 CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks);
+/* Count the allocations made by cJSON in the calling thread (per process if the compiler has no
+ * thread local storage) into stats, which is reset first and updated until cJSON_StopStats.
+ * Counting functions are put in front of the allocator while any thread counts. They are installed when the first thread
+ * starts counting and removed when the last one stops, which must not happen while other threads use cJSON. */
+CJSON_PUBLIC(void) cJSON_StartStats(cJSON_Stats *stats);
+CJSON_PUBLIC(void) cJSON_StopStats(void);
+/* Keep up to max_nodes deleted items and up to max_strings strings of every length below 64 in a cache of the
+ * current thread, and use them for new items instead of allocating. cJSON_InitHooks empties the cache of the
+ * calling thread. Returns false if memory ran out. */
+CJSON_PUBLIC(cJSON_bool) cJSON_EnableCache(size_t max_nodes, size_t max_strings);
+/* Free everything that is cached and stop caching. Has to be called before a thread that used the cache exits. */
+CJSON_PUBLIC(void) cJSON_DisableCache(void);
+/* Counters since cJSON_EnableCache. */
+CJSON_PUBLIC(void) cJSON_GetCacheStats(cJSON_CacheStats *stats);
 
 /* Memory Management: the caller is always responsible to free the results from all variants of cJSON_Parse (with cJSON_Delete) and cJSON_Print (with stdlib free, cJSON_Hooks.free_fn, or cJSON_free as appropriate). The exception is cJSON_PrintPreallocated, where the caller has full responsibility of the buffer. */
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. */
@@ -158,6 +218,95 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
 
+/* Options for cJSON_ParseWithOptions. A zero initialised structure behaves like cJSON_ParseWithLengthOpts. */
+typedef struct cJSON_ParseOptions
+{
+    /* fail if anything other than whitespace follows the parsed value */
+    cJSON_bool require_null_terminated;
+    /* Arrays and objects nested this deep or deeper (the root is at depth 0) are not parsed up front.
+     * They are kept as cJSON_Raw items flagged with cJSON_IsDeferred that hold their source text and
+     * are expanded on first access through cJSON_GetArrayItem/cJSON_GetObjectItem or cJSON_Expand.
+     * Their text is checked like by cJSON_Validate (strict RFC 8259) when it is skipped.
+     * cJSON_IsArray/cJSON_IsObject report them by their text and cJSON_IsRaw doesn't. Printing doesn't
+     * expand them, their text is minified or formatted like the rest of the output. 0 parses everything. */
+    size_t defer_depth;
+    /* Record the input range of every value in a table next to the tree (the input is copied and the
+     * table is freed with the root). cJSON_PrintUnformatted then copies values that weren't changed
+     * through the cJSON API from the input without its whitespace instead of printing them again. */
+    cJSON_bool track_source;
+    /* Store arrays that only contain numbers packed (see cJSON_CreatePackedArray). Ignored with track_source. */
+    cJSON_bool pack_numbers;
+    /* Fail on arrays and objects nested deeper than this, 0 for CJSON_NESTING_LIMIT. Every level takes about
+     * 40 bytes of heap while it is parsed, so this can be much larger than the default. */
+    size_t max_depth;
+    /* Object keys are interned in this pool instead of being copied for every member. The members get
+     * the pooled copy flagged with cJSON_StringIsConst, so equal keys are the same pointer. */
+    cJSON_KeyPool *key_pool;
+    /* Record the parent of every parsed item while the tree is built, like cJSON_TrackParents on the result. */
+    cJSON_bool track_parents;
+} cJSON_ParseOptions;
+/* options may be NULL */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithOptions(const char *value, size_t buffer_length, const cJSON_ParseOptions *options, const char **return_parse_end);
+/* A parser for many documents with the same options (copied, may be NULL). It keeps the nodes of the trees that are
+ * handed back with cJSON_Parser_Release and reuses them for the next documents, as well as its scratch space.
+ * Trees of a parser may also be deleted with cJSON_Delete and released trees don't have to come from a parser.
+ * A parser must not be used by two threads at the same time. */
+CJSON_PUBLIC(cJSON_Parser *) cJSON_Parser_Create(const cJSON_ParseOptions *options);
+CJSON_PUBLIC(cJSON *) cJSON_Parser_Parse(cJSON_Parser *parser, const char *value, size_t buffer_length, const char **return_parse_end);
+/* Delete item like cJSON_Delete, but keep its nodes for the next documents of parser. */
+CJSON_PUBLIC(void) cJSON_Parser_Release(cJSON_Parser *parser, cJSON *item);
+/* Frees the kept nodes as well. */
+CJSON_PUBLIC(void) cJSON_Parser_Delete(cJSON_Parser *parser);
+/* A pool for the key_pool parse option. Keys are only freed with the pool, so it must outlive every tree
+ * (and copy of one) that uses them. A pool must not be used by two threads at the same time. */
+CJSON_PUBLIC(cJSON_KeyPool *) cJSON_KeyPool_Create(void);
+/* The pooled copy of key, it is added if it isn't there yet. Looking a member up with it compares pointers first. */
+CJSON_PUBLIC(const char *) cJSON_KeyPool_Intern(cJSON_KeyPool *pool, const char *key);
+/* The number of distinct keys in pool. */
+CJSON_PUBLIC(size_t) cJSON_KeyPool_GetCount(const cJSON_KeyPool *pool);
+CJSON_PUBLIC(void) cJSON_KeyPool_Delete(cJSON_KeyPool *pool);
+/* Turn a deferred item into a real array or object in place. Nested containers stay deferred.
+ * Items flagged with cJSON_IsShared get their own children (see cJSON_DuplicateShared), packed arrays get one
+ * item per number (see cJSON_CreatePackedArray).
+ * Returns true if the item is not (or no longer) deferred, false if its text couldn't be parsed or memory ran out.
+ * The getters do the same in place although they take a const item, so trees that several threads read at once
+ * have to be expanded before. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Expand(cJSON *item);
+/* Parse the whole content of a deferred item into a new tree without changing the item, NULL if item isn't deferred.
+ * Arrays and objects may be nested max_depth levels deep, 0 for the limit the tree was parsed with. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseDeferred(const cJSON *item, size_t max_depth);
+/* Get the byte range [start, end) an item was parsed from, if it was parsed with track_source. */
+CJSON_PUBLIC(cJSON_bool) cJSON_GetSourceRange(const cJSON *item, size_t *start, size_t *end);
+/* Tell cJSON that an item of a tracked document (or with cached hashes) was changed directly by writing to its members.
+ * The setter functions and macros (cJSON_SetNumberValue, cJSON_SetIntValue, cJSON_SetBoolValue, ...) do this themselves. */
+CJSON_PUBLIC(void) cJSON_MarkDirty(const cJSON *item);
+/* Keep parent links for item and everything below it in a table next to the tree. Items that are later
+ * added, inserted or replaced below a tracked container are tracked too, detached items become roots.
+ * Links are dropped when items are deleted. Returns false if the table couldn't be allocated.
+ * Parsing with the track_parents option records the links of the parsed tree right away.
+ * The table (also used for cached hashes and track_source) is kept per thread, so only the thread that tracked
+ * a tree sees its links and may change or delete it. */
+CJSON_PUBLIC(cJSON_bool) cJSON_TrackParents(cJSON *item);
+/* The array or object item is part of, NULL for roots and items that aren't tracked. */
+CJSON_PUBLIC(cJSON *) cJSON_GetParent(const cJSON *item);
+/* 128 bit structural hash: equal values hash equal, independent of the order of object members.
+ * Numbers hash by their exact value and keys case sensitively. Deferred items are expanded.
+ * Returns all zeros for NULL and for trees nested CJSON_CIRCULAR_LIMIT levels deep or deeper. */
+CJSON_PUBLIC(cJSON_HashValue) cJSON_Hash(const cJSON *item);
+/* Hash item and everything below it and keep the hashes in a table next to the tree. Changes made through
+ * the cJSON API (or reported with cJSON_MarkDirty) drop the cached hashes of the changed item and everything
+ * above it, they are recomputed by the next cJSON_Hash. cJSON_Compare and the diff functions of cJSON_Utils
+ * treat subtrees with equal cached hashes as equal without looking at them. Returns false if the table couldn't
+ * be allocated or the tree is nested too deep to hash (see cJSON_Hash). */
+CJSON_PUBLIC(cJSON_bool) cJSON_CacheHashes(const cJSON *item);
+/* Returns false if item has no valid cached hash. */
+CJSON_PUBLIC(cJSON_bool) cJSON_GetCachedHash(const cJSON *item, cJSON_HashValue *hash);
+/* Check that a buffer holds exactly one well formed JSON value (RFC 8259) without allocating anything.
+ * Only whitespace or a zero terminator may follow the value. This is stricter than cJSON_Parse:
+ * strings have to be valid UTF-8 and numbers have to follow the JSON grammar.
+ * If error_at is supplied, it is set to NULL on success or to the offending position otherwise. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Validate(const char *value, size_t buffer_length, const char **error_at);
+
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. */
@@ -167,11 +316,30 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* A printer keeps its output buffer for the next documents. cJSON_Printer_Print returns the text of item in that
+ * buffer, valid until the next print or cJSON_Printer_Delete, and stores its length (may be NULL). */
+CJSON_PUBLIC(cJSON_Printer *) cJSON_Printer_Create(cJSON_bool format);
+CJSON_PUBLIC(const char *) cJSON_Printer_Print(cJSON_Printer *printer, const cJSON *item, size_t *length);
+CJSON_PUBLIC(void) cJSON_Printer_Delete(cJSON_Printer *printer);
+/* Render in the canonical form of RFC 8785 (JCS): members sorted by the UTF-16 code units of their keys,
+ * numbers formatted like ECMAScript does and no whitespace. The tree isn't modified. Fails for duplicate keys,
+ * invalid UTF-8, NaN, Infinity, raw items and trees nested CJSON_CIRCULAR_LIMIT levels deep or deeper. */
+CJSON_PUBLIC(char *) cJSON_PrintCanonical(const cJSON *item);
+/* Same output, handed to write in chunks instead of being collected in a string (e.g. to feed a hash). */
+CJSON_PUBLIC(cJSON_bool) cJSON_PrintCanonicalToCallback(const cJSON *item, cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length), void *context);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
 
 /* Returns the number of items in an array (or object). */
 CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array);
+/* Returns the numbers of a packed array and stores their count in count (may be NULL), NULL for anything else. */
+CJSON_PUBLIC(const double *) cJSON_GetDoubleArray(const cJSON *array, int *count);
+/* Stores number "index" of an array in number. Packed arrays are read directly without creating items.
+ * Returns false if there is no such item or it isn't a number. */
+CJSON_PUBLIC(cJSON_bool) cJSON_GetPackedNumber(const cJSON *array, int index, double *number);
+/* Returns the first item of an array or object, deferred items and packed arrays are expanded first
+ * (a packed array allocates one item per number). */
+CJSON_PUBLIC(cJSON *) cJSON_GetFirstChild(const cJSON *item);
 /* Retrieve item number "index" from array "array". Returns NULL if unsuccessful. */
 CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index);
 /* Get item "string" from object. Case insensitive. */
@@ -223,6 +391,14 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateIntArray(const int *numbers, int count);
 CJSON_PUBLIC(cJSON *) cJSON_CreateFloatArray(const float *numbers, int count);
 CJSON_PUBLIC(cJSON *) cJSON_CreateDoubleArray(const double *numbers, int count);
 CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int count);
+/* Create an array that keeps its numbers in one buffer instead of one item per number, flagged with cJSON_IsPacked.
+ * Printing (also canonical, MessagePack, CBOR and snapshots), duplicating, comparing, hashing, cJSON_GetArraySize,
+ * cJSON_GetDoubleArray and cJSON_GetPackedNumber use the buffer directly. Everything that hands out or changes items
+ * (cJSON_GetArrayItem, cJSON_GetFirstChild, cJSON_ArrayForEach, cJSON_AddItemToArray, ...) turns it into a normal
+ * array first, which allocates one item per number. */
+CJSON_PUBLIC(cJSON *) cJSON_CreatePackedArray(const double *numbers, int count);
+/* Pack an array that only contains numbers. Returns false if it contains anything else or memory ran out. */
+CJSON_PUBLIC(cJSON_bool) cJSON_PackArray(cJSON *array);
 
 /* Append item to the specified array/object. */
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item);
@@ -256,8 +432,20 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse);
 /* Duplicate will create a new, identical cJSON item to the one you pass, in new memory that will
  * need to be released. With recurse!=0, it will duplicate any children connected to the item.
  * The item->next and ->prev pointers are always zero on return from Duplicate. */
+/* Copy-on-write duplicate: returns a copy of item in O(1) that shares item's children instead of copying them.
+ * Both item and the copy are flagged with cJSON_IsShared (their valuestring is used for the share count) until they
+ * get their own children, which happens one level at a time when they are changed through the add/insert/detach/
+ * replace functions or with cJSON_Unshare/cJSON_Expand. The getters don't copy anything, the items they return from
+ * a shared item belong to all copies: to change one, call cJSON_Unshare on every item on the path to it first (or
+ * use cJSONUtils_GetPointer, which does that). Changing a deep item therefore only copies the items on the path to
+ * it. Shared items are deleted together with the last item that shares them, in any order. */
+CJSON_PUBLIC(cJSON *) cJSON_DuplicateShared(cJSON *item);
+/* Give item its own copy of its children if they are shared. Only one level is copied, the copies share their
+ * children in turn. Returns false on allocation failure. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Unshare(cJSON *item);
 /* Recursively compare two cJSON items for equality. If either a or b is NULL or invalid, they will be considered unequal.
- * case_sensitive determines if object keys are treated case sensitive (1) or case insensitive (0) */
+ * case_sensitive determines if object keys are treated case sensitive (1) or case insensitive (0).
+ * Trees nested CJSON_CIRCULAR_LIMIT levels deep or deeper are considered unequal unless a and b are the same item. */
 CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive);
 
 /* Minify a strings, remove blank characters(such as ' ', '\t', '\r', '\n') from strings.
@@ -278,22 +466,20 @@ CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char *
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name);
 
 /* When assigning an integer value, it needs to be propagated to valuedouble too. */
-#define cJSON_SetIntValue(object, number) ((object) ? (object)->valueint = (object)->valuedouble = (number) : (number))
+#define cJSON_SetIntValue(object, number) ((object) ? (int)cJSON_SetNumberHelper(object, (double)(number)) : (number))
 /* helper for the cJSON_SetNumberValue macro */
 CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number);
 #define cJSON_SetNumberValue(object, number) ((object != NULL) ? cJSON_SetNumberHelper(object, (double)number) : (number))
 /* Change the valuestring of a cJSON_String object, only takes effect when type of object is cJSON_String */
 CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring);
 
+/* helper for the cJSON_SetBoolValue macro */
+CJSON_PUBLIC(int) cJSON_SetBoolHelper(cJSON *object, cJSON_bool boolValue);
 /* If the object is not a boolean type this does nothing and returns cJSON_Invalid else it returns the new type*/
-#define cJSON_SetBoolValue(object, boolValue) ( \
-    (object != NULL && ((object)->type & (cJSON_False|cJSON_True))) ? \
-    (object)->type=((object)->type &(~(cJSON_False|cJSON_True)))|((boolValue)?cJSON_True:cJSON_False) : \
-    cJSON_Invalid\
-)
-
-/* Macro for iterating over an array or object */
-#define cJSON_ArrayForEach(element, array) for(element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+#define cJSON_SetBoolValue(object, boolValue) ((object != NULL) ? cJSON_SetBoolHelper(object, (boolValue) ? 1 : 0) : cJSON_Invalid)
+
+/* Macro for iterating over an array or object, deferred items and packed arrays are expanded first (see cJSON_GetFirstChild) */
+#define cJSON_ArrayForEach(element, array) for(element = cJSON_GetFirstChild(array); element != NULL; element = element->next)
 
 /* malloc/free objects using the malloc/free functions that have been set with cJSON_InitHooks */
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size);
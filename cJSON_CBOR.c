@@ -0,0 +1,1045 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+#if defined(_MSC_VER)
+#pragma warning (push)
+/* disable warning about single line comments in system headers */
+#pragma warning (disable : 4001)
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <float.h>
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+
+#include "cJSON_CBOR.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+/* define isnan and isinf for ANSI C, if in C99 or above, isnan and isinf has been defined in math.h */
+#ifndef isinf
+#define isinf(d) (isnan((d - d)) && !isnan(d))
+#endif
+#ifndef isnan
+#define isnan(d) (d != d)
+#endif
+
+/* CBOR (RFC 8949) with deterministic encoding: preferred (shortest) integer, length and float encodings,
+ * definite lengths only and map keys sorted by their encoded bytes. Both directions use an explicit stack
+ * instead of recursion, it is limited to CJSON_NESTING_LIMIT. */
+
+/* major types, in the upper three bits of the initial byte */
+#define CBOR_UNSIGNED_INTEGER 0x00
+#define CBOR_NEGATIVE_INTEGER 0x20
+#define CBOR_BYTE_STRING 0x40
+#define CBOR_TEXT_STRING 0x60
+#define CBOR_ARRAY 0x80
+#define CBOR_MAP 0xA0
+#define CBOR_TAG 0xC0
+#define CBOR_SIMPLE 0xE0
+/* cJSON_Raw items are written as a byte string with this tag (embedded JSON) */
+#define CBOR_EMBEDDED_JSON 262
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+} cbor_output;
+
+typedef struct
+{
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+} cbor_input;
+
+/* Make room for needed more bytes at the offset, returns where they go. */
+static unsigned char *ensure_cbor(cbor_output * const output, const size_t needed)
+{
+    unsigned char *new_buffer = NULL;
+    size_t new_length = 0;
+
+    if (needed > (((size_t)-1) / 2) - output->offset)
+    {
+        return NULL;
+    }
+    if ((output->offset + needed) <= output->length)
+    {
+        return output->buffer + output->offset;
+    }
+
+    new_length = (output->offset + needed) * 2;
+    new_buffer = (unsigned char*)cJSON_malloc(new_length);
+    if (new_buffer == NULL)
+    {
+        return NULL;
+    }
+    memcpy(new_buffer, output->buffer, output->offset);
+    cJSON_free(output->buffer);
+    output->buffer = new_buffer;
+    output->length = new_length;
+
+    return output->buffer + output->offset;
+}
+
+/* Returns the stack with room for at least 'needed' elements of 'size' bytes, NULL if out of memory
+ * (the old stack is kept in that case). */
+static void *grow_stack(void * const stack, size_t * const capacity, const size_t needed, const size_t size)
+{
+    void *grown = NULL;
+    size_t new_capacity = (*capacity > 0) ? *capacity : 16;
+
+    if (needed <= *capacity)
+    {
+        return stack;
+    }
+
+    while (new_capacity < needed)
+    {
+        new_capacity *= 2;
+    }
+    if (new_capacity > (((size_t)-1) / size))
+    {
+        return NULL; /* overflow */
+    }
+
+    grown = cJSON_malloc(new_capacity * size);
+    if (grown == NULL)
+    {
+        return NULL;
+    }
+    if (stack != NULL)
+    {
+        memcpy(grown, stack, *capacity * size);
+        cJSON_free(stack);
+    }
+    *capacity = new_capacity;
+
+    return grown;
+}
+
+/* Copy a value to or from big endian byte order, this assumes IEEE 754 floating point numbers. */
+static void copy_big_endian(unsigned char * const output, const unsigned char * const input, const size_t size)
+{
+    const unsigned int one = 1;
+    size_t index = 0;
+
+    if (*(const unsigned char*)&one == 0)
+    {
+        memcpy(output, input, size);
+        return;
+    }
+
+    for (index = 0; index < size; index++)
+    {
+        output[index] = input[size - 1 - index];
+    }
+}
+
+/* write an initial byte followed by the 'size' lowest bytes of value */
+static cJSON_bool write_cbor_header(cbor_output * const output, const unsigned char initial, const unsigned long value, const size_t size)
+{
+    unsigned char *buffer = ensure_cbor(output, size + 1);
+    size_t index = 0;
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    buffer[0] = initial;
+    for (index = 1; index <= size; index++)
+    {
+        buffer[index] = (unsigned char)((value >> (8 * (size - index))) & 0xFF);
+    }
+    output->offset += size + 1;
+
+    return true;
+}
+
+static cJSON_bool write_cbor_bytes(cbor_output * const output, const unsigned char * const bytes, const size_t length)
+{
+    unsigned char *buffer = ensure_cbor(output, length);
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    memcpy(buffer, bytes, length);
+    output->offset += length;
+
+    return true;
+}
+
+/* 64 bit arguments are written as two 32 bit halves, so they don't need a 64 bit type */
+static cJSON_bool write_cbor_int64(cbor_output * const output, const unsigned char initial, const unsigned long high, const unsigned long low)
+{
+    unsigned char bytes[4];
+
+    bytes[0] = (unsigned char)((low >> 24) & 0xFF);
+    bytes[1] = (unsigned char)((low >> 16) & 0xFF);
+    bytes[2] = (unsigned char)((low >> 8) & 0xFF);
+    bytes[3] = (unsigned char)(low & 0xFF);
+
+    return write_cbor_header(output, initial, high, 4) && write_cbor_bytes(output, bytes, sizeof(bytes));
+}
+
+/* read a big endian unsigned integer of 'size' (at most 4) bytes */
+static cJSON_bool read_cbor_uint(cbor_input * const input, const size_t size, unsigned long * const value)
+{
+    size_t index = 0;
+
+    if ((input->length - input->offset) < size)
+    {
+        return false;
+    }
+
+    *value = 0;
+    for (index = 0; index < size; index++)
+    {
+        *value = (*value << 8) | input->content[input->offset + index];
+    }
+    input->offset += size;
+
+    return true;
+}
+
+/* Returns a zero terminated copy of the next 'length' bytes. */
+static char *read_cbor_text(cbor_input * const input, const size_t length)
+{
+    const unsigned char * const start = input->content + input->offset;
+    char *text = NULL;
+
+    if ((input->length - input->offset) < length)
+    {
+        return NULL;
+    }
+    if (memchr(start, '\0', length) != NULL)
+    {
+        /* cJSON strings can't contain zero bytes */
+        return NULL;
+    }
+
+    text = (char*)cJSON_malloc(length + sizeof(""));
+    if (text == NULL)
+    {
+        return NULL; /* allocation failure */
+    }
+    memcpy(text, start, length);
+    text[length] = '\0';
+    input->offset += length;
+
+    return text;
+}
+
+static void set_cbor_number(cJSON * const item, const double number)
+{
+    item->type = cJSON_Number;
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    if (number >= INT_MAX)
+    {
+        item->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        item->valueint = INT_MIN;
+    }
+    else
+    {
+        item->valueint = (int)number;
+    }
+}
+
+/* 'size' is 4 or 8 */
+static cJSON_bool read_cbor_float(cJSON * const item, cbor_input * const input, const size_t size)
+{
+    float single = 0;
+    double number = 0;
+
+    if ((input->length - input->offset) < size)
+    {
+        return false;
+    }
+
+    if (size == sizeof(single))
+    {
+        copy_big_endian((unsigned char*)&single, input->content + input->offset, sizeof(single));
+        number = (double)single;
+    }
+    else
+    {
+        copy_big_endian((unsigned char*)&number, input->content + input->offset, sizeof(number));
+    }
+    input->offset += size;
+    set_cbor_number(item, number);
+
+    return true;
+}
+
+/* initial byte and the argument in the shortest form, values above 32 bit are passed as two halves */
+static cJSON_bool write_cbor_head(cbor_output * const output, const unsigned char major, const unsigned long high, const unsigned long low)
+{
+    if (high != 0)
+    {
+        return write_cbor_int64(output, (unsigned char)(major | 27), high, low);
+    }
+    if (low < 24)
+    {
+        return write_cbor_header(output, (unsigned char)(major | low), 0, 0);
+    }
+    if (low < 256)
+    {
+        return write_cbor_header(output, (unsigned char)(major | 24), low, 1);
+    }
+    if (low < 65536)
+    {
+        return write_cbor_header(output, (unsigned char)(major | 25), low, 2);
+    }
+
+    return write_cbor_header(output, (unsigned char)(major | 26), low, 4);
+}
+
+static cJSON_bool write_cbor_length(cbor_output * const output, const unsigned char major, const size_t length)
+{
+    return write_cbor_head(output, major, (unsigned long)((length >> 16) >> 16), (unsigned long)(length & 0xFFFFFFFFUL));
+}
+
+static cJSON_bool write_cbor_string(cbor_output * const output, const unsigned char major, const char * const string)
+{
+    const size_t length = strlen(string);
+
+    return write_cbor_length(output, major, length) && write_cbor_bytes(output, (const unsigned char*)string, length);
+}
+
+/* Stores the bits of a float 16 in half if it holds number exactly. */
+static cJSON_bool cbor_half(const double number, unsigned long * const half)
+{
+    const double zero = 0;
+    const double magnitude = fabs(number);
+    double mantissa = 0;
+    int exponent = 0;
+
+    if (isnan(number))
+    {
+        *half = 0x7E00;
+        return true;
+    }
+
+    *half = ((number < 0) || ((number == 0) && (memcmp(&number, &zero, sizeof(number)) != 0))) ? 0x8000UL : 0;
+    if (isinf(number))
+    {
+        *half |= 0x7C00;
+        return true;
+    }
+
+    if (magnitude < ldexp(1, -14))
+    {
+        /* subnormal, in steps of 2^-24 */
+        mantissa = ldexp(magnitude, 24);
+        if (mantissa != floor(mantissa))
+        {
+            return false;
+        }
+        *half |= (unsigned long)mantissa;
+        return true;
+    }
+
+    /* magnitude = mantissa * 2^exponent with 0.5 <= mantissa < 1 */
+    mantissa = frexp(magnitude, &exponent);
+    mantissa = ldexp(mantissa, 11);
+    if ((exponent > 16) || (mantissa != floor(mantissa)))
+    {
+        return false;
+    }
+    *half |= ((unsigned long)(exponent + 14) << 10) | ((unsigned long)mantissa - 1024);
+
+    return true;
+}
+
+/* integral numbers are written as integers, the others as the shortest float that holds them exactly */
+static cJSON_bool write_cbor_number(cbor_output * const output, const double number)
+{
+    const double zero = 0;
+    unsigned char bytes[sizeof(double)];
+    unsigned long half = 0;
+
+    if ((number == floor(number)) && (number > -18446744073709551616.0) && (number < 18446744073709551616.0)
+        && ((number != 0) || (memcmp(&number, &zero, sizeof(number)) == 0)))
+    {
+        const double magnitude = fabs(number);
+        unsigned long high = (unsigned long)floor(magnitude / 4294967296.0);
+        unsigned long low = (unsigned long)fmod(magnitude, 4294967296.0);
+
+        if (number >= 0)
+        {
+            return write_cbor_head(output, CBOR_UNSIGNED_INTEGER, high, low);
+        }
+
+        /* negative integers are stored as -1 - number */
+        if (low == 0)
+        {
+            high--;
+            low = 0xFFFFFFFFUL;
+        }
+        else
+        {
+            low--;
+        }
+        return write_cbor_head(output, CBOR_NEGATIVE_INTEGER, high, low);
+    }
+
+    if (cbor_half(number, &half))
+    {
+        return write_cbor_header(output, CBOR_SIMPLE | 25, half, 2);
+    }
+
+    if ((fabs(number) <= (double)FLT_MAX) && ((double)(float)number == number))
+    {
+        const float single = (float)number;
+        copy_big_endian(bytes, (const unsigned char*)&single, sizeof(single));
+        return write_cbor_header(output, CBOR_SIMPLE | 26, 0, 0) && write_cbor_bytes(output, bytes, sizeof(single));
+    }
+
+    copy_big_endian(bytes, (const unsigned char*)&number, sizeof(number));
+    return write_cbor_header(output, CBOR_SIMPLE | 27, 0, 0) && write_cbor_bytes(output, bytes, sizeof(number));
+}
+
+/* keys in the order of their encoding: shorter ones first, then bytewise */
+static int compare_cbor_keys(const unsigned char *a, const unsigned char *b)
+{
+    const size_t a_length = strlen((const char*)a);
+    const size_t b_length = strlen((const char*)b);
+
+    if (a_length != b_length)
+    {
+        return (a_length < b_length) ? -1 : 1;
+    }
+
+    return memcmp(a, b, a_length);
+}
+
+/* stable merge sort of the members by their keys, equal keys make it fail */
+static cJSON_bool sort_members(const cJSON **members, const cJSON **buffer, const size_t count)
+{
+    size_t middle = count / 2;
+    size_t left = 0;
+    size_t right = middle;
+    size_t output = 0;
+
+    if (count < 2)
+    {
+        return true;
+    }
+    if (!sort_members(members, buffer, middle) || !sort_members(members + middle, buffer, count - middle))
+    {
+        return false;
+    }
+
+    while ((left < middle) && (right < count))
+    {
+        int difference = compare_cbor_keys((const unsigned char*)members[left]->string, (const unsigned char*)members[right]->string);
+        if (difference == 0)
+        {
+            /* duplicate keys have no deterministic encoding */
+            return false;
+        }
+        buffer[output++] = (difference < 0) ? members[left++] : members[right++];
+    }
+    while (left < middle)
+    {
+        buffer[output++] = members[left++];
+    }
+    while (right < count)
+    {
+        buffer[output++] = members[right++];
+    }
+    memcpy((void*)members, (const void*)buffer, count * sizeof(const cJSON*));
+
+    return true;
+}
+
+typedef struct
+{
+    const cJSON *next; /* next element of an array */
+    size_t start; /* members of an object in the member stack */
+    size_t member;
+    size_t end;
+} cbor_writer_frame;
+
+static cJSON_bool write_cbor(const cJSON * const root, cbor_output * const output, const size_t base_depth)
+{
+    cbor_writer_frame *frames = NULL;
+    size_t frame_capacity = 0;
+    size_t depth = 0;
+    const cJSON **members = NULL;
+    size_t member_capacity = 0;
+    size_t member_count = 0;
+    const cJSON *item = root;
+    const cJSON *child = NULL;
+    cbor_writer_frame *frame = NULL;
+    void *grown = NULL;
+    size_t count = 0;
+    cJSON_bool written = false;
+    cJSON_bool success = false;
+
+    for (;;)
+    {
+        switch (item->type & 0xFF)
+        {
+            case cJSON_NULL:
+                written = write_cbor_header(output, CBOR_SIMPLE | 22, 0, 0);
+                break;
+
+            case cJSON_False:
+                written = write_cbor_header(output, CBOR_SIMPLE | 20, 0, 0);
+                break;
+
+            case cJSON_True:
+                written = write_cbor_header(output, CBOR_SIMPLE | 21, 0, 0);
+                break;
+
+            case cJSON_Number:
+                written = write_cbor_number(output, item->valuedouble);
+                break;
+
+            case cJSON_String:
+                written = (item->valuestring != NULL) && write_cbor_string(output, CBOR_TEXT_STRING, item->valuestring);
+                break;
+
+            case cJSON_Raw:
+                if (item->type & cJSON_IsDeferred)
+                {
+                    /* deferred subtrees are written with their content, not as raw text. The item stays
+                     * deferred, its content is parsed into a temporary tree that may only use what is left
+                     * of the nesting limit. */
+                    cJSON *content = ((base_depth + depth) < CJSON_NESTING_LIMIT)
+                        ? cJSON_ParseDeferred(item, CJSON_NESTING_LIMIT - (base_depth + depth)) : NULL;
+                    written = (content != NULL) && write_cbor(content, output, base_depth + depth);
+                    cJSON_Delete(content);
+                    break;
+                }
+                written = (item->valuestring != NULL)
+                    && write_cbor_head(output, CBOR_TAG, 0, CBOR_EMBEDDED_JSON)
+                    && write_cbor_string(output, CBOR_BYTE_STRING, item->valuestring);
+                break;
+
+            case cJSON_Array:
+            case cJSON_Object:
+                if ((base_depth + depth) >= CJSON_NESTING_LIMIT)
+                {
+                    goto cleanup; /* nested too deep */
+                }
+                if (item->type & cJSON_IsPacked)
+                {
+                    int packed_count = 0;
+                    const double *numbers = cJSON_GetDoubleArray(item, &packed_count);
+                    int index = 0;
+                    written = (numbers != NULL) && write_cbor_length(output, CBOR_ARRAY, (size_t)packed_count);
+                    for (index = 0; written && (index < packed_count); index++)
+                    {
+                        written = write_cbor_number(output, numbers[index]);
+                    }
+                    break;
+                }
+                for (count = 0, child = item->child; child != NULL; child = child->next)
+                {
+                    count++;
+                }
+                written = write_cbor_length(output, cJSON_IsArray(item) ? CBOR_ARRAY : CBOR_MAP, count);
+                if (!written || (count == 0))
+                {
+                    break;
+                }
+
+                grown = grow_stack(frames, &frame_capacity, depth + 1, sizeof(cbor_writer_frame));
+                if (grown == NULL)
+                {
+                    goto cleanup;
+                }
+                frames = (cbor_writer_frame*)grown;
+                frame = &frames[depth++];
+                frame->next = NULL;
+                frame->start = frame->member = frame->end = member_count;
+
+                if (cJSON_IsArray(item))
+                {
+                    frame->next = item->child;
+                    break;
+                }
+
+                /* the members are sorted on top of the member stack, with room for the merge */
+                grown = grow_stack((void*)members, &member_capacity, member_count + 2 * count, sizeof(const cJSON*));
+                if (grown == NULL)
+                {
+                    goto cleanup;
+                }
+                members = (const cJSON**)grown;
+                for (count = 0, child = item->child; child != NULL; child = child->next, count++)
+                {
+                    if (child->string == NULL)
+                    {
+                        goto cleanup;
+                    }
+                    members[member_count + count] = child;
+                }
+                /* duplicate keys aren't allowed in deterministic encoding */
+                written = sort_members(members + member_count, members + member_count + count, count);
+                member_count += count;
+                frame->end = member_count;
+                break;
+
+            default:
+                written = false;
+                break;
+        }
+        if (!written)
+        {
+            goto cleanup;
+        }
+
+        /* leave the finished containers and continue with the next value */
+        while ((depth > 0) && (frames[depth - 1].next == NULL) && (frames[depth - 1].member == frames[depth - 1].end))
+        {
+            depth--;
+            member_count = frames[depth].start;
+        }
+        if (depth == 0)
+        {
+            break;
+        }
+
+        frame = &frames[depth - 1];
+        if (frame->next != NULL)
+        {
+            item = frame->next;
+            frame->next = item->next;
+        }
+        else
+        {
+            item = members[frame->member++];
+            if (!write_cbor_string(output, CBOR_TEXT_STRING, item->string))
+            {
+                goto cleanup;
+            }
+        }
+    }
+
+    success = true;
+
+cleanup:
+    if (frames != NULL)
+    {
+        cJSON_free(frames);
+    }
+    if (members != NULL)
+    {
+        cJSON_free((void*)members);
+    }
+
+    return success;
+}
+
+CJSON_PUBLIC(unsigned char *) cJSON_PrintCBOR(const cJSON *item, size_t *length)
+{
+    cbor_output buffer = { 0, 0, 0 };
+
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    buffer.buffer = (unsigned char*)cJSON_malloc(256);
+    if (buffer.buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer.length = 256;
+
+    if (!write_cbor(item, &buffer, 0))
+    {
+        cJSON_free(buffer.buffer);
+        return NULL;
+    }
+
+    if (length != NULL)
+    {
+        *length = buffer.offset;
+    }
+
+    return buffer.buffer;
+}
+
+/* the argument that follows an initial byte with the given additional information */
+static cJSON_bool read_cbor_argument(cbor_input * const input, const unsigned char additional, unsigned long * const high, unsigned long * const low)
+{
+    *high = 0;
+
+    if (additional < 24)
+    {
+        *low = additional;
+        return true;
+    }
+
+    switch (additional)
+    {
+        case 24:
+            return read_cbor_uint(input, 1, low);
+        case 25:
+            return read_cbor_uint(input, 2, low);
+        case 26:
+            return read_cbor_uint(input, 4, low);
+        case 27:
+            return read_cbor_uint(input, 4, high) && read_cbor_uint(input, 4, low);
+        default:
+            return false; /* reserved or indefinite length */
+    }
+}
+
+/* the length of a string or container whose entries take at least 'entry_size' bytes each */
+static cJSON_bool read_cbor_length(cbor_input * const input, const unsigned char additional, const size_t entry_size, size_t * const length)
+{
+    unsigned long high = 0;
+    unsigned long low = 0;
+
+    if (!read_cbor_argument(input, additional, &high, &low) || (high != 0) || (low > ((input->length - input->offset) / entry_size)))
+    {
+        /* longer than the rest of the input */
+        return false;
+    }
+    *length = (size_t)low;
+
+    return true;
+}
+
+static double cbor_half_to_double(const unsigned long half)
+{
+    const unsigned long exponent = (half >> 10) & 0x1F;
+    const unsigned long mantissa = half & 0x3FF;
+    double number = 0;
+
+    if (exponent == 0x1F)
+    {
+        /* infinity or NaN, built from its bits */
+        unsigned char bytes[sizeof(double)];
+        memset(bytes, '\0', sizeof(bytes));
+        bytes[0] = (half & 0x8000) ? 0xFF : 0x7F;
+        bytes[1] = (mantissa != 0) ? 0xF8 : 0xF0;
+        copy_big_endian((unsigned char*)&number, bytes, sizeof(number));
+        return number;
+    }
+
+    if (exponent == 0)
+    {
+        number = ldexp((double)mantissa, -24);
+    }
+    else
+    {
+        number = ldexp((double)(mantissa | 0x400), (int)exponent - 25);
+    }
+
+    return (half & 0x8000) ? -number : number;
+}
+
+/* Reads the value at the current position into item, for arrays and objects only the number of their
+ * entries is read into count. */
+static cJSON_bool read_cbor_value(cJSON * const item, cbor_input * const input, size_t * const count)
+{
+    unsigned char initial = 0;
+    unsigned long high = 0;
+    unsigned long low = 0;
+    size_t length = 0;
+    double number = 0;
+
+    for (;;)
+    {
+        if (input->offset >= input->length)
+        {
+            return false;
+        }
+        initial = input->content[input->offset++];
+        if ((initial & 0xE0) != CBOR_TAG)
+        {
+            break;
+        }
+
+        if (!read_cbor_argument(input, (unsigned char)(initial & 0x1F), &high, &low))
+        {
+            return false;
+        }
+        if ((high == 0) && (low == CBOR_EMBEDDED_JSON))
+        {
+            if ((input->offset >= input->length) || ((input->content[input->offset] & 0xE0) != CBOR_BYTE_STRING))
+            {
+                return false;
+            }
+            initial = input->content[input->offset++];
+            if (!read_cbor_length(input, (unsigned char)(initial & 0x1F), 1, &length))
+            {
+                return false;
+            }
+            item->valuestring = read_cbor_text(input, length);
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            item->type = cJSON_Raw;
+            return true;
+        }
+        /* other tags don't change how the value is represented */
+    }
+
+    switch (initial & 0xE0)
+    {
+        case CBOR_UNSIGNED_INTEGER:
+        case CBOR_NEGATIVE_INTEGER:
+            if (!read_cbor_argument(input, (unsigned char)(initial & 0x1F), &high, &low))
+            {
+                return false;
+            }
+            number = (double)high * 4294967296.0 + (double)low;
+            set_cbor_number(item, ((initial & 0xE0) == CBOR_NEGATIVE_INTEGER) ? (-1 - number) : number);
+            return true;
+
+        case CBOR_TEXT_STRING:
+            if (!read_cbor_length(input, (unsigned char)(initial & 0x1F), 1, &length))
+            {
+                return false;
+            }
+            item->valuestring = read_cbor_text(input, length);
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            item->type = cJSON_String;
+            return true;
+
+        case CBOR_ARRAY:
+            item->type = cJSON_Array;
+            return read_cbor_length(input, (unsigned char)(initial & 0x1F), 1, count);
+
+        case CBOR_MAP:
+            /* every member takes at least two bytes */
+            item->type = cJSON_Object;
+            return read_cbor_length(input, (unsigned char)(initial & 0x1F), 2, count);
+
+        case CBOR_SIMPLE:
+            switch (initial & 0x1F)
+            {
+                case 20:
+                    item->type = cJSON_False;
+                    return true;
+
+                case 21:
+                    item->type = cJSON_True;
+                    item->valueint = 1;
+                    return true;
+
+                case 22:
+                    item->type = cJSON_NULL;
+                    return true;
+
+                case 25:
+                    if (!read_cbor_uint(input, 2, &low))
+                    {
+                        return false;
+                    }
+                    set_cbor_number(item, cbor_half_to_double(low));
+                    return true;
+
+                case 26:
+                    return read_cbor_float(item, input, 4);
+                case 27:
+                    return read_cbor_float(item, input, 8);
+
+                default:
+                    return false; /* undefined, other simple values and break */
+            }
+
+        default:
+            return false; /* byte strings are only supported as embedded JSON */
+    }
+}
+
+typedef struct
+{
+    cJSON *container;
+    size_t remaining;
+} cbor_reader_frame;
+
+static cJSON_bool read_cbor(cJSON * const root, cbor_input * const input)
+{
+    cbor_reader_frame *frames = NULL;
+    size_t frame_capacity = 0;
+    size_t depth = 0;
+    cJSON *item = root;
+    cbor_reader_frame *frame = NULL;
+    void *grown = NULL;
+    size_t count = 0;
+    size_t length = 0;
+    unsigned char initial = 0;
+    cJSON_bool success = false;
+
+    for (;;)
+    {
+        if (!read_cbor_value(item, input, &count))
+        {
+            goto cleanup;
+        }
+
+        if (cJSON_IsArray(item) || cJSON_IsObject(item))
+        {
+            if (depth >= CJSON_NESTING_LIMIT)
+            {
+                goto cleanup; /* to deeply nested */
+            }
+            if (count > 0)
+            {
+                grown = grow_stack(frames, &frame_capacity, depth + 1, sizeof(cbor_reader_frame));
+                if (grown == NULL)
+                {
+                    goto cleanup;
+                }
+                frames = (cbor_reader_frame*)grown;
+                frames[depth].container = item;
+                frames[depth].remaining = count;
+                depth++;
+            }
+        }
+
+        /* leave the finished containers and continue with the next entry */
+        while ((depth > 0) && (frames[depth - 1].remaining == 0))
+        {
+            depth--;
+        }
+        if (depth == 0)
+        {
+            break;
+        }
+        frame = &frames[depth - 1];
+        frame->remaining--;
+
+        item = cJSON_CreateNull();
+        if (item == NULL)
+        {
+            goto cleanup; /* allocation failure */
+        }
+
+        /* add to the end, the tree is complete at all times so it can be deleted on failure */
+        if (frame->container->child == NULL)
+        {
+            frame->container->child = item;
+        }
+        else
+        {
+            frame->container->child->prev->next = item;
+            item->prev = frame->container->child->prev;
+        }
+        frame->container->child->prev = item;
+
+        if (cJSON_IsObject(frame->container))
+        {
+            /* keys have to be text strings */
+            if ((input->offset >= input->length) || ((input->content[input->offset] & 0xE0) != CBOR_TEXT_STRING))
+            {
+                goto cleanup;
+            }
+            initial = input->content[input->offset++];
+            if (!read_cbor_length(input, (unsigned char)(initial & 0x1F), 1, &length))
+            {
+                goto cleanup;
+            }
+            item->string = read_cbor_text(input, length);
+            if (item->string == NULL)
+            {
+                goto cleanup;
+            }
+        }
+    }
+
+    success = true;
+
+cleanup:
+    if (frames != NULL)
+    {
+        cJSON_free(frames);
+    }
+
+    return success;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseCBOR(const unsigned char *data, size_t length)
+{
+    cbor_input buffer = { 0, 0, 0 };
+    cJSON *item = NULL;
+
+    if ((data == NULL) || (length == 0))
+    {
+        return NULL;
+    }
+
+    buffer.content = data;
+    buffer.length = length;
+
+    item = cJSON_CreateNull();
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    /* the whole input has to be one value */
+    if (!read_cbor(item, &buffer) || (buffer.offset != buffer.length))
+    {
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    return item;
+}
+
@@ -0,0 +1,46 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef cJSON_CBOR__h
+#define cJSON_CBOR__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* Convert between cJSON items and CBOR (RFC 8949) with deterministic encoding: integral numbers are written as
+ * integers, other numbers as the shortest float that holds them exactly, object members are sorted by key (shorter
+ * keys first) and duplicate keys make it fail. cJSON_Raw items are written as byte strings with tag 262 (embedded
+ * JSON). The returned buffer has to be freed with cJSON_free, its size is stored in length.
+ * cJSON_ParseCBOR expects exactly one value in data. Indefinite lengths, other byte strings, undefined and other
+ * simple values can't be represented and make it fail, other tags are ignored. */
+CJSON_PUBLIC(unsigned char *) cJSON_PrintCBOR(const cJSON *item, size_t *length);
+CJSON_PUBLIC(cJSON *) cJSON_ParseCBOR(const unsigned char *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
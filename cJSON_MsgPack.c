@@ -0,0 +1,825 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+#if defined(_MSC_VER)
+#pragma warning (push)
+/* disable warning about single line comments in system headers */
+#pragma warning (disable : 4001)
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <float.h>
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+
+#include "cJSON_MsgPack.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+/* MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md) */
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+    size_t depth; /* current nesting depth (for the nesting limit) */
+} msgpack_output;
+
+typedef struct
+{
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+    size_t depth; /* current nesting depth (for the nesting limit) */
+} msgpack_input;
+
+/* Make room for needed more bytes at the offset, returns where they go. */
+static unsigned char *ensure_msgpack(msgpack_output * const output, const size_t needed)
+{
+    unsigned char *new_buffer = NULL;
+    size_t new_length = 0;
+
+    if (needed > (((size_t)-1) / 2) - output->offset)
+    {
+        return NULL;
+    }
+    if ((output->offset + needed) <= output->length)
+    {
+        return output->buffer + output->offset;
+    }
+
+    new_length = (output->offset + needed) * 2;
+    new_buffer = (unsigned char*)cJSON_malloc(new_length);
+    if (new_buffer == NULL)
+    {
+        return NULL;
+    }
+    memcpy(new_buffer, output->buffer, output->offset);
+    cJSON_free(output->buffer);
+    output->buffer = new_buffer;
+    output->length = new_length;
+
+    return output->buffer + output->offset;
+}
+
+/* Copy a value to or from big endian byte order, this assumes IEEE 754 floating point numbers. */
+static void copy_big_endian(unsigned char * const output, const unsigned char * const input, const size_t size)
+{
+    const unsigned int one = 1;
+    size_t index = 0;
+
+    if (*(const unsigned char*)&one == 0)
+    {
+        memcpy(output, input, size);
+        return;
+    }
+
+    for (index = 0; index < size; index++)
+    {
+        output[index] = input[size - 1 - index];
+    }
+}
+
+/* write a type byte followed by the 'size' lowest bytes of value */
+static cJSON_bool write_msgpack_header(msgpack_output * const output, const unsigned char tag, const unsigned long value, const size_t size)
+{
+    unsigned char *buffer = ensure_msgpack(output, size + 1);
+    size_t index = 0;
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    buffer[0] = tag;
+    for (index = 1; index <= size; index++)
+    {
+        buffer[index] = (unsigned char)((value >> (8 * (size - index))) & 0xFF);
+    }
+    output->offset += size + 1;
+
+    return true;
+}
+
+/* the header of a string, array, map or extension: a fixed size form for lengths up to fix_limit (if fix isn't 0),
+ * then 8 (if tag8 isn't 0), 16 and 32 bit lengths */
+static cJSON_bool write_msgpack_length(msgpack_output * const output, const size_t length, const unsigned char fix, const size_t fix_limit, const unsigned char tag8, const unsigned char tag16, const unsigned char tag32)
+{
+    if ((fix != 0) && (length <= fix_limit))
+    {
+        return write_msgpack_header(output, (unsigned char)(fix | length), 0, 0);
+    }
+    if ((tag8 != 0) && (length <= 0xFF))
+    {
+        return write_msgpack_header(output, tag8, (unsigned long)length, 1);
+    }
+    if (length <= 0xFFFF)
+    {
+        return write_msgpack_header(output, tag16, (unsigned long)length, 2);
+    }
+    if (length <= 0xFFFFFFFFUL)
+    {
+        return write_msgpack_header(output, tag32, (unsigned long)length, 4);
+    }
+
+    return false;
+}
+
+static cJSON_bool write_msgpack_bytes(msgpack_output * const output, const unsigned char * const bytes, const size_t length)
+{
+    unsigned char *buffer = ensure_msgpack(output, length);
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    memcpy(buffer, bytes, length);
+    output->offset += length;
+
+    return true;
+}
+
+static cJSON_bool write_msgpack_string(msgpack_output * const output, const char * const string)
+{
+    const size_t length = (string != NULL) ? strlen(string) : 0;
+
+    return write_msgpack_length(output, length, 0xA0, 31, 0xD9, 0xDA, 0xDB)
+        && write_msgpack_bytes(output, (const unsigned char*)string, length);
+}
+
+/* raw JSON is kept as text in an extension type */
+static cJSON_bool write_msgpack_raw(msgpack_output * const output, const char * const raw)
+{
+    const size_t length = strlen(raw);
+    cJSON_bool success = false;
+
+    switch (length)
+    {
+        case 1: success = write_msgpack_header(output, 0xD4, 0, 0); break;
+        case 2: success = write_msgpack_header(output, 0xD5, 0, 0); break;
+        case 4: success = write_msgpack_header(output, 0xD6, 0, 0); break;
+        case 8: success = write_msgpack_header(output, 0xD7, 0, 0); break;
+        case 16: success = write_msgpack_header(output, 0xD8, 0, 0); break;
+        default: success = write_msgpack_length(output, length, 0, 0, 0xC7, 0xC8, 0xC9); break;
+    }
+
+    return success
+        && write_msgpack_header(output, (unsigned char)CJSON_MSGPACK_RAW_EXT, 0, 0)
+        && write_msgpack_bytes(output, (const unsigned char*)raw, length);
+}
+
+/* 64 bit integers are written as two 32 bit halves, so they don't need a 64 bit type */
+static cJSON_bool write_msgpack_int64(msgpack_output * const output, const unsigned char tag, const unsigned long high, const unsigned long low)
+{
+    unsigned char bytes[4];
+
+    bytes[0] = (unsigned char)((low >> 24) & 0xFF);
+    bytes[1] = (unsigned char)((low >> 16) & 0xFF);
+    bytes[2] = (unsigned char)((low >> 8) & 0xFF);
+    bytes[3] = (unsigned char)(low & 0xFF);
+
+    return write_msgpack_header(output, tag, high, 4) && write_msgpack_bytes(output, bytes, sizeof(bytes));
+}
+
+/* integral numbers are written in the smallest integer format, the others as float 32 if that is exact */
+static cJSON_bool write_msgpack_number(msgpack_output * const output, const double number)
+{
+    const double zero = 0;
+    unsigned char bytes[sizeof(double)];
+
+    if ((number == floor(number)) && (number >= -9223372036854775808.0) && (number < 18446744073709551616.0)
+        && ((number != 0) || (memcmp(&number, &zero, sizeof(number)) == 0)))
+    {
+        if (number >= 0)
+        {
+            if (number < 128)
+            {
+                return write_msgpack_header(output, (unsigned char)number, 0, 0);
+            }
+            if (number < 256)
+            {
+                return write_msgpack_header(output, 0xCC, (unsigned long)number, 1);
+            }
+            if (number < 65536)
+            {
+                return write_msgpack_header(output, 0xCD, (unsigned long)number, 2);
+            }
+            if (number < 4294967296.0)
+            {
+                return write_msgpack_header(output, 0xCE, (unsigned long)number, 4);
+            }
+            return write_msgpack_int64(output, 0xCF, (unsigned long)floor(number / 4294967296.0), (unsigned long)fmod(number, 4294967296.0));
+        }
+        if (number >= -32)
+        {
+            return write_msgpack_header(output, (unsigned char)(256 + number), 0, 0);
+        }
+        if (number >= -128)
+        {
+            return write_msgpack_header(output, 0xD0, (unsigned long)(256 + number), 1);
+        }
+        if (number >= -32768)
+        {
+            return write_msgpack_header(output, 0xD1, (unsigned long)(65536 + number), 2);
+        }
+        if (number >= -2147483648.0)
+        {
+            return write_msgpack_header(output, 0xD2, (unsigned long)(4294967296.0 + number), 4);
+        }
+        else
+        {
+            /* two's complement of the magnitude */
+            const unsigned long high = (unsigned long)floor(-number / 4294967296.0);
+            const unsigned long low = (unsigned long)fmod(-number, 4294967296.0);
+            return write_msgpack_int64(output, 0xD3, (~high + ((low == 0) ? 1UL : 0UL)) & 0xFFFFFFFFUL, (~low + 1UL) & 0xFFFFFFFFUL);
+        }
+    }
+
+    if ((fabs(number) <= (double)FLT_MAX) && ((double)(float)number == number))
+    {
+        const float single = (float)number;
+        copy_big_endian(bytes, (const unsigned char*)&single, sizeof(single));
+        return write_msgpack_header(output, 0xCA, 0, 0) && write_msgpack_bytes(output, bytes, sizeof(single));
+    }
+
+    copy_big_endian(bytes, (const unsigned char*)&number, sizeof(number));
+    return write_msgpack_header(output, 0xCB, 0, 0) && write_msgpack_bytes(output, bytes, sizeof(number));
+}
+
+static cJSON_bool write_msgpack_value(const cJSON * const item, msgpack_output * const output)
+{
+    const cJSON *child = NULL;
+    size_t count = 0;
+    cJSON_bool success = true;
+
+    /* deferred subtrees are written with their content, not as raw text. The item stays deferred,
+     * its content is parsed into a temporary tree. */
+    if (item->type & cJSON_IsDeferred)
+    {
+        cJSON *content = NULL;
+        if (output->depth >= CJSON_NESTING_LIMIT)
+        {
+            return false; /* nested too deep */
+        }
+        /* the content may only use what is left of the nesting limit */
+        content = cJSON_ParseDeferred(item, CJSON_NESTING_LIMIT - output->depth);
+        if (content == NULL)
+        {
+            return false;
+        }
+        success = write_msgpack_value(content, output);
+        cJSON_Delete(content);
+        return success;
+    }
+
+    if (item->type & cJSON_IsPacked)
+    {
+        int packed_count = 0;
+        const double *numbers = cJSON_GetDoubleArray(item, &packed_count);
+        int index = 0;
+        success = (numbers != NULL) && write_msgpack_length(output, (size_t)packed_count, 0x90, 15, 0, 0xDC, 0xDD);
+        for (index = 0; success && (index < packed_count); index++)
+        {
+            success = write_msgpack_number(output, numbers[index]);
+        }
+        return success;
+    }
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_NULL:
+            return write_msgpack_header(output, 0xC0, 0, 0);
+
+        case cJSON_False:
+            return write_msgpack_header(output, 0xC2, 0, 0);
+
+        case cJSON_True:
+            return write_msgpack_header(output, 0xC3, 0, 0);
+
+        case cJSON_Number:
+            return write_msgpack_number(output, item->valuedouble);
+
+        case cJSON_String:
+            return write_msgpack_string(output, item->valuestring);
+
+        case cJSON_Raw:
+            return (item->valuestring != NULL) && write_msgpack_raw(output, item->valuestring);
+
+        case cJSON_Array:
+        case cJSON_Object:
+            if (output->depth >= CJSON_NESTING_LIMIT)
+            {
+                return false; /* nested too deep */
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                count++;
+            }
+            if (cJSON_IsArray(item))
+            {
+                success = write_msgpack_length(output, count, 0x90, 15, 0, 0xDC, 0xDD);
+            }
+            else
+            {
+                success = write_msgpack_length(output, count, 0x80, 15, 0, 0xDE, 0xDF);
+            }
+
+            output->depth++;
+            for (child = item->child; success && (child != NULL); child = child->next)
+            {
+                if (cJSON_IsObject(item))
+                {
+                    success = (child->string != NULL) && write_msgpack_string(output, child->string);
+                }
+                success = success && write_msgpack_value(child, output);
+            }
+            output->depth--;
+
+            return success;
+
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(unsigned char *) cJSON_ToMessagePack(const cJSON *item, size_t *length)
+{
+    msgpack_output buffer = { 0, 0, 0, 0 };
+
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    buffer.buffer = (unsigned char*)cJSON_malloc(256);
+    if (buffer.buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer.length = 256;
+
+    if (!write_msgpack_value(item, &buffer))
+    {
+        cJSON_free(buffer.buffer);
+        return NULL;
+    }
+
+    if (length != NULL)
+    {
+        *length = buffer.offset;
+    }
+
+    return buffer.buffer;
+}
+
+/* read a big endian unsigned integer of 'size' (at most 4) bytes */
+static cJSON_bool read_msgpack_uint(msgpack_input * const input, const size_t size, unsigned long * const value)
+{
+    size_t index = 0;
+
+    if ((input->length - input->offset) < size)
+    {
+        return false;
+    }
+
+    *value = 0;
+    for (index = 0; index < size; index++)
+    {
+        *value = (*value << 8) | input->content[input->offset + index];
+    }
+    input->offset += size;
+
+    return true;
+}
+
+static cJSON_bool read_msgpack_length(msgpack_input * const input, const size_t size, size_t * const length)
+{
+    unsigned long value = 0;
+
+    if (!read_msgpack_uint(input, size, &value) || (value > (input->length - input->offset)))
+    {
+        /* longer than the rest of the input */
+        return false;
+    }
+    *length = (size_t)value;
+
+    return true;
+}
+
+/* Returns a zero terminated copy of the next 'length' bytes. */
+static char *read_msgpack_text(msgpack_input * const input, const size_t length)
+{
+    const unsigned char * const start = input->content + input->offset;
+    char *text = NULL;
+
+    if ((input->length - input->offset) < length)
+    {
+        return NULL;
+    }
+    if (memchr(start, '\0', length) != NULL)
+    {
+        /* cJSON strings can't contain zero bytes */
+        return NULL;
+    }
+
+    text = (char*)cJSON_malloc(length + sizeof(""));
+    if (text == NULL)
+    {
+        return NULL; /* allocation failure */
+    }
+    memcpy(text, start, length);
+    text[length] = '\0';
+    input->offset += length;
+
+    return text;
+}
+
+/* the length of a string with the given type byte */
+static cJSON_bool read_msgpack_string_length(msgpack_input * const input, const unsigned char tag, size_t * const length)
+{
+    if ((tag & 0xE0) == 0xA0)
+    {
+        *length = (size_t)(tag & 0x1F);
+        return true;
+    }
+
+    switch (tag)
+    {
+        case 0xD9:
+            return read_msgpack_length(input, 1, length);
+        case 0xDA:
+            return read_msgpack_length(input, 2, length);
+        case 0xDB:
+            return read_msgpack_length(input, 4, length);
+        default:
+            return false;
+    }
+}
+
+static void set_msgpack_number(cJSON * const item, const double number)
+{
+    item->type = cJSON_Number;
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    if (number >= INT_MAX)
+    {
+        item->valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        item->valueint = INT_MIN;
+    }
+    else
+    {
+        item->valueint = (int)number;
+    }
+}
+
+/* 'size' is 4 or 8 */
+static cJSON_bool read_msgpack_float(cJSON * const item, msgpack_input * const input, const size_t size)
+{
+    float single = 0;
+    double number = 0;
+
+    if ((input->length - input->offset) < size)
+    {
+        return false;
+    }
+
+    if (size == sizeof(single))
+    {
+        copy_big_endian((unsigned char*)&single, input->content + input->offset, sizeof(single));
+        number = (double)single;
+    }
+    else
+    {
+        copy_big_endian((unsigned char*)&number, input->content + input->offset, sizeof(number));
+    }
+    input->offset += size;
+    set_msgpack_number(item, number);
+
+    return true;
+}
+
+/* an integer of 'size' bytes, negative numbers are in two's complement */
+static cJSON_bool read_msgpack_integer(cJSON * const item, msgpack_input * const input, const size_t size, const cJSON_bool is_signed)
+{
+    unsigned long high = 0;
+    unsigned long low = 0;
+    double number = 0;
+
+    if (size == 8)
+    {
+        if (!read_msgpack_uint(input, 4, &high) || !read_msgpack_uint(input, 4, &low))
+        {
+            return false;
+        }
+        number = ((is_signed && (high & 0x80000000UL)) ? ((double)high - 4294967296.0) : (double)high) * 4294967296.0 + (double)low;
+    }
+    else
+    {
+        if (!read_msgpack_uint(input, size, &low))
+        {
+            return false;
+        }
+        number = (double)low;
+        if (is_signed && (low >> (8 * size - 1)))
+        {
+            number -= ldexp(1, (int)(8 * size));
+        }
+    }
+    set_msgpack_number(item, number);
+
+    return true;
+}
+
+/* extensions of type CJSON_MSGPACK_RAW_EXT hold raw JSON, other ones aren't supported */
+static cJSON_bool read_msgpack_raw(cJSON * const item, msgpack_input * const input, const size_t length)
+{
+    if ((input->offset >= input->length) || (input->content[input->offset] != (unsigned char)CJSON_MSGPACK_RAW_EXT))
+    {
+        return false;
+    }
+    input->offset++;
+
+    item->valuestring = read_msgpack_text(input, length);
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+    item->type = cJSON_Raw;
+
+    return true;
+}
+
+static cJSON_bool read_msgpack_value(cJSON * const item, msgpack_input * const input);
+
+/* read 'count' elements or members into item */
+static cJSON_bool read_msgpack_container(cJSON * const item, msgpack_input * const input, size_t count, const cJSON_bool is_object)
+{
+    cJSON *head = NULL;
+    cJSON *current_item = NULL;
+
+    if (input->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    /* every element takes at least one byte and every member two */
+    if (count > ((input->length - input->offset) / (is_object ? 2 : 1)))
+    {
+        return false;
+    }
+    input->depth++;
+
+    for (; count > 0; count--)
+    {
+        cJSON *new_item = cJSON_CreateNull();
+        if (new_item == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+
+        /* attach next item to list */
+        if (head == NULL)
+        {
+            /* start the linked list */
+            current_item = head = new_item;
+        }
+        else
+        {
+            /* add to the end and advance */
+            current_item->next = new_item;
+            new_item->prev = current_item;
+            current_item = new_item;
+        }
+
+        if (is_object)
+        {
+            size_t length = 0;
+            if ((input->offset >= input->length) || !read_msgpack_string_length(input, input->content[input->offset++], &length))
+            {
+                goto fail; /* keys have to be strings */
+            }
+            current_item->string = read_msgpack_text(input, length);
+            if (current_item->string == NULL)
+            {
+                goto fail;
+            }
+        }
+
+        if (!read_msgpack_value(current_item, input))
+        {
+            goto fail;
+        }
+    }
+
+    input->depth--;
+
+    if (head != NULL)
+    {
+        head->prev = current_item;
+    }
+
+    item->type = is_object ? cJSON_Object : cJSON_Array;
+    item->child = head;
+
+    return true;
+
+fail:
+    if (head != NULL)
+    {
+        cJSON_Delete(head);
+    }
+
+    return false;
+}
+
+static cJSON_bool read_msgpack_value(cJSON * const item, msgpack_input * const input)
+{
+    unsigned char tag = 0;
+    size_t length = 0;
+
+    if (input->offset >= input->length)
+    {
+        return false;
+    }
+    tag = input->content[input->offset++];
+
+    if (tag <= 0x7F)
+    {
+        /* positive fixint */
+        set_msgpack_number(item, (double)tag);
+        return true;
+    }
+    if (tag >= 0xE0)
+    {
+        /* negative fixint */
+        set_msgpack_number(item, (double)tag - 256);
+        return true;
+    }
+    if (tag <= 0x8F)
+    {
+        return read_msgpack_container(item, input, (size_t)(tag & 0x0F), true);
+    }
+    if (tag <= 0x9F)
+    {
+        return read_msgpack_container(item, input, (size_t)(tag & 0x0F), false);
+    }
+
+    switch (tag)
+    {
+        case 0xC0:
+            item->type = cJSON_NULL;
+            return true;
+
+        case 0xC2:
+            item->type = cJSON_False;
+            return true;
+
+        case 0xC3:
+            item->type = cJSON_True;
+            item->valueint = 1;
+            return true;
+
+        case 0xCA:
+            return read_msgpack_float(item, input, 4);
+        case 0xCB:
+            return read_msgpack_float(item, input, 8);
+
+        case 0xCC:
+            return read_msgpack_integer(item, input, 1, false);
+        case 0xCD:
+            return read_msgpack_integer(item, input, 2, false);
+        case 0xCE:
+            return read_msgpack_integer(item, input, 4, false);
+        case 0xCF:
+            return read_msgpack_integer(item, input, 8, false);
+        case 0xD0:
+            return read_msgpack_integer(item, input, 1, true);
+        case 0xD1:
+            return read_msgpack_integer(item, input, 2, true);
+        case 0xD2:
+            return read_msgpack_integer(item, input, 4, true);
+        case 0xD3:
+            return read_msgpack_integer(item, input, 8, true);
+
+        case 0xD4:
+            return read_msgpack_raw(item, input, 1);
+        case 0xD5:
+            return read_msgpack_raw(item, input, 2);
+        case 0xD6:
+            return read_msgpack_raw(item, input, 4);
+        case 0xD7:
+            return read_msgpack_raw(item, input, 8);
+        case 0xD8:
+            return read_msgpack_raw(item, input, 16);
+        case 0xC7:
+            return read_msgpack_length(input, 1, &length) && read_msgpack_raw(item, input, length);
+        case 0xC8:
+            return read_msgpack_length(input, 2, &length) && read_msgpack_raw(item, input, length);
+        case 0xC9:
+            return read_msgpack_length(input, 4, &length) && read_msgpack_raw(item, input, length);
+
+        case 0xDC:
+            return read_msgpack_length(input, 2, &length) && read_msgpack_container(item, input, length, false);
+        case 0xDD:
+            return read_msgpack_length(input, 4, &length) && read_msgpack_container(item, input, length, false);
+        case 0xDE:
+            return read_msgpack_length(input, 2, &length) && read_msgpack_container(item, input, length, true);
+        case 0xDF:
+            return read_msgpack_length(input, 4, &length) && read_msgpack_container(item, input, length, true);
+
+        default:
+            break;
+    }
+
+    /* strings, binary data and 0xC1 (never used) are left */
+    if (!read_msgpack_string_length(input, tag, &length))
+    {
+        return false;
+    }
+    item->valuestring = read_msgpack_text(input, length);
+    if (item->valuestring == NULL)
+    {
+        return false;
+    }
+    item->type = cJSON_String;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_FromMessagePack(const unsigned char *data, size_t length)
+{
+    msgpack_input buffer = { 0, 0, 0, 0 };
+    cJSON *item = NULL;
+
+    if ((data == NULL) || (length == 0))
+    {
+        return NULL;
+    }
+
+    buffer.content = data;
+    buffer.length = length;
+
+    item = cJSON_CreateNull();
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    /* the whole input has to be one value */
+    if (!read_msgpack_value(item, &buffer) || (buffer.offset != buffer.length))
+    {
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    return item;
+}
+
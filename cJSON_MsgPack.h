@@ -0,0 +1,51 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef cJSON_MsgPack__h
+#define cJSON_MsgPack__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* The MessagePack extension type that cJSON_Raw items are written as. */
+#ifndef CJSON_MSGPACK_RAW_EXT
+#define CJSON_MSGPACK_RAW_EXT 1
+#endif
+
+/* Convert between cJSON items and MessagePack (https://msgpack.org). Integral numbers are written as the smallest
+ * integer type that holds them, other numbers as float 32 if that is exact and as float 64 otherwise. cJSON_Raw items
+ * are written as extension type CJSON_MSGPACK_RAW_EXT holding their text. The returned buffer has to be freed with
+ * cJSON_free, its size is stored in length.
+ * cJSON_FromMessagePack expects exactly one value in data. Binary data, other extension types and strings that
+ * contain zero bytes can't be represented and make it fail. */
+CJSON_PUBLIC(unsigned char *) cJSON_ToMessagePack(const cJSON *item, size_t *length);
+CJSON_PUBLIC(cJSON *) cJSON_FromMessagePack(const unsigned char *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
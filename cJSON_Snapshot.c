@@ -0,0 +1,765 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+#if defined(_MSC_VER)
+#pragma warning (push)
+/* disable warning about single line comments in system headers */
+#pragma warning (disable : 4001)
+#endif
+
+#include <ctype.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+/* snapshots are mapped with mmap where it is available */
+#if !defined(CJSON_SNAPSHOT_NO_MMAP) && (defined(__unix__) || (defined(__APPLE__) && defined(__MACH__)))
+#define CJSON_SNAPSHOT_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+
+#include "cJSON_Snapshot.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+#ifndef NAN
+#ifdef _WIN32
+#define NAN sqrt(-1.0)
+#else
+#define NAN 0.0/0.0
+#endif
+#endif
+
+/* string comparison which doesn't consider NULL pointers equal */
+static int compare_strings(const unsigned char *string1, const unsigned char *string2, const cJSON_bool case_sensitive)
+{
+    if ((string1 == NULL) || (string2 == NULL))
+    {
+        return 1;
+    }
+
+    if (string1 == string2)
+    {
+        return 0;
+    }
+
+    if (case_sensitive)
+    {
+        return strcmp((const char*)string1, (const char*)string2);
+    }
+
+    for(; tolower(*string1) == tolower(*string2); (void)string1++, string2++)
+    {
+        if (*string1 == '\0')
+        {
+            return 0;
+        }
+    }
+
+    return tolower(*string1) - tolower(*string2);
+}
+
+/* Copy a value to or from big endian byte order, this assumes IEEE 754 floating point numbers. */
+static void copy_big_endian(unsigned char * const output, const unsigned char * const input, const size_t size)
+{
+    const unsigned int one = 1;
+    size_t index = 0;
+
+    if (*(const unsigned char*)&one == 0)
+    {
+        memcpy(output, input, size);
+        return;
+    }
+
+    for (index = 0; index < size; index++)
+    {
+        output[index] = input[size - 1 - index];
+    }
+}
+
+/* Snapshots. The file starts with a header:
+ *   magic (8 bytes), version, node count, string pool length, reserved (4 bytes each)
+ * followed by the nodes in document order (every item before its children) and the string pool. A node is:
+ *   0: type without flags
+ *   4: offset of the key from the start of the node, 0 if there is none
+ *   8: distance to the next node of the same array/object in nodes, 0 if it's the last one
+ *  12: for strings and raw items the offset of the text from the start of the node, otherwise the entry count
+ *  16: for numbers the double
+ * The first entry of an array/object is the node right after it. Everything is stored in big endian byte order,
+ * offsets are relative so the image can be used wherever it is mapped. */
+#define SNAPSHOT_HEADER_SIZE 24
+#define SNAPSHOT_NODE_SIZE 24
+#define SNAPSHOT_VERSION 1
+static const unsigned char snapshot_magic[8] = { 'c', 'J', 'S', 'O', 'N', 's', 'n', 'p' };
+
+struct cJSON_Snapshot
+{
+    unsigned char *data;
+    size_t length;
+    cJSON_bool mapped; /* with mmap, otherwise allocated */
+};
+
+static void write_snapshot_uint(unsigned char * const output, const size_t value)
+{
+    output[0] = (unsigned char)((value >> 24) & 0xFF);
+    output[1] = (unsigned char)((value >> 16) & 0xFF);
+    output[2] = (unsigned char)((value >> 8) & 0xFF);
+    output[3] = (unsigned char)(value & 0xFF);
+}
+
+static size_t read_snapshot_uint(const unsigned char * const input)
+{
+    return ((size_t)input[0] << 24) | ((size_t)input[1] << 16) | ((size_t)input[2] << 8) | (size_t)input[3];
+}
+
+typedef struct
+{
+    unsigned char *nodes;
+    size_t node_count;
+    unsigned char *strings;
+    size_t string_length;
+    /* the content of deferred items, parsed while counting and used in the same order while filling */
+    cJSON **deferred;
+    size_t deferred_count;
+    size_t deferred_capacity;
+    size_t next_deferred;
+} snapshot_writer;
+
+/* Parse the content of a deferred item at depth into a temporary tree, the item itself stays deferred. */
+static const cJSON *parse_deferred_content(snapshot_writer * const writer, const cJSON * const item, const size_t depth)
+{
+    cJSON *content = NULL;
+
+    if (writer->deferred_count == writer->deferred_capacity)
+    {
+        const size_t new_capacity = (writer->deferred_capacity == 0) ? 16 : writer->deferred_capacity * 2;
+        cJSON **new_deferred = NULL;
+        if (new_capacity > (((size_t)-1) / sizeof(cJSON*)))
+        {
+            return NULL;
+        }
+        new_deferred = (cJSON**)cJSON_malloc(new_capacity * sizeof(cJSON*));
+        if (new_deferred == NULL)
+        {
+            return NULL;
+        }
+        if (writer->deferred != NULL)
+        {
+            memcpy(new_deferred, writer->deferred, writer->deferred_count * sizeof(cJSON*));
+            cJSON_free(writer->deferred);
+        }
+        writer->deferred = new_deferred;
+        writer->deferred_capacity = new_capacity;
+    }
+
+    if (depth >= CJSON_NESTING_LIMIT)
+    {
+        return NULL; /* nested too deep */
+    }
+    /* the content may only use what is left of the nesting limit */
+    content = cJSON_ParseDeferred(item, CJSON_NESTING_LIMIT - depth);
+    if (content == NULL)
+    {
+        return NULL;
+    }
+    writer->deferred[writer->deferred_count++] = content;
+
+    return content;
+}
+
+/* count the nodes and string bytes of item and check that it can be saved */
+static cJSON_bool count_snapshot(snapshot_writer * const writer, const cJSON *item, const size_t depth, size_t * const nodes, size_t * const string_bytes)
+{
+    const cJSON *child = NULL;
+    int packed_count = 0;
+
+    /* deferred subtrees are saved with their content, not as raw text */
+    if (item->type & cJSON_IsDeferred)
+    {
+        item = parse_deferred_content(writer, item, depth);
+        if (item == NULL)
+        {
+            return false;
+        }
+    }
+
+    (*nodes)++;
+    if (cJSON_GetDoubleArray(item, &packed_count) != NULL)
+    {
+        /* one node per number */
+        *nodes += (size_t)packed_count;
+        return depth < CJSON_NESTING_LIMIT;
+    }
+    switch (item->type & 0xFF)
+    {
+        case cJSON_NULL:
+        case cJSON_False:
+        case cJSON_True:
+        case cJSON_Number:
+            return true;
+
+        case cJSON_String:
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            *string_bytes += strlen(item->valuestring) + sizeof("");
+            return true;
+
+        case cJSON_Array:
+        case cJSON_Object:
+            if (depth >= CJSON_NESTING_LIMIT)
+            {
+                return false; /* nested too deep */
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                if (cJSON_IsObject(item))
+                {
+                    if (child->string == NULL)
+                    {
+                        return false;
+                    }
+                    *string_bytes += strlen(child->string) + sizeof("");
+                }
+                if (!count_snapshot(writer, child, depth + 1, nodes, string_bytes))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/* copy a string into the pool, returns its offset from node */
+static size_t add_snapshot_string(snapshot_writer * const writer, const unsigned char * const node, const char * const string)
+{
+    const size_t length = strlen(string) + sizeof("");
+    unsigned char * const target = writer->strings + writer->string_length;
+
+    memcpy(target, string, length);
+    writer->string_length += length;
+
+    return (size_t)(target - node);
+}
+
+/* write the nodes of item and its children, returns how many */
+static size_t fill_snapshot(snapshot_writer * const writer, const cJSON *item, const char * const key)
+{
+    unsigned char * const node = writer->nodes + (writer->node_count++ * SNAPSHOT_NODE_SIZE);
+    const cJSON *child = NULL;
+    const double *numbers = NULL;
+    int packed_count = 0;
+    size_t total = 1;
+    size_t count = 0;
+
+    if (item->type & cJSON_IsDeferred)
+    {
+        item = writer->deferred[writer->next_deferred++];
+    }
+
+    memset(node, '\0', SNAPSHOT_NODE_SIZE);
+    write_snapshot_uint(node, (size_t)(item->type & 0xFF));
+    if (key != NULL)
+    {
+        write_snapshot_uint(node + 4, add_snapshot_string(writer, node, key));
+    }
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_Number:
+            copy_big_endian(node + 16, (const unsigned char*)&item->valuedouble, sizeof(double));
+            break;
+
+        case cJSON_String:
+        case cJSON_Raw:
+            write_snapshot_uint(node + 12, add_snapshot_string(writer, node, item->valuestring));
+            break;
+
+        case cJSON_Array:
+        case cJSON_Object:
+            numbers = cJSON_GetDoubleArray(item, &packed_count);
+            if (numbers != NULL)
+            {
+                for (count = 0; count < (size_t)packed_count; count++)
+                {
+                    unsigned char * const child_node = writer->nodes + (writer->node_count++ * SNAPSHOT_NODE_SIZE);
+                    memset(child_node, '\0', SNAPSHOT_NODE_SIZE);
+                    write_snapshot_uint(child_node, (size_t)cJSON_Number);
+                    if ((count + 1) < (size_t)packed_count)
+                    {
+                        write_snapshot_uint(child_node + 8, 1);
+                    }
+                    copy_big_endian(child_node + 16, (const unsigned char*)&numbers[count], sizeof(double));
+                }
+                total += count;
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                unsigned char * const child_node = writer->nodes + (writer->node_count * SNAPSHOT_NODE_SIZE);
+                const size_t nodes = fill_snapshot(writer, child, cJSON_IsObject(item) ? child->string : NULL);
+                if (child->next != NULL)
+                {
+                    write_snapshot_uint(child_node + 8, nodes);
+                }
+                total += nodes;
+                count++;
+            }
+            write_snapshot_uint(node + 12, count);
+            break;
+
+        default:
+            break;
+    }
+
+    return total;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_SaveSnapshot(const cJSON *item, const char *path)
+{
+    size_t node_count = 0;
+    size_t string_bytes = 0;
+    size_t length = 0;
+    unsigned char *image = NULL;
+    snapshot_writer writer = { NULL, 0, NULL, 0, NULL, 0, 0, 0 };
+    FILE *file = NULL;
+    cJSON_bool success = false;
+
+    if ((item == NULL) || (path == NULL) || !count_snapshot(&writer, item, 0, &node_count, &string_bytes))
+    {
+        goto cleanup;
+    }
+
+    /* all offsets have to fit into 32 bit */
+    if ((node_count > ((0xFFFFFFFFUL - SNAPSHOT_HEADER_SIZE) / SNAPSHOT_NODE_SIZE))
+        || (string_bytes > (0xFFFFFFFFUL - SNAPSHOT_HEADER_SIZE - node_count * SNAPSHOT_NODE_SIZE)))
+    {
+        goto cleanup;
+    }
+    length = SNAPSHOT_HEADER_SIZE + node_count * SNAPSHOT_NODE_SIZE + string_bytes;
+
+    image = (unsigned char*)cJSON_malloc(length);
+    if (image == NULL)
+    {
+        goto cleanup;
+    }
+
+    memset(image, '\0', SNAPSHOT_HEADER_SIZE);
+    memcpy(image, snapshot_magic, sizeof(snapshot_magic));
+    write_snapshot_uint(image + 8, SNAPSHOT_VERSION);
+    write_snapshot_uint(image + 12, node_count);
+    write_snapshot_uint(image + 16, string_bytes);
+
+    writer.nodes = image + SNAPSHOT_HEADER_SIZE;
+    writer.strings = writer.nodes + node_count * SNAPSHOT_NODE_SIZE;
+    fill_snapshot(&writer, item, NULL);
+
+    file = fopen(path, "wb");
+    if (file != NULL)
+    {
+        success = (fwrite(image, 1, length, file) == length);
+        success = (fclose(file) == 0) && success;
+    }
+
+cleanup:
+    if (image != NULL)
+    {
+        cJSON_free(image);
+    }
+    while (writer.deferred_count > 0)
+    {
+        cJSON_Delete(writer.deferred[--writer.deferred_count]);
+    }
+    if (writer.deferred != NULL)
+    {
+        cJSON_free(writer.deferred);
+    }
+
+    return success;
+}
+
+/* check that every offset of the image stays inside of it */
+static cJSON_bool validate_snapshot(const unsigned char * const data, const size_t length)
+{
+    size_t node_count = 0;
+    size_t string_bytes = 0;
+    size_t strings_start = 0;
+    size_t index = 0;
+
+    if ((length < (SNAPSHOT_HEADER_SIZE + SNAPSHOT_NODE_SIZE))
+        || (memcmp(data, snapshot_magic, sizeof(snapshot_magic)) != 0)
+        || (read_snapshot_uint(data + 8) != SNAPSHOT_VERSION))
+    {
+        return false;
+    }
+
+    node_count = read_snapshot_uint(data + 12);
+    string_bytes = read_snapshot_uint(data + 16);
+    if ((node_count == 0) || (node_count > ((length - SNAPSHOT_HEADER_SIZE) / SNAPSHOT_NODE_SIZE))
+        || ((length - SNAPSHOT_HEADER_SIZE - node_count * SNAPSHOT_NODE_SIZE) != string_bytes)
+        || ((string_bytes > 0) && (data[length - 1] != '\0')))
+    {
+        return false;
+    }
+    strings_start = SNAPSHOT_HEADER_SIZE + node_count * SNAPSHOT_NODE_SIZE;
+
+    for (index = 0; index < node_count; index++)
+    {
+        const size_t position = SNAPSHOT_HEADER_SIZE + index * SNAPSHOT_NODE_SIZE;
+        const unsigned char * const node = data + position;
+        const size_t key = read_snapshot_uint(node + 4);
+        const size_t value = read_snapshot_uint(node + 12);
+        /* nodes after this one */
+        const size_t remaining = node_count - 1 - index;
+
+        if (((key != 0) && ((key < (strings_start - position)) || (key >= (length - position))))
+            || (read_snapshot_uint(node + 8) > remaining))
+        {
+            return false;
+        }
+
+        switch (read_snapshot_uint(node))
+        {
+            case cJSON_NULL:
+            case cJSON_False:
+            case cJSON_True:
+            case cJSON_Number:
+                break;
+
+            case cJSON_String:
+            case cJSON_Raw:
+                if ((value < (strings_start - position)) || (value >= (length - position)))
+                {
+                    return false;
+                }
+                break;
+
+            case cJSON_Array:
+            case cJSON_Object:
+                if (value > remaining)
+                {
+                    return false;
+                }
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+#ifdef CJSON_SNAPSHOT_MMAP
+static cJSON_bool load_snapshot(cJSON_Snapshot * const snapshot, const char * const path)
+{
+    struct stat status;
+    void *data = NULL;
+    int file = open(path, O_RDONLY);
+
+    if (file < 0)
+    {
+        return false;
+    }
+    if ((fstat(file, &status) != 0) || (status.st_size <= 0))
+    {
+        close(file);
+        return false;
+    }
+
+    data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    snapshot->data = (unsigned char*)data;
+    snapshot->length = (size_t)status.st_size;
+    snapshot->mapped = true;
+
+    return true;
+}
+#else
+static cJSON_bool load_snapshot(cJSON_Snapshot * const snapshot, const char * const path)
+{
+    long length = 0;
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+    if ((fseek(file, 0, SEEK_END) != 0) || ((length = ftell(file)) <= 0) || (fseek(file, 0, SEEK_SET) != 0))
+    {
+        fclose(file);
+        return false;
+    }
+
+    snapshot->data = (unsigned char*)cJSON_malloc((size_t)length);
+    if (snapshot->data != NULL)
+    {
+        snapshot->length = fread(snapshot->data, 1, (size_t)length, file);
+    }
+    fclose(file);
+    snapshot->mapped = false;
+
+    return (snapshot->data != NULL) && (snapshot->length == (size_t)length);
+}
+#endif
+
+CJSON_PUBLIC(void) cJSON_UnmapSnapshot(cJSON_Snapshot *snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return;
+    }
+
+    if (snapshot->data != NULL)
+    {
+#ifdef CJSON_SNAPSHOT_MMAP
+        if (snapshot->mapped)
+        {
+            munmap(snapshot->data, snapshot->length);
+        }
+        else
+#endif
+        {
+            cJSON_free(snapshot->data);
+        }
+    }
+    cJSON_free(snapshot);
+}
+
+CJSON_PUBLIC(cJSON_Snapshot *) cJSON_MapSnapshot(const char *path)
+{
+    cJSON_Snapshot *snapshot = NULL;
+
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    snapshot = (cJSON_Snapshot*)cJSON_malloc(sizeof(cJSON_Snapshot));
+    if (snapshot == NULL)
+    {
+        return NULL;
+    }
+    memset(snapshot, '\0', sizeof(cJSON_Snapshot));
+
+    if (!load_snapshot(snapshot, path) || !validate_snapshot(snapshot->data, snapshot->length))
+    {
+        cJSON_UnmapSnapshot(snapshot);
+        return NULL;
+    }
+
+    return snapshot;
+}
+
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotRoot(const cJSON_Snapshot *snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return NULL;
+    }
+
+    return (const cJSON_SnapshotItem*)(snapshot->data + SNAPSHOT_HEADER_SIZE);
+}
+
+CJSON_PUBLIC(int) cJSON_SnapshotType(const cJSON_SnapshotItem *item)
+{
+    if (item == NULL)
+    {
+        return cJSON_Invalid;
+    }
+
+    return (int)read_snapshot_uint((const unsigned char*)item);
+}
+
+CJSON_PUBLIC(const char *) cJSON_SnapshotKey(const cJSON_SnapshotItem *item)
+{
+    size_t offset = 0;
+
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    offset = read_snapshot_uint((const unsigned char*)item + 4);
+    if (offset == 0)
+    {
+        return NULL;
+    }
+
+    return (const char*)item + offset;
+}
+
+CJSON_PUBLIC(const char *) cJSON_SnapshotString(const cJSON_SnapshotItem *item)
+{
+    const int type = cJSON_SnapshotType(item);
+
+    if ((type != cJSON_String) && (type != cJSON_Raw))
+    {
+        return NULL;
+    }
+
+    return (const char*)item + read_snapshot_uint((const unsigned char*)item + 12);
+}
+
+CJSON_PUBLIC(double) cJSON_SnapshotNumber(const cJSON_SnapshotItem *item)
+{
+    double number = 0;
+
+    if (cJSON_SnapshotType(item) != cJSON_Number)
+    {
+        return (double) NAN;
+    }
+
+    copy_big_endian((unsigned char*)&number, (const unsigned char*)item + 16, sizeof(number));
+
+    return number;
+}
+
+CJSON_PUBLIC(int) cJSON_SnapshotGetArraySize(const cJSON_SnapshotItem *item)
+{
+    const int type = cJSON_SnapshotType(item);
+
+    if ((type != cJSON_Array) && (type != cJSON_Object))
+    {
+        return 0;
+    }
+
+    /* can't overflow, a snapshot has less than 4 GB / SNAPSHOT_NODE_SIZE nodes */
+    return (int)read_snapshot_uint((const unsigned char*)item + 12);
+}
+
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotChild(const cJSON_SnapshotItem *item)
+{
+    if (cJSON_SnapshotGetArraySize(item) == 0)
+    {
+        return NULL;
+    }
+
+    return (const cJSON_SnapshotItem*)((const unsigned char*)item + SNAPSHOT_NODE_SIZE);
+}
+
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotNext(const cJSON_SnapshotItem *item)
+{
+    size_t distance = 0;
+
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    distance = read_snapshot_uint((const unsigned char*)item + 8);
+    if (distance == 0)
+    {
+        return NULL;
+    }
+
+    return (const cJSON_SnapshotItem*)((const unsigned char*)item + distance * SNAPSHOT_NODE_SIZE);
+}
+
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetArrayItem(const cJSON_SnapshotItem *array, int index)
+{
+    const cJSON_SnapshotItem *current_element = NULL;
+
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    /* siblings are skipped without visiting their children */
+    current_element = cJSON_SnapshotChild(array);
+    while ((current_element != NULL) && (index > 0))
+    {
+        index--;
+        current_element = cJSON_SnapshotNext(current_element);
+    }
+
+    return current_element;
+}
+
+static const cJSON_SnapshotItem *get_snapshot_object_item(const cJSON_SnapshotItem * const object, const char * const name, const cJSON_bool case_sensitive)
+{
+    const cJSON_SnapshotItem *current_element = NULL;
+
+    if ((cJSON_SnapshotType(object) != cJSON_Object) || (name == NULL))
+    {
+        return NULL;
+    }
+
+    for (current_element = cJSON_SnapshotChild(object); current_element != NULL; current_element = cJSON_SnapshotNext(current_element))
+    {
+        const char * const key = cJSON_SnapshotKey(current_element);
+        if (compare_strings((const unsigned char*)name, (const unsigned char*)key, case_sensitive) == 0)
+        {
+            return current_element;
+        }
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetObjectItem(const cJSON_SnapshotItem *object, const char *string)
+{
+    return get_snapshot_object_item(object, string, false);
+}
+
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetObjectItemCaseSensitive(const cJSON_SnapshotItem *object, const char *string)
+{
+    return get_snapshot_object_item(object, string, true);
+}
+
@@ -0,0 +1,68 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef cJSON_Snapshot__h
+#define cJSON_Snapshot__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* A snapshot file mapped into memory and an item in it, see cJSON_MapSnapshot. Both are opaque. */
+typedef struct cJSON_Snapshot cJSON_Snapshot;
+typedef struct cJSON_SnapshotItem cJSON_SnapshotItem;
+
+/* Snapshots are binary images of a tree that can be used without parsing: a table of fixed size nodes in document
+ * order that refer to each other and to a pool of zero terminated strings by relative offsets. cJSON_SaveSnapshot
+ * writes one to a file. cJSON_MapSnapshot maps such a file read only (mmap where available, otherwise it is read
+ * into a single buffer) and checks that all offsets stay inside of it, no nodes are allocated. It returns NULL if the
+ * file can't be read or isn't a valid snapshot. Items and strings of a snapshot are valid until
+ * cJSON_UnmapSnapshot. Snapshots can't be larger than 4 GB. */
+CJSON_PUBLIC(cJSON_bool) cJSON_SaveSnapshot(const cJSON *item, const char *path);
+CJSON_PUBLIC(cJSON_Snapshot *) cJSON_MapSnapshot(const char *path);
+CJSON_PUBLIC(void) cJSON_UnmapSnapshot(cJSON_Snapshot *snapshot);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotRoot(const cJSON_Snapshot *snapshot);
+/* The type without flags (cJSON_Invalid for NULL), the key of object members, the text of strings and raw items,
+ * the number of numbers (NaN otherwise) and the number of entries of arrays and objects. */
+CJSON_PUBLIC(int) cJSON_SnapshotType(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(const char *) cJSON_SnapshotKey(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(const char *) cJSON_SnapshotString(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(double) cJSON_SnapshotNumber(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(int) cJSON_SnapshotGetArraySize(const cJSON_SnapshotItem *item);
+/* The first entry of an array or object and the entry after item, NULL if there is none. */
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotChild(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotNext(const cJSON_SnapshotItem *item);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetArrayItem(const cJSON_SnapshotItem *array, int index);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetObjectItem(const cJSON_SnapshotItem *object, const char *string);
+CJSON_PUBLIC(const cJSON_SnapshotItem *) cJSON_SnapshotGetObjectItemCaseSensitive(const cJSON_SnapshotItem *object, const char *string);
+
+/* Macro for iterating over an array or object of a snapshot */
+#define cJSON_SnapshotForEach(element, array) for(element = cJSON_SnapshotChild(array); element != NULL; element = cJSON_SnapshotNext(element))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
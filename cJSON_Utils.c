@@ -63,22 +63,6 @@
 #endif
 #define false ((cJSON_bool)0)
 
-static unsigned char* cJSONUtils_strdup(const unsigned char* const string)
-{
-    size_t length = 0;
-    unsigned char *copy = NULL;
-
-    length = strlen((const char*)string) + sizeof("");
-    copy = (unsigned char*) cJSON_malloc(length);
-    if (copy == NULL)
-    {
-        return NULL;
-    }
-    memcpy(copy, string, length);
-
-    return copy;
-}
-
 /* string comparison which doesn't consider NULL pointers equal */
 static int compare_strings(const unsigned char *string1, const unsigned char *string2, const cJSON_bool case_sensitive)
 {
@@ -115,6 +99,12 @@ static cJSON_bool compare_double(double a, double b)
     return (fabs(a - b) <= maxVal * DBL_EPSILON);
 }
 
+/* Deferred subtrees (see cJSON_ParseOptions.defer_depth) are parsed before they are walked,
+ * until then they are raw items without children. */
+static cJSON_bool expand_deferred(cJSON * const item)
+{
+    return (item == NULL) || !(item->type & cJSON_IsDeferred) || cJSON_Expand(item);
+}
 
 /* Compare the next path element of two JSON pointers, two NULL pointers are considered unequal: */
 static cJSON_bool compare_pointers(const unsigned char *name, const unsigned char *pointer, const cJSON_bool case_sensitive)
@@ -195,67 +185,243 @@ static void encode_string_as_pointer(unsigned char *destination, const unsigned
     destination[0] = '\0';
 }
 
-CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromObjectTo(const cJSON * const object, const cJSON * const target)
+/* position of item in the list of children of parent */
+static size_t get_item_index(const cJSON * const parent, const cJSON * const item)
 {
-    size_t child_index = 0;
-    cJSON *current_child = 0;
+    const cJSON *child = NULL;
+    size_t index = 0;
 
-    if ((object == NULL) || (target == NULL))
+    for (child = parent->child; (child != NULL) && (child != item); child = child->next)
     {
-        return NULL;
+        index++;
+    }
+
+    return index;
+}
+
+static size_t decimal_length(size_t number)
+{
+    size_t length = 1;
+    for (; number >= 10; number /= 10)
+    {
+        length++;
+    }
+
+    return length;
+}
+
+/* Build the pointer by walking up the parent links of a tree tracked with cJSON_TrackParents.
+ * Returns NULL if object can't be reached from target that way. */
+static unsigned char *pointer_from_parent_links(const cJSON * const object, const cJSON * const target)
+{
+    const cJSON *current = NULL;
+    const cJSON *parent = NULL;
+    unsigned char *pointer = NULL;
+    size_t length = 0;
+    size_t position = 0;
+
+    for (current = target; current != object; current = parent)
+    {
+        parent = cJSON_GetParent(current);
+        if (parent == NULL)
+        {
+            return NULL;
+        }
+        if (cJSON_IsArray(parent))
+        {
+            length += sizeof("/") - sizeof("") + decimal_length(get_item_index(parent, current));
+        }
+        else if (cJSON_IsObject(parent) && (current->string != NULL))
+        {
+            length += sizeof("/") - sizeof("") + pointer_encoded_length((const unsigned char*)current->string);
+        }
+        else
+        {
+            return NULL;
+        }
     }
 
-    if (object == target)
+    pointer = (unsigned char*)cJSON_malloc(length + sizeof(""));
+    if (pointer == NULL)
     {
-        /* found */
-        return (char*)cJSONUtils_strdup((const unsigned char*)"");
+        return NULL;
     }
 
-    /* recursively search all children of the object or array */
-    for (current_child = object->child; current_child != NULL; (void)(current_child = current_child->next), child_index++)
+    /* the tokens are visited from the last to the first, so the pointer is written back to front */
+    position = length;
+    pointer[position] = '\0';
+    for (current = target; current != object; current = parent)
     {
-        unsigned char *target_pointer = (unsigned char*)cJSONUtils_FindPointerFromObjectTo(current_child, target);
-        /* found the target? */
-        if (target_pointer != NULL)
+        parent = cJSON_GetParent(current);
+        if (cJSON_IsArray(parent))
         {
-            if (cJSON_IsArray(object))
+            size_t index = get_item_index(parent, current);
+            do
             {
-                /* reserve enough memory for a 64 bit integer + '/' and '\0' */
-                unsigned char *full_pointer = (unsigned char*)cJSON_malloc(strlen((char*)target_pointer) + 20 + sizeof("/"));
-                /* check if conversion to unsigned long is valid
-                 * This should be eliminated at compile time by dead code elimination
-                 * if size_t is an alias of unsigned long, or if it is bigger */
-                if (child_index > ULONG_MAX)
+                pointer[--position] = (unsigned char)('0' + (index % 10));
+                index /= 10;
+            } while (index > 0);
+        }
+        else
+        {
+            const unsigned char *key = (const unsigned char*)current->string;
+            size_t key_position = strlen(current->string);
+            for (; key_position > 0; key_position--)
+            {
+                unsigned char character = key[key_position - 1];
+                if ((character == '/') || (character == '~'))
                 {
-                    cJSON_free(target_pointer);
-                    cJSON_free(full_pointer);
-                    return NULL;
+                    pointer[--position] = (character == '/') ? '1' : '0';
+                    character = '~';
                 }
-                sprintf((char*)full_pointer, "/%lu%s", (unsigned long)child_index, target_pointer); /* /<array_index><path> */
-                cJSON_free(target_pointer);
-
-                return (char*)full_pointer;
+                pointer[--position] = character;
             }
+        }
+        pointer[--position] = '/';
+    }
 
-            if (cJSON_IsObject(object))
-            {
-                unsigned char *full_pointer = (unsigned char*)cJSON_malloc(strlen((char*)target_pointer) + pointer_encoded_length((unsigned char*)current_child->string) + 2);
-                full_pointer[0] = '/';
-                encode_string_as_pointer(full_pointer + 1, (unsigned char*)current_child->string);
-                strcat((char*)full_pointer, (char*)target_pointer);
-                cJSON_free(target_pointer);
+    return pointer;
+}
+
+typedef struct
+{
+    const cJSON *item; /* an item on the path, its parent is the item of the frame below or the object */
+    size_t index; /* position of item in its parent */
+} search_frame;
+
+/* Search the tree depth first with a stack of frames instead of recursion. When target is found, the stack holds
+ * the path to it and the pointer is built from that. */
+static unsigned char *find_pointer_by_search(const cJSON * const object, const cJSON * const target)
+{
+    search_frame *frames = NULL;
+    size_t capacity = 0;
+    size_t count = 0;
+    const cJSON *current = object;
+    const cJSON *parent = NULL;
+    unsigned char *pointer = NULL;
+    size_t length = 0;
+    size_t position = 0;
+    size_t level = 0;
 
-                return (char*)full_pointer;
+    while (current != target)
+    {
+        if (current->child != NULL)
+        {
+            if (count == capacity)
+            {
+                search_frame *new_frames = NULL;
+                size_t new_capacity = (capacity == 0) ? 16 : (capacity * 2);
+                if (new_capacity > (((size_t)-1) / sizeof(search_frame)))
+                {
+                    goto cleanup;
+                }
+                new_frames = (search_frame*)cJSON_malloc(new_capacity * sizeof(search_frame));
+                if (new_frames == NULL)
+                {
+                    goto cleanup;
+                }
+                if (frames != NULL)
+                {
+                    memcpy(new_frames, frames, count * sizeof(search_frame));
+                    cJSON_free(frames);
+                }
+                frames = new_frames;
+                capacity = new_capacity;
+            }
+            frames[count].item = current->child;
+            frames[count].index = 0;
+            count++;
+        }
+        else
+        {
+            /* continue with the next sibling of current or of the closest item above it that has one */
+            while ((count > 0) && (frames[count - 1].item->next == NULL))
+            {
+                count--;
+            }
+            if (count == 0)
+            {
+                /* not found */
+                goto cleanup;
             }
+            frames[count - 1].item = frames[count - 1].item->next;
+            frames[count - 1].index++;
+        }
+        current = frames[count - 1].item;
+    }
 
-            /* reached leaf of the tree, found nothing */
-            cJSON_free(target_pointer);
-            return NULL;
+    for (level = 0; level < count; level++)
+    {
+        parent = (level > 0) ? frames[level - 1].item : object;
+        if (cJSON_IsArray(parent))
+        {
+            length += sizeof("/") - sizeof("") + decimal_length(frames[level].index);
+        }
+        else if (cJSON_IsObject(parent) && (frames[level].item->string != NULL))
+        {
+            length += sizeof("/") - sizeof("") + pointer_encoded_length((const unsigned char*)frames[level].item->string);
+        }
+        else
+        {
+            goto cleanup;
         }
     }
 
-    /* not found */
-    return NULL;
+    pointer = (unsigned char*)cJSON_malloc(length + sizeof(""));
+    if (pointer == NULL)
+    {
+        goto cleanup;
+    }
+    pointer[length] = '\0';
+    for (level = 0; level < count; level++)
+    {
+        parent = (level > 0) ? frames[level - 1].item : object;
+        pointer[position++] = '/';
+        if (cJSON_IsArray(parent))
+        {
+            /* the digits are written back to front */
+            size_t index = frames[level].index;
+            size_t digit = position + decimal_length(index);
+            position = digit;
+            do
+            {
+                pointer[--digit] = (unsigned char)('0' + (index % 10));
+                index /= 10;
+            } while (index > 0);
+        }
+        else
+        {
+            encode_string_as_pointer(pointer + position, (const unsigned char*)frames[level].item->string);
+            position += pointer_encoded_length((const unsigned char*)frames[level].item->string);
+        }
+    }
+
+cleanup:
+    if (frames != NULL)
+    {
+        cJSON_free(frames);
+    }
+
+    return pointer;
+}
+
+CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromObjectTo(const cJSON * const object, const cJSON * const target)
+{
+    unsigned char *pointer = NULL;
+
+    if ((object == NULL) || (target == NULL))
+    {
+        return NULL;
+    }
+
+    /* tracked trees don't have to be searched */
+    pointer = pointer_from_parent_links(object, target);
+    if (pointer == NULL)
+    {
+        pointer = find_pointer_by_search(object, target);
+    }
+
+    return (char*)pointer;
 }
 
 /* non broken version of cJSON_GetArrayItem */
@@ -311,6 +477,11 @@ static cJSON *get_item_from_pointer(cJSON * const object, const char * pointer,
     while ((pointer[0] == '/') && (current_element != NULL))
     {
         pointer++;
+        /* deferred subtrees are parsed on the way down */
+        if (!cJSON_Expand(current_element))
+        {
+            return NULL;
+        }
         if (cJSON_IsArray(current_element))
         {
             size_t index = 0;
@@ -342,6 +513,11 @@ static cJSON *get_item_from_pointer(cJSON * const object, const char * pointer,
         }
     }
 
+    if (current_element != NULL)
+    {
+        cJSON_Expand(current_element);
+    }
+
     return current_element;
 }
 
@@ -355,183 +531,424 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, c
     return get_item_from_pointer(object, pointer, true);
 }
 
-/* JSON Patch implementation. */
-static void decode_pointer_inplace(unsigned char *string)
+/* a single reference token of a compiled JSON pointer, with escapes already decoded */
+typedef struct pointer_token
 {
-    unsigned char *decoded_string = string;
+    const unsigned char *key;
+    size_t length;
+    unsigned long hash;
+    size_t index;
+    cJSON_bool is_index;
+} pointer_token;
 
-    if (string == NULL) {
-        return;
+struct cJSONUtils_CompiledPointer
+{
+    pointer_token *tokens;
+    size_t count;
+    unsigned char *keys;
+    cJSON_bool case_sensitive;
+};
+
+/* FNV-1a, case insensitive tokens are hashed in lower case so that equal lookups hash equal */
+static unsigned long hash_token(const unsigned char *key, const size_t length, const cJSON_bool case_sensitive)
+{
+    unsigned long hash = 2166136261UL;
+    size_t position = 0;
+
+    for (position = 0; position < length; position++)
+    {
+        hash ^= (unsigned long)(case_sensitive ? key[position] : tolower(key[position]));
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+static cJSONUtils_CompiledPointer *compile_pointer(const char * const pointer, const cJSON_bool case_sensitive)
+{
+    cJSONUtils_CompiledPointer *compiled = NULL;
+    const unsigned char *position = (const unsigned char*)pointer;
+    unsigned char *key = NULL;
+    size_t token = 0;
+
+    /* only the empty pointer and pointers starting with '/' are valid */
+    if ((pointer == NULL) || ((pointer[0] != '\0') && (pointer[0] != '/')))
+    {
+        return NULL;
+    }
+
+    compiled = (cJSONUtils_CompiledPointer*)cJSON_malloc(sizeof(cJSONUtils_CompiledPointer));
+    if (compiled == NULL)
+    {
+        return NULL;
+    }
+    memset(compiled, '\0', sizeof(cJSONUtils_CompiledPointer));
+    compiled->case_sensitive = case_sensitive;
+
+    for (; *position != '\0'; position++)
+    {
+        if (*position == '/')
+        {
+            compiled->count++;
+        }
     }
 
-    for (; *string; (void)decoded_string++, string++)
+    /* decoded keys are never longer than the encoded pointer */
+    compiled->keys = (unsigned char*)cJSON_malloc(strlen(pointer) + sizeof(""));
+    if (compiled->keys == NULL)
     {
-        if (string[0] == '~')
+        goto fail;
+    }
+    if (compiled->count > 0)
+    {
+        compiled->tokens = (pointer_token*)cJSON_malloc(compiled->count * sizeof(pointer_token));
+        if (compiled->tokens == NULL)
+        {
+            goto fail;
+        }
+    }
+
+    key = compiled->keys;
+    position = (const unsigned char*)pointer;
+    for (token = 0; token < compiled->count; token++)
+    {
+        pointer_token *current = &compiled->tokens[token];
+
+        /* skip the '/' */
+        position++;
+        current->key = key;
+        current->index = 0;
+        current->is_index = decode_array_index_from_pointer(position, &current->index);
+        for (; (*position != '\0') && (*position != '/'); (void)position++, key++)
         {
-            if (string[1] == '0')
+            if (*position != '~')
             {
-                decoded_string[0] = '~';
+                *key = *position;
+                continue;
             }
-            else if (string[1] == '1')
+
+            if (position[1] == '0')
+            {
+                *key = '~';
+            }
+            else if (position[1] == '1')
             {
-                decoded_string[1] = '/';
+                *key = '/';
             }
             else
             {
                 /* invalid escape sequence */
-                return;
+                goto fail;
             }
-
-            string++;
+            position++;
         }
+        current->length = (size_t)(key - current->key);
+        current->hash = hash_token(current->key, current->length, case_sensitive);
+        *key = '\0';
+        key++;
     }
 
-    decoded_string[0] = '\0';
+    return compiled;
+
+fail:
+    cJSONUtils_DeleteCompiledPointer(compiled);
+
+    return NULL;
 }
 
-/* non-broken cJSON_DetachItemFromArray */
-static cJSON *detach_item_from_array(cJSON *array, size_t which)
+CJSON_PUBLIC(cJSONUtils_CompiledPointer *) cJSONUtils_CompilePointer(const char *pointer)
 {
-    cJSON *c = array->child;
-    while (c && (which > 0))
-    {
-        c = c->next;
-        which--;
-    }
-    if (!c)
-    {
-        /* item doesn't exist */
-        return NULL;
-    }
-    if (c != array->child)
-    {
-        /* not the first element */
-        c->prev->next = c->next;
-    }
-    if (c->next)
+    return compile_pointer(pointer, false);
+}
+
+CJSON_PUBLIC(cJSONUtils_CompiledPointer *) cJSONUtils_CompilePointerCaseSensitive(const char *pointer)
+{
+    return compile_pointer(pointer, true);
+}
+
+CJSON_PUBLIC(void) cJSONUtils_DeleteCompiledPointer(cJSONUtils_CompiledPointer *pointer)
+{
+    if (pointer == NULL)
     {
-        c->next->prev = c->prev;
+        return;
     }
-    if (c == array->child)
+
+    if (pointer->tokens != NULL)
     {
-        array->child = c->next;
+        cJSON_free(pointer->tokens);
     }
-    else if (c->next == NULL)
+    if (pointer->keys != NULL)
     {
-        array->child->prev = c->prev;
+        cJSON_free(pointer->keys);
     }
-    /* make sure the detached item doesn't point anywhere anymore */
-    c->prev = c->next = NULL;
-
-    return c;
+    cJSON_free(pointer);
 }
 
-/* detach an item at the given path */
-static cJSON *detach_path(cJSON *object, const unsigned char *path, const cJSON_bool case_sensitive)
+static cJSON *get_item_from_token(cJSON * const item, const pointer_token * const token, const cJSON_bool case_sensitive)
 {
-    unsigned char *parent_pointer = NULL;
-    unsigned char *child_pointer = NULL;
-    cJSON *parent = NULL;
-    cJSON *detached_item = NULL;
+    cJSON *child = NULL;
 
-    /* copy path and split it in parent and child */
-    parent_pointer = cJSONUtils_strdup(path);
-    if (parent_pointer == NULL) {
-        goto cleanup;
+    /* deferred subtrees are parsed on the way down */
+    if (!cJSON_Expand(item))
+    {
+        return NULL;
     }
 
-    child_pointer = (unsigned char*)strrchr((char*)parent_pointer, '/'); /* last '/' */
-    if (child_pointer == NULL)
+    if (cJSON_IsArray(item))
     {
-        goto cleanup;
+        return token->is_index ? get_array_item(item, token->index) : NULL;
     }
-    /* split strings */
-    child_pointer[0] = '\0';
-    child_pointer++;
 
-    parent = get_item_from_pointer(object, (char*)parent_pointer, case_sensitive);
-    decode_pointer_inplace(child_pointer);
+    if (!cJSON_IsObject(item))
+    {
+        return NULL;
+    }
 
-    if (cJSON_IsArray(parent))
+    for (child = item->child; child != NULL; child = child->next)
     {
-        size_t index = 0;
-        if (!decode_array_index_from_pointer(child_pointer, &index))
+        if (compare_strings((const unsigned char*)child->string, token->key, case_sensitive) == 0)
         {
-            goto cleanup;
+            return child;
         }
-        detached_item = detach_item_from_array(parent, index);
     }
-    else if (cJSON_IsObject(parent))
+
+    return NULL;
+}
+
+/* follow the tokens of a compiled pointer starting at 'depth',
+ * the item reached after each token is stored in path (if given) */
+static cJSON *follow_compiled_pointer(cJSON *current_element, const cJSONUtils_CompiledPointer * const pointer, size_t depth, cJSON ** const path)
+{
+    for (; depth < pointer->count; depth++)
     {
-        detached_item = cJSON_DetachItemFromObject(parent, (char*)child_pointer);
+        if (current_element != NULL)
+        {
+            current_element = get_item_from_token(current_element, &pointer->tokens[depth], pointer->case_sensitive);
+        }
+        if (path != NULL)
+        {
+            path[depth + 1] = current_element;
+        }
     }
-    else
+
+    if (current_element != NULL)
     {
-        /* Couldn't find object to remove child from. */
-        goto cleanup;
+        cJSON_Expand(current_element);
     }
 
-cleanup:
-    if (parent_pointer != NULL)
+    return current_element;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetCompiledPointer(cJSON * const object, const cJSONUtils_CompiledPointer * const pointer)
+{
+    if ((object == NULL) || (pointer == NULL))
     {
-        cJSON_free(parent_pointer);
+        return NULL;
     }
 
-    return detached_item;
+    return follow_compiled_pointer(object, pointer, 0, NULL);
 }
 
-/* sort lists using mergesort */
-static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
+typedef struct pointer_batch_entry
 {
-    cJSON *first = list;
-    cJSON *second = list;
-    cJSON *current_item = list;
-    cJSON *result = list;
-    cJSON *result_tail = NULL;
+    const cJSONUtils_CompiledPointer *pointer;
+    size_t position;
+} pointer_batch_entry;
 
-    if ((list == NULL) || (list->next == NULL))
+static int compare_tokens(const pointer_token * const a, const pointer_token * const b)
+{
+    if (a->hash != b->hash)
     {
-        /* One entry is sorted already. */
-        return result;
+        return (a->hash < b->hash) ? -1 : 1;
     }
-
-    while ((current_item != NULL) && (current_item->next != NULL) && (compare_strings((unsigned char*)current_item->string, (unsigned char*)current_item->next->string, case_sensitive) < 0))
+    if (a->length != b->length)
     {
-        /* Test for list sorted. */
-        current_item = current_item->next;
+        return (a->length < b->length) ? -1 : 1;
     }
-    if ((current_item == NULL) || (current_item->next == NULL))
+
+    return memcmp(a->key, b->key, a->length);
+}
+
+/* orders the batch so that pointers sharing a prefix end up next to each other */
+static int compare_batch_entries(const void *a, const void *b)
+{
+    const pointer_batch_entry *first = (const pointer_batch_entry*)a;
+    const pointer_batch_entry *second = (const pointer_batch_entry*)b;
+    size_t token = 0;
+
+    if (first->pointer->case_sensitive != second->pointer->case_sensitive)
     {
-        /* Leave sorted lists unmodified. */
-        return result;
+        return first->pointer->case_sensitive ? 1 : -1;
     }
 
-    /* reset pointer to the beginning */
-    current_item = list;
-    while (current_item != NULL)
+    for (token = 0; (token < first->pointer->count) && (token < second->pointer->count); token++)
     {
-        /* Walk two pointers to find the middle. */
-        second = second->next;
-        current_item = current_item->next;
-        /* advances current_item two steps at a time */
-        if (current_item != NULL)
+        int difference = compare_tokens(&first->pointer->tokens[token], &second->pointer->tokens[token]);
+        if (difference != 0)
         {
-            current_item = current_item->next;
+            return difference;
         }
     }
-    if ((second != NULL) && (second->prev != NULL))
+
+    if (first->pointer->count != second->pointer->count)
     {
-        /* Split the lists */
-        second->prev->next = NULL;
-        second->prev = NULL;
+        return (first->pointer->count < second->pointer->count) ? -1 : 1;
     }
 
-    /* Recursively sort the sub-lists. */
-    first = sort_list(first, case_sensitive);
-    second = sort_list(second, case_sensitive);
-    result = NULL;
+    return (first->position < second->position) ? -1 : 1;
+}
 
-    /* Merge the sub-lists */
+static size_t shared_prefix_length(const cJSONUtils_CompiledPointer * const a, const cJSONUtils_CompiledPointer * const b)
+{
+    size_t length = 0;
+
+    if (a->case_sensitive != b->case_sensitive)
+    {
+        return 0;
+    }
+
+    while ((length < a->count) && (length < b->count) && (compare_tokens(&a->tokens[length], &b->tokens[length]) == 0))
+    {
+        length++;
+    }
+
+    return length;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_GetCompiledPointers(cJSON * const object, const cJSONUtils_CompiledPointer * const * const pointers, const size_t count, cJSON ** const results)
+{
+    pointer_batch_entry *entries = NULL;
+    cJSON **path = NULL;
+    const cJSONUtils_CompiledPointer *previous = NULL;
+    size_t entry_count = 0;
+    size_t max_depth = 0;
+    size_t position = 0;
+
+    if ((pointers == NULL) || (results == NULL))
+    {
+        return false;
+    }
+
+    for (position = 0; position < count; position++)
+    {
+        results[position] = NULL;
+        if (pointers[position] == NULL)
+        {
+            continue;
+        }
+        entry_count++;
+        if (pointers[position]->count > max_depth)
+        {
+            max_depth = pointers[position]->count;
+        }
+    }
+
+    if ((object == NULL) || (entry_count == 0))
+    {
+        return true;
+    }
+
+    entries = (pointer_batch_entry*)cJSON_malloc(entry_count * sizeof(pointer_batch_entry));
+    path = (cJSON**)cJSON_malloc((max_depth + 1) * sizeof(cJSON*));
+    if ((entries == NULL) || (path == NULL))
+    {
+        goto fail;
+    }
+
+    entry_count = 0;
+    for (position = 0; position < count; position++)
+    {
+        if (pointers[position] != NULL)
+        {
+            entries[entry_count].pointer = pointers[position];
+            entries[entry_count].position = position;
+            entry_count++;
+        }
+    }
+    qsort(entries, entry_count, sizeof(pointer_batch_entry), compare_batch_entries);
+
+    /* path[depth] is the item reached by the first 'depth' tokens of the previous pointer,
+     * so each pointer only has to walk the part it doesn't share with its predecessor */
+    path[0] = object;
+    for (position = 0; position < entry_count; position++)
+    {
+        const cJSONUtils_CompiledPointer *pointer = entries[position].pointer;
+        size_t depth = (previous != NULL) ? shared_prefix_length(previous, pointer) : 0;
+
+        results[entries[position].position] = follow_compiled_pointer(path[depth], pointer, depth, path);
+        previous = pointer;
+    }
+
+    cJSON_free(entries);
+    cJSON_free(path);
+
+    return true;
+
+fail:
+    if (entries != NULL)
+    {
+        cJSON_free(entries);
+    }
+    if (path != NULL)
+    {
+        cJSON_free(path);
+    }
+
+    return false;
+}
+
+/* sort lists using mergesort */
+static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
+{
+    cJSON *first = list;
+    cJSON *second = list;
+    cJSON *current_item = list;
+    cJSON *result = list;
+    cJSON *result_tail = NULL;
+
+    if ((list == NULL) || (list->next == NULL))
+    {
+        /* One entry is sorted already. */
+        return result;
+    }
+
+    while ((current_item != NULL) && (current_item->next != NULL) && (compare_strings((unsigned char*)current_item->string, (unsigned char*)current_item->next->string, case_sensitive) < 0))
+    {
+        /* Test for list sorted. */
+        current_item = current_item->next;
+    }
+    if ((current_item == NULL) || (current_item->next == NULL))
+    {
+        /* Leave sorted lists unmodified. */
+        return result;
+    }
+
+    /* reset pointer to the beginning */
+    current_item = list;
+    while (current_item != NULL)
+    {
+        /* Walk two pointers to find the middle. */
+        second = second->next;
+        current_item = current_item->next;
+        /* advances current_item two steps at a time */
+        if (current_item != NULL)
+        {
+            current_item = current_item->next;
+        }
+    }
+    if ((second != NULL) && (second->prev != NULL))
+    {
+        /* Split the lists */
+        second->prev->next = NULL;
+        second->prev = NULL;
+    }
+
+    /* Recursively sort the sub-lists. */
+    first = sort_list(first, case_sensitive);
+    second = sort_list(second, case_sensitive);
+    result = NULL;
+
+    /* Merge the sub-lists */
     while ((first != NULL) && (second != NULL))
     {
         cJSON *smaller = NULL;
@@ -592,113 +1009,175 @@ static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
     return result;
 }
 
-static void sort_object(cJSON * const object, const cJSON_bool case_sensitive)
+/* Objects are sorted in a temporary array of their members. The first bytes of every key are packed
+ * into a number up front (lower case for case insensitive sorting), so most comparisons don't have
+ * to look at the keys at all. */
+typedef struct sort_entry
+{
+    cJSON *item;
+    unsigned long prefix;
+} sort_entry;
+
+#define SORT_PREFIX_LENGTH 4
+/* objects up to this size are sorted without allocating */
+#define SMALL_SORT_MEMBERS 16
+
+static unsigned long key_prefix(const unsigned char *key, const cJSON_bool case_sensitive)
 {
-    if (object == NULL)
+    unsigned long prefix = 0;
+    size_t position = 0;
+
+    for (position = 0; position < SORT_PREFIX_LENGTH; position++)
     {
-        return;
+        unsigned char character = 0;
+        if ((key != NULL) && (*key != '\0'))
+        {
+            character = case_sensitive ? *key : (unsigned char)tolower(*key);
+            key++;
+        }
+        prefix = (prefix << 8) | character;
     }
-    object->child = sort_list(object->child, case_sensitive);
+
+    return prefix;
 }
 
-static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensitive)
+static int compare_sort_entries(const sort_entry * const a, const sort_entry * const b, const cJSON_bool case_sensitive)
 {
-    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+    if (a->prefix != b->prefix)
     {
-        /* mismatched type. */
-        return false;
+        return (a->prefix < b->prefix) ? -1 : 1;
     }
-    switch (a->type & 0xFF)
-    {
-        case cJSON_Number:
-            /* numeric mismatch. */
-            if ((a->valueint != b->valueint) || (!compare_double(a->valuedouble, b->valuedouble)))
-            {
-                return false;
-            }
-            else
-            {
-                return true;
-            }
 
-        case cJSON_String:
-            /* string mismatch. */
-            if (strcmp(a->valuestring, b->valuestring) != 0)
-            {
-                return false;
-            }
-            else
-            {
-                return true;
-            }
+    return compare_strings((unsigned char*)a->item->string, (unsigned char*)b->item->string, case_sensitive);
+}
 
-        case cJSON_Array:
-            for ((void)(a = a->child), b = b->child; (a != NULL) && (b != NULL); (void)(a = a->next), b = b->next)
-            {
-                cJSON_bool identical = compare_json(a, b, case_sensitive);
-                if (!identical)
-                {
-                    return false;
-                }
-            }
+/* bottom up merge sort, equal keys keep their order. Returns the array that holds the result. */
+static sort_entry *sort_entries(sort_entry *entries, sort_entry *buffer, const size_t count, const cJSON_bool case_sensitive)
+{
+    size_t width = 0;
 
-            /* array size mismatch? (one of both children is not NULL) */
-            if ((a != NULL) || (b != NULL))
-            {
-                return false;
-            }
-            else
-            {
-                return true;
-            }
+    for (width = 1; width < count; width *= 2)
+    {
+        size_t start = 0;
+        sort_entry *swap = NULL;
 
-        case cJSON_Object:
-            sort_object(a, case_sensitive);
-            sort_object(b, case_sensitive);
-            for ((void)(a = a->child), b = b->child; (a != NULL) && (b != NULL); (void)(a = a->next), b = b->next)
+        for (start = 0; start < count; start += 2 * width)
+        {
+            size_t middle = ((start + width) < count) ? (start + width) : count;
+            size_t end = ((middle + width) < count) ? (middle + width) : count;
+            size_t left = start;
+            size_t right = middle;
+            size_t output = start;
+
+            while ((left < middle) && (right < end))
             {
-                cJSON_bool identical = false;
-                /* compare object keys */
-                if (compare_strings((unsigned char*)a->string, (unsigned char*)b->string, case_sensitive))
+                if (compare_sort_entries(&entries[right], &entries[left], case_sensitive) < 0)
                 {
-                    /* missing member */
-                    return false;
+                    buffer[output++] = entries[right++];
                 }
-                identical = compare_json(a, b, case_sensitive);
-                if (!identical)
+                else
                 {
-                    return false;
+                    buffer[output++] = entries[left++];
                 }
             }
-
-            /* object length mismatch (one of both children is not null) */
-            if ((a != NULL) || (b != NULL))
+            while (left < middle)
             {
-                return false;
+                buffer[output++] = entries[left++];
             }
-            else
+            while (right < end)
             {
-                return true;
+                buffer[output++] = entries[right++];
             }
+        }
 
-        default:
-            break;
+        swap = entries;
+        entries = buffer;
+        buffer = swap;
     }
 
-    /* null, true or false */
-    return true;
+    return entries;
+}
+
+static void sort_object(cJSON * const object, const cJSON_bool case_sensitive)
+{
+    sort_entry small_entries[2 * SMALL_SORT_MEMBERS];
+    sort_entry *entries = small_entries;
+    sort_entry *sorted = NULL;
+    cJSON *child = NULL;
+    size_t count = 0;
+    size_t index = 0;
+    cJSON_bool is_sorted = true;
+
+    if ((object == NULL) || !expand_deferred(object) || (object->child == NULL))
+    {
+        return;
+    }
+
+    for (child = object->child; child->next != NULL; child = child->next)
+    {
+        if (is_sorted && (compare_strings((unsigned char*)child->string, (unsigned char*)child->next->string, case_sensitive) > 0))
+        {
+            is_sorted = false;
+        }
+        count++;
+    }
+    count++;
+    if (is_sorted)
+    {
+        /* Leave sorted lists unmodified. */
+        return;
+    }
+    /* members that are shared with a copy of the object mustn't be relinked */
+    if (!cJSON_Unshare(object))
+    {
+        return;
+    }
+
+    if (count > SMALL_SORT_MEMBERS)
+    {
+        entries = (sort_entry*)cJSON_malloc(2 * count * sizeof(sort_entry));
+    }
+    if (entries == NULL)
+    {
+        /* fall back to sorting the list in place */
+        object->child = sort_list(object->child, case_sensitive);
+        return;
+    }
+
+    for (child = object->child, index = 0; child != NULL; child = child->next, index++)
+    {
+        entries[index].item = child;
+        entries[index].prefix = key_prefix((unsigned char*)child->string, case_sensitive);
+    }
+    sorted = sort_entries(entries, entries + count, count, case_sensitive);
+
+    /* relink the members in their new order */
+    for (index = 0; index < count; index++)
+    {
+        sorted[index].item->prev = (index > 0) ? sorted[index - 1].item : sorted[count - 1].item;
+        sorted[index].item->next = ((index + 1) < count) ? sorted[index + 1].item : NULL;
+    }
+    object->child = sorted[0].item;
+
+    if (entries != small_entries)
+    {
+        cJSON_free(entries);
+    }
 }
 
+/* JSON Patch implementation. */
+
 /* non broken version of cJSON_InsertItemInArray */
 static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newitem)
 {
     cJSON *child = array->child;
-    while (child && (which > 0))
+    size_t position = which;
+    while (child && (position > 0))
     {
         child = child->next;
-        which--;
+        position--;
     }
-    if (which > 0)
+    if (position > 0)
     {
         /* item is after the end of the array */
         return 0;
@@ -708,23 +1187,13 @@ static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newite
         cJSON_AddItemToArray(array, newitem);
         return 1;
     }
-
-    /* insert into the linked list */
-    newitem->next = child;
-    newitem->prev = child->prev;
-    child->prev = newitem;
-
-    /* was it at the beginning */
-    if (child == array->child)
-    {
-        array->child = newitem;
-    }
-    else
+    if (which > INT_MAX)
     {
-        newitem->prev->next = newitem;
+        return 0;
     }
 
-    return 1;
+    /* the core function keeps the bookkeeping of tracked trees up to date */
+    return cJSON_InsertItemInArray(array, (int)which, newitem);
 }
 
 static cJSON *get_object_item(const cJSON * const object, const char* name, const cJSON_bool case_sensitive)
@@ -780,367 +1249,1333 @@ static enum patch_operation decode_patch_operation(const cJSON * const patch, co
     return INVALID;
 }
 
-/* overwrite and existing item with another one and free resources on the way */
-static void overwrite_item(cJSON * const root, const cJSON replacement)
+/* Patches are applied as a transaction: all pointers are compiled up front, the containers on the path of
+ * the previous operation are remembered so that operations in the same area don't walk the tree from the
+ * root again, and every change is recorded in an undo log. Removed items are only deleted once all
+ * operations succeeded, if one fails the log is played backwards to restore the document. */
+enum patch_undo_kind { UNDO_ADDED, UNDO_REMOVED, UNDO_ROOT };
+
+typedef struct patch_undo
 {
-    if (root == NULL)
+    enum patch_undo_kind kind;
+    cJSON *parent;
+    cJSON *item;
+    /* UNDO_REMOVED: where item was, UNDO_ADDED: the key of a moved item before it was added to an object */
+    size_t index;
+    char *string;
+    int string_type;
+    /* UNDO_REMOVED: the item is deleted on commit, not the case if it was moved somewhere else */
+    cJSON_bool owned;
+    /* UNDO_ROOT: what the root was before it was replaced */
+    cJSON contents;
+} patch_undo;
+
+typedef struct compiled_patch
+{
+    enum patch_operation opcode;
+    cJSONUtils_CompiledPointer *path;
+    cJSONUtils_CompiledPointer *from;
+    const cJSON *patch;
+    int status; /* for malformed patches */
+} compiled_patch;
+
+typedef struct patch_transaction
+{
+    cJSON *root;
+    cJSON_bool case_sensitive;
+    patch_undo *log;
+    size_t log_length;
+    /* nodes[depth] is the item reached after 'depth' tokens of 'cached' */
+    cJSON **nodes;
+    const cJSONUtils_CompiledPointer *cached;
+    size_t cached_depth;
+} patch_transaction;
+
+/* item reached after the first 'depth' tokens of pointer, starting where the previous lookup diverges */
+static cJSON *resolve_pointer(patch_transaction * const transaction, const cJSONUtils_CompiledPointer * const pointer, const size_t depth)
+{
+    size_t reached = 0;
+
+    if (pointer == NULL)
     {
-        return;
+        return NULL;
     }
 
-    if (root->string != NULL)
+    if (transaction->cached != NULL)
     {
-        cJSON_free(root->string);
+        reached = shared_prefix_length(transaction->cached, pointer);
+        if (reached > transaction->cached_depth)
+        {
+            reached = transaction->cached_depth;
+        }
     }
-    if (root->valuestring != NULL)
+    if (reached > depth)
     {
-        cJSON_free(root->valuestring);
+        reached = depth;
     }
-    if (root->child != NULL)
+
+    transaction->cached = pointer;
+    for (; reached < depth; reached++)
     {
-        cJSON_Delete(root->child);
+        transaction->nodes[reached + 1] = get_item_from_token(transaction->nodes[reached], &pointer->tokens[reached], transaction->case_sensitive);
+        if (transaction->nodes[reached + 1] == NULL)
+        {
+            transaction->cached_depth = reached;
+            return NULL;
+        }
     }
+    transaction->cached_depth = depth;
 
-    memcpy(root, &replacement, sizeof(cJSON));
+    return transaction->nodes[depth];
 }
 
-static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_sensitive)
+/* the children of the container at 'depth' changed, items further down may have moved */
+static void invalidate_below(patch_transaction * const transaction, const size_t depth)
 {
-    cJSON *path = NULL;
-    cJSON *value = NULL;
-    cJSON *parent = NULL;
-    enum patch_operation opcode = INVALID;
-    unsigned char *parent_pointer = NULL;
-    unsigned char *child_pointer = NULL;
-    int status = 0;
-
-    path = get_object_item(patch, "path", case_sensitive);
-    if (!cJSON_IsString(path))
+    if (transaction->cached_depth > depth)
     {
-        /* malformed patch. */
-        status = 2;
-        goto cleanup;
+        transaction->cached_depth = depth;
     }
+}
 
-    opcode = decode_patch_operation(patch, case_sensitive);
-    if (opcode == INVALID)
-    {
-        status = 3;
-        goto cleanup;
-    }
-    else if (opcode == TEST)
+static void log_change(patch_transaction * const transaction, const enum patch_undo_kind kind, cJSON * const parent, cJSON * const item, const size_t index)
+{
+    patch_undo *entry = &transaction->log[transaction->log_length++];
+
+    memset(entry, '\0', sizeof(patch_undo));
+    entry->kind = kind;
+    entry->parent = parent;
+    entry->item = item;
+    entry->index = index;
+    entry->owned = true;
+}
+
+static void detach_logged(patch_transaction * const transaction, cJSON * const parent, cJSON * const item)
+{
+    log_change(transaction, UNDO_REMOVED, parent, item, get_item_index(parent, item));
+    cJSON_DetachItemViaPointer(parent, item);
+}
+
+/* adds value as the last token of path says, returns the status of the patch */
+static int add_logged(patch_transaction * const transaction, const cJSONUtils_CompiledPointer * const path, cJSON * const value, const cJSON_bool moved)
+{
+    const pointer_token *child = NULL;
+    cJSON *parent = NULL;
+
+    if ((path == NULL) || (path->count == 0))
     {
-        /* compare value: {...} with the given path */
-        status = !compare_json(get_item_from_pointer(object, path->valuestring, case_sensitive), get_object_item(patch, "value", case_sensitive), case_sensitive);
-        goto cleanup;
+        return 9;
     }
+    child = &path->tokens[path->count - 1];
+    parent = resolve_pointer(transaction, path, path->count - 1);
+    invalidate_below(transaction, path->count - 1);
 
-    /* special case for replacing the root */
-    if (path->valuestring[0] == '\0')
+    if (cJSON_IsArray(parent))
     {
-        if (opcode == REMOVE)
+        if ((child->length == 1) && (child->key[0] == '-'))
+        {
+            if (!cJSON_AddItemToArray(parent, value))
+            {
+                return 8;
+            }
+        }
+        else if (!child->is_index)
+        {
+            return 11;
+        }
+        else if (!insert_item_in_array(parent, child->index, value))
         {
-            static const cJSON invalid = { NULL, NULL, NULL, cJSON_Invalid, NULL, 0, 0, NULL};
+            return 10;
+        }
+
+        log_change(transaction, UNDO_ADDED, parent, value, 0);
+        return 0;
+    }
 
-            overwrite_item(object, invalid);
+    if (cJSON_IsObject(parent))
+    {
+        cJSON *existing = get_item_from_token(parent, child, transaction->case_sensitive);
+        char *string = value->string;
+        int string_type = value->type & cJSON_StringIsConst;
 
-            status = 0;
-            goto cleanup;
+        if (existing != NULL)
+        {
+            detach_logged(transaction, parent, existing);
         }
 
-        if ((opcode == REPLACE) || (opcode == ADD))
+        /* the key of a moved item is kept in case it has to be moved back */
+        if (moved)
         {
-            value = get_object_item(patch, "value", case_sensitive);
-            if (value == NULL)
+            value->string = NULL;
+            value->type &= ~cJSON_StringIsConst;
+        }
+        if (!cJSON_AddItemToObject(parent, (const char*)child->key, value))
+        {
+            if (moved)
             {
-                /* missing "value" for add/replace. */
-                status = 7;
-                goto cleanup;
+                value->string = string;
+                value->type |= string_type;
             }
+            return 8;
+        }
 
-            value = cJSON_Duplicate(value, 1);
-            if (value == NULL)
-            {
-                /* out of memory for add/replace. */
-                status = 8;
-                goto cleanup;
-            }
+        log_change(transaction, UNDO_ADDED, parent, value, 0);
+        if (moved)
+        {
+            transaction->log[transaction->log_length - 1].string = string;
+            transaction->log[transaction->log_length - 1].string_type = string_type;
+        }
+        return 0;
+    }
+
+    /* Couldn't find object to add to. */
+    return 9;
+}
+
+/* With CJSON_INLINE_STRINGS, cJSON keeps short strings in the valuedouble of their item, they aren't allocated on their own */
+static cJSON_bool is_inline_string(const cJSON * const item, const char * const string)
+{
+    return (string != NULL) && (string == (const char*)&item->valuedouble);
+}
+
+/* replace the contents of the root in place, the replacement itself is freed */
+static void replace_root_logged(patch_transaction * const transaction, cJSON * const replacement)
+{
+    cJSON * const root = transaction->root;
+    cJSON *child = NULL;
+
+    log_change(transaction, UNDO_ROOT, NULL, root, 0);
+    transaction->log[transaction->log_length - 1].contents = *root;
+    invalidate_below(transaction, 0);
+
+    root->type = cJSON_Invalid;
+    root->child = NULL;
+    root->valuestring = NULL;
+    root->valueint = 0;
+    root->valuedouble = 0;
+    if (replacement != NULL)
+    {
+        root->type = replacement->type & ~cJSON_StringIsConst;
+        root->valuestring = replacement->valuestring;
+        root->valueint = replacement->valueint;
+        root->valuedouble = replacement->valuedouble;
+        if (is_inline_string(replacement, replacement->valuestring))
+        {
+            root->valuestring = (char*)&root->valuedouble;
+        }
+        child = replacement->child;
+        if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+        {
+            cJSON_free(replacement->string);
+        }
+        cJSON_free(replacement);
+    }
+    cJSON_MarkDirty(root);
+
+    /* link the children through the core API so parent links of a tracked root stay valid */
+    while (child != NULL)
+    {
+        cJSON *next = child->next;
+        child->prev = NULL;
+        child->next = NULL;
+        cJSON_AddItemToArray(root, child);
+        child = next;
+    }
+}
+
+/* free what a cJSON held besides its key, contents is a copy of item */
+static void free_contents(const cJSON * const contents, const cJSON * const item)
+{
+    if (contents->type & cJSON_IsReference)
+    {
+        return;
+    }
+    if (contents->child != NULL)
+    {
+        cJSON_Delete(contents->child);
+    }
+    if ((contents->valuestring != NULL) && !is_inline_string(item, contents->valuestring))
+    {
+        cJSON_free(contents->valuestring);
+    }
+}
 
-            overwrite_item(object, *value);
+static void rollback_transaction(patch_transaction * const transaction)
+{
+    while (transaction->log_length > 0)
+    {
+        patch_undo *entry = &transaction->log[--transaction->log_length];
+        switch (entry->kind)
+        {
+            case UNDO_ADDED:
+                cJSON_DetachItemViaPointer(entry->parent, entry->item);
+                if (entry->owned)
+                {
+                    cJSON_Delete(entry->item);
+                }
+                else if (entry->string != NULL)
+                {
+                    /* give the moved item its key back */
+                    cJSON_free(entry->item->string);
+                    entry->item->string = entry->string;
+                    entry->item->type |= entry->string_type;
+                }
+                break;
 
-            /* delete the duplicated value */
-            cJSON_free(value);
-            value = NULL;
+            case UNDO_REMOVED:
+                insert_item_in_array(entry->parent, entry->index, entry->item);
+                break;
 
-            /* the string "value" isn't needed */
-            if (object->string != NULL)
+            case UNDO_ROOT:
             {
-                cJSON_free(object->string);
-                object->string = NULL;
+                cJSON * const root = entry->item;
+                cJSON current = *root;
+                current.string = NULL;
+                free_contents(&current, root);
+
+                root->type = entry->contents.type;
+                root->child = entry->contents.child;
+                root->valuestring = entry->contents.valuestring;
+                root->valueint = entry->contents.valueint;
+                root->valuedouble = entry->contents.valuedouble;
+                cJSON_MarkDirty(root);
+                break;
             }
 
-            status = 0;
-            goto cleanup;
+            default:
+                break;
         }
     }
+}
+
+static void commit_transaction(patch_transaction * const transaction)
+{
+    size_t position = 0;
 
-    if ((opcode == REMOVE) || (opcode == REPLACE))
+    for (position = 0; position < transaction->log_length; position++)
+    {
+        patch_undo *entry = &transaction->log[position];
+        switch (entry->kind)
+        {
+            case UNDO_ADDED:
+                if ((entry->string != NULL) && !(entry->string_type & cJSON_StringIsConst))
+                {
+                    cJSON_free(entry->string);
+                }
+                break;
+
+            case UNDO_REMOVED:
+                if (entry->owned)
+                {
+                    cJSON_Delete(entry->item);
+                }
+                break;
+
+            case UNDO_ROOT:
+                free_contents(&entry->contents, entry->item);
+                break;
+
+            default:
+                break;
+        }
+    }
+    transaction->log_length = 0;
+}
+
+static int apply_compiled_patch(patch_transaction * const transaction, const compiled_patch * const patch)
+{
+    const cJSONUtils_CompiledPointer * const path = patch->path;
+    cJSON *value = NULL;
+    int status = 0;
+
+    if (patch->status != 0)
+    {
+        return patch->status;
+    }
+
+    if (patch->opcode == TEST)
+    {
+        /* compare value: {...} with the given path */
+        value = resolve_pointer(transaction, path, (path != NULL) ? path->count : 0);
+        return !cJSON_Compare(value, get_object_item(patch->patch, "value", transaction->case_sensitive), transaction->case_sensitive);
+    }
+
+    /* special case for replacing the root */
+    if ((path != NULL) && (path->count == 0) && (patch->opcode != MOVE) && (patch->opcode != COPY))
+    {
+        if (patch->opcode == REMOVE)
+        {
+            replace_root_logged(transaction, NULL);
+            return 0;
+        }
+
+        value = get_object_item(patch->patch, "value", transaction->case_sensitive);
+        if (value == NULL)
+        {
+            /* missing "value" for add/replace. */
+            return 7;
+        }
+        value = cJSON_Duplicate(value, 1);
+        if (value == NULL)
+        {
+            /* out of memory for add/replace. */
+            return 8;
+        }
+        replace_root_logged(transaction, value);
+        return 0;
+    }
+
+    if ((patch->opcode == REMOVE) || (patch->opcode == REPLACE))
     {
         /* Get rid of old. */
-        cJSON *old_item = detach_path(object, (unsigned char*)path->valuestring, case_sensitive);
+        cJSON *parent = NULL;
+        cJSON *old_item = NULL;
+        if ((path != NULL) && (path->count > 0))
+        {
+            parent = resolve_pointer(transaction, path, path->count - 1);
+            old_item = resolve_pointer(transaction, path, path->count);
+        }
         if (old_item == NULL)
         {
-            status = 13;
-            goto cleanup;
+            return 13;
         }
-        cJSON_Delete(old_item);
-        if (opcode == REMOVE)
+        detach_logged(transaction, parent, old_item);
+        invalidate_below(transaction, path->count - 1);
+        if (patch->opcode == REMOVE)
         {
             /* For Remove, this job is done. */
-            status = 0;
-            goto cleanup;
+            return 0;
         }
     }
 
     /* Copy/Move uses "from". */
-    if ((opcode == MOVE) || (opcode == COPY))
+    if ((patch->opcode == MOVE) || (patch->opcode == COPY))
+    {
+        const cJSONUtils_CompiledPointer * const from = patch->from;
+        cJSON *from_parent = NULL;
+
+        if ((from != NULL) && (from->count > 0))
+        {
+            from_parent = resolve_pointer(transaction, from, from->count - 1);
+        }
+        value = resolve_pointer(transaction, from, (from != NULL) ? from->count : 0);
+        if (value == NULL)
+        {
+            /* missing "from" for copy/move. */
+            return 5;
+        }
+
+        if (patch->opcode == COPY)
+        {
+            value = cJSON_Duplicate(value, 1);
+            if (value == NULL)
+            {
+                /* out of memory for copy/move. */
+                return 6;
+            }
+        }
+        else if (from_parent == NULL)
+        {
+            /* can't move the root */
+            return 5;
+        }
+        else
+        {
+            size_t removal = transaction->log_length;
+            detach_logged(transaction, from_parent, value);
+            invalidate_below(transaction, from->count - 1);
+
+            status = add_logged(transaction, path, value, true);
+            if (status == 0)
+            {
+                /* the item lives on at the new place */
+                transaction->log[removal].owned = false;
+                transaction->log[transaction->log_length - 1].owned = false;
+            }
+            return status;
+        }
+    }
+    else /* Add/Replace uses "value". */
+    {
+        value = get_object_item(patch->patch, "value", transaction->case_sensitive);
+        if (value == NULL)
+        {
+            /* missing "value" for add/replace. */
+            return 7;
+        }
+        value = cJSON_Duplicate(value, 1);
+        if (value == NULL)
+        {
+            /* out of memory for add/replace. */
+            return 8;
+        }
+    }
+
+    /* Now, just add "value" to "path". */
+    status = add_logged(transaction, path, value, false);
+    if (status != 0)
+    {
+        cJSON_Delete(value);
+    }
+
+    return status;
+}
+
+static int apply_patches(cJSON * const object, const cJSON * const patches, const cJSON_bool case_sensitive, const cJSON_bool atomic)
+{
+    patch_transaction transaction;
+    compiled_patch *compiled = NULL;
+    const cJSON *current_patch = NULL;
+    size_t count = 0;
+    size_t position = 0;
+    size_t max_depth = 0;
+    int status = 0;
+
+    if (!cJSON_IsArray(patches) || (object == NULL))
+    {
+        /* malformed patches. */
+        return 1;
+    }
+
+    for (current_patch = patches->child; current_patch != NULL; current_patch = current_patch->next)
+    {
+        count++;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    memset(&transaction, '\0', sizeof(transaction));
+    transaction.root = object;
+    transaction.case_sensitive = case_sensitive;
+
+    /* an operation logs at most three changes (remove, remove the replaced member, add) */
+    transaction.log = (patch_undo*)cJSON_malloc(count * 3 * sizeof(patch_undo));
+    compiled = (compiled_patch*)cJSON_malloc(count * sizeof(compiled_patch));
+    if ((transaction.log == NULL) || (compiled == NULL))
+    {
+        status = 8;
+        goto cleanup;
+    }
+    memset(compiled, '\0', count * sizeof(compiled_patch));
+
+    for (current_patch = patches->child, position = 0; current_patch != NULL; current_patch = current_patch->next, position++)
+    {
+        compiled_patch *patch = &compiled[position];
+        cJSON *path = get_object_item(current_patch, "path", case_sensitive);
+
+        patch->patch = current_patch;
+        if (!cJSON_IsString(path))
+        {
+            /* malformed patch. */
+            patch->status = 2;
+            continue;
+        }
+
+        patch->opcode = decode_patch_operation(current_patch, case_sensitive);
+        if (patch->opcode == INVALID)
+        {
+            patch->status = 3;
+            continue;
+        }
+
+        /* pointers that don't compile can't be found */
+        patch->path = compile_pointer(path->valuestring, case_sensitive);
+        if ((patch->path != NULL) && (patch->path->count > max_depth))
+        {
+            max_depth = patch->path->count;
+        }
+
+        if ((patch->opcode == MOVE) || (patch->opcode == COPY))
+        {
+            cJSON *from = get_object_item(current_patch, "from", case_sensitive);
+            if (from == NULL)
+            {
+                /* missing "from" for copy/move. */
+                patch->status = 4;
+                continue;
+            }
+            if (cJSON_IsString(from))
+            {
+                patch->from = compile_pointer(from->valuestring, case_sensitive);
+            }
+            if ((patch->from != NULL) && (patch->from->count > max_depth))
+            {
+                max_depth = patch->from->count;
+            }
+        }
+    }
+
+    transaction.nodes = (cJSON**)cJSON_malloc((max_depth + 1) * sizeof(cJSON*));
+    if ((transaction.nodes == NULL) || !cJSON_Expand(object))
+    {
+        status = 8;
+        goto cleanup;
+    }
+    transaction.nodes[0] = object;
+
+    for (position = 0; (position < count) && (status == 0); position++)
+    {
+        status = apply_compiled_patch(&transaction, &compiled[position]);
+    }
+
+    if ((status != 0) && atomic)
+    {
+        rollback_transaction(&transaction);
+    }
+    else
+    {
+        commit_transaction(&transaction);
+    }
+
+cleanup:
+    if (compiled != NULL)
+    {
+        for (position = 0; position < count; position++)
+        {
+            cJSONUtils_DeleteCompiledPointer(compiled[position].path);
+            cJSONUtils_DeleteCompiledPointer(compiled[position].from);
+        }
+        cJSON_free(compiled);
+    }
+    if (transaction.log != NULL)
+    {
+        cJSON_free(transaction.log);
+    }
+    if (transaction.nodes != NULL)
+    {
+        cJSON_free(transaction.nodes);
+    }
+
+    return status;
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, false, false);
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, true, false);
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomic(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, false, true);
+}
+
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomicCaseSensitive(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, true, true);
+}
+
+static void compose_patch(cJSON * const patches, const unsigned char * const operation, const unsigned char * const path, const unsigned char *suffix, const cJSON * const value)
+{
+    cJSON *patch = NULL;
+
+    if ((patches == NULL) || (operation == NULL) || (path == NULL))
+    {
+        return;
+    }
+
+    patch = cJSON_CreateObject();
+    if (patch == NULL)
+    {
+        return;
+    }
+    cJSON_AddItemToObject(patch, "op", cJSON_CreateString((const char*)operation));
+
+    if (suffix == NULL)
+    {
+        cJSON_AddItemToObject(patch, "path", cJSON_CreateString((const char*)path));
+    }
+    else
+    {
+        size_t suffix_length = pointer_encoded_length(suffix);
+        size_t path_length = strlen((const char*)path);
+        unsigned char *full_path = (unsigned char*)cJSON_malloc(path_length + suffix_length + sizeof("/"));
+
+        sprintf((char*)full_path, "%s/", (const char*)path);
+        encode_string_as_pointer(full_path + path_length + 1, suffix);
+
+        cJSON_AddItemToObject(patch, "path", cJSON_CreateString((const char*)full_path));
+        cJSON_free(full_path);
+    }
+
+    if (value != NULL)
+    {
+        cJSON_AddItemToObject(patch, "value", cJSON_Duplicate(value, 1));
+    }
+    cJSON_AddItemToArray(patches, patch);
+}
+
+CJSON_PUBLIC(void) cJSONUtils_AddPatchToArray(cJSON * const array, const char * const operation, const char * const path, const cJSON * const value)
+{
+    compose_patch(array, (const unsigned char*)operation, (const unsigned char*)path, NULL, value);
+}
+
+/* subtrees with equal cached hashes (see cJSON_CacheHashes) don't have to be diffed */
+static cJSON_bool identical_by_hash(const cJSON * const a, const cJSON * const b)
+{
+    cJSON_HashValue a_hash;
+    cJSON_HashValue b_hash;
+
+    return cJSON_GetCachedHash(a, &a_hash) && cJSON_GetCachedHash(b, &b_hash) && (memcmp(a_hash.words, b_hash.words, sizeof(a_hash.words)) == 0);
+}
+
+/* Minimal array diff: Myers' algorithm on the hashes of the elements finds the longest common subsequence,
+ * equal elements that were removed in one place and added in another become moves and the remaining
+ * removals and additions between two common elements are paired up and diffed recursively. */
+#define NO_INDEX ((size_t)-1)
+#define MOVED_INDEX ((size_t)-2)
+/* The trace of Myers' algorithm grows with the square of the edit distance. Beyond this many edits
+ * between the common prefix and suffix the arrays are treated as completely different. */
+#define MAX_ARRAY_EDIT_DISTANCE 1024
+
+typedef struct
+{
+    size_t from_index; /* NO_INDEX for additions */
+    size_t to_index; /* NO_INDEX for removals */
+} array_edit;
+
+static void create_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const cJSON_bool minimal_arrays, const size_t depth);
+
+static cJSON_bool hashes_equal(const cJSON_HashValue * const a, const cJSON_HashValue * const b)
+{
+    return memcmp(a->words, b->words, sizeof(a->words)) == 0;
+}
+
+/* Where the furthest reaching path on diagonal k after d edits starts, before following equal elements.
+ * previous holds the results for d - 1, indexed by k + d - 1. Returns -1 if diagonal k can't be reached. */
+static long myers_start(const long * const previous, const long d, const long k, const long n, const long m, long * const previous_k)
+{
+    long down = -1;
+    long right = -1;
+
+    if (k < d)
+    {
+        /* add an element of b */
+        down = previous[k + 1 + d - 1];
+        if ((down >= 0) && ((down - k) > m))
+        {
+            down = -1;
+        }
+    }
+    if (k > -d)
+    {
+        /* remove an element of a */
+        right = previous[k - 1 + d - 1];
+        if ((right >= 0) && ((right + 1) <= n))
+        {
+            right++;
+        }
+        else
+        {
+            right = -1;
+        }
+    }
+
+    if (down >= right)
+    {
+        *previous_k = k + 1;
+        return down;
+    }
+
+    *previous_k = k - 1;
+    return right;
+}
+
+/* Writes the edit script between a[0..n) and b[0..m) to the end of edits (room for n + m entries),
+ * indices are shifted by offset. Returns the index of the first edit, NO_INDEX if the distance
+ * is too large or memory runs out. */
+static size_t myers_diff(const cJSON_HashValue * const a, const long n, const cJSON_HashValue * const b, const long m, const size_t offset, array_edit * const edits)
+{
+    long *trace = NULL;
+    size_t trace_capacity = 0;
+    long max_distance = ((n + m) < MAX_ARRAY_EDIT_DISTANCE) ? (n + m) : MAX_ARRAY_EDIT_DISTANCE;
+    long distance = -1;
+    long d = 0;
+    long k = 0;
+    long x = 0;
+    long y = 0;
+    size_t position = (size_t)(n + m);
+
+    /* the results for d edits are stored at trace[d * d], indexed by k + d */
+    for (d = 0; (d <= max_distance) && (distance < 0); d++)
+    {
+        size_t needed = (size_t)((d + 1) * (d + 1));
+        long *current = NULL;
+        const long *previous = NULL;
+        long previous_k = 0;
+
+        if (needed > trace_capacity)
+        {
+            size_t new_capacity = (trace_capacity == 0) ? 64 : (trace_capacity * 2);
+            long *new_trace = NULL;
+            while (new_capacity < needed)
+            {
+                new_capacity *= 2;
+            }
+            new_trace = (long*)cJSON_malloc(new_capacity * sizeof(long));
+            if (new_trace == NULL)
+            {
+                goto fail;
+            }
+            if (trace != NULL)
+            {
+                memcpy(new_trace, trace, trace_capacity * sizeof(long));
+                cJSON_free(trace);
+            }
+            trace = new_trace;
+            trace_capacity = new_capacity;
+        }
+        current = trace + (d * d);
+        previous = (d > 0) ? (trace + ((d - 1) * (d - 1))) : NULL;
+
+        for (k = -d; k <= d; k += 2)
+        {
+            x = (d == 0) ? 0 : myers_start(previous, d, k, n, m, &previous_k);
+            if (x >= 0)
+            {
+                for (y = x - k; (x < n) && (y < m) && hashes_equal(&a[x], &b[y]); (void)x++, y++)
+                {
+                }
+                if ((x >= n) && ((x - k) >= m))
+                {
+                    current[k + d] = x;
+                    distance = d;
+                    break;
+                }
+            }
+            current[k + d] = x;
+        }
+    }
+
+    if (distance < 0)
+    {
+        goto fail;
+    }
+
+    /* walk back from the end */
+    x = n;
+    y = m;
+    for (d = distance; d > 0; d--)
+    {
+        long previous_k = 0;
+        long start = 0;
+
+        k = x - y;
+        start = myers_start(trace + ((d - 1) * (d - 1)), d, k, n, m, &previous_k);
+        for (; x > start; (void)x--, y--)
+        {
+            position--;
+            edits[position].from_index = offset + (size_t)(x - 1);
+            edits[position].to_index = offset + (size_t)(y - 1);
+        }
+        position--;
+        if (previous_k == (k + 1))
+        {
+            edits[position].from_index = NO_INDEX;
+            edits[position].to_index = offset + (size_t)(y - 1);
+            y--;
+        }
+        else
+        {
+            edits[position].from_index = offset + (size_t)(x - 1);
+            edits[position].to_index = NO_INDEX;
+            x--;
+        }
+    }
+    for (; x > 0; (void)x--, y--)
+    {
+        position--;
+        edits[position].from_index = offset + (size_t)(x - 1);
+        edits[position].to_index = offset + (size_t)(y - 1);
+    }
+
+    cJSON_free(trace);
+
+    return position;
+
+fail:
+    if (trace != NULL)
+    {
+        cJSON_free(trace);
+    }
+
+    return NO_INDEX;
+}
+
+/* Fenwick trees count the elements that were moved away from ahead of the current position
+ * and the ones that are still waiting to be moved further back. */
+static void fenwick_add(size_t * const tree, const size_t size, size_t index)
+{
+    for (index++; index <= size; index += index & (~index + 1))
+    {
+        tree[index - 1]++;
+    }
+}
+
+static void fenwick_remove(size_t * const tree, const size_t size, size_t index)
+{
+    for (index++; index <= size; index += index & (~index + 1))
+    {
+        tree[index - 1]--;
+    }
+}
+
+/* number of marked indices below index */
+static size_t fenwick_count(const size_t * const tree, size_t index)
+{
+    size_t count = 0;
+    for (; index > 0; index -= index & (~index + 1))
+    {
+        count += tree[index - 1];
+    }
+
+    return count;
+}
+
+typedef struct
+{
+    cJSON *patches;
+    const unsigned char *path;
+    unsigned char *element_path;
+    cJSON **from_items;
+    cJSON **to_items;
+    size_t from_count;
+    size_t *move_target; /* per element of from: index in to, NO_INDEX or MOVED_INDEX */
+    size_t *move_source; /* per element of to: index in from or NO_INDEX */
+    size_t *taken; /* fenwick tree over from, elements that were moved back already */
+    size_t *waiting; /* fenwick tree over waiting_order */
+    size_t *waiting_order; /* per element of from that waits to be moved */
+    size_t *waiting_position; /* number of placed elements when it started waiting */
+    size_t waiting_count;
+    size_t next_waiting_order;
+    /* the patched array consists of 'placed' elements of to (with the waiting elements between them)
+     * followed by the elements of from starting at 'cursor' that weren't moved yet */
+    size_t placed;
+    size_t cursor;
+    cJSON_bool case_sensitive;
+    size_t depth; /* of the arrays */
+} array_patcher;
+
+static void compose_index_patch(array_patcher * const patcher, const char * const operation, const size_t index, const cJSON * const value)
+{
+    unsigned char suffix[24];
+    sprintf((char*)suffix, "%lu", (unsigned long)index);
+    compose_patch(patcher->patches, (const unsigned char*)operation, patcher->path, suffix, value);
+}
+
+static void compose_move_patch(array_patcher * const patcher, const size_t from_index, const size_t to_index)
+{
+    cJSON *patch = NULL;
+    size_t path_length = strlen((const char*)patcher->path);
+
+    if (from_index == to_index)
+    {
+        return;
+    }
+
+    patch = cJSON_CreateObject();
+    if (patch == NULL)
+    {
+        return;
+    }
+    cJSON_AddItemToObject(patch, "op", cJSON_CreateString("move"));
+    sprintf((char*)patcher->element_path + path_length, "/%lu", (unsigned long)from_index);
+    cJSON_AddItemToObject(patch, "from", cJSON_CreateString((const char*)patcher->element_path));
+    sprintf((char*)patcher->element_path + path_length, "/%lu", (unsigned long)to_index);
+    cJSON_AddItemToObject(patch, "path", cJSON_CreateString((const char*)patcher->element_path));
+    cJSON_AddItemToArray(patcher->patches, patch);
+}
+
+/* an element of from that isn't kept or diffed */
+static void patch_removed_element(array_patcher * const patcher, const size_t from_index)
+{
+    size_t target = patcher->move_target[from_index];
+
+    if (target == NO_INDEX)
+    {
+        compose_index_patch(patcher, "remove", patcher->placed + patcher->waiting_count, NULL);
+    }
+    else if (target != MOVED_INDEX)
+    {
+        /* it has to go further back, leave it where it is for now */
+        patcher->waiting_order[from_index] = patcher->next_waiting_order++;
+        patcher->waiting_position[from_index] = patcher->placed;
+        fenwick_add(patcher->waiting, patcher->from_count, patcher->waiting_order[from_index]);
+        patcher->waiting_count++;
+    }
+    patcher->cursor = from_index + 1;
+}
+
+/* an element of to that isn't kept or diffed */
+static void patch_added_element(array_patcher * const patcher, const size_t to_index)
+{
+    size_t source = patcher->move_source[to_index];
+
+    if (source == NO_INDEX)
+    {
+        compose_index_patch(patcher, "add", patcher->placed + patcher->waiting_count, patcher->to_items[to_index]);
+    }
+    else if (source < patcher->cursor)
+    {
+        /* the element is waiting behind the current position */
+        size_t order = patcher->waiting_order[source];
+        size_t source_position = patcher->waiting_position[source] + fenwick_count(patcher->waiting, order);
+        fenwick_remove(patcher->waiting, patcher->from_count, order);
+        patcher->waiting_count--;
+        compose_move_patch(patcher, source_position, patcher->placed + patcher->waiting_count);
+    }
+    else
+    {
+        /* the element is still ahead */
+        size_t moved_before = fenwick_count(patcher->taken, source) - fenwick_count(patcher->taken, patcher->cursor);
+        size_t source_position = patcher->placed + patcher->waiting_count + (source - patcher->cursor) - moved_before;
+        compose_move_patch(patcher, source_position, patcher->placed + patcher->waiting_count);
+        fenwick_add(patcher->taken, patcher->from_count, source);
+        patcher->move_target[source] = MOVED_INDEX;
+    }
+    patcher->placed++;
+}
+
+static void patch_changed_element(array_patcher * const patcher, const size_t from_index, const size_t to_index)
+{
+    size_t path_length = strlen((const char*)patcher->path);
+
+    sprintf((char*)patcher->element_path + path_length, "/%lu", (unsigned long)(patcher->placed + patcher->waiting_count));
+    create_patches(patcher->patches, patcher->element_path, patcher->from_items[from_index], patcher->to_items[to_index], patcher->case_sensitive, true, patcher->depth + 1);
+    patcher->placed++;
+    patcher->cursor = from_index + 1;
+}
+
+/* Process the removals and additions between two common elements. Elements that are moved are handled
+ * first, the others are paired up in order and diffed, whatever is left over is removed or added. */
+static void patch_array_gap(array_patcher * const patcher, const array_edit * const edits, const size_t count)
+{
+    size_t removal = 0;
+    size_t addition = 0;
+
+    for (;;)
     {
-        cJSON *from = get_object_item(patch, "from", case_sensitive);
-        if (from == NULL)
+        while ((removal < count) && ((edits[removal].to_index != NO_INDEX) || (patcher->move_target[edits[removal].from_index] != NO_INDEX)))
         {
-            /* missing "from" for copy/move. */
-            status = 4;
-            goto cleanup;
+            if (edits[removal].to_index == NO_INDEX)
+            {
+                patch_removed_element(patcher, edits[removal].from_index);
+            }
+            removal++;
         }
-
-        if (opcode == MOVE)
+        while ((addition < count) && ((edits[addition].from_index != NO_INDEX) || (patcher->move_source[edits[addition].to_index] != NO_INDEX)))
         {
-            value = detach_path(object, (unsigned char*)from->valuestring, case_sensitive);
+            if (edits[addition].from_index == NO_INDEX)
+            {
+                patch_added_element(patcher, edits[addition].to_index);
+            }
+            addition++;
         }
-        if (opcode == COPY)
+
+        if ((removal < count) && (addition < count))
         {
-            value = get_item_from_pointer(object, from->valuestring, case_sensitive);
+            patch_changed_element(patcher, edits[removal].from_index, edits[addition].to_index);
+            removal++;
+            addition++;
         }
-        if (value == NULL)
+        else if (removal < count)
         {
-            /* missing "from" for copy/move. */
-            status = 5;
-            goto cleanup;
+            patch_removed_element(patcher, edits[removal].from_index);
+            removal++;
         }
-        if (opcode == COPY)
+        else if (addition < count)
         {
-            value = cJSON_Duplicate(value, 1);
+            patch_added_element(patcher, edits[addition].to_index);
+            addition++;
         }
-        if (value == NULL)
+        else
         {
-            /* out of memory for copy/move. */
-            status = 6;
-            goto cleanup;
+            break;
         }
     }
-    else /* Add/Replace uses "value". */
-    {
-        value = get_object_item(patch, "value", case_sensitive);
-        if (value == NULL)
-        {
-            /* missing "value" for add/replace. */
-            status = 7;
-            goto cleanup;
-        }
-        value = cJSON_Duplicate(value, 1);
-        if (value == NULL)
+}
+
+/* Pair up removed and added elements with equal hashes. Removed elements with the same hash are
+ * chained in order in a temporary table, the first unused one is used for the next addition. */
+static cJSON_bool find_moves(array_patcher * const patcher, const cJSON_HashValue * const from_hashes, const cJSON_HashValue * const to_hashes, const array_edit * const edits, const size_t count)
+{
+    size_t *table = NULL;
+    size_t *first = NULL; /* element of the chain for comparing hashes, NO_INDEX for empty slots */
+    size_t *unused = NULL; /* first unused element of the chain */
+    size_t *last = NULL; /* last element of the chain */
+    size_t *next = NULL; /* per element of from */
+    size_t capacity = 1;
+    size_t removals = 0;
+    size_t edit = 0;
+
+    for (edit = 0; edit < count; edit++)
+    {
+        if (edits[edit].to_index == NO_INDEX)
         {
-            /* out of memory for add/replace. */
-            status = 8;
-            goto cleanup;
+            removals++;
         }
     }
-
-    /* Now, just add "value" to "path". */
-
-    /* split pointer in parent and child */
-    parent_pointer = cJSONUtils_strdup((unsigned char*)path->valuestring);
-    if (parent_pointer) {
-        child_pointer = (unsigned char*)strrchr((char*)parent_pointer, '/');
+    if ((removals == 0) || (removals == count))
+    {
+        /* nothing to pair */
+        return true;
     }
-    if (child_pointer != NULL)
+    while (capacity < (removals * 2))
     {
-        child_pointer[0] = '\0';
-        child_pointer++;
+        capacity *= 2;
     }
-    parent = get_item_from_pointer(object, (char*)parent_pointer, case_sensitive);
-    decode_pointer_inplace(child_pointer);
-
-    /* add, remove, replace, move, copy, test. */
-    if ((parent == NULL) || (child_pointer == NULL))
+    table = (size_t*)cJSON_malloc(((capacity * 3) + patcher->from_count) * sizeof(size_t));
+    if (table == NULL)
     {
-        /* Couldn't find object to add to. */
-        status = 9;
-        goto cleanup;
+        return false;
+    }
+    first = table;
+    unused = table + capacity;
+    last = table + (capacity * 2);
+    next = table + (capacity * 3);
+    for (edit = 0; edit < capacity; edit++)
+    {
+        first[edit] = NO_INDEX;
     }
-    else if (cJSON_IsArray(parent))
+
+    for (edit = 0; edit < count; edit++)
     {
-        if (strcmp((char*)child_pointer, "-") == 0)
+        size_t from_index = edits[edit].from_index;
+        size_t slot = 0;
+        if (edits[edit].to_index != NO_INDEX)
         {
-            cJSON_AddItemToArray(parent, value);
-            value = NULL;
+            continue;
         }
-        else
+        for (slot = from_hashes[from_index].words[0] & (capacity - 1); first[slot] != NO_INDEX; slot = (slot + 1) & (capacity - 1))
         {
-            size_t index = 0;
-            if (!decode_array_index_from_pointer(child_pointer, &index))
-            {
-                status = 11;
-                goto cleanup;
-            }
-
-            if (!insert_item_in_array(parent, index, value))
+            if (hashes_equal(&from_hashes[first[slot]], &from_hashes[from_index]))
             {
-                status = 10;
-                goto cleanup;
+                break;
             }
-            value = NULL;
         }
-    }
-    else if (cJSON_IsObject(parent))
-    {
-        if (case_sensitive)
+        next[from_index] = NO_INDEX;
+        if (first[slot] == NO_INDEX)
         {
-            cJSON_DeleteItemFromObjectCaseSensitive(parent, (char*)child_pointer);
+            first[slot] = from_index;
+            unused[slot] = from_index;
         }
         else
         {
-            cJSON_DeleteItemFromObject(parent, (char*)child_pointer);
+            next[last[slot]] = from_index;
         }
-        cJSON_AddItemToObject(parent, (char*)child_pointer, value);
-        value = NULL;
+        last[slot] = from_index;
     }
-    else /* parent is not an object */
+
+    for (edit = 0; edit < count; edit++)
     {
-        /* Couldn't find object to add to. */
-        status = 9;
-        goto cleanup;
+        size_t to_index = edits[edit].to_index;
+        size_t slot = 0;
+        if (edits[edit].from_index != NO_INDEX)
+        {
+            continue;
+        }
+        for (slot = to_hashes[to_index].words[0] & (capacity - 1); first[slot] != NO_INDEX; slot = (slot + 1) & (capacity - 1))
+        {
+            if (hashes_equal(&from_hashes[first[slot]], &to_hashes[to_index]))
+            {
+                size_t from_index = unused[slot];
+                if (from_index != NO_INDEX)
+                {
+                    patcher->move_target[from_index] = to_index;
+                    patcher->move_source[to_index] = from_index;
+                    unused[slot] = next[from_index];
+                }
+                break;
+            }
+        }
     }
 
-cleanup:
-    if (value != NULL)
+    cJSON_free(table);
+
+    return true;
+}
+
+/* Returns false without generating any patches if memory runs out. */
+static cJSON_bool create_minimal_array_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const size_t depth)
+{
+    array_patcher patcher;
+    cJSON_HashValue *from_hashes = NULL;
+    cJSON_HashValue *to_hashes = NULL;
+    array_edit *edits = NULL;
+    size_t *indices = NULL;
+    size_t to_count = 0;
+    size_t count = 0;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    size_t middle_start = 0;
+    size_t index = 0;
+    cJSON *child = NULL;
+    cJSON_bool success = false;
+
+    memset(&patcher, 0, sizeof(patcher));
+    patcher.patches = patches;
+    patcher.path = path;
+    patcher.case_sensitive = case_sensitive;
+    patcher.depth = depth;
+
+    for (child = from->child; child != NULL; child = child->next)
     {
-        cJSON_Delete(value);
+        patcher.from_count++;
     }
-    if (parent_pointer != NULL)
+    for (child = to->child; child != NULL; child = child->next)
     {
-        cJSON_free(parent_pointer);
+        to_count++;
+    }
+    /* myers_diff works with signed indices */
+    if ((patcher.from_count > (size_t)(LONG_MAX / 2)) || (to_count > (size_t)(LONG_MAX / 2)))
+    {
+        return false;
     }
 
-    return status;
-}
-
-CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches)
-{
-    const cJSON *current_patch = NULL;
-    int status = 0;
+    patcher.element_path = (unsigned char*)cJSON_malloc(strlen((const char*)path) + 20 + sizeof("/")); /* Allow space for 64bit int. log10(2^64) = 20 */
+    patcher.from_items = (cJSON**)cJSON_malloc((patcher.from_count + to_count + 1) * sizeof(cJSON*));
+    from_hashes = (cJSON_HashValue*)cJSON_malloc((patcher.from_count + to_count + 1) * sizeof(cJSON_HashValue));
+    edits = (array_edit*)cJSON_malloc((patcher.from_count + to_count + 1) * sizeof(array_edit));
+    /* move_target, taken, waiting, waiting_order and waiting_position per element of from, move_source per element of to */
+    indices = (size_t*)cJSON_malloc(((patcher.from_count * 5) + to_count + 1) * sizeof(size_t));
+    if ((patcher.element_path == NULL) || (patcher.from_items == NULL) || (from_hashes == NULL) || (edits == NULL) || (indices == NULL))
+    {
+        goto cleanup;
+    }
+    /* the element paths are written after the path of the array */
+    strcpy((char*)patcher.element_path, (const char*)path);
+    patcher.to_items = patcher.from_items + patcher.from_count;
+    to_hashes = from_hashes + patcher.from_count;
+    patcher.move_target = indices;
+    patcher.taken = indices + patcher.from_count;
+    patcher.waiting = indices + (patcher.from_count * 2);
+    patcher.waiting_order = indices + (patcher.from_count * 3);
+    patcher.waiting_position = indices + (patcher.from_count * 4);
+    patcher.move_source = indices + (patcher.from_count * 5);
 
-    if (!cJSON_IsArray(patches))
+    for (child = from->child, index = 0; child != NULL; child = child->next, index++)
     {
-        /* malformed patches. */
-        return 1;
+        patcher.from_items[index] = child;
+        from_hashes[index] = cJSON_Hash(child);
+        patcher.move_target[index] = NO_INDEX;
+        patcher.taken[index] = 0;
+        patcher.waiting[index] = 0;
+    }
+    for (child = to->child, index = 0; child != NULL; child = child->next, index++)
+    {
+        patcher.to_items[index] = child;
+        to_hashes[index] = cJSON_Hash(child);
+        patcher.move_source[index] = NO_INDEX;
     }
 
-    if (patches != NULL)
+    /* the common prefix and suffix are kept */
+    while ((prefix < patcher.from_count) && (prefix < to_count) && hashes_equal(&from_hashes[prefix], &to_hashes[prefix]))
+    {
+        edits[count].from_index = prefix;
+        edits[count].to_index = prefix;
+        count++;
+        prefix++;
+    }
+    while (((prefix + suffix) < patcher.from_count) && ((prefix + suffix) < to_count)
+            && hashes_equal(&from_hashes[patcher.from_count - suffix - 1], &to_hashes[to_count - suffix - 1]))
     {
-        current_patch = patches->child;
+        suffix++;
     }
 
-    while (current_patch != NULL)
+    middle_start = myers_diff(from_hashes + prefix, (long)(patcher.from_count - prefix - suffix), to_hashes + prefix, (long)(to_count - prefix - suffix), prefix, edits + count);
+    if (middle_start == NO_INDEX)
     {
-        status = apply_patch(object, current_patch, false);
-        if (status != 0)
+        /* too different, remove everything in between and add the new elements */
+        for (index = prefix; index < (patcher.from_count - suffix); index++)
         {
-            return status;
+            edits[count].from_index = index;
+            edits[count].to_index = NO_INDEX;
+            count++;
+        }
+        for (index = prefix; index < (to_count - suffix); index++)
+        {
+            edits[count].from_index = NO_INDEX;
+            edits[count].to_index = index;
+            count++;
         }
-        current_patch = current_patch->next;
     }
-
-    return 0;
-}
-
-CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches)
-{
-    const cJSON *current_patch = NULL;
-    int status = 0;
-
-    if (!cJSON_IsArray(patches))
+    else
     {
-        /* malformed patches. */
-        return 1;
+        size_t middle_count = patcher.from_count + to_count - (2 * (prefix + suffix)) - middle_start;
+        memmove(edits + count, edits + count + middle_start, middle_count * sizeof(array_edit));
+        count += middle_count;
+    }
+    for (index = suffix; index > 0; index--)
+    {
+        edits[count].from_index = patcher.from_count - index;
+        edits[count].to_index = to_count - index;
+        count++;
     }
 
-    if (patches != NULL)
+    if (!find_moves(&patcher, from_hashes, to_hashes, edits, count))
     {
-        current_patch = patches->child;
+        goto cleanup;
     }
 
-    while (current_patch != NULL)
+    for (index = 0; index < count;)
     {
-        status = apply_patch(object, current_patch, true);
-        if (status != 0)
+        size_t gap_end = index;
+        if ((edits[index].from_index != NO_INDEX) && (edits[index].to_index != NO_INDEX))
         {
-            return status;
+            /* kept */
+            patcher.placed++;
+            patcher.cursor = edits[index].from_index + 1;
+            index++;
+            continue;
         }
-        current_patch = current_patch->next;
-    }
-
-    return 0;
-}
 
-static void compose_patch(cJSON * const patches, const unsigned char * const operation, const unsigned char * const path, const unsigned char *suffix, const cJSON * const value)
-{
-    cJSON *patch = NULL;
+        while ((gap_end < count) && ((edits[gap_end].from_index == NO_INDEX) || (edits[gap_end].to_index == NO_INDEX)))
+        {
+            gap_end++;
+        }
+        patch_array_gap(&patcher, edits + index, gap_end - index);
+        index = gap_end;
+    }
+    success = true;
 
-    if ((patches == NULL) || (operation == NULL) || (path == NULL))
+cleanup:
+    if (patcher.element_path != NULL)
     {
-        return;
+        cJSON_free(patcher.element_path);
     }
-
-    patch = cJSON_CreateObject();
-    if (patch == NULL)
+    if (patcher.from_items != NULL)
     {
-        return;
+        cJSON_free(patcher.from_items);
     }
-    cJSON_AddItemToObject(patch, "op", cJSON_CreateString((const char*)operation));
-
-    if (suffix == NULL)
+    if (from_hashes != NULL)
     {
-        cJSON_AddItemToObject(patch, "path", cJSON_CreateString((const char*)path));
+        cJSON_free(from_hashes);
     }
-    else
+    if (edits != NULL)
     {
-        size_t suffix_length = pointer_encoded_length(suffix);
-        size_t path_length = strlen((const char*)path);
-        unsigned char *full_path = (unsigned char*)cJSON_malloc(path_length + suffix_length + sizeof("/"));
-
-        sprintf((char*)full_path, "%s/", (const char*)path);
-        encode_string_as_pointer(full_path + path_length + 1, suffix);
-
-        cJSON_AddItemToObject(patch, "path", cJSON_CreateString((const char*)full_path));
-        cJSON_free(full_path);
+        cJSON_free(edits);
     }
-
-    if (value != NULL)
+    if (indices != NULL)
     {
-        cJSON_AddItemToObject(patch, "value", cJSON_Duplicate(value, 1));
+        cJSON_free(indices);
     }
-    cJSON_AddItemToArray(patches, patch);
-}
 
-CJSON_PUBLIC(void) cJSONUtils_AddPatchToArray(cJSON * const array, const char * const operation, const char * const path, const cJSON * const value)
-{
-    compose_patch(array, (const unsigned char*)operation, (const unsigned char*)path, NULL, value);
+    return success;
 }
 
-static void create_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive)
+static void create_patches(cJSON * const patches, const unsigned char * const path, cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const cJSON_bool minimal_arrays, const size_t depth)
 {
-    if ((from == NULL) || (to == NULL))
+    if ((from == NULL) || (to == NULL) || identical_by_hash(from, to))
+    {
+        return;
+    }
+    if (!expand_deferred(from) || !expand_deferred(to))
     {
         return;
     }
@@ -1150,6 +2585,15 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
         compose_patch(patches, (const unsigned char*)"replace", path, 0, to);
         return;
     }
+    /* this recurses, arrays and objects deeper than the parser's limit are replaced as a whole instead */
+    if ((depth >= CJSON_NESTING_LIMIT) && (cJSON_IsArray(from) || cJSON_IsObject(from)))
+    {
+        if (!cJSON_Compare(from, to, case_sensitive))
+        {
+            compose_patch(patches, (const unsigned char*)"replace", path, NULL, to);
+        }
+        return;
+    }
 
     switch (from->type & 0xFF)
     {
@@ -1170,9 +2614,24 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
         case cJSON_Array:
         {
             size_t index = 0;
-            cJSON *from_child = from->child;
-            cJSON *to_child = to->child;
-            unsigned char *new_path = (unsigned char*)cJSON_malloc(strlen((const char*)path) + 20 + sizeof("/")); /* Allow space for 64bit int. log10(2^64) = 20 */
+            cJSON *from_child = NULL;
+            cJSON *to_child = NULL;
+            unsigned char *new_path = NULL;
+
+            /* packed arrays are compared item by item */
+            if (((from->type & cJSON_IsPacked) && !cJSON_Expand(from)) || ((to->type & cJSON_IsPacked) && !cJSON_Expand(to)))
+            {
+                return;
+            }
+            from_child = from->child;
+            to_child = to->child;
+
+            if (minimal_arrays && create_minimal_array_patches(patches, path, from, to, case_sensitive, depth))
+            {
+                return;
+            }
+
+            new_path = (unsigned char*)cJSON_malloc(strlen((const char*)path) + 20 + sizeof("/")); /* Allow space for 64bit int. log10(2^64) = 20 */
 
             /* generate patches for all array elements that exist in both "from" and "to" */
             for (index = 0; (from_child != NULL) && (to_child != NULL); (void)(from_child = from_child->next), (void)(to_child = to_child->next), index++)
@@ -1186,7 +2645,7 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
                     return;
                 }
                 sprintf((char*)new_path, "%s/%lu", path, (unsigned long)index); /* path of the current array element */
-                create_patches(patches, new_path, from_child, to_child, case_sensitive);
+                create_patches(patches, new_path, from_child, to_child, case_sensitive, minimal_arrays, depth + 1);
             }
 
             /* remove leftover elements from 'from' that are not in 'to' */
@@ -1249,7 +2708,7 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
                     encode_string_as_pointer(new_path + path_length + 1, (unsigned char*)from_child->string);
 
                     /* create a patch for the element */
-                    create_patches(patches, new_path, from_child, to_child, case_sensitive);
+                    create_patches(patches, new_path, from_child, to_child, case_sensitive, minimal_arrays, depth + 1);
                     cJSON_free(new_path);
 
                     from_child = from_child->next;
@@ -1288,7 +2747,7 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * con
     }
 
     patches = cJSON_CreateArray();
-    create_patches(patches, (const unsigned char*)"", from, to, false);
+    create_patches(patches, (const unsigned char*)"", from, to, false, false, 0);
 
     return patches;
 }
@@ -1303,7 +2762,37 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from
     }
 
     patches = cJSON_CreateArray();
-    create_patches(patches, (const unsigned char*)"", from, to, true);
+    create_patches(patches, (const unsigned char*)"", from, to, true, false, 0);
+
+    return patches;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMinimalPatches(cJSON * const from, cJSON * const to)
+{
+    cJSON *patches = NULL;
+
+    if ((from == NULL) || (to == NULL))
+    {
+        return NULL;
+    }
+
+    patches = cJSON_CreateArray();
+    create_patches(patches, (const unsigned char*)"", from, to, false, true, 0);
+
+    return patches;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMinimalPatchesCaseSensitive(cJSON * const from, cJSON * const to)
+{
+    cJSON *patches = NULL;
+
+    if ((from == NULL) || (to == NULL))
+    {
+        return NULL;
+    }
+
+    patches = cJSON_CreateArray();
+    create_patches(patches, (const unsigned char*)"", from, to, true, true, 0);
 
     return patches;
 }
@@ -1311,14 +2800,18 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from
 CJSON_PUBLIC(void) cJSONUtils_SortObject(cJSON * const object)
 {
     sort_object(object, false);
+    cJSON_MarkDirty(object);
 }
 
 CJSON_PUBLIC(void) cJSONUtils_SortObjectCaseSensitive(cJSON * const object)
 {
     sort_object(object, true);
+    cJSON_MarkDirty(object);
 }
 
-static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_bool case_sensitive)
+/* 'owned' is the same item as patch if the patch is consumed: values are moved out of it instead of being duplicated.
+ * This recurses, depth is how many objects are above patch. */
+static cJSON *merge_patch(cJSON *target, const cJSON * const patch, cJSON * const owned, const cJSON_bool case_sensitive, const size_t depth)
 {
     cJSON *patch_child = NULL;
 
@@ -1326,8 +2819,18 @@ static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_
     {
         /* scalar value, array or NULL, just duplicate */
         cJSON_Delete(target);
+        if (owned != NULL)
+        {
+            return owned;
+        }
         return cJSON_Duplicate(patch, 1);
     }
+    if (depth >= CJSON_NESTING_LIMIT)
+    {
+        /* nested deeper than the parser allows */
+        cJSON_Delete(target);
+        return NULL;
+    }
 
     if (!cJSON_IsObject(target))
     {
@@ -1335,9 +2838,18 @@ static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_
         target = cJSON_CreateObject();
     }
 
-    patch_child = patch->child;
+    /* values moved out of the patch have to be its own */
+    if (!expand_deferred(target) || ((owned != NULL) && (!expand_deferred(owned) || !cJSON_Unshare(owned))))
+    {
+        cJSON_Delete(target);
+        return NULL;
+    }
+
+    /* a deferred patch is expanded like by cJSON_ArrayForEach */
+    patch_child = cJSON_GetFirstChild(patch);
     while (patch_child != NULL)
     {
+        cJSON *next = patch_child->next;
         if (cJSON_IsNull(patch_child))
         {
             /* NULL is the indicator to remove a value, see RFC7396 */
@@ -1354,6 +2866,7 @@ static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_
         {
             cJSON *replace_me = NULL;
             cJSON *replacement = NULL;
+            cJSON *owned_child = NULL;
 
             if (case_sensitive)
             {
@@ -1364,31 +2877,66 @@ static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_
                 replace_me = cJSON_DetachItemFromObject(target, patch_child->string);
             }
 
-            replacement = merge_patch(replace_me, patch_child, case_sensitive);
+            if (owned != NULL)
+            {
+                owned_child = patch_child;
+                if (!cJSON_IsObject(patch_child))
+                {
+                    /* the value itself is moved over */
+                    cJSON_DetachItemViaPointer(owned, patch_child);
+                }
+            }
+
+            replacement = merge_patch(replace_me, patch_child, owned_child, case_sensitive, depth + 1);
             if (replacement == NULL)
             {
                 cJSON_Delete(target);
                 return NULL;
             }
 
+            /* the key of a moved value is duplicated before the old one is freed */
             cJSON_AddItemToObject(target, patch_child->string, replacement);
         }
-        patch_child = patch_child->next;
+        patch_child = next;
     }
     return target;
 }
 
 CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatch(cJSON *target, const cJSON * const patch)
 {
-    return merge_patch(target, patch, false);
+    return merge_patch(target, patch, NULL, false, 0);
 }
 
 CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchCaseSensitive(cJSON *target, const cJSON * const patch)
 {
-    return merge_patch(target, patch, true);
+    return merge_patch(target, patch, NULL, true, 0);
 }
 
-static cJSON *generate_merge_patch(cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive)
+static cJSON *merge_patch_consume(cJSON *target, cJSON * const patch, const cJSON_bool case_sensitive)
+{
+    cJSON *merged = merge_patch(target, patch, patch, case_sensitive, 0);
+    if (merged != patch)
+    {
+        /* whatever wasn't moved out of the patch */
+        cJSON_Delete(patch);
+    }
+
+    return merged;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchConsume(cJSON *target, cJSON * const patch)
+{
+    return merge_patch_consume(target, patch, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchConsumeCaseSensitive(cJSON *target, cJSON * const patch)
+{
+    return merge_patch_consume(target, patch, true);
+}
+
+/* if move is set, values are moved out of 'to' into the patch instead of being duplicated.
+ * This recurses, depth is how many objects are above from and to. */
+static cJSON *generate_merge_patch(cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive, const cJSON_bool move, const size_t depth)
 {
     cJSON *from_child = NULL;
     cJSON *to_child = NULL;
@@ -1402,9 +2950,24 @@ static cJSON *generate_merge_patch(cJSON * const from, cJSON * const to, const c
     {
         return cJSON_Duplicate(to, 1);
     }
+    if (identical_by_hash(from, to))
+    {
+        /* no patch needed */
+        return NULL;
+    }
+    if ((depth >= CJSON_NESTING_LIMIT) || !expand_deferred(from) || !expand_deferred(to))
+    {
+        /* nested deeper than the parser allows or out of memory */
+        return NULL;
+    }
 
     sort_object(from, case_sensitive);
     sort_object(to, case_sensitive);
+    /* values moved out of 'to' have to be its own */
+    if (move && !cJSON_Unshare(to))
+    {
+        return NULL;
+    }
 
     from_child = from->child;
     to_child = to->child;
@@ -1442,22 +3005,48 @@ static cJSON *generate_merge_patch(cJSON * const from, cJSON * const to, const c
         else if (diff > 0)
         {
             /* to has a value that from doesn't have -> add to patch */
-            cJSON_AddItemToObject(patch, to_child->string, cJSON_Duplicate(to_child, 1));
+            cJSON *next = to_child->next;
+            if (move)
+            {
+                cJSON_DetachItemViaPointer(to, to_child);
+                cJSON_AddItemToObject(patch, to_child->string, to_child);
+            }
+            else
+            {
+                cJSON_AddItemToObject(patch, to_child->string, cJSON_Duplicate(to_child, 1));
+            }
 
-            to_child = to_child->next;
+            to_child = next;
         }
         else
         {
             /* object key exists in both objects */
-            if (!compare_json(from_child, to_child, case_sensitive))
+            cJSON *next = to_child->next;
+            if (!cJSON_Compare(from_child, to_child, case_sensitive))
             {
                 /* not identical --> generate a patch */
-                cJSON_AddItemToObject(patch, to_child->string, cJSONUtils_GenerateMergePatch(from_child, to_child));
+                if (move && !(cJSON_IsObject(from_child) && cJSON_IsObject(to_child)))
+                {
+                    /* the patch is the new value itself */
+                    cJSON_DetachItemViaPointer(to, to_child);
+                    cJSON_AddItemToObject(patch, to_child->string, to_child);
+                }
+                else
+                {
+                    cJSON *child_patch = generate_merge_patch(from_child, to_child, case_sensitive, move, depth + 1);
+                    if (child_patch == NULL)
+                    {
+                        /* they differ, so the only reason for no patch is an error */
+                        cJSON_Delete(patch);
+                        return NULL;
+                    }
+                    cJSON_AddItemToObject(patch, to_child->string, child_patch);
+                }
             }
 
             /* next key in the object */
             from_child = from_child->next;
-            to_child = to_child->next;
+            to_child = next;
         }
     }
     if (patch->child == NULL)
@@ -1472,10 +3061,36 @@ static cJSON *generate_merge_patch(cJSON * const from, cJSON * const to, const c
 
 CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatch(cJSON * const from, cJSON * const to)
 {
-    return generate_merge_patch(from, to, false);
+    return generate_merge_patch(from, to, false, false, 0);
 }
 
 CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchCaseSensitive(cJSON * const from, cJSON * const to)
 {
-    return generate_merge_patch(from, to, true);
+    return generate_merge_patch(from, to, true, false, 0);
+}
+
+static cJSON *generate_merge_patch_move(cJSON * const from, cJSON * const to, const cJSON_bool case_sensitive)
+{
+    cJSON *patch = NULL;
+
+    if ((to != NULL) && (!cJSON_IsObject(to) || !cJSON_IsObject(from)))
+    {
+        /* the patch is 'to' itself */
+        return to;
+    }
+
+    patch = generate_merge_patch(from, to, case_sensitive, true, 0);
+    cJSON_Delete(to);
+
+    return patch;
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchMove(cJSON * const from, cJSON * const to)
+{
+    return generate_merge_patch_move(from, to, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchMoveCaseSensitive(cJSON * const from, cJSON * const to)
+{
+    return generate_merge_patch_move(from, to, true);
 }
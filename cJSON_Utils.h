@@ -34,45 +34,57 @@ extern "C"
 CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointer(cJSON * const object, const char *pointer);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, const char *pointer);
 
+/* Pointers that are evaluated repeatedly can be compiled once: the reference tokens are decoded,
+ * array indices parsed and keys hashed up front. Returns NULL for invalid pointers.
+ * The compiled pointer has to be released with cJSONUtils_DeleteCompiledPointer. */
+typedef struct cJSONUtils_CompiledPointer cJSONUtils_CompiledPointer;
+CJSON_PUBLIC(cJSONUtils_CompiledPointer *) cJSONUtils_CompilePointer(const char *pointer);
+CJSON_PUBLIC(cJSONUtils_CompiledPointer *) cJSONUtils_CompilePointerCaseSensitive(const char *pointer);
+CJSON_PUBLIC(void) cJSONUtils_DeleteCompiledPointer(cJSONUtils_CompiledPointer *pointer);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetCompiledPointer(cJSON * const object, const cJSONUtils_CompiledPointer * const pointer);
+/* Evaluates 'count' compiled pointers against the same object, results[i] receives the item for pointers[i] or NULL.
+ * Pointers that share a prefix only walk it once. Returns 0 on invalid arguments or allocation failure. */
+CJSON_PUBLIC(cJSON_bool) cJSONUtils_GetCompiledPointers(cJSON * const object, const cJSONUtils_CompiledPointer * const * const pointers, const size_t count, cJSON ** const results);
+
 /* Implement RFC6902 (https://tools.ietf.org/html/rfc6902) JSON Patch spec. */
 /* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
+/* Arrays and objects nested CJSON_NESTING_LIMIT levels deep or deeper are replaced as a whole when they differ. */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * const to);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from, cJSON * const to);
+/* Like cJSONUtils_GeneratePatches, but array elements are matched by their structural hash (see cJSON_Hash)
+ * instead of their index, so insertions, removals and reorderings produce few "add", "remove" and "move"
+ * operations. Elements that changed between two equal ones are diffed recursively. */
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMinimalPatches(cJSON * const from, cJSON * const to);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMinimalPatchesCaseSensitive(cJSON * const from, cJSON * const to);
 /* Utility for generating patch array entries. */
 CJSON_PUBLIC(void) cJSONUtils_AddPatchToArray(cJSON * const array, const char * const operation, const char * const path, const cJSON * const value);
 /* Returns 0 for success. */
 CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches);
 CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches);
 
-/*
-// Note that ApplyPatches is NOT atomic on failure. To implement an atomic ApplyPatches, use:
-//int cJSONUtils_AtomicApplyPatches(cJSON **object, cJSON *patches)
-//{
-//    cJSON *modme = cJSON_Duplicate(*object, 1);
-//    int error = cJSONUtils_ApplyPatches(modme, patches);
-//    if (!error)
-//    {
-//        cJSON_Delete(*object);
-//        *object = modme;
-//    }
-//    else
-//    {
-//        cJSON_Delete(modme);
-//    }
-//
-//    return error;
-//}
-// Code not added to library since this strategy is a LOT slower.
-*/
+/* Note that ApplyPatches is NOT atomic on failure: the operations before the failing one stay applied.
+ * ApplyPatchesAtomic keeps an undo log instead and restores the document if any operation fails. */
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomic(cJSON * const object, const cJSON * const patches);
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesAtomicCaseSensitive(cJSON * const object, const cJSON * const patches);
 
 /* Implement RFC7386 (https://tools.ietf.org/html/rfc7396) JSON Merge Patch spec. */
 /* target will be modified by patch. return value is new ptr for target. */
+/* Fails (returns NULL and deletes target) for objects in patch that are nested CJSON_NESTING_LIMIT levels deep. */
 CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatch(cJSON *target, const cJSON * const patch);
 CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchCaseSensitive(cJSON *target, const cJSON * const patch);
+/* Like MergePatch, but patch is consumed: its values are moved into target instead of being duplicated.
+ * The patch must not be used afterwards, it may have become (part of) the returned target. */
+CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchConsume(cJSON *target, cJSON * const patch);
+CJSON_PUBLIC(cJSON *) cJSONUtils_MergePatchConsumeCaseSensitive(cJSON *target, cJSON * const patch);
 /* generates a patch to move from -> to */
 /* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
+/* Returns NULL if there is no difference, but also if the objects that differ are nested CJSON_NESTING_LIMIT levels deep. */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatch(cJSON * const from, cJSON * const to);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchCaseSensitive(cJSON * const from, cJSON * const to);
+/* Like GenerateMergePatch, but 'to' is consumed: changed values are moved into the patch instead of being
+ * duplicated and the rest of 'to' is deleted. */
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchMove(cJSON * const from, cJSON * const to);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateMergePatchMoveCaseSensitive(cJSON * const from, cJSON * const to);
 
 /* Given a root object and a target object, construct a pointer from one to the other. */
 CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromObjectTo(const cJSON * const object, const cJSON * const target);
@@ -0,0 +1,674 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+#if defined(_MSC_VER)
+#pragma warning (push)
+/* disable warning about single line comments in system headers */
+#pragma warning (disable : 4001)
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#if defined(_MSC_VER)
+#pragma warning (pop)
+#endif
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+
+#include "cJSON_Writer.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+/* Streaming writer: values are printed into a buffer as they are written, without building a tree.
+ * The formatting is the same as cJSON_Print/cJSON_PrintUnformatted. Writers with a callback hand the text
+ * over whenever WRITER_CHUNK_SIZE bytes are collected. */
+#define WRITER_CHUNK_SIZE 4096
+
+/* flags of an open array or object */
+#define WRITER_OBJECT 1
+#define WRITER_HAS_ITEMS 2
+#define WRITER_HAS_KEY 4
+
+struct cJSON_Writer
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+    size_t depth; /* the number of open arrays and objects */
+    cJSON_bool format;
+    unsigned char *levels;
+    size_t capacity;
+    cJSON_Printer *printer; /* prints the trees of cJSON_Writer_Item, created when it is first needed */
+    cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length);
+    void *context;
+    cJSON_bool failed;
+    cJSON_bool complete; /* the top level value was written */
+};
+
+static cJSON_bool writer_fail(cJSON_Writer * const writer)
+{
+    writer->failed = true;
+    return false;
+}
+
+/* Make room for needed more bytes and the terminating zero, returns where they go. */
+static unsigned char *writer_reserve(cJSON_Writer * const writer, const size_t needed)
+{
+    unsigned char *new_buffer = NULL;
+    size_t new_length = 0;
+
+    if (needed >= ((size_t)-1) - writer->offset)
+    {
+        return NULL;
+    }
+    if ((writer->offset + needed) < writer->length)
+    {
+        return writer->buffer + writer->offset;
+    }
+
+    new_length = writer->offset + needed + 1;
+    if (new_length <= (((size_t)-1) / 2))
+    {
+        new_length *= 2;
+    }
+    new_buffer = (unsigned char*)cJSON_malloc(new_length);
+    if (new_buffer == NULL)
+    {
+        return NULL;
+    }
+    memcpy(new_buffer, writer->buffer, writer->offset + 1);
+    cJSON_free(writer->buffer);
+    writer->buffer = new_buffer;
+    writer->length = new_length;
+
+    return writer->buffer + writer->offset;
+}
+
+static cJSON_bool writer_append(cJSON_Writer * const writer, const char * const data, const size_t length)
+{
+    unsigned char *output_pointer = writer_reserve(writer, length);
+    if (output_pointer == NULL)
+    {
+        return writer_fail(writer);
+    }
+    memcpy(output_pointer, data, length);
+    output_pointer[length] = '\0';
+    writer->offset += length;
+
+    return true;
+}
+
+static cJSON_bool writer_indent(cJSON_Writer * const writer, const size_t depth)
+{
+    unsigned char *output_pointer = writer_reserve(writer, depth);
+    if (output_pointer == NULL)
+    {
+        return writer_fail(writer);
+    }
+    memset(output_pointer, '\t', depth);
+    output_pointer[depth] = '\0';
+    writer->offset += depth;
+
+    return true;
+}
+
+/* Same escaping as cJSON_Print uses for strings and keys. */
+static cJSON_bool writer_string(cJSON_Writer * const writer, const unsigned char * const input)
+{
+    const unsigned char *input_pointer = NULL;
+    unsigned char *output = NULL;
+    unsigned char *output_pointer = NULL;
+    size_t output_length = 0;
+    /* numbers of additional characters needed for escaping */
+    size_t escape_characters = 0;
+
+    for (input_pointer = input; *input_pointer; input_pointer++)
+    {
+        switch (*input_pointer)
+        {
+            case '\"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+                /* one character escape sequence */
+                escape_characters++;
+                break;
+            default:
+                if (*input_pointer < 32)
+                {
+                    /* UTF-16 escape sequence uXXXX */
+                    escape_characters += 5;
+                }
+                break;
+        }
+    }
+    output_length = (size_t)(input_pointer - input) + escape_characters;
+
+    output = writer_reserve(writer, output_length + sizeof("\"\"") - 1);
+    if (output == NULL)
+    {
+        return writer_fail(writer);
+    }
+
+    output[0] = '\"';
+    output_pointer = output + 1;
+    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    {
+        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
+        {
+            /* normal character, copy */
+            *output_pointer = *input_pointer;
+        }
+        else
+        {
+            /* character needs to be escaped */
+            *output_pointer++ = '\\';
+            switch (*input_pointer)
+            {
+                case '\\':
+                    *output_pointer = '\\';
+                    break;
+                case '\"':
+                    *output_pointer = '\"';
+                    break;
+                case '\b':
+                    *output_pointer = 'b';
+                    break;
+                case '\f':
+                    *output_pointer = 'f';
+                    break;
+                case '\n':
+                    *output_pointer = 'n';
+                    break;
+                case '\r':
+                    *output_pointer = 'r';
+                    break;
+                case '\t':
+                    *output_pointer = 't';
+                    break;
+                default:
+                    /* escape and print as unicode codepoint */
+                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
+                    output_pointer += 4;
+                    break;
+            }
+        }
+    }
+    output[output_length + 1] = '\"';
+    output[output_length + 2] = '\0';
+    writer->offset += output_length + 2;
+
+    return true;
+}
+
+static cJSON_bool writer_flush(cJSON_Writer * const writer)
+{
+    if ((writer->offset > 0) && !writer->write(writer->context, (const char*)writer->buffer, writer->offset))
+    {
+        return writer_fail(writer);
+    }
+    writer->offset = 0;
+    writer->buffer[0] = '\0';
+
+    return true;
+}
+
+/* Called before every value: checks that a value may follow and prints the separator in front of it. */
+static cJSON_bool writer_begin_value(cJSON_Writer * const writer)
+{
+    unsigned char *level = NULL;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+    if (writer->depth == 0)
+    {
+        /* only one value at the top level */
+        return writer->complete ? writer_fail(writer) : true;
+    }
+
+    level = &writer->levels[writer->depth - 1];
+    if (*level & WRITER_OBJECT)
+    {
+        if (!(*level & WRITER_HAS_KEY))
+        {
+            return writer_fail(writer); /* values in objects need a key */
+        }
+        *level &= (unsigned char)~WRITER_HAS_KEY;
+        return true;
+    }
+
+    if ((*level & WRITER_HAS_ITEMS) && !writer_append(writer, ", ", writer->format ? 2 : 1))
+    {
+        return false;
+    }
+    *level |= WRITER_HAS_ITEMS;
+
+    return true;
+}
+
+/* Called after every value. */
+static cJSON_bool writer_end_value(cJSON_Writer * const writer)
+{
+    if (writer->depth == 0)
+    {
+        writer->complete = true;
+    }
+    if ((writer->write != NULL) && (writer->offset >= WRITER_CHUNK_SIZE))
+    {
+        return writer_flush(writer);
+    }
+
+    return true;
+}
+
+static cJSON_bool writer_begin_container(cJSON_Writer * const writer, const unsigned char flags)
+{
+    if (!writer_begin_value(writer))
+    {
+        return false;
+    }
+    if (writer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return writer_fail(writer);
+    }
+
+    if (writer->depth == writer->capacity)
+    {
+        size_t new_capacity = (writer->capacity == 0) ? 16 : writer->capacity * 2;
+        unsigned char *new_levels = (unsigned char*)cJSON_malloc(new_capacity);
+        if (new_levels == NULL)
+        {
+            return writer_fail(writer);
+        }
+        if (writer->levels != NULL)
+        {
+            memcpy(new_levels, writer->levels, writer->capacity);
+            cJSON_free(writer->levels);
+        }
+        writer->levels = new_levels;
+        writer->capacity = new_capacity;
+    }
+
+    if (flags & WRITER_OBJECT)
+    {
+        /* fmt: {\n */
+        if (!writer_append(writer, "{\n", writer->format ? 2 : 1))
+        {
+            return false;
+        }
+    }
+    else if (!writer_append(writer, "[", 1))
+    {
+        return false;
+    }
+    writer->levels[writer->depth] = flags;
+    writer->depth++;
+
+    return true;
+}
+
+static cJSON_bool writer_end_container(cJSON_Writer * const writer, const unsigned char flags)
+{
+    unsigned char level = 0;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+    if (writer->depth == 0)
+    {
+        return writer_fail(writer);
+    }
+    level = writer->levels[writer->depth - 1];
+    if (((level & WRITER_OBJECT) != flags) || (level & WRITER_HAS_KEY))
+    {
+        return writer_fail(writer); /* wrong kind of container or a key without value */
+    }
+
+    if ((flags & WRITER_OBJECT) && writer->format)
+    {
+        if (((level & WRITER_HAS_ITEMS) && !writer_append(writer, "\n", 1)) || !writer_indent(writer, writer->depth - 1))
+        {
+            return false;
+        }
+    }
+    if (!writer_append(writer, (flags & WRITER_OBJECT) ? "}" : "]", 1))
+    {
+        return false;
+    }
+    writer->depth--;
+
+    return writer_end_value(writer);
+}
+
+static cJSON_Writer *create_writer(const cJSON_bool format, cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length), void *context)
+{
+    cJSON_Writer *writer = (cJSON_Writer*)cJSON_malloc(sizeof(cJSON_Writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    memset(writer, '\0', sizeof(cJSON_Writer));
+
+    writer->buffer = (unsigned char*)cJSON_malloc(WRITER_CHUNK_SIZE);
+    if (writer->buffer == NULL)
+    {
+        cJSON_free(writer);
+        return NULL;
+    }
+    writer->buffer[0] = '\0';
+    writer->length = WRITER_CHUNK_SIZE;
+    writer->format = format;
+    writer->write = write;
+    writer->context = context;
+
+    return writer;
+}
+
+CJSON_PUBLIC(cJSON_Writer *) cJSON_Writer_Create(cJSON_bool format)
+{
+    return create_writer(format, NULL, NULL);
+}
+
+CJSON_PUBLIC(cJSON_Writer *) cJSON_Writer_CreateToCallback(cJSON_bool format, cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length), void *context)
+{
+    if (write == NULL)
+    {
+        return NULL;
+    }
+
+    return create_writer(format, write, context);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_BeginObject(cJSON_Writer *writer)
+{
+    return writer_begin_container(writer, WRITER_OBJECT);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_EndObject(cJSON_Writer *writer)
+{
+    return writer_end_container(writer, WRITER_OBJECT);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_BeginArray(cJSON_Writer *writer)
+{
+    return writer_begin_container(writer, 0);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_EndArray(cJSON_Writer *writer)
+{
+    return writer_end_container(writer, 0);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Key(cJSON_Writer *writer, const char *key)
+{
+    unsigned char *level = NULL;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+    if ((key == NULL) || (writer->depth == 0))
+    {
+        return writer_fail(writer);
+    }
+    level = &writer->levels[writer->depth - 1];
+    if (!(*level & WRITER_OBJECT) || (*level & WRITER_HAS_KEY))
+    {
+        return writer_fail(writer);
+    }
+
+    if ((*level & WRITER_HAS_ITEMS) && !writer_append(writer, ",\n", writer->format ? 2 : 1))
+    {
+        return false;
+    }
+    if (writer->format && !writer_indent(writer, writer->depth))
+    {
+        return false;
+    }
+    if (!writer_string(writer, (const unsigned char*)key) || !writer_append(writer, ":\t", writer->format ? 2 : 1))
+    {
+        return false;
+    }
+    *level |= WRITER_HAS_ITEMS | WRITER_HAS_KEY;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_String(cJSON_Writer *writer, const char *string)
+{
+    if ((string == NULL) || !writer_begin_value(writer))
+    {
+        return (writer != NULL) ? writer_fail(writer) : false;
+    }
+    if (!writer_string(writer, (const unsigned char*)string))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Number(cJSON_Writer *writer, double number)
+{
+    cJSON item;
+    char text[32];
+
+    if (!writer_begin_value(writer))
+    {
+        return false;
+    }
+
+    /* a number item on the stack prints the number exactly like cJSON_Print does */
+    memset(&item, '\0', sizeof(item));
+    item.type = cJSON_Number;
+    cJSON_SetNumberHelper(&item, number);
+    if (!cJSON_PrintPreallocated(&item, text, (int)sizeof(text), false))
+    {
+        return writer_fail(writer);
+    }
+    if (!writer_append(writer, text, strlen(text)))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Bool(cJSON_Writer *writer, cJSON_bool boolean)
+{
+    if (!writer_begin_value(writer))
+    {
+        return false;
+    }
+    if (!(boolean ? writer_append(writer, "true", 4) : writer_append(writer, "false", 5)))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Null(cJSON_Writer *writer)
+{
+    if (!writer_begin_value(writer) || !writer_append(writer, "null", 4))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Raw(cJSON_Writer *writer, const char *raw)
+{
+    if ((raw == NULL) || !writer_begin_value(writer))
+    {
+        return (writer != NULL) ? writer_fail(writer) : false;
+    }
+    if (!writer_append(writer, raw, strlen(raw)))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Item(cJSON_Writer *writer, const cJSON *item)
+{
+    const char *text = NULL;
+    size_t length = 0;
+    size_t start = 0;
+    size_t position = 0;
+
+    if ((item == NULL) || !writer_begin_value(writer))
+    {
+        return (writer != NULL) ? writer_fail(writer) : false;
+    }
+    if (writer->printer == NULL)
+    {
+        writer->printer = cJSON_Printer_Create(writer->format);
+        if (writer->printer == NULL)
+        {
+            return writer_fail(writer);
+        }
+    }
+    text = cJSON_Printer_Print(writer->printer, item, &length);
+    if (text == NULL)
+    {
+        return writer_fail(writer);
+    }
+
+    /* the tree is printed on its own, indent its lines by the open arrays and objects like it was part of them */
+    if (writer->format && (writer->depth > 0))
+    {
+        for (position = 0; position < length; position++)
+        {
+            if ((text[position] == '\n') && (!writer_append(writer, text + start, position + 1 - start) || !writer_indent(writer, writer->depth)))
+            {
+                return false;
+            }
+            if (text[position] == '\n')
+            {
+                start = position + 1;
+            }
+        }
+    }
+    if (!writer_append(writer, text + start, length - start))
+    {
+        return false;
+    }
+
+    return writer_end_value(writer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Finish(cJSON_Writer *writer)
+{
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+    if (!writer->complete || (writer->depth != 0))
+    {
+        return writer_fail(writer);
+    }
+    if (writer->write != NULL)
+    {
+        return writer_flush(writer);
+    }
+
+    return true;
+}
+
+CJSON_PUBLIC(const char *) cJSON_Writer_GetString(const cJSON_Writer *writer, size_t *length)
+{
+    if ((writer == NULL) || writer->failed || !writer->complete || (writer->depth != 0) || (writer->write != NULL))
+    {
+        return NULL;
+    }
+
+    if (length != NULL)
+    {
+        *length = writer->offset;
+    }
+
+    return (const char*)writer->buffer;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Reset(cJSON_Writer *writer)
+{
+    if (writer == NULL)
+    {
+        return false;
+    }
+
+    writer->buffer[0] = '\0';
+    writer->offset = 0;
+    writer->depth = 0;
+    writer->failed = false;
+    writer->complete = false;
+
+    return true;
+}
+
+CJSON_PUBLIC(void) cJSON_Writer_Delete(cJSON_Writer *writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+
+    cJSON_free(writer->buffer);
+    if (writer->levels != NULL)
+    {
+        cJSON_free(writer->levels);
+    }
+    if (writer->printer != NULL)
+    {
+        cJSON_Printer_Delete(writer->printer);
+    }
+    cJSON_free(writer);
+}
@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#ifndef cJSON_Writer__h
+#define cJSON_Writer__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* Prints values as they are written instead of building a tree first, see cJSON_Writer_Create. Opaque. */
+typedef struct cJSON_Writer cJSON_Writer;
+
+/* Write JSON without building a tree: the values are printed as they are written, formatted like cJSON_Print
+ * (format = 1) or cJSON_PrintUnformatted. A writer made with cJSON_Writer_Create collects the text, get it with
+ * cJSON_Writer_GetString after cJSON_Writer_Finish. A writer made with cJSON_Writer_CreateToCallback hands it to
+ * write in chunks instead. Every function returns false once something fails or is written in the wrong place
+ * (like a value in an object without key), the writer stays failed until it is reset.
+ * Reusing a writer with cJSON_Writer_Reset keeps its buffer. */
+CJSON_PUBLIC(cJSON_Writer *) cJSON_Writer_Create(cJSON_bool format);
+CJSON_PUBLIC(cJSON_Writer *) cJSON_Writer_CreateToCallback(cJSON_bool format, cJSON_bool (CJSON_CDECL *write)(void *context, const char *data, size_t length), void *context);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_BeginObject(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_EndObject(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_BeginArray(cJSON_Writer *writer);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_EndArray(cJSON_Writer *writer);
+/* The key of the next value in an object. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Key(cJSON_Writer *writer, const char *key);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_String(cJSON_Writer *writer, const char *string);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Number(cJSON_Writer *writer, double number);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Bool(cJSON_Writer *writer, cJSON_bool boolean);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Null(cJSON_Writer *writer);
+/* Text that is written as it is, like cJSON_CreateRaw. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Raw(cJSON_Writer *writer, const char *raw);
+/* Print an existing tree as the next value. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Item(cJSON_Writer *writer, const cJSON *item);
+/* Check that one complete value was written and hand the rest of it to the callback. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Finish(cJSON_Writer *writer);
+/* The text of a finished writer without callback, valid until the writer is reset or deleted. length may be NULL. */
+CJSON_PUBLIC(const char *) cJSON_Writer_GetString(const cJSON_Writer *writer, size_t *length);
+CJSON_PUBLIC(cJSON_bool) cJSON_Writer_Reset(cJSON_Writer *writer);
+CJSON_PUBLIC(void) cJSON_Writer_Delete(cJSON_Writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
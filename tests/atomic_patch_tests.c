@@ -0,0 +1,161 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_Utils.h"
+
+static const char *document = "{\"name\":\"doc\",\"list\":[1,2,{\"deep\":[true,false]}],\"map\":{\"a\":1,\"b\":[null]},\"empty\":{}}";
+
+/* applies the patches atomically to the document, they have to fail with 'status' and change nothing */
+static void assert_rolled_back(const char * const patches_json, const int status)
+{
+    cJSON *object = cJSON_Parse(document);
+    cJSON *original = cJSON_Parse(document);
+    cJSON *patches = cJSON_Parse(patches_json);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_NOT_NULL(original);
+    TEST_ASSERT_NOT_NULL(patches);
+
+    TEST_ASSERT_EQUAL_INT(status, cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patches));
+    /* member order is restored too */
+    printed = cJSON_PrintUnformatted(object);
+    TEST_ASSERT_EQUAL_STRING(document, printed);
+    TEST_ASSERT_TRUE(cJSON_Compare(object, original, true));
+
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+    cJSON_Delete(original);
+    cJSON_Delete(object);
+}
+
+static void failing_patches_should_be_rolled_back(void)
+{
+    /* every kind of change followed by an operation that fails */
+    assert_rolled_back("[{\"op\":\"add\",\"path\":\"/list/0\",\"value\":0},{\"op\":\"remove\",\"path\":\"/missing\"}]", 13);
+    assert_rolled_back("[{\"op\":\"remove\",\"path\":\"/list/1\"},{\"op\":\"remove\",\"path\":\"/name\"},{\"op\":\"test\",\"path\":\"/name\",\"value\":1}]", 1);
+    assert_rolled_back("[{\"op\":\"replace\",\"path\":\"/map/a\",\"value\":[1,2]},{\"op\":\"add\",\"path\":\"/map/b\",\"value\":2},{\"op\":\"add\",\"path\":\"/list/9\",\"value\":0}]", 10);
+    assert_rolled_back("[{\"op\":\"move\",\"from\":\"/name\",\"path\":\"/map/a\"},{\"op\":\"move\",\"from\":\"/list/2/deep\",\"path\":\"/list/0\"},{\"op\":\"add\",\"path\":\"/list/x\",\"value\":0}]", 11);
+    assert_rolled_back("[{\"op\":\"copy\",\"from\":\"/map\",\"path\":\"/empty/copy\"},{\"op\":\"move\",\"from\":\"/map\",\"path\":\"/map/b/0\"}]", 9);
+    assert_rolled_back("[{\"op\":\"replace\",\"path\":\"\",\"value\":[1]},{\"op\":\"add\",\"path\":\"/-\",\"value\":2},{\"op\":\"copy\",\"from\":\"/5\",\"path\":\"/0\"}]", 5);
+    assert_rolled_back("[{\"op\":\"remove\",\"path\":\"\"},{\"op\":\"add\",\"path\":\"/a\",\"value\":2}]", 9);
+    assert_rolled_back("[{\"op\":\"add\",\"path\":\"/map/c\",\"value\":3},{\"op\":\"unknown\",\"path\":\"/map\"}]", 3);
+}
+
+static void successful_patches_should_match_apply_patches(void)
+{
+    const char *patches_json = "[{\"op\":\"add\",\"path\":\"/list/0\",\"value\":0},{\"op\":\"move\",\"from\":\"/list/3/deep\",\"path\":\"/map/a\"},"
+        "{\"op\":\"copy\",\"from\":\"/map/a\",\"path\":\"/map/b/-\"},{\"op\":\"replace\",\"path\":\"/map/b/0\",\"value\":\"x\"},"
+        "{\"op\":\"remove\",\"path\":\"/list/1\"},{\"op\":\"test\",\"path\":\"/map/b/1/0\",\"value\":true}]";
+    cJSON *patches = cJSON_Parse(patches_json);
+    cJSON *atomic = cJSON_Parse(document);
+    cJSON *sequential = cJSON_Parse(document);
+    char *printed = NULL;
+
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesAtomicCaseSensitive(atomic, patches));
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(sequential, patches));
+    TEST_ASSERT_TRUE(cJSON_Compare(atomic, sequential, true));
+
+    printed = cJSON_PrintUnformatted(atomic);
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"doc\",\"list\":[0,2,{}],\"map\":{\"b\":[\"x\",[true,false]],\"a\":[true,false]},\"empty\":{}}", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(sequential);
+    cJSON_Delete(atomic);
+    cJSON_Delete(patches);
+}
+
+static void rollback_should_keep_parent_links(void)
+{
+    cJSON *object = cJSON_Parse(document);
+    cJSON *patches = cJSON_Parse("[{\"op\":\"move\",\"from\":\"/map/b\",\"path\":\"/list/0\"},{\"op\":\"replace\",\"path\":\"\",\"value\":{}},{\"op\":\"remove\",\"path\":\"/x\"}]");
+    cJSON *map = NULL;
+    cJSON *b = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_TrackParents(object));
+    map = cJSON_GetObjectItem(object, "map");
+    b = cJSON_GetObjectItem(map, "b");
+
+    TEST_ASSERT_EQUAL_INT(13, cJSONUtils_ApplyPatchesAtomic(object, patches));
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(map, "b") == b);
+    TEST_ASSERT_TRUE(cJSON_GetParent(b) == map);
+    TEST_ASSERT_TRUE(cJSON_GetParent(map) == object);
+
+    cJSON_Delete(patches);
+    cJSON_Delete(object);
+}
+
+static void non_atomic_patches_should_keep_earlier_operations(void)
+{
+    cJSON *object = cJSON_Parse(document);
+    cJSON *patches = cJSON_Parse("[{\"op\":\"remove\",\"path\":\"/name\"},{\"op\":\"move\",\"from\":\"/map\",\"path\":\"/missing/map\"}]");
+
+    TEST_ASSERT_EQUAL_INT(9, cJSONUtils_ApplyPatches(object, patches));
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(object, "name"));
+
+    cJSON_Delete(patches);
+    cJSON_Delete(object);
+}
+
+static void replacing_a_short_string_root_should_be_rolled_back(void)
+{
+    cJSON *object = cJSON_Parse("\"old\"");
+    cJSON *failing = cJSON_Parse("[{\"op\":\"replace\",\"path\":\"\",\"value\":\"new\"},{\"op\":\"test\",\"path\":\"\",\"value\":\"other\"}]");
+    cJSON *patches = cJSON_Parse("[{\"op\":\"replace\",\"path\":\"\",\"value\":\"a longer string\"},{\"op\":\"replace\",\"path\":\"\",\"value\":\"new\"}]");
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_NOT_NULL(failing);
+    TEST_ASSERT_NOT_NULL(patches);
+
+    /* with CJSON_INLINE_STRINGS short strings are stored in their item, the root keeps its own copy */
+    TEST_ASSERT_TRUE(cJSONUtils_ApplyPatchesAtomic(object, failing) != 0);
+    TEST_ASSERT_EQUAL_STRING("old", cJSON_GetStringValue(object));
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesAtomic(object, patches));
+    TEST_ASSERT_EQUAL_STRING("new", cJSON_GetStringValue(object));
+#if CJSON_INLINE_STRINGS
+    TEST_ASSERT_TRUE(object->valuestring == (char*)&object->valuedouble);
+#endif
+
+    cJSON_Delete(patches);
+    cJSON_Delete(failing);
+    cJSON_Delete(object);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(failing_patches_should_be_rolled_back);
+    RUN_TEST(successful_patches_should_match_apply_patches);
+    RUN_TEST(rollback_should_keep_parent_links);
+    RUN_TEST(non_atomic_patches_should_keep_earlier_operations);
+    RUN_TEST(replacing_a_short_string_root_should_be_rolled_back);
+
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* the string values are too long to be stored inline (CJSON_INLINE_STRINGS), so every string is allocated */
+static const char message[] = "{\"id\":null,\"name\":\"cached document\",\"tags\":[\"first tag\",\"second tag\"],\"ok\":true}";
+
+static void cache_should_reuse_nodes_and_strings(void)
+{
+    cJSON_CacheStats cache_stats;
+    cJSON_Stats stats;
+    cJSON *tree = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_EnableCache(100, 8));
+    tree = cJSON_Parse(message);
+    TEST_ASSERT_NOT_NULL(tree);
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.node_hits);
+    TEST_ASSERT_EQUAL_UINT(7U, (unsigned int)cache_stats.node_misses);
+    TEST_ASSERT_EQUAL_UINT(7U, (unsigned int)cache_stats.string_misses);
+    cJSON_Delete(tree);
+
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(7U, (unsigned int)cache_stats.cached_nodes);
+    TEST_ASSERT_EQUAL_UINT(7U, (unsigned int)cache_stats.cached_strings);
+
+    /* the same document again doesn't allocate anything */
+    cJSON_StartStats(&stats);
+    tree = cJSON_Parse(message);
+    cJSON_StopStats();
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.allocations);
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(7U, (unsigned int)cache_stats.node_hits);
+    TEST_ASSERT_EQUAL_UINT(7U, (unsigned int)cache_stats.string_hits);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_nodes);
+
+    {
+        char *printed = cJSON_PrintUnformatted(tree);
+        TEST_ASSERT_EQUAL_STRING(message, printed);
+        cJSON_free(printed);
+    }
+    cJSON_Delete(tree);
+
+    cJSON_DisableCache();
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_nodes);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_strings);
+}
+
+static void cache_should_be_bounded(void)
+{
+    cJSON_CacheStats cache_stats;
+    cJSON *tree = cJSON_Parse("[\"first one\",\"third one\",\"second one\",\"a string that is much too long to be kept in the cache of short strings\"]");
+    TEST_ASSERT_NOT_NULL(tree);
+
+    TEST_ASSERT_TRUE(cJSON_EnableCache(2, 1));
+    cJSON_Delete(tree);
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)cache_stats.cached_nodes);
+    /* one string of length 9 and one of length 10 */
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)cache_stats.cached_strings);
+
+    cJSON_DisableCache();
+}
+
+static void cache_should_reuse_strings_of_the_same_length(void)
+{
+    cJSON_CacheStats cache_stats;
+    cJSON *item = NULL;
+    char *buffer = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_EnableCache(4, 4));
+    item = cJSON_CreateString("abcdefghij");
+    TEST_ASSERT_NOT_NULL(item);
+    buffer = item->valuestring;
+    cJSON_Delete(item);
+
+    /* a different length doesn't fit */
+    item = cJSON_CreateString("abcdefghijkl");
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(item->valuestring != buffer);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateString("klmnopqrst");
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(item->valuestring == buffer);
+    TEST_ASSERT_EQUAL_STRING("klmnopqrst", item->valuestring);
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(1U, (unsigned int)cache_stats.string_hits);
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)cache_stats.string_misses);
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)cache_stats.node_hits);
+    cJSON_Delete(item);
+
+    cJSON_DisableCache();
+}
+
+static void cache_should_not_keep_packed_numbers(void)
+{
+    const double numbers[] = { 1, 2, 3 };
+    cJSON_CacheStats cache_stats;
+
+    TEST_ASSERT_TRUE(cJSON_EnableCache(4, 4));
+    cJSON_Delete(cJSON_CreatePackedArray(numbers, 3));
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(1U, (unsigned int)cache_stats.cached_nodes);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_strings);
+
+    cJSON_DisableCache();
+}
+
+static void cache_should_be_off_by_default(void)
+{
+    cJSON_CacheStats cache_stats;
+
+    cJSON_Delete(cJSON_Parse(message));
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_nodes);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_strings);
+    cJSON_GetCacheStats(NULL);
+
+    /* changing the allocator empties the cache */
+    TEST_ASSERT_TRUE(cJSON_EnableCache(10, 10));
+    cJSON_Delete(cJSON_Parse(message));
+    cJSON_InitHooks(NULL);
+    cJSON_GetCacheStats(&cache_stats);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_nodes);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cache_stats.cached_strings);
+    cJSON_DisableCache();
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(cache_should_reuse_nodes_and_strings);
+    RUN_TEST(cache_should_be_bounded);
+    RUN_TEST(cache_should_reuse_strings_of_the_same_length);
+    RUN_TEST(cache_should_not_keep_packed_numbers);
+    RUN_TEST(cache_should_be_off_by_default);
+
+    return UNITY_END();
+}
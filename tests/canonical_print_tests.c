@@ -0,0 +1,205 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void assert_canonical(const char * const json, const char * const expected)
+{
+    cJSON *item = cJSON_Parse(json);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(item);
+    printed = cJSON_PrintCanonical(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+    global_hooks.deallocate(printed);
+    cJSON_Delete(item);
+}
+
+static void assert_number(const double number, const char * const expected)
+{
+    cJSON *item = cJSON_CreateNumber(number);
+    char *printed = cJSON_PrintCanonical(item);
+
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+
+    global_hooks.deallocate(printed);
+    cJSON_Delete(item);
+}
+
+static void canonical_print_should_print_the_rfc_example(void)
+{
+    assert_canonical("{\"numbers\": [333333333.33333329, 1E30, 4.50, 2e-3, 0.000000000000000000000000001],"
+        " \"string\": \"\\u20ac$\\u000F\\u000aA'\\u0042\\u0022\\u005c\\\\\\\"\\/\", \"literals\": [null, true, false]}",
+        "{\"literals\":[null,true,false],\"numbers\":[333333333.3333333,1e+30,4.5,0.002,1e-27],\"string\":\"\xE2\x82\xAC$\\u000f\\nA'B\\\"\\\\\\\\\\\"/\"}");
+}
+
+static void canonical_print_should_sort_by_utf16_code_units(void)
+{
+    /* U+1F600 is a surrogate pair in UTF-16 and sorts before U+FB33 */
+    assert_canonical("{\"\\u20ac\":\"Euro Sign\",\"\\r\":\"Carriage Return\",\"\\ufb33\":\"Hebrew Letter Dalet With Dagesh\",\"1\":\"One\","
+        "\"\\ud83d\\ude00\":\"Emoji: Grinning Face\",\"\\u0080\":\"Control\",\"\\u00f6\":\"Latin Small Letter O With Diaeresis\"}",
+        "{\"\\r\":\"Carriage Return\",\"1\":\"One\",\"\xC2\x80\":\"Control\",\"\xC3\xB6\":\"Latin Small Letter O With Diaeresis\","
+        "\"\xE2\x82\xAC\":\"Euro Sign\",\"\xF0\x9F\x98\x80\":\"Emoji: Grinning Face\",\"\xEF\xAC\xB3\":\"Hebrew Letter Dalet With Dagesh\"}");
+    assert_canonical("{\"b\":[{\"z\":1,\"a\":2}],\"a\":{},\"\":[]}", "{\"\":[],\"a\":{},\"b\":[{\"a\":2,\"z\":1}]}");
+}
+
+static void canonical_print_should_format_numbers_like_ecmascript(void)
+{
+    assert_number(0, "0");
+    assert_number(-0.0, "0");
+    assert_number(1, "1");
+    assert_number(-1.5, "-1.5");
+    assert_number(1e21, "1e+21");
+    assert_number(1e20, "100000000000000000000");
+    assert_number(123456789012345680000.0, "123456789012345680000");
+    assert_number(295147905179352830000.0, "295147905179352830000");
+    assert_number(9007199254740992.0, "9007199254740992");
+    assert_number(0.000001, "0.000001");
+    assert_number(1e-7, "1e-7");
+    assert_number(5e-324, "5e-324");
+    assert_number(1.7976931348623157e308, "1.7976931348623157e+308");
+    assert_number(-1.7976931348623157e308, "-1.7976931348623157e+308");
+    assert_number(0.1 + 0.2, "0.30000000000000004");
+    assert_number(2.5e-5, "0.000025");
+    assert_number(1.25e25, "1.25e+25");
+}
+
+static void canonical_print_should_not_modify_the_tree(void)
+{
+    const char json[] = "{\"z\":1,\"y\":[3,2,1],\"x\":{\"b\":1,\"a\":2}}";
+    cJSON *item = cJSON_Parse(json);
+    char *canonical = cJSON_PrintCanonical(item);
+    char *printed = cJSON_PrintUnformatted(item);
+
+    TEST_ASSERT_EQUAL_STRING("{\"x\":{\"a\":2,\"b\":1},\"y\":[3,2,1],\"z\":1}", canonical);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+
+    global_hooks.deallocate(canonical);
+    global_hooks.deallocate(printed);
+    cJSON_Delete(item);
+}
+
+static void canonical_print_should_fail_without_canonical_form(void)
+{
+    cJSON *item = cJSON_Parse("{\"a\":1,\"a\":2}");
+    TEST_ASSERT_NULL(cJSON_PrintCanonical(item));
+    cJSON_Delete(item);
+
+    item = cJSON_CreateNumber(0);
+    item->valuedouble = HUGE_VAL;
+    TEST_ASSERT_NULL(cJSON_PrintCanonical(item));
+    cJSON_Delete(item);
+
+    item = cJSON_CreateRaw("[1, 2]");
+    TEST_ASSERT_NULL(cJSON_PrintCanonical(item));
+    cJSON_Delete(item);
+
+    item = cJSON_CreateString("\xC0\xAF");
+    TEST_ASSERT_NULL(cJSON_PrintCanonical(item));
+    cJSON_Delete(item);
+
+    TEST_ASSERT_NULL(cJSON_PrintCanonical(NULL));
+}
+
+typedef struct
+{
+    char data[8192];
+    size_t length;
+    size_t calls;
+    size_t fail_after;
+} collected_output;
+
+static cJSON_bool CJSON_CDECL collect(void *context, const char *data, size_t length)
+{
+    collected_output *output = (collected_output*)context;
+
+    output->calls++;
+    if ((output->calls > output->fail_after) || ((output->length + length) >= sizeof(output->data)))
+    {
+        return false;
+    }
+    memcpy(output->data + output->length, data, length);
+    output->length += length;
+    output->data[output->length] = '\0';
+
+    return true;
+}
+
+static void canonical_print_should_stream_to_a_callback(void)
+{
+    cJSON *item = cJSON_CreateObject();
+    collected_output output;
+    char key[16];
+    char long_string[600];
+    char *printed = NULL;
+    int i = 0;
+
+    for (i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", 199 - i);
+        cJSON_AddNumberToObject(item, key, i / 8.0);
+    }
+    /* longer than the internal buffer */
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    cJSON_AddStringToObject(item, "long", long_string);
+
+    memset(&output, 0, sizeof(output));
+    output.fail_after = (size_t)-1;
+    TEST_ASSERT_TRUE(cJSON_PrintCanonicalToCallback(item, collect, &output));
+    TEST_ASSERT_TRUE(output.calls > 1);
+
+    printed = cJSON_PrintCanonical(item);
+    TEST_ASSERT_EQUAL_STRING(printed, output.data);
+    global_hooks.deallocate(printed);
+
+    /* errors of the callback are reported */
+    memset(&output, 0, sizeof(output));
+    output.fail_after = 1;
+    TEST_ASSERT_FALSE(cJSON_PrintCanonicalToCallback(item, collect, &output));
+
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(canonical_print_should_print_the_rfc_example);
+    RUN_TEST(canonical_print_should_sort_by_utf16_code_units);
+    RUN_TEST(canonical_print_should_format_numbers_like_ecmascript);
+    RUN_TEST(canonical_print_should_not_modify_the_tree);
+    RUN_TEST(canonical_print_should_fail_without_canonical_form);
+    RUN_TEST(canonical_print_should_stream_to_a_callback);
+
+    return UNITY_END();
+}
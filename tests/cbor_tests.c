@@ -0,0 +1,319 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_CBOR.h"
+
+static cJSON *round_trip(const cJSON * const item)
+{
+    unsigned char *encoded = NULL;
+    size_t length = 0;
+    cJSON *decoded = NULL;
+
+    encoded = cJSON_PrintCBOR(item, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    decoded = cJSON_ParseCBOR(encoded, length);
+    cJSON_free(encoded);
+
+    return decoded;
+}
+
+static void assert_encodes_to(const cJSON * const item, const unsigned char * const expected, const size_t expected_length)
+{
+    unsigned char *encoded = NULL;
+    size_t length = 0;
+
+    encoded = cJSON_PrintCBOR(item, &length);
+    TEST_ASSERT_NOT_NULL(encoded);
+    TEST_ASSERT_EQUAL_UINT(expected_length, length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, encoded, expected_length);
+
+    cJSON_free(encoded);
+}
+
+static void assert_json_encodes_to(const char * const json, const unsigned char * const expected, const size_t expected_length)
+{
+    cJSON *item = cJSON_Parse(json);
+    TEST_ASSERT_NOT_NULL(item);
+    assert_encodes_to(item, expected, expected_length);
+    cJSON_Delete(item);
+}
+
+/* examples from appendix A of RFC 8949 */
+static void cbor_should_use_the_preferred_encodings(void)
+{
+    static const unsigned char integers[] = { 0x8D, 0x00, 0x17, 0x18, 0x18, 0x18, 0x64, 0x19, 0x03, 0xE8,
+        0x1A, 0x00, 0x0F, 0x42, 0x40, 0x1B, 0x00, 0x00, 0x00, 0xE8, 0xD4, 0xA5, 0x10, 0x00,
+        0x20, 0x29, 0x38, 0x63, 0x39, 0x03, 0xE7, 0x3B, 0x00, 0x00, 0x00, 0xE8, 0xD4, 0xA5, 0x0F, 0xFF, 0x23 };
+    static const unsigned char floats[] = { 0x88, 0xF9, 0x3E, 0x00, 0xF9, 0x35, 0x55, 0xFA, 0x47, 0xC3, 0x50, 0x40,
+        0xFA, 0x7F, 0x7F, 0xFF, 0xFF, 0xFB, 0x7E, 0x37, 0xE4, 0x3C, 0x88, 0x00, 0x75, 0x9C,
+        0xF9, 0x00, 0x01, 0xF9, 0x04, 0x00, 0xF9, 0x80, 0x00 };
+    static const unsigned char simple[] = { 0x84, 0xF4, 0xF5, 0xF6, 0x64, 'I', 'E', 'T', 'F' };
+    static const unsigned char object[] = { 0xA2, 0x61, 'a', 0x01, 0x61, 'b', 0x82, 0x02, 0x03 };
+
+    assert_json_encodes_to("[0,23,24,100,1000,1000000,1000000000000,-1,-10,-100,-1000,-1000000000000,-4]", integers, sizeof(integers));
+    assert_json_encodes_to("[1.5,0.333251953125,100000.5,3.4028234663852886e+38,1.0e+300,5.960464477539063e-8,0.00006103515625,-0]", floats, sizeof(floats));
+    assert_json_encodes_to("[false,true,null,\"IETF\"]", simple, sizeof(simple));
+    assert_json_encodes_to("{\"a\":1,\"b\":[2,3]}", object, sizeof(object));
+}
+
+static void cbor_should_sort_keys_deterministically(void)
+{
+    static const unsigned char sorted[] = { 0xA4, 0x60, 0xF6, 0x61, 'a', 0x02, 0x61, 'b', 0xA2, 0x61, 'y', 0x01, 0x62, 'x', 'x', 0x00,
+        0x62, 'a', 'a', 0x03 };
+    cJSON *item = cJSON_Parse("{\"b\":{\"xx\":0,\"y\":1},\"aa\":3,\"a\":2,\"\":null}");
+    TEST_ASSERT_NOT_NULL(item);
+
+    assert_encodes_to(item, sorted, sizeof(sorted));
+
+    /* duplicate keys have no deterministic encoding */
+    TEST_ASSERT_NOT_NULL(cJSON_AddNullToObject(cJSON_GetObjectItem(item, "b"), "y"));
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(item, NULL));
+    cJSON_Delete(item);
+}
+
+static void cbor_should_round_trip_numbers(void)
+{
+    static const double numbers[] = {
+        0, 1, 23, 24, 255, 256, 65535, 65536, 4294967295.0, 4294967296.0, 9007199254740992.0, 1e19,
+        -1, -24, -25, -256, -257, -65536, -65537, -4294967296.0, -4294967297.0, -9007199254740992.0, -1e19,
+        0.5, -0.25, 0.1, 1e300, -1e-300, 3.4028234663852886e38, 1e20, 65504, 65505, 5.960464477539063e-8, 1e-7, 1.0009765625
+    };
+    cJSON *array = cJSON_CreateDoubleArray(numbers, (int)(sizeof(numbers) / sizeof(numbers[0])));
+    cJSON *decoded = NULL;
+    cJSON *element = NULL;
+    size_t index = 0;
+    TEST_ASSERT_NOT_NULL(array);
+
+    decoded = round_trip(array);
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_EQUAL_INT(cJSON_GetArraySize(array), cJSON_GetArraySize(decoded));
+    cJSON_ArrayForEach(element, decoded)
+    {
+        TEST_ASSERT_TRUE(cJSON_IsNumber(element));
+        TEST_ASSERT_TRUE(element->valuedouble == numbers[index]);
+        index++;
+    }
+
+    cJSON_Delete(array);
+    cJSON_Delete(decoded);
+}
+
+static void cbor_should_read_special_floats_and_tags(void)
+{
+    static const unsigned char special[] = { 0x83, 0xF9, 0x7C, 0x00, 0xF9, 0xFC, 0x00, 0xC1, 0xFB, 0x41, 0xD4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    static const unsigned char infinity[] = { 0xF9, 0x7C, 0x00 };
+    cJSON *item = cJSON_ParseCBOR(special, sizeof(special));
+    TEST_ASSERT_NOT_NULL(item);
+
+    TEST_ASSERT_TRUE(cJSON_GetArrayItem(item, 0)->valuedouble > 1e308);
+    TEST_ASSERT_TRUE(cJSON_GetArrayItem(item, 1)->valuedouble < -1e308);
+    /* tag 1 (epoch time) is ignored */
+    TEST_ASSERT_TRUE(cJSON_GetArrayItem(item, 2)->valuedouble == 1342177280.0);
+
+    assert_encodes_to(cJSON_GetArrayItem(item, 0), infinity, sizeof(infinity));
+    cJSON_Delete(item);
+}
+
+static void cbor_should_round_trip_the_test_inputs(void)
+{
+    static const char * const inputs[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t index = 0;
+
+    for (index = 0; index < (sizeof(inputs) / sizeof(inputs[0])); index++)
+    {
+        char *json = read_file(inputs[index]);
+        cJSON *item = NULL;
+        cJSON *decoded = NULL;
+        TEST_ASSERT_NOT_NULL(json);
+
+        item = cJSON_Parse(json);
+        free(json);
+        if (item == NULL)
+        {
+            /* some inputs are HTML */
+            continue;
+        }
+
+        decoded = round_trip(item);
+        TEST_ASSERT_NOT_NULL_MESSAGE(decoded, inputs[index]);
+        /* members are sorted, so compare regardless of order */
+        TEST_ASSERT_TRUE_MESSAGE(cJSON_Compare(item, decoded, true), inputs[index]);
+
+        cJSON_Delete(item);
+        cJSON_Delete(decoded);
+    }
+}
+
+static void cbor_should_keep_raw_and_deferred_items(void)
+{
+    static const unsigned char raw[] = { 0x81, 0xD9, 0x01, 0x06, 0x42, '[', ']' };
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *item = cJSON_CreateArray();
+    cJSON *decoded = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(item);
+
+    cJSON_AddItemToArray(item, cJSON_CreateRaw("[]"));
+    assert_encodes_to(item, raw, sizeof(raw));
+    cJSON_Delete(item);
+
+    decoded = cJSON_ParseCBOR(raw, sizeof(raw));
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(decoded->child));
+    printed = cJSON_PrintUnformatted(decoded);
+    TEST_ASSERT_EQUAL_STRING("[[]]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(decoded);
+
+    options.defer_depth = 1;
+    item = parse_with_options("{\"a\":{\"b\":[1,2]}}", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    decoded = round_trip(item);
+    TEST_ASSERT_NOT_NULL(decoded);
+    printed = cJSON_PrintUnformatted(decoded);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"b\":[1,2]}}", printed);
+    /* writing doesn't expand the item */
+    TEST_ASSERT_TRUE(item->child->type & cJSON_IsDeferred);
+    cJSON_free(printed);
+    cJSON_Delete(decoded);
+    cJSON_Delete(item);
+}
+
+static void cbor_should_write_packed_arrays_as_items(void)
+{
+    static const double numbers[] = { 1, -2.5, 0.1 };
+    cJSON *array = cJSON_CreatePackedArray(numbers, 3);
+    cJSON *decoded = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(array);
+
+    decoded = round_trip(array);
+    TEST_ASSERT_NOT_NULL(decoded);
+    printed = cJSON_PrintUnformatted(decoded);
+    TEST_ASSERT_EQUAL_STRING("[1,-2.5,0.1]", printed);
+    /* the array isn't unpacked */
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+
+    cJSON_free(printed);
+    cJSON_Delete(array);
+    cJSON_Delete(decoded);
+}
+
+static void cbor_should_limit_nesting(void)
+{
+    unsigned char *deep = (unsigned char*)malloc(CJSON_NESTING_LIMIT + 2);
+    cJSON *item = NULL;
+    cJSON *innermost = NULL;
+    cJSON *decoded = NULL;
+    int index = 0;
+    TEST_ASSERT_NOT_NULL(deep);
+
+    /* one array more than the parser accepts */
+    memset(deep, 0x81, CJSON_NESTING_LIMIT + 1);
+    deep[CJSON_NESTING_LIMIT + 1] = 0xF6;
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(deep, CJSON_NESTING_LIMIT + 2));
+    item = cJSON_ParseCBOR(deep + 1, CJSON_NESTING_LIMIT + 1);
+    TEST_ASSERT_NOT_NULL(item);
+    cJSON_Delete(item);
+    free(deep);
+
+    item = innermost = cJSON_CreateArray();
+    for (index = 1; index < CJSON_NESTING_LIMIT; index++)
+    {
+        cJSON *array = cJSON_CreateArray();
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(innermost, array));
+        innermost = array;
+    }
+    decoded = round_trip(item);
+    TEST_ASSERT_NOT_NULL(decoded);
+    TEST_ASSERT_TRUE(cJSON_Compare(item, decoded, true));
+    cJSON_Delete(decoded);
+
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(innermost, cJSON_CreateObject()));
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(item, NULL));
+    cJSON_Delete(item);
+}
+
+static void cbor_should_reject_invalid_input(void)
+{
+    static const unsigned char truncated_string[] = { 0x63, 'a', 'b' };
+    static const unsigned char truncated_array[] = { 0x82, 0x01 };
+    static const unsigned char huge_array[] = { 0x9B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    static const unsigned char indefinite_array[] = { 0x9F, 0x01, 0xFF };
+    static const unsigned char reserved[] = { 0x1C };
+    static const unsigned char byte_string[] = { 0x41, 0x00 };
+    static const unsigned char undefined[] = { 0xF7 };
+    static const unsigned char integer_key[] = { 0xA1, 0x01, 0x02 };
+    static const unsigned char zero_byte[] = { 0x62, 'a', 0x00 };
+    static const unsigned char embedded_text[] = { 0xD9, 0x01, 0x06, 0x61, '1' };
+    static const unsigned char trailing[] = { 0xF6, 0xF6 };
+    static const unsigned char truncated_float[] = { 0xFB, 0x00, 0x00 };
+    cJSON *item = NULL;
+
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(NULL, 1));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(trailing, 0));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(truncated_string, sizeof(truncated_string)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(truncated_array, sizeof(truncated_array)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(huge_array, sizeof(huge_array)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(indefinite_array, sizeof(indefinite_array)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(reserved, sizeof(reserved)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(byte_string, sizeof(byte_string)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(undefined, sizeof(undefined)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(integer_key, sizeof(integer_key)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(zero_byte, sizeof(zero_byte)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(embedded_text, sizeof(embedded_text)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(trailing, sizeof(trailing)));
+    TEST_ASSERT_NULL(cJSON_ParseCBOR(truncated_float, sizeof(truncated_float)));
+
+    item = cJSON_CreateObject();
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(NULL, NULL));
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(item, "invalid", cJSON_CreateNull()));
+    cJSON_GetObjectItem(item, "invalid")->type = cJSON_Invalid;
+    TEST_ASSERT_NULL(cJSON_PrintCBOR(item, NULL));
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(cbor_should_use_the_preferred_encodings);
+    RUN_TEST(cbor_should_sort_keys_deterministically);
+    RUN_TEST(cbor_should_round_trip_numbers);
+    RUN_TEST(cbor_should_read_special_floats_and_tags);
+    RUN_TEST(cbor_should_round_trip_the_test_inputs);
+    RUN_TEST(cbor_should_keep_raw_and_deferred_items);
+    RUN_TEST(cbor_should_write_packed_arrays_as_items);
+    RUN_TEST(cbor_should_limit_nesting);
+    RUN_TEST(cbor_should_reject_invalid_input);
+
+    return UNITY_END();
+}
@@ -31,7 +31,7 @@ void reset(cJSON *item) {
     {
         cJSON_Delete(item->child);
     }
-    if ((item->valuestring != NULL) && !(item->type & cJSON_IsReference))
+    if ((item->valuestring != NULL) && !(item->type & cJSON_IsReference) && !has_inline_string(item))
     {
         global_hooks.deallocate(item->valuestring);
     }
@@ -99,6 +99,22 @@ cleanup:
     return content;
 }
 
+/* options that parse like cJSON_Parse, tests set the fields they need */
+cJSON_ParseOptions default_parse_options(void);
+cJSON_ParseOptions default_parse_options(void)
+{
+    cJSON_ParseOptions options;
+    memset(&options, 0, sizeof(options));
+
+    return options;
+}
+
+cJSON *parse_with_options(const char *value, const cJSON_ParseOptions *options);
+cJSON *parse_with_options(const char *value, const cJSON_ParseOptions *options)
+{
+    return cJSON_ParseWithOptions(value, strlen(value) + sizeof(""), options, NULL);
+}
+
 /* assertion helper macros */
 #define assert_has_type(item, item_type) TEST_ASSERT_BITS_MESSAGE(0xFF, item_type, item->type, "Item doesn't have expected type.")
 #define assert_has_no_reference(item) TEST_ASSERT_BITS_MESSAGE(cJSON_IsReference, 0, item->type, "Item should not have a string as reference.")
@@ -189,6 +189,104 @@ static void cjson_compare_should_compare_objects(void)
                 false))
 }
 
+static cJSON *create_object_with_members(size_t count, cJSON_bool reversed, const char *prefix)
+{
+    cJSON *object = cJSON_CreateObject();
+    size_t i = 0;
+    TEST_ASSERT_NOT_NULL(object);
+
+    for (i = 0; i < count; i++)
+    {
+        char key[32];
+        size_t number = reversed ? (count - 1 - i) : i;
+        sprintf(key, "%s%u", prefix, (unsigned int)number);
+        TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(object, key, (double)number));
+    }
+
+    return object;
+}
+
+static void cjson_compare_should_compare_large_objects(void)
+{
+    cJSON *a = create_object_with_members(1000, false, "key");
+    cJSON *b = create_object_with_members(1000, true, "key");
+    cJSON *upper = create_object_with_members(1000, true, "KEY");
+    cJSON *smaller = create_object_with_members(999, false, "key");
+    char *a_before = cJSON_PrintUnformatted(a);
+    char *b_before = cJSON_PrintUnformatted(b);
+    char *a_after = NULL;
+    char *b_after = NULL;
+
+    TEST_ASSERT_TRUE(cJSON_Compare(a, b, true));
+    TEST_ASSERT_TRUE(cJSON_Compare(b, a, false));
+    TEST_ASSERT_FALSE(cJSON_Compare(a, upper, true));
+    TEST_ASSERT_TRUE(cJSON_Compare(a, upper, false));
+    TEST_ASSERT_FALSE(cJSON_Compare(a, smaller, true));
+    TEST_ASSERT_FALSE(cJSON_Compare(smaller, a, true));
+
+    /* a different value */
+    cJSON_GetObjectItem(b, "key500")->valuedouble = 1;
+    TEST_ASSERT_FALSE(cJSON_Compare(a, b, true));
+    cJSON_GetObjectItem(b, "key500")->valuedouble = 500;
+
+    /* the inputs aren't reordered */
+    a_after = cJSON_PrintUnformatted(a);
+    b_after = cJSON_PrintUnformatted(b);
+    TEST_ASSERT_EQUAL_STRING(a_before, a_after);
+    TEST_ASSERT_EQUAL_STRING(b_before, b_after);
+
+    cJSON_free(a_before);
+    cJSON_free(b_before);
+    cJSON_free(a_after);
+    cJSON_free(b_after);
+    cJSON_Delete(a);
+    cJSON_Delete(b);
+    cJSON_Delete(upper);
+    cJSON_Delete(smaller);
+}
+
+static void cjson_compare_should_compare_objects_with_duplicate_keys(void)
+{
+    TEST_ASSERT_TRUE(compare_from_string("{\"a\": 1, \"a\": 1}", "{\"a\": 1}", true));
+    TEST_ASSERT_FALSE(compare_from_string("{\"a\": 1, \"a\": 2}", "{\"a\": 1}", true));
+    TEST_ASSERT_FALSE(compare_from_string("{\"a\": 1}", "{\"a\": 1, \"a\": 2}", true));
+    TEST_ASSERT_FALSE(compare_from_string(
+                "{\"0\":0,\"1\":1,\"2\":2,\"3\":3,\"4\":4,\"5\":5,\"6\":6,\"7\":7,\"8\":8,\"8\":9}",
+                "{\"0\":0,\"1\":1,\"2\":2,\"3\":3,\"4\":4,\"5\":5,\"6\":6,\"7\":7,\"8\":8}",
+                true));
+    TEST_ASSERT_FALSE(compare_from_string(
+                "{\"0\":0,\"1\":1,\"2\":2,\"3\":3,\"4\":4,\"5\":5,\"6\":6,\"7\":7,\"8\":8}",
+                "{\"0\":0,\"1\":1,\"2\":2,\"3\":3,\"4\":4,\"5\":5,\"6\":6,\"7\":7,\"8\":8,\"8\":9}",
+                true));
+}
+
+static void cjson_compare_should_compare_deeply_nested_objects(void)
+{
+    cJSON *a = cJSON_CreateObject();
+    cJSON *b = cJSON_CreateObject();
+    cJSON *a_current = a;
+    cJSON *b_current = b;
+    size_t depth = 0;
+
+    /* every level used to be compared twice, which took exponential time */
+    for (depth = 0; depth < 200; depth++)
+    {
+        TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(a_current, "level", (double)depth));
+        TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(b_current, "level", (double)depth));
+        a_current = cJSON_AddObjectToObject(a_current, "next");
+        b_current = cJSON_AddObjectToObject(b_current, "next");
+        TEST_ASSERT_NOT_NULL(a_current);
+        TEST_ASSERT_NOT_NULL(b_current);
+    }
+
+    TEST_ASSERT_TRUE(cJSON_Compare(a, b, true));
+    TEST_ASSERT_NOT_NULL(cJSON_AddNullToObject(b_current, "extra"));
+    TEST_ASSERT_FALSE(cJSON_Compare(a, b, true));
+
+    cJSON_Delete(a);
+    cJSON_Delete(b);
+}
+
 int CJSON_CDECL main(void)
 {
     UNITY_BEGIN();
@@ -203,6 +301,9 @@ int CJSON_CDECL main(void)
     RUN_TEST(cjson_compare_should_compare_raw);
     RUN_TEST(cjson_compare_should_compare_arrays);
     RUN_TEST(cjson_compare_should_compare_objects);
+    RUN_TEST(cjson_compare_should_compare_large_objects);
+    RUN_TEST(cjson_compare_should_compare_objects_with_duplicate_keys);
+    RUN_TEST(cjson_compare_should_compare_deeply_nested_objects);
 
     return UNITY_END();
 }
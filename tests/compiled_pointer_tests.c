@@ -0,0 +1,170 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_Utils.h"
+
+static const char *json = "{\"foo\":[\"bar\",\"baz\"],\"\":0,\"a/b\":1,\"c%d\":2,\"e^f\":3,\"g|h\":4,\"i\\\\j\":5,\"k\\\"l\":6,\" \":7,\"m~n\":8,\"deep\":{\"Nested\":{\"x\":[10,{\"y\":11}]}}}";
+
+static const char *pointers[] = {
+    "",
+    "/foo",
+    "/foo/0",
+    "/",
+    "/a~1b",
+    "/c%d",
+    "/e^f",
+    "/g|h",
+    "/i\\j",
+    "/k\"l",
+    "/ ",
+    "/m~0n",
+    "/deep/Nested/x/1/y",
+    "/deep/nested/x/0",
+    "/foo/2",
+    "/foo/01",
+    "/foo/-",
+    "/missing/child",
+    "/deep/Nested/x/1/y/z"
+};
+
+#define POINTER_COUNT (sizeof(pointers) / sizeof(pointers[0]))
+
+static void compiled_pointers_should_match_get_pointer(void)
+{
+    cJSON *root = cJSON_Parse(json);
+    size_t i = 0;
+    TEST_ASSERT_NOT_NULL(root);
+
+    for (i = 0; i < POINTER_COUNT; i++)
+    {
+        cJSONUtils_CompiledPointer *compiled = cJSONUtils_CompilePointer(pointers[i]);
+        cJSONUtils_CompiledPointer *compiled_case_sensitive = cJSONUtils_CompilePointerCaseSensitive(pointers[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(compiled, pointers[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(compiled_case_sensitive, pointers[i]);
+
+        TEST_ASSERT_TRUE_MESSAGE(cJSONUtils_GetPointer(root, pointers[i]) == cJSONUtils_GetCompiledPointer(root, compiled), pointers[i]);
+        TEST_ASSERT_TRUE_MESSAGE(cJSONUtils_GetPointerCaseSensitive(root, pointers[i]) == cJSONUtils_GetCompiledPointer(root, compiled_case_sensitive), pointers[i]);
+
+        cJSONUtils_DeleteCompiledPointer(compiled);
+        cJSONUtils_DeleteCompiledPointer(compiled_case_sensitive);
+    }
+
+    cJSON_Delete(root);
+}
+
+static void compiled_pointers_should_respect_case_sensitivity(void)
+{
+    cJSON *root = cJSON_Parse(json);
+    cJSONUtils_CompiledPointer *insensitive = cJSONUtils_CompilePointer("/DEEP/nested/X/0");
+    cJSONUtils_CompiledPointer *sensitive = cJSONUtils_CompilePointerCaseSensitive("/DEEP/nested/X/0");
+    cJSON *item = NULL;
+    TEST_ASSERT_NOT_NULL(root);
+
+    item = cJSONUtils_GetCompiledPointer(root, insensitive);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_INT(10, item->valueint);
+    TEST_ASSERT_NULL(cJSONUtils_GetCompiledPointer(root, sensitive));
+
+    cJSONUtils_DeleteCompiledPointer(insensitive);
+    cJSONUtils_DeleteCompiledPointer(sensitive);
+    cJSON_Delete(root);
+}
+
+static void compile_pointer_should_reject_invalid_pointers(void)
+{
+    TEST_ASSERT_NULL(cJSONUtils_CompilePointer(NULL));
+    TEST_ASSERT_NULL(cJSONUtils_CompilePointer("foo"));
+    TEST_ASSERT_NULL(cJSONUtils_CompilePointer("/foo~2"));
+    TEST_ASSERT_NULL(cJSONUtils_CompilePointer("/foo~"));
+    TEST_ASSERT_NULL(cJSONUtils_GetCompiledPointer(NULL, NULL));
+    cJSONUtils_DeleteCompiledPointer(NULL);
+}
+
+static void batch_evaluation_should_match_single_evaluation(void)
+{
+    cJSON *root = cJSON_Parse(json);
+    cJSONUtils_CompiledPointer *compiled[POINTER_COUNT + 1];
+    cJSON *results[POINTER_COUNT + 1];
+    size_t i = 0;
+    TEST_ASSERT_NOT_NULL(root);
+
+    for (i = 0; i < POINTER_COUNT; i++)
+    {
+        /* alternate case sensitivity to make sure prefixes are only shared between equal modes */
+        compiled[i] = (i % 2) ? cJSONUtils_CompilePointerCaseSensitive(pointers[i]) : cJSONUtils_CompilePointer(pointers[i]);
+        TEST_ASSERT_NOT_NULL(compiled[i]);
+    }
+    compiled[POINTER_COUNT] = NULL;
+
+    TEST_ASSERT_TRUE(cJSONUtils_GetCompiledPointers(root, (const cJSONUtils_CompiledPointer * const *)compiled, POINTER_COUNT + 1, results));
+    for (i = 0; i < POINTER_COUNT; i++)
+    {
+        TEST_ASSERT_TRUE_MESSAGE(results[i] == cJSONUtils_GetCompiledPointer(root, compiled[i]), pointers[i]);
+        cJSONUtils_DeleteCompiledPointer(compiled[i]);
+    }
+    TEST_ASSERT_NULL(results[POINTER_COUNT]);
+
+    TEST_ASSERT_FALSE(cJSONUtils_GetCompiledPointers(root, NULL, 1, results));
+
+    cJSON_Delete(root);
+}
+
+static void compiled_pointers_should_expand_deferred_subtrees(void)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    const char deferred[] = "{\"a\":{\"b\":[1,2,3]}}";
+    cJSON *root = NULL;
+    cJSONUtils_CompiledPointer *compiled = cJSONUtils_CompilePointer("/a/b/1");
+    cJSON *item = NULL;
+
+    options.defer_depth = 1;
+    root = parse_with_options(deferred, &options);
+    TEST_ASSERT_NOT_NULL(root);
+
+    item = cJSONUtils_GetCompiledPointer(root, compiled);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_EQUAL_INT(2, item->valueint);
+
+    cJSONUtils_DeleteCompiledPointer(compiled);
+    cJSON_Delete(root);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(compiled_pointers_should_match_get_pointer);
+    RUN_TEST(compiled_pointers_should_respect_case_sensitivity);
+    RUN_TEST(compile_pointer_should_reject_invalid_pointers);
+    RUN_TEST(batch_evaluation_should_match_single_evaluation);
+    RUN_TEST(compiled_pointers_should_expand_deferred_subtrees);
+
+    return UNITY_END();
+}
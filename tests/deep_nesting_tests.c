@@ -0,0 +1,255 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+/* deep enough that recursion on the C stack would overflow it */
+#define DEEP 200000
+
+/* depth nested arrays and objects around 1: [{"a":[{"a":...1...}]}] */
+static char *create_deep_json(size_t depth)
+{
+    char *json = (char*)malloc((depth * 6) + 2);
+    size_t length = 0;
+    size_t level = 0;
+
+    TEST_ASSERT_NOT_NULL(json);
+    for (level = 0; level < depth; level++)
+    {
+        if ((level % 2) == 0)
+        {
+            json[length++] = '[';
+        }
+        else
+        {
+            memcpy(json + length, "{\"a\":", 5);
+            length += 5;
+        }
+    }
+    json[length++] = '1';
+    for (level = depth; level > 0; level--)
+    {
+        json[length++] = ((level % 2) == 1) ? ']' : '}';
+    }
+    json[length] = '\0';
+
+    return json;
+}
+
+static cJSON *parse_deep(const char * const json, size_t max_depth)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    options.require_null_terminated = true;
+    options.max_depth = max_depth;
+
+    return parse_with_options(json, &options);
+}
+
+static void deep_documents_should_parse_and_print(void)
+{
+    char *json = create_deep_json(DEEP);
+    char *printed = NULL;
+    cJSON *tree = NULL;
+
+    TEST_ASSERT_NULL(cJSON_Parse(json));
+
+    tree = parse_deep(json, DEEP);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cJSON_IsArray(tree));
+    TEST_ASSERT_TRUE(cJSON_IsObject(tree->child));
+
+    printed = cJSON_PrintUnformatted(tree);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(tree);
+    free(json);
+}
+
+static void deep_documents_should_duplicate(void)
+{
+    char *json = create_deep_json(CJSON_CIRCULAR_LIMIT - 1);
+    char *printed = NULL;
+    cJSON *tree = parse_deep(json, CJSON_CIRCULAR_LIMIT);
+    cJSON *copy = NULL;
+    TEST_ASSERT_NOT_NULL(tree);
+
+    copy = cJSON_Duplicate(tree, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    printed = cJSON_PrintUnformatted(copy);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+    cJSON_free(printed);
+    cJSON_Delete(copy);
+
+    /* one level deeper is too deep to copy */
+    TEST_ASSERT_TRUE(cJSON_ReplaceItemInArray(tree, 0, cJSON_CreateArray()));
+    cJSON_Delete(tree);
+    free(json);
+    json = create_deep_json(CJSON_CIRCULAR_LIMIT + 1);
+    tree = parse_deep(json, CJSON_CIRCULAR_LIMIT + 1);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_NULL(cJSON_Duplicate(tree, true));
+
+    cJSON_Delete(tree);
+    free(json);
+}
+
+static void compare_hash_and_canonical_should_work_on_deep_documents(void)
+{
+    char *json = create_deep_json(CJSON_CIRCULAR_LIMIT - 1);
+    cJSON *tree = parse_deep(json, CJSON_CIRCULAR_LIMIT);
+    cJSON *copy = parse_deep(json, CJSON_CIRCULAR_LIMIT);
+    cJSON *innermost = NULL;
+    char *printed = NULL;
+    cJSON_HashValue hash;
+    cJSON_HashValue copy_hash;
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    TEST_ASSERT_TRUE(cJSON_Compare(tree, copy, true));
+    printed = cJSON_PrintCanonical(tree);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(json, printed);
+    cJSON_free(printed);
+    hash = cJSON_Hash(tree);
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(copy));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(copy, &copy_hash));
+    TEST_ASSERT_EQUAL_MEMORY(hash.words, copy_hash.words, sizeof(hash.words));
+    TEST_ASSERT_NOT_EQUAL(0, hash.words[0] | hash.words[1] | hash.words[2] | hash.words[3]);
+
+    /* only the innermost value differs */
+    innermost = copy;
+    while (innermost->child != NULL)
+    {
+        innermost = innermost->child;
+    }
+    cJSON_SetNumberValue(innermost, 2);
+    TEST_ASSERT_FALSE(cJSON_Compare(tree, copy, true));
+    copy_hash = cJSON_Hash(copy);
+    TEST_ASSERT_FALSE(memcmp(hash.words, copy_hash.words, sizeof(hash.words)) == 0);
+
+    cJSON_Delete(copy);
+    cJSON_Delete(tree);
+    free(json);
+}
+
+static void compare_hash_and_canonical_should_fail_on_too_deep_documents(void)
+{
+    char *json = create_deep_json(DEEP);
+    cJSON *tree = parse_deep(json, DEEP);
+    cJSON *copy = parse_deep(json, DEEP);
+    cJSON_HashValue hash;
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    /* they give up below CJSON_CIRCULAR_LIMIT like cJSON_Duplicate, that is where circular references end up */
+    TEST_ASSERT_FALSE(cJSON_Compare(tree, copy, true));
+    TEST_ASSERT_NULL(cJSON_PrintCanonical(tree));
+    TEST_ASSERT_FALSE(cJSON_CacheHashes(tree));
+    hash = cJSON_Hash(tree);
+    TEST_ASSERT_EQUAL_UINT32(0, hash.words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, hash.words[3]);
+
+    /* identical items don't have to be looked at */
+    TEST_ASSERT_TRUE(cJSON_Compare(tree, tree, true));
+
+    cJSON_Delete(copy);
+    cJSON_Delete(tree);
+    free(json);
+}
+
+static void max_depth_should_limit_nesting(void)
+{
+    char *json = create_deep_json(100);
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *tree = NULL;
+    const char *end = NULL;
+
+    tree = parse_deep(json, 100);
+    TEST_ASSERT_NOT_NULL(tree);
+    cJSON_Delete(tree);
+
+    /* the error is at the container that is too deep, 50 arrays and 49 objects follow in front of it */
+    options.max_depth = 99;
+    TEST_ASSERT_NULL(cJSON_ParseWithOptions(json, strlen(json), &options, &end));
+    TEST_ASSERT_TRUE(end == json + 50 + (49 * 5));
+    free(json);
+
+    json = create_deep_json(CJSON_NESTING_LIMIT);
+    tree = parse_deep(json, 0);
+    TEST_ASSERT_NOT_NULL(tree);
+    cJSON_Delete(tree);
+    free(json);
+}
+
+static void broken_deep_documents_should_be_freed(void)
+{
+    char *json = create_deep_json(1000);
+    const char *end = NULL;
+    size_t length = strlen(json);
+
+    /* an object gets a comma instead of its end, the error is behind the bracket that follows */
+    json[length - 500] = ',';
+    TEST_ASSERT_NULL(cJSON_ParseWithOpts(json, &end, false));
+    TEST_ASSERT_TRUE(end == json + length - 498);
+
+    free(json);
+}
+
+static void formatted_printing_should_indent_deep_documents(void)
+{
+    char *json = create_deep_json(4);
+    cJSON *tree = cJSON_Parse(json);
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(tree);
+
+    printed = cJSON_Print(tree);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING("[{\n\t\t\"a\":\t[{\n\t\t\t\t\"a\":\t1\n\t\t\t}]\n\t}]", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(tree);
+    free(json);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(deep_documents_should_parse_and_print);
+    RUN_TEST(deep_documents_should_duplicate);
+    RUN_TEST(compare_hash_and_canonical_should_work_on_deep_documents);
+    RUN_TEST(compare_hash_and_canonical_should_fail_on_too_deep_documents);
+    RUN_TEST(max_depth_should_limit_nesting);
+    RUN_TEST(broken_deep_documents_should_be_freed);
+    RUN_TEST(formatted_printing_should_indent_deep_documents);
+
+    return UNITY_END();
+}
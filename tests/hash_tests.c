@@ -0,0 +1,204 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static cJSON_bool hashes_equal(const cJSON_HashValue a, const cJSON_HashValue b)
+{
+    return memcmp(a.words, b.words, sizeof(a.words)) == 0;
+}
+
+static cJSON_bool hash_strings_equal(const char * const a, const char * const b)
+{
+    cJSON *a_json = cJSON_Parse(a);
+    cJSON *b_json = cJSON_Parse(b);
+    cJSON_bool equal = false;
+    TEST_ASSERT_NOT_NULL(a_json);
+    TEST_ASSERT_NOT_NULL(b_json);
+
+    equal = hashes_equal(cJSON_Hash(a_json), cJSON_Hash(b_json));
+
+    cJSON_Delete(a_json);
+    cJSON_Delete(b_json);
+
+    return equal;
+}
+
+static void hash_should_match_for_equal_values(void)
+{
+    TEST_ASSERT_TRUE(hash_strings_equal("null", "null"));
+    TEST_ASSERT_TRUE(hash_strings_equal("1.5", "15e-1"));
+    TEST_ASSERT_TRUE(hash_strings_equal("0", "-0"));
+    TEST_ASSERT_TRUE(hash_strings_equal("\"string\"", "\"string\""));
+    TEST_ASSERT_TRUE(hash_strings_equal("[1,[2,3],{}]", "[1, [2, 3], {}]"));
+    TEST_ASSERT_TRUE(hash_strings_equal("{\"a\":1,\"b\":{\"c\":[true,false]}}", "{\"b\":{\"c\":[true,false]},\"a\":1}"));
+}
+
+static void hash_should_differ_for_different_values(void)
+{
+    TEST_ASSERT_FALSE(hash_strings_equal("true", "false"));
+    TEST_ASSERT_FALSE(hash_strings_equal("1", "\"1\""));
+    TEST_ASSERT_FALSE(hash_strings_equal("1", "1.0000001"));
+    TEST_ASSERT_FALSE(hash_strings_equal("1", "-1"));
+    TEST_ASSERT_FALSE(hash_strings_equal("\"a\"", "\"b\""));
+    TEST_ASSERT_FALSE(hash_strings_equal("[1,2]", "[2,1]"));
+    TEST_ASSERT_FALSE(hash_strings_equal("[]", "{}"));
+    TEST_ASSERT_FALSE(hash_strings_equal("[[]]", "[]"));
+    TEST_ASSERT_FALSE(hash_strings_equal("{\"a\":1}", "{\"A\":1}"));
+    TEST_ASSERT_FALSE(hash_strings_equal("{\"a\":1,\"b\":2}", "{\"a\":2,\"b\":1}"));
+    TEST_ASSERT_FALSE(hash_strings_equal("{\"a\":1}", "{\"a\":1,\"a\":1}"));
+}
+
+static void hash_of_null_should_be_zero(void)
+{
+    cJSON_HashValue hash = cJSON_Hash(NULL);
+    cJSON_HashValue zero;
+    memset(&zero, '\0', sizeof(zero));
+
+    TEST_ASSERT_TRUE(hashes_equal(zero, hash));
+    TEST_ASSERT_FALSE(cJSON_CacheHashes(NULL));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(NULL, &hash));
+}
+
+static void cached_hashes_should_be_invalidated_by_changes(void)
+{
+    cJSON *tree = cJSON_Parse("{\"a\":{\"b\":\"x\",\"c\":[1,2]},\"d\":true}");
+    cJSON *a = NULL;
+    cJSON *b = NULL;
+    cJSON *c = NULL;
+    cJSON *added = cJSON_CreateObject();
+    cJSON_HashValue hash;
+    cJSON_HashValue before;
+    TEST_ASSERT_NOT_NULL(tree);
+    a = cJSON_GetObjectItem(tree, "a");
+    b = cJSON_GetObjectItem(a, "b");
+    c = cJSON_GetObjectItem(a, "c");
+
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(tree, &hash));
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(tree));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(tree, &before));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(b, &hash));
+    TEST_ASSERT_TRUE(hashes_equal(hash, cJSON_Hash(b)));
+
+    /* the changed item and everything above it */
+    TEST_ASSERT_NOT_NULL(cJSON_SetValuestring(b, "y"));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(b, &hash));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(a, &hash));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(tree, &hash));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(c, &hash));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(cJSON_GetObjectItem(tree, "d"), &hash));
+
+    /* hashing again refreshes the cache */
+    hash = cJSON_Hash(tree);
+    TEST_ASSERT_FALSE(hashes_equal(before, hash));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(tree, &before));
+    TEST_ASSERT_TRUE(hashes_equal(before, hash));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(b, &hash));
+
+    /* new items are cached once their parent is hashed again */
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(c, added));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(tree, &hash));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(added, &hash));
+    cJSON_Hash(tree);
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(added, &hash));
+
+    /* after moving an item, changes invalidate its new parents */
+    added = cJSON_DetachItemViaPointer(c, added);
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(tree, "moved", added));
+    cJSON_Hash(tree);
+    TEST_ASSERT_NOT_NULL(cJSON_AddNullToObject(added, "null"));
+    TEST_ASSERT_FALSE(cJSON_GetCachedHash(tree, &hash));
+    TEST_ASSERT_TRUE(cJSON_GetCachedHash(a, &hash));
+
+    cJSON_Delete(tree);
+    /* deleting the items drops their entries */
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)node_info_count);
+}
+
+static void compare_should_use_cached_hashes(void)
+{
+    cJSON *a = cJSON_Parse("{\"list\":[1,2,3],\"name\":\"a\"}");
+    cJSON *b = cJSON_Parse("{\"name\":\"a\",\"list\":[1,2,3]}");
+    cJSON *number = NULL;
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(a));
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(b));
+    TEST_ASSERT_TRUE(cJSON_Compare(a, b, true));
+
+    /* a direct change that isn't reported isn't noticed, which shows the subtree is skipped */
+    number = cJSON_GetArrayItem(cJSON_GetObjectItem(b, "list"), 0);
+    number->valuedouble = 5;
+    TEST_ASSERT_TRUE(cJSON_Compare(a, b, true));
+    cJSON_MarkDirty(number);
+    TEST_ASSERT_FALSE(cJSON_Compare(a, b, true));
+
+    cJSON_Delete(a);
+    cJSON_Delete(b);
+}
+
+static void setter_macros_should_invalidate_cached_hashes(void)
+{
+    cJSON *a = cJSON_Parse("[1,true]");
+    cJSON *b = cJSON_Parse("[1,true]");
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(a));
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(b));
+    TEST_ASSERT_TRUE(cJSON_Compare(a, b, true));
+
+    TEST_ASSERT_EQUAL_INT(2, cJSON_SetIntValue(b->child, 2));
+    TEST_ASSERT_EQUAL_DOUBLE(2, b->child->valuedouble);
+    TEST_ASSERT_FALSE(cJSON_Compare(a, b, true));
+    TEST_ASSERT_EQUAL_INT(2, cJSON_SetIntValue(a->child, 2));
+    TEST_ASSERT_TRUE(cJSON_Compare(a, b, true));
+
+    TEST_ASSERT_EQUAL_INT(cJSON_False, cJSON_SetBoolValue(b->child->next, 0));
+    TEST_ASSERT_FALSE(cJSON_Compare(a, b, true));
+    TEST_ASSERT_FALSE(hashes_equal(cJSON_Hash(a), cJSON_Hash(b)));
+    TEST_ASSERT_EQUAL_INT(cJSON_Invalid, cJSON_SetBoolValue(b->child, 1));
+
+    cJSON_Delete(a);
+    cJSON_Delete(b);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(hash_should_match_for_equal_values);
+    RUN_TEST(hash_should_differ_for_different_values);
+    RUN_TEST(hash_of_null_should_be_zero);
+    RUN_TEST(cached_hashes_should_be_invalidated_by_changes);
+    RUN_TEST(compare_should_use_cached_hashes);
+    RUN_TEST(setter_macros_should_invalidate_cached_hashes);
+
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/* these tests build their own copy of cJSON with inline strings */
+#undef CJSON_INLINE_STRINGS
+#define CJSON_INLINE_STRINGS 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static cJSON_bool is_inline(const cJSON * const item)
+{
+    return item->valuestring == (const char*)&item->valuedouble;
+}
+
+static void short_strings_should_be_stored_inline(void)
+{
+    cJSON *tree = cJSON_Parse("{\"short\":\"abcdefg\",\"long\":\"abcdefgh\",\"escaped\":\"\\u00e4\\n\",\"empty\":\"\"}");
+    cJSON *item = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(tree);
+
+    item = cJSON_GetObjectItem(tree, "short");
+    TEST_ASSERT_TRUE(is_inline(item));
+    TEST_ASSERT_EQUAL_STRING("abcdefg", cJSON_GetStringValue(item));
+    TEST_ASSERT_FALSE(is_inline(cJSON_GetObjectItem(tree, "long")));
+    TEST_ASSERT_TRUE(is_inline(cJSON_GetObjectItem(tree, "escaped")));
+    TEST_ASSERT_EQUAL_STRING("\xC3\xA4\n", cJSON_GetObjectItem(tree, "escaped")->valuestring);
+    TEST_ASSERT_TRUE(is_inline(cJSON_GetObjectItem(tree, "empty")));
+
+    /* keys are never stored inline, the value of their item may need the space */
+    TEST_ASSERT_TRUE(item->string != (char*)&item->valuedouble);
+
+    printed = cJSON_PrintUnformatted(tree);
+    TEST_ASSERT_EQUAL_STRING("{\"short\":\"abcdefg\",\"long\":\"abcdefgh\",\"escaped\":\"\xC3\xA4\\n\",\"empty\":\"\"}", printed);
+    cJSON_free(printed);
+    cJSON_Delete(tree);
+
+    item = cJSON_CreateString("short");
+    TEST_ASSERT_TRUE(is_inline(item));
+    TEST_ASSERT_EQUAL_STRING("short", item->valuestring);
+    cJSON_Delete(item);
+}
+
+static void short_strings_should_not_be_allocated(void)
+{
+    cJSON_Stats stats;
+    cJSON *tree = NULL;
+
+    cJSON_StartStats(&stats);
+    tree = cJSON_Parse("[\"a\",\"bc\",\"def\"]");
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_UINT(4U, (unsigned int)stats.allocations);
+    cJSON_Delete(tree);
+    TEST_ASSERT_EQUAL_UINT(4U, (unsigned int)stats.deallocations);
+    cJSON_StopStats();
+}
+
+static void set_valuestring_should_grow_inline_strings(void)
+{
+    cJSON *item = cJSON_CreateString("a");
+    TEST_ASSERT_NOT_NULL(item);
+
+    TEST_ASSERT_NOT_NULL(cJSON_SetValuestring(item, "abcdefg"));
+    TEST_ASSERT_TRUE(is_inline(item));
+    TEST_ASSERT_EQUAL_STRING("abcdefg", item->valuestring);
+
+    TEST_ASSERT_NOT_NULL(cJSON_SetValuestring(item, "abcdefgh"));
+    TEST_ASSERT_FALSE(is_inline(item));
+    TEST_ASSERT_EQUAL_STRING("abcdefgh", item->valuestring);
+
+    TEST_ASSERT_NOT_NULL(cJSON_SetValuestring(item, "xyz"));
+    TEST_ASSERT_EQUAL_STRING("xyz", item->valuestring);
+    cJSON_Delete(item);
+}
+
+static void copies_should_have_their_own_inline_strings(void)
+{
+    cJSON *tree = cJSON_Parse("[\"one\",{\"two\":\"2\"}]");
+    cJSON *copy = NULL;
+    cJSON *shared = NULL;
+    TEST_ASSERT_NOT_NULL(tree);
+
+    copy = cJSON_Duplicate(tree, true);
+    shared = cJSON_DuplicateShared(tree);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_NOT_NULL(shared);
+    TEST_ASSERT_TRUE(is_inline(copy->child));
+    TEST_ASSERT_TRUE(copy->child->valuestring != tree->child->valuestring);
+
+    /* changing the shared copy gives it its own items */
+    TEST_ASSERT_TRUE(cJSON_Unshare(shared));
+    TEST_ASSERT_NOT_NULL(cJSON_SetValuestring(cJSON_GetArrayItem(shared, 0), "three"));
+    TEST_ASSERT_TRUE(is_inline(shared->child));
+
+    cJSON_Delete(tree);
+    TEST_ASSERT_EQUAL_STRING("one", copy->child->valuestring);
+    TEST_ASSERT_EQUAL_STRING("2", cJSON_GetObjectItem(copy->child->next, "two")->valuestring);
+    TEST_ASSERT_EQUAL_STRING("three", shared->child->valuestring);
+    TEST_ASSERT_EQUAL_STRING("2", cJSON_GetObjectItem(cJSON_GetArrayItem(shared, 1), "two")->valuestring);
+    cJSON_Delete(copy);
+    cJSON_Delete(shared);
+}
+
+static void setting_a_number_should_keep_the_string(void)
+{
+    cJSON *item = cJSON_CreateString("text");
+    TEST_ASSERT_NOT_NULL(item);
+
+    TEST_ASSERT_EQUAL_DOUBLE(1.5, cJSON_SetNumberValue(item, 1.5));
+    TEST_ASSERT_FALSE(is_inline(item));
+    TEST_ASSERT_EQUAL_STRING("text", item->valuestring);
+    TEST_ASSERT_EQUAL_DOUBLE(1.5, item->valuedouble);
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(short_strings_should_be_stored_inline);
+    RUN_TEST(short_strings_should_not_be_allocated);
+    RUN_TEST(set_valuestring_should_grow_inline_strings);
+    RUN_TEST(copies_should_have_their_own_inline_strings);
+    RUN_TEST(setting_a_number_should_keep_the_string);
+
+    return UNITY_END();
+}
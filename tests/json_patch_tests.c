@@ -91,6 +91,13 @@ static cJSON_bool test_apply_patch(const cJSON * const test)
         /* excepting an error */
         TEST_ASSERT_TRUE_MESSAGE(0 != cJSONUtils_ApplyPatchesCaseSensitive(object, patch), "Test didn't fail as it's supposed to.");
 
+        /* the atomic version leaves the document untouched */
+        cJSON_Delete(object);
+        object = cJSON_Duplicate(doc, true);
+        TEST_ASSERT_NOT_NULL(object);
+        TEST_ASSERT_TRUE_MESSAGE(0 != cJSONUtils_ApplyPatchesAtomicCaseSensitive(object, patch), "Atomic test didn't fail as it's supposed to.");
+        TEST_ASSERT_TRUE_MESSAGE(cJSON_Compare(object, doc, true), "Atomic patch wasn't rolled back.");
+
         successful = true;
     }
     else
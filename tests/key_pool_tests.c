@@ -0,0 +1,223 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static const char records[] = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"id\":3,\"name\":\"c\"}]";
+
+static cJSON *parse_pooled(const char * const json, cJSON_KeyPool * const pool)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    options.key_pool = pool;
+
+    return parse_with_options(json, &options);
+}
+
+static void assert_prints(const cJSON * const item, const char * const expected)
+{
+    char *printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+    cJSON_free(printed);
+}
+
+static void key_pool_should_intern_keys(void)
+{
+    cJSON_KeyPool *pool = cJSON_KeyPool_Create();
+    const char *first = NULL;
+    char key[16];
+    int index = 0;
+    TEST_ASSERT_NOT_NULL(pool);
+
+    first = cJSON_KeyPool_Intern(pool, "name");
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL_STRING("name", first);
+    TEST_ASSERT_TRUE(first == cJSON_KeyPool_Intern(pool, "name"));
+    TEST_ASSERT_TRUE(first != cJSON_KeyPool_Intern(pool, "nam"));
+    TEST_ASSERT_EQUAL_STRING("", cJSON_KeyPool_Intern(pool, ""));
+    TEST_ASSERT_EQUAL_UINT(3U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+
+    /* more keys than the first table and block can hold */
+    for (index = 0; index < 1000; index++)
+    {
+        sprintf(key, "key%d", index);
+        TEST_ASSERT_EQUAL_STRING(key, cJSON_KeyPool_Intern(pool, key));
+    }
+    TEST_ASSERT_EQUAL_UINT(1003U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+    TEST_ASSERT_TRUE(first == cJSON_KeyPool_Intern(pool, "name"));
+    TEST_ASSERT_EQUAL_STRING("key500", cJSON_KeyPool_Intern(pool, "key500"));
+    TEST_ASSERT_EQUAL_UINT(1003U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+
+    TEST_ASSERT_NULL(cJSON_KeyPool_Intern(NULL, "name"));
+    TEST_ASSERT_NULL(cJSON_KeyPool_Intern(pool, NULL));
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)cJSON_KeyPool_GetCount(NULL));
+    cJSON_KeyPool_Delete(pool);
+    cJSON_KeyPool_Delete(NULL);
+}
+
+static void key_pool_should_share_the_keys_of_parsed_objects(void)
+{
+    cJSON_KeyPool *pool = cJSON_KeyPool_Create();
+    cJSON *tree = NULL;
+    cJSON *record = NULL;
+    const char *id = NULL;
+    TEST_ASSERT_NOT_NULL(pool);
+
+    tree = parse_pooled(records, pool);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+
+    id = cJSON_KeyPool_Intern(pool, "id");
+    cJSON_ArrayForEach(record, tree)
+    {
+        TEST_ASSERT_TRUE(record->child->string == id);
+        TEST_ASSERT_TRUE(record->child->type & cJSON_StringIsConst);
+        TEST_ASSERT_TRUE(cJSON_IsNumber(record->child));
+        TEST_ASSERT_TRUE(cJSON_IsString(record->child->next));
+        TEST_ASSERT_TRUE(cJSON_GetObjectItemCaseSensitive(record, id) == record->child);
+        TEST_ASSERT_TRUE(cJSON_GetObjectItem(record, "NAME") == record->child->next);
+    }
+    assert_prints(tree, records);
+
+    cJSON_Delete(tree);
+    cJSON_KeyPool_Delete(pool);
+}
+
+static void key_pool_should_intern_escaped_keys(void)
+{
+    cJSON_KeyPool *pool = cJSON_KeyPool_Create();
+    cJSON *tree = NULL;
+    TEST_ASSERT_NOT_NULL(pool);
+
+    tree = parse_pooled("{\"a\\u0062\":1,\"ab\":2,\"a\\\"b\":3,\"\":4}", pool);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_UINT(3U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+    TEST_ASSERT_TRUE(tree->child->string == tree->child->next->string);
+    TEST_ASSERT_TRUE(tree->child->string == cJSON_KeyPool_Intern(pool, "ab"));
+    TEST_ASSERT_EQUAL_STRING("a\"b", tree->child->next->next->string);
+    TEST_ASSERT_EQUAL_STRING("", tree->child->next->next->next->string);
+    assert_prints(tree, "{\"ab\":1,\"ab\":2,\"a\\\"b\":3,\"\":4}");
+
+    cJSON_Delete(tree);
+    cJSON_KeyPool_Delete(pool);
+}
+
+static void key_pool_should_keep_values_of_any_type(void)
+{
+    cJSON_KeyPool *pool = cJSON_KeyPool_Create();
+    cJSON_ParseOptions options = default_parse_options();
+    const char json[] = "{\"empty\":[],\"packed\":[1,2],\"list\":[true,{}],\"object\":{\"x\":null},\"text\":\"t\"}";
+    cJSON *tree = NULL;
+    cJSON *copy = NULL;
+    cJSON *member = NULL;
+    TEST_ASSERT_NOT_NULL(pool);
+
+    options.pack_numbers = true;
+    options.key_pool = pool;
+    tree = parse_with_options(json, &options);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_FALSE(tree->type & cJSON_StringIsConst);
+    cJSON_ArrayForEach(member, tree)
+    {
+        TEST_ASSERT_TRUE(member->type & cJSON_StringIsConst);
+    }
+    TEST_ASSERT_TRUE(cJSON_IsArray(cJSON_GetObjectItem(tree, "empty")));
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(tree, "packed")->type & cJSON_IsPacked);
+    TEST_ASSERT_TRUE(cJSON_IsObject(cJSON_GetObjectItem(tree, "object")));
+    TEST_ASSERT_TRUE(cJSON_IsString(cJSON_GetObjectItem(tree, "text")));
+
+    /* copies share the pooled keys too */
+    copy = cJSON_Duplicate(tree, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(copy->child->string == tree->child->string);
+    TEST_ASSERT_TRUE(cJSON_Compare(tree, copy, true));
+    cJSON_Delete(tree);
+    assert_prints(copy, "{\"empty\":[],\"packed\":[1,2],\"list\":[true,{}],\"object\":{\"x\":null},\"text\":\"t\"}");
+    cJSON_Delete(copy);
+
+    cJSON_KeyPool_Delete(pool);
+}
+
+static void key_pool_should_work_with_parsers(void)
+{
+    cJSON_KeyPool *pool = cJSON_KeyPool_Create();
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON_Parser *parser = NULL;
+    cJSON *first = NULL;
+    cJSON *second = NULL;
+    TEST_ASSERT_NOT_NULL(pool);
+
+    options.key_pool = pool;
+    parser = cJSON_Parser_Create(&options);
+    TEST_ASSERT_NOT_NULL(parser);
+
+    first = cJSON_Parser_Parse(parser, records, sizeof(records), NULL);
+    TEST_ASSERT_NOT_NULL(first);
+    cJSON_Parser_Release(parser, first);
+
+    /* the reused nodes don't keep the keys of the released tree */
+    second = cJSON_Parser_Parse(parser, "{\"other\":{\"id\":0}}", sizeof("{\"other\":{\"id\":0}}"), NULL);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL_UINT(3U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+    TEST_ASSERT_TRUE(second->child->child->string == cJSON_KeyPool_Intern(pool, "id"));
+    assert_prints(second, "{\"other\":{\"id\":0}}");
+    cJSON_Parser_Release(parser, second);
+
+    cJSON_Parser_Delete(parser);
+    cJSON_KeyPool_Delete(pool);
+}
+
+static void key_pool_should_free_invalid_documents(void)
+{
+    cJSON_KeyPool *pool = cJSON_KeyPool_Create();
+    TEST_ASSERT_NOT_NULL(pool);
+
+    TEST_ASSERT_NULL(parse_pooled("{\"a\":1,\"b\":", pool));
+    TEST_ASSERT_NULL(parse_pooled("{\"a\":{\"b\":[1,2}}", pool));
+    TEST_ASSERT_NULL(parse_pooled("{\"a", pool));
+    TEST_ASSERT_NULL(parse_pooled("{\"a\\u00\":1}", pool));
+    TEST_ASSERT_NULL(parse_pooled("{1:2}", pool));
+    TEST_ASSERT_NULL(parse_pooled("{1\":2}", pool));
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)cJSON_KeyPool_GetCount(pool));
+
+    cJSON_KeyPool_Delete(pool);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(key_pool_should_intern_keys);
+    RUN_TEST(key_pool_should_share_the_keys_of_parsed_objects);
+    RUN_TEST(key_pool_should_intern_escaped_keys);
+    RUN_TEST(key_pool_should_keep_values_of_any_type);
+    RUN_TEST(key_pool_should_work_with_parsers);
+    RUN_TEST(key_pool_should_free_invalid_documents);
+
+    return UNITY_END();
+}
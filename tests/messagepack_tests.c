@@ -0,0 +1,296 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_MsgPack.h"
+
+static cJSON *round_trip(const cJSON * const item)
+{
+    unsigned char *packed = NULL;
+    size_t length = 0;
+    cJSON *unpacked = NULL;
+
+    packed = cJSON_ToMessagePack(item, &length);
+    TEST_ASSERT_NOT_NULL(packed);
+    unpacked = cJSON_FromMessagePack(packed, length);
+    cJSON_free(packed);
+
+    return unpacked;
+}
+
+static void assert_packs_to(const char * const json, const unsigned char * const expected, const size_t expected_length)
+{
+    cJSON *item = cJSON_Parse(json);
+    unsigned char *packed = NULL;
+    size_t length = 0;
+    TEST_ASSERT_NOT_NULL(item);
+
+    packed = cJSON_ToMessagePack(item, &length);
+    TEST_ASSERT_NOT_NULL(packed);
+    TEST_ASSERT_EQUAL_UINT(expected_length, length);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, packed, expected_length);
+
+    cJSON_free(packed);
+    cJSON_Delete(item);
+}
+
+static void messagepack_should_use_the_smallest_formats(void)
+{
+    static const unsigned char object[] = { 0x82, 0xA1, 'a', 0xC0, 0xA1, 'b', 0x93, 0xC3, 0xC2, 0xA0 };
+    static const unsigned char integers[] = { 0x9A, 0x00, 0x7F, 0xCC, 0x80, 0xCD, 0x01, 0x00, 0xCE, 0x00, 0x01, 0x00, 0x00,
+        0xFF, 0xE0, 0xD0, 0xDF, 0xD1, 0xFF, 0x7F, 0xD2, 0xFF, 0xFF, 0x7F, 0xFF };
+    static const unsigned char large_integers[] = { 0x92, 0xCF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0xD3, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF };
+    static const unsigned char floats[] = { 0x93, 0xCA, 0x3F, 0xC0, 0x00, 0x00,
+        0xCB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A, 0xCA, 0x80, 0x00, 0x00, 0x00 };
+
+    assert_packs_to("{\"a\":null,\"b\":[true,false,\"\"]}", object, sizeof(object));
+    assert_packs_to("[0,127,128,256,65536,-1,-32,-33,-129,-32769]", integers, sizeof(integers));
+    assert_packs_to("[4294967296,-2147483649]", large_integers, sizeof(large_integers));
+    assert_packs_to("[1.5,0.1,-0]", floats, sizeof(floats));
+}
+
+static void messagepack_should_round_trip_numbers(void)
+{
+    static const double numbers[] = {
+        0, 1, 127, 128, 255, 256, 65535, 65536, 4294967295.0, 4294967296.0, 9007199254740992.0, 1e19,
+        -1, -32, -33, -128, -129, -32768, -32769, -2147483648.0, -2147483649.0, -9007199254740992.0, -9223372036854775808.0,
+        0.5, -0.25, 0.1, 1e300, -1e-300, 3.4028234663852886e38, 1e20
+    };
+    cJSON *array = cJSON_CreateDoubleArray(numbers, (int)(sizeof(numbers) / sizeof(numbers[0])));
+    cJSON *unpacked = NULL;
+    cJSON *element = NULL;
+    size_t index = 0;
+    TEST_ASSERT_NOT_NULL(array);
+
+    unpacked = round_trip(array);
+    TEST_ASSERT_NOT_NULL(unpacked);
+    TEST_ASSERT_EQUAL_INT(cJSON_GetArraySize(array), cJSON_GetArraySize(unpacked));
+    cJSON_ArrayForEach(element, unpacked)
+    {
+        TEST_ASSERT_TRUE(cJSON_IsNumber(element));
+        TEST_ASSERT_TRUE(element->valuedouble == numbers[index]);
+        index++;
+    }
+
+    cJSON_Delete(array);
+    cJSON_Delete(unpacked);
+}
+
+static void messagepack_should_round_trip_the_test_inputs(void)
+{
+    static const char * const inputs[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t index = 0;
+
+    for (index = 0; index < (sizeof(inputs) / sizeof(inputs[0])); index++)
+    {
+        char *json = read_file(inputs[index]);
+        cJSON *item = NULL;
+        cJSON *unpacked = NULL;
+        TEST_ASSERT_NOT_NULL(json);
+
+        item = cJSON_Parse(json);
+        free(json);
+        if (item == NULL)
+        {
+            /* some inputs are HTML */
+            continue;
+        }
+
+        unpacked = round_trip(item);
+        TEST_ASSERT_NOT_NULL_MESSAGE(unpacked, inputs[index]);
+        TEST_ASSERT_TRUE_MESSAGE(cJSON_Compare(item, unpacked, true), inputs[index]);
+
+        cJSON_Delete(item);
+        cJSON_Delete(unpacked);
+    }
+}
+
+static void messagepack_should_keep_raw_items(void)
+{
+    static const unsigned char packed[] = { 0x91, 0xD5, CJSON_MSGPACK_RAW_EXT, '[', ']' };
+    cJSON *array = cJSON_CreateArray();
+    cJSON *unpacked = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(array);
+
+    cJSON_AddItemToArray(array, cJSON_CreateRaw("{\"raw\":true}"));
+    cJSON_AddItemToArray(array, cJSON_CreateRaw(""));
+    unpacked = round_trip(array);
+    TEST_ASSERT_NOT_NULL(unpacked);
+    TEST_ASSERT_TRUE(cJSON_IsRaw(cJSON_GetArrayItem(unpacked, 0)));
+    TEST_ASSERT_EQUAL_STRING("{\"raw\":true}", cJSON_GetArrayItem(unpacked, 0)->valuestring);
+    TEST_ASSERT_EQUAL_STRING("", cJSON_GetArrayItem(unpacked, 1)->valuestring);
+    cJSON_Delete(unpacked);
+    cJSON_Delete(array);
+
+    unpacked = cJSON_FromMessagePack(packed, sizeof(packed));
+    TEST_ASSERT_NOT_NULL(unpacked);
+    printed = cJSON_PrintUnformatted(unpacked);
+    TEST_ASSERT_EQUAL_STRING("[[]]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(unpacked);
+}
+
+static void messagepack_should_write_long_strings_and_containers(void)
+{
+    char *string = (char*)malloc(70000);
+    cJSON *object = cJSON_CreateObject();
+    cJSON *array = cJSON_CreateArray();
+    cJSON *unpacked = NULL;
+    int index = 0;
+    TEST_ASSERT_NOT_NULL(string);
+
+    memset(string, 'x', 69999);
+    string[69999] = '\0';
+    TEST_ASSERT_NOT_NULL(cJSON_AddStringToObject(object, "long", string));
+    string[300] = '\0';
+    TEST_ASSERT_NOT_NULL(cJSON_AddStringToObject(object, "medium", string));
+    for (index = 0; index < 70000; index++)
+    {
+        cJSON_AddItemToArray(array, cJSON_CreateNumber(index));
+    }
+    cJSON_AddItemToObject(object, "array", array);
+
+    unpacked = round_trip(object);
+    TEST_ASSERT_NOT_NULL(unpacked);
+    TEST_ASSERT_TRUE(cJSON_Compare(object, unpacked, true));
+
+    free(string);
+    cJSON_Delete(object);
+    cJSON_Delete(unpacked);
+}
+
+static void messagepack_should_write_deferred_items_with_their_content(void)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *item = NULL;
+    cJSON *unpacked = NULL;
+    char *printed = NULL;
+
+    options.defer_depth = 1;
+    item = parse_with_options("{\"a\":{\"b\":[1,2]}}", &options);
+    TEST_ASSERT_NOT_NULL(item);
+
+    unpacked = round_trip(item);
+    TEST_ASSERT_NOT_NULL(unpacked);
+    printed = cJSON_PrintUnformatted(unpacked);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"b\":[1,2]}}", printed);
+    TEST_ASSERT_TRUE(cJSON_IsObject(cJSON_GetObjectItem(unpacked, "a")));
+    /* writing doesn't expand the item */
+    TEST_ASSERT_TRUE(item->child->type & cJSON_IsDeferred);
+
+    cJSON_free(printed);
+    cJSON_Delete(item);
+    cJSON_Delete(unpacked);
+}
+
+static void messagepack_should_write_packed_arrays_as_items(void)
+{
+    static const double numbers[] = { 1, -2.5, 0.1 };
+    cJSON *array = cJSON_CreatePackedArray(numbers, 3);
+    cJSON *unpacked = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(array);
+
+    unpacked = round_trip(array);
+    TEST_ASSERT_NOT_NULL(unpacked);
+    printed = cJSON_PrintUnformatted(unpacked);
+    TEST_ASSERT_EQUAL_STRING("[1,-2.5,0.1]", printed);
+    /* the array isn't unpacked */
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+
+    cJSON_free(printed);
+    cJSON_Delete(array);
+    cJSON_Delete(unpacked);
+}
+
+static void messagepack_should_reject_invalid_input(void)
+{
+    static const unsigned char truncated_string[] = { 0xA3, 'a', 'b' };
+    static const unsigned char truncated_array[] = { 0x92, 0x01 };
+    static const unsigned char huge_array[] = { 0xDD, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    static const unsigned char never_used[] = { 0xC1 };
+    static const unsigned char binary[] = { 0xC4, 0x01, 0x00 };
+    static const unsigned char integer_key[] = { 0x81, 0x01, 0x02 };
+    static const unsigned char zero_byte[] = { 0xA2, 'a', 0x00 };
+    static const unsigned char other_extension[] = { 0xD4, 0x7F, 0x00 };
+    static const unsigned char trailing[] = { 0xC0, 0xC0 };
+    static const unsigned char truncated_float[] = { 0xCB, 0x00, 0x00 };
+    unsigned char *deep = (unsigned char*)malloc(CJSON_NESTING_LIMIT + 2);
+    cJSON *item = NULL;
+
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(NULL, 1));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(trailing, 0));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(truncated_string, sizeof(truncated_string)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(truncated_array, sizeof(truncated_array)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(huge_array, sizeof(huge_array)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(never_used, sizeof(never_used)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(binary, sizeof(binary)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(integer_key, sizeof(integer_key)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(zero_byte, sizeof(zero_byte)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(other_extension, sizeof(other_extension)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(trailing, sizeof(trailing)));
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(truncated_float, sizeof(truncated_float)));
+
+    TEST_ASSERT_NOT_NULL(deep);
+    /* one array more than the parser accepts */
+    memset(deep, 0x91, CJSON_NESTING_LIMIT + 1);
+    deep[CJSON_NESTING_LIMIT + 1] = 0xC0;
+    TEST_ASSERT_NULL(cJSON_FromMessagePack(deep, CJSON_NESTING_LIMIT + 2));
+    item = cJSON_FromMessagePack(deep + 1, CJSON_NESTING_LIMIT + 1);
+    TEST_ASSERT_NOT_NULL(item);
+    cJSON_Delete(item);
+    free(deep);
+
+    item = cJSON_CreateObject();
+    TEST_ASSERT_NULL(cJSON_ToMessagePack(NULL, NULL));
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(item, "invalid", cJSON_CreateNull()));
+    cJSON_GetObjectItem(item, "invalid")->type = cJSON_Invalid;
+    TEST_ASSERT_NULL(cJSON_ToMessagePack(item, NULL));
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(messagepack_should_use_the_smallest_formats);
+    RUN_TEST(messagepack_should_round_trip_numbers);
+    RUN_TEST(messagepack_should_round_trip_the_test_inputs);
+    RUN_TEST(messagepack_should_keep_raw_items);
+    RUN_TEST(messagepack_should_write_long_strings_and_containers);
+    RUN_TEST(messagepack_should_write_deferred_items_with_their_content);
+    RUN_TEST(messagepack_should_write_packed_arrays_as_items);
+    RUN_TEST(messagepack_should_reject_invalid_input);
+
+    return UNITY_END();
+}
@@ -0,0 +1,258 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_Utils.h"
+
+/* generates minimal patches, checks that they turn 'from' into 'to' and returns how many there are */
+static int apply_minimal_patches(cJSON * const from, cJSON * const to)
+{
+    cJSON *patched = cJSON_Duplicate(from, true);
+    cJSON *patches = cJSONUtils_GenerateMinimalPatchesCaseSensitive(from, to);
+    int count = 0;
+
+    TEST_ASSERT_NOT_NULL(patched);
+    TEST_ASSERT_NOT_NULL(patches);
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(patched, patches));
+    TEST_ASSERT_TRUE_MESSAGE(cJSON_Compare(patched, to, true), "patches don't produce the target");
+
+    count = cJSON_GetArraySize(patches);
+    cJSON_Delete(patches);
+    cJSON_Delete(patched);
+
+    return count;
+}
+
+static cJSON *number_array(const int * const numbers, const int count)
+{
+    cJSON *array = cJSON_CreateIntArray(numbers, count);
+    TEST_ASSERT_NOT_NULL(array);
+
+    return array;
+}
+
+static void insertion_at_the_front_should_be_one_add(void)
+{
+    int numbers[1001];
+    cJSON *from = NULL;
+    cJSON *to = NULL;
+    cJSON *patches = NULL;
+    cJSON *patch = NULL;
+    int i = 0;
+
+    for (i = 0; i < 1001; i++)
+    {
+        numbers[i] = i;
+    }
+    from = number_array(numbers + 1, 1000);
+    to = number_array(numbers, 1001);
+
+    patches = cJSONUtils_GenerateMinimalPatches(from, to);
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(patches));
+    patch = cJSON_GetArrayItem(patches, 0);
+    TEST_ASSERT_EQUAL_STRING("add", cJSON_GetObjectItem(patch, "op")->valuestring);
+    TEST_ASSERT_EQUAL_STRING("/0", cJSON_GetObjectItem(patch, "path")->valuestring);
+    cJSON_Delete(patches);
+
+    TEST_ASSERT_EQUAL_INT(1, apply_minimal_patches(to, from));
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void moved_element_should_be_one_move(void)
+{
+    cJSON *from = cJSON_Parse("[{\"id\":1},{\"id\":2},{\"id\":3},{\"id\":4},{\"id\":5}]");
+    cJSON *to = cJSON_Parse("[{\"id\":2},{\"id\":3},{\"id\":4},{\"id\":1},{\"id\":5}]");
+    cJSON *patches = NULL;
+    cJSON *patch = NULL;
+
+    patches = cJSONUtils_GenerateMinimalPatches(from, to);
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(patches));
+    patch = cJSON_GetArrayItem(patches, 0);
+    TEST_ASSERT_EQUAL_STRING("move", cJSON_GetObjectItem(patch, "op")->valuestring);
+    TEST_ASSERT_EQUAL_STRING("/0", cJSON_GetObjectItem(patch, "from")->valuestring);
+    TEST_ASSERT_EQUAL_STRING("/3", cJSON_GetObjectItem(patch, "path")->valuestring);
+    cJSON_Delete(patches);
+
+    TEST_ASSERT_EQUAL_INT(1, apply_minimal_patches(to, from));
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void changed_elements_should_be_diffed_in_place(void)
+{
+    cJSON *from = cJSON_Parse("{\"list\":[1,{\"name\":\"a\",\"tags\":[1,2,3]},3]}");
+    cJSON *to = cJSON_Parse("{\"list\":[0,1,{\"name\":\"a\",\"tags\":[1,3]},3]}");
+    cJSON *patches = NULL;
+    char *printed = NULL;
+
+    patches = cJSONUtils_GenerateMinimalPatches(from, to);
+    printed = cJSON_PrintUnformatted(patches);
+    TEST_ASSERT_EQUAL_STRING("[{\"op\":\"add\",\"path\":\"/list/0\",\"value\":0},{\"op\":\"remove\",\"path\":\"/list/2/tags/1\"}]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+
+    TEST_ASSERT_EQUAL_INT(2, apply_minimal_patches(from, to));
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void default_patches_should_still_pair_by_index(void)
+{
+    cJSON *from = cJSON_Parse("[1,2,3]");
+    cJSON *to = cJSON_Parse("[0,1,2,3]");
+    cJSON *patches = NULL;
+
+    patches = cJSONUtils_GeneratePatches(from, to);
+    TEST_ASSERT_EQUAL_INT(4, cJSON_GetArraySize(patches));
+    cJSON_Delete(patches);
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static unsigned long random_state = 1;
+
+static int random_below(const int limit)
+{
+    random_state = (random_state * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    return (int)((random_state >> 8) % (unsigned long)limit);
+}
+
+static cJSON *random_element(void)
+{
+    if (random_below(4) == 0)
+    {
+        cJSON *object = cJSON_CreateObject();
+        cJSON_AddNumberToObject(object, "id", random_below(8));
+        cJSON_AddItemToObject(object, "list", cJSON_CreateArray());
+        cJSON_AddItemToArray(cJSON_GetObjectItem(object, "list"), cJSON_CreateNumber(random_below(3)));
+        return object;
+    }
+
+    /* few distinct values to get plenty of duplicates */
+    return cJSON_CreateNumber(random_below(6));
+}
+
+static void random_edits_should_produce_the_target(void)
+{
+    int round = 0;
+
+    for (round = 0; round < 400; round++)
+    {
+        cJSON *from = cJSON_CreateArray();
+        cJSON *to = NULL;
+        int size = random_below(40);
+        int edits = 1 + random_below(12);
+        int i = 0;
+
+        for (i = 0; i < size; i++)
+        {
+            cJSON_AddItemToArray(from, random_element());
+        }
+        to = cJSON_Duplicate(from, true);
+
+        for (i = 0; i < edits; i++)
+        {
+            int length = cJSON_GetArraySize(to);
+            switch (random_below(4))
+            {
+                case 0:
+                    cJSON_InsertItemInArray(to, random_below(length + 1), random_element());
+                    break;
+
+                case 1:
+                    if (length > 0)
+                    {
+                        cJSON_DeleteItemFromArray(to, random_below(length));
+                    }
+                    break;
+
+                case 2:
+                    if (length > 1)
+                    {
+                        cJSON *moved = cJSON_DetachItemFromArray(to, random_below(length));
+                        cJSON_InsertItemInArray(to, random_below(length), moved);
+                    }
+                    break;
+
+                default:
+                    if (length > 0)
+                    {
+                        cJSON_ReplaceItemInArray(to, random_below(length), random_element());
+                    }
+                    break;
+            }
+        }
+
+        apply_minimal_patches(from, to);
+        apply_minimal_patches(to, from);
+
+        cJSON_Delete(from);
+        cJSON_Delete(to);
+    }
+}
+
+static void distant_arrays_should_still_produce_the_target(void)
+{
+    int numbers[3000];
+    cJSON *from = NULL;
+    cJSON *to = NULL;
+    int i = 0;
+
+    for (i = 0; i < 3000; i++)
+    {
+        numbers[i] = i;
+    }
+    from = number_array(numbers, 1500);
+    to = number_array(numbers + 1500, 1500);
+
+    /* more edits than the limit of the diff, every element is replaced */
+    TEST_ASSERT_EQUAL_INT(1500, apply_minimal_patches(from, to));
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(insertion_at_the_front_should_be_one_add);
+    RUN_TEST(moved_element_should_be_one_move);
+    RUN_TEST(changed_elements_should_be_diffed_in_place);
+    RUN_TEST(default_patches_should_still_pair_by_index);
+    RUN_TEST(random_edits_should_produce_the_target);
+    RUN_TEST(distant_arrays_should_still_produce_the_target);
+
+    return UNITY_END();
+}
@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "unity/examples/unity_config.h"
 #include "unity/src/unity.h"
@@ -70,11 +71,373 @@ static void cjson_utils_functions_shouldnt_crash_with_null_pointers(void)
     cJSON_Delete(item);
 }
 
+static void find_pointer_should_use_parent_links(void)
+{
+    const char *json = "{\"a/b\":[0,{\"c~d\":[10,11,12,13,14,15,16,17,18,19,20]}],\"e\":{\"f\":null}}";
+    const char *paths[] = { "", "/a~1b", "/a~1b/1", "/a~1b/1/c~0d", "/a~1b/1/c~0d/10", "/e/f" };
+    cJSON *tracked = cJSON_Parse(json);
+    cJSON *untracked = cJSON_Parse(json);
+    cJSON *patches = cJSON_Parse("[{\"op\":\"replace\",\"path\":\"\",\"value\":{\"x\":[1,{\"y\":2}]}}]");
+    size_t i = 0;
+    TEST_ASSERT_NOT_NULL(tracked);
+    TEST_ASSERT_NOT_NULL(untracked);
+    TEST_ASSERT_NOT_NULL(patches);
+    TEST_ASSERT_TRUE(cJSON_TrackParents(tracked));
+
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+    {
+        char *from_links = cJSONUtils_FindPointerFromObjectTo(tracked, cJSONUtils_GetPointer(tracked, paths[i]));
+        char *from_search = cJSONUtils_FindPointerFromObjectTo(untracked, cJSONUtils_GetPointer(untracked, paths[i]));
+        TEST_ASSERT_EQUAL_STRING(paths[i], from_links);
+        TEST_ASSERT_EQUAL_STRING(paths[i], from_search);
+        cJSON_free(from_links);
+        cJSON_free(from_search);
+    }
+
+    /* relative to an inner item and for items that aren't below the object */
+    {
+        char *relative = cJSONUtils_FindPointerFromObjectTo(cJSONUtils_GetPointer(tracked, "/a~1b"), cJSONUtils_GetPointer(tracked, "/a~1b/1/c~0d/3"));
+        TEST_ASSERT_EQUAL_STRING("/1/c~0d/3", relative);
+        cJSON_free(relative);
+        TEST_ASSERT_NULL(cJSONUtils_FindPointerFromObjectTo(cJSONUtils_GetPointer(tracked, "/e"), cJSONUtils_GetPointer(tracked, "/a~1b/0")));
+    }
+
+    /* replacing the root keeps the links valid */
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(tracked, patches));
+    TEST_ASSERT_TRUE(cJSON_GetParent(tracked->child) == tracked);
+    {
+        char *pointer = cJSONUtils_FindPointerFromObjectTo(tracked, cJSONUtils_GetPointer(tracked, "/x/1/y"));
+        TEST_ASSERT_EQUAL_STRING("/x/1/y", pointer);
+        cJSON_free(pointer);
+    }
+
+    cJSON_Delete(patches);
+    cJSON_Delete(untracked);
+    cJSON_Delete(tracked);
+}
+
+static void patch_test_operation_should_not_reorder_objects(void)
+{
+    cJSON *object = cJSON_Parse("{\"b\":{\"y\":1,\"x\":2},\"a\":0}");
+    cJSON *patches = cJSON_Parse("[{\"op\":\"test\",\"path\":\"\",\"value\":{\"a\":0,\"b\":{\"x\":2,\"y\":1}}}]");
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(object);
+    TEST_ASSERT_NOT_NULL(patches);
+
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(object, patches));
+    printed = cJSON_PrintUnformatted(object);
+    TEST_ASSERT_EQUAL_STRING("{\"b\":{\"y\":1,\"x\":2},\"a\":0}", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+    cJSON_Delete(object);
+}
+
+static void generate_patches_should_skip_subtrees_with_equal_cached_hashes(void)
+{
+    cJSON *from = cJSON_Parse("{\"same\":{\"x\":[1,2,3]},\"changed\":{\"y\":1}}");
+    cJSON *to = cJSON_Parse("{\"changed\":{\"y\":2},\"same\":{\"x\":[1,2,3]}}");
+    cJSON *patches = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(from);
+    TEST_ASSERT_NOT_NULL(to);
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(from));
+    TEST_ASSERT_TRUE(cJSON_CacheHashes(to));
+
+    patches = cJSONUtils_GeneratePatchesCaseSensitive(from, to);
+    printed = cJSON_PrintUnformatted(patches);
+    TEST_ASSERT_EQUAL_STRING("[{\"op\":\"replace\",\"path\":\"/changed/y\",\"value\":2}]", printed);
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+
+    patches = cJSONUtils_GenerateMergePatchCaseSensitive(from, to);
+    printed = cJSON_PrintUnformatted(patches);
+    TEST_ASSERT_EQUAL_STRING("{\"changed\":{\"y\":2}}", printed);
+    cJSON_free(printed);
+    cJSON_Delete(patches);
+
+    /* identical trees */
+    {
+        cJSON *y = cJSON_GetObjectItem(cJSON_GetObjectItem(to, "changed"), "y");
+        y->valuedouble = 1;
+        y->valueint = 1;
+        cJSON_MarkDirty(y);
+    }
+    cJSON_CacheHashes(to);
+    patches = cJSONUtils_GeneratePatchesCaseSensitive(from, to);
+    TEST_ASSERT_NULL(patches->child);
+    cJSON_Delete(patches);
+    TEST_ASSERT_NULL(cJSONUtils_GenerateMergePatchCaseSensitive(from, to));
+
+    cJSON_Delete(from);
+    cJSON_Delete(to);
+}
+
+static void merge_patch_consume_should_move_values(void)
+{
+    cJSON *target = cJSON_Parse("{\"a\":1,\"b\":{\"c\":2,\"d\":3}}");
+    cJSON *patch = cJSON_Parse("{\"a\":null,\"b\":{\"c\":[4,5]},\"e\":\"new\"}");
+    cJSON *list = cJSON_GetObjectItem(cJSON_GetObjectItem(patch, "b"), "c");
+    cJSON *string = cJSON_GetObjectItem(patch, "e");
+    char *printed = NULL;
+
+    target = cJSONUtils_MergePatchConsume(target, patch);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(cJSON_GetObjectItem(target, "b"), "c") == list);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(target, "e") == string);
+
+    printed = cJSON_PrintUnformatted(target);
+    TEST_ASSERT_EQUAL_STRING("{\"b\":{\"d\":3,\"c\":[4,5]},\"e\":\"new\"}", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(target);
+}
+
+static void generate_merge_patch_move_should_move_values(void)
+{
+    cJSON *from = cJSON_Parse("{\"a\":1,\"b\":{\"c\":2,\"d\":3},\"f\":0}");
+    cJSON *to = cJSON_Parse("{\"b\":{\"c\":[4,5],\"d\":3},\"e\":{\"x\":1},\"f\":0}");
+    cJSON *list = cJSON_GetObjectItem(cJSON_GetObjectItem(to, "b"), "c");
+    cJSON *object = cJSON_GetObjectItem(to, "e");
+    cJSON *patch = NULL;
+    char *printed = NULL;
+
+    patch = cJSONUtils_GenerateMergePatchMove(from, to);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(cJSON_GetObjectItem(patch, "b"), "c") == list);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(patch, "e") == object);
+
+    printed = cJSON_PrintUnformatted(patch);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":null,\"b\":{\"c\":[4,5]},\"e\":{\"x\":1}}", printed);
+
+    cJSON_free(printed);
+    cJSON_Delete(patch);
+    cJSON_Delete(from);
+}
+
+static int compare_lower_case(const char *a, const char *b)
+{
+    for (; tolower((unsigned char)*a) == tolower((unsigned char)*b); (void)a++, b++)
+    {
+        if (*a == '\0')
+        {
+            return 0;
+        }
+    }
+
+    return tolower((unsigned char)*a) - tolower((unsigned char)*b);
+}
+
+static void sort_object_should_sort_large_objects(void)
+{
+    cJSON *object = cJSON_CreateObject();
+    cJSON *child = NULL;
+    char key[32];
+    unsigned long state = 7;
+    int i = 0;
+
+    for (i = 0; i < 1000; i++)
+    {
+        state = (state * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+        /* long shared prefixes, mixed case and duplicates */
+        sprintf(key, "%s%lu", ((state >> 3) & 1) ? "Key_" : "key_", (state >> 8) % 600);
+        TEST_ASSERT_NOT_NULL(cJSON_AddNumberToObject(object, key, i));
+    }
+
+    cJSONUtils_SortObject(object);
+    TEST_ASSERT_EQUAL_INT(1000, cJSON_GetArraySize(object));
+    TEST_ASSERT_NULL(object->child->prev->next);
+    for (child = object->child; child->next != NULL; child = child->next)
+    {
+        int difference = compare_lower_case(child->string, child->next->string);
+        TEST_ASSERT_TRUE(difference <= 0);
+        TEST_ASSERT_TRUE(child->next->prev == child);
+        if (difference == 0)
+        {
+            /* equal keys keep their order */
+            TEST_ASSERT_TRUE(child->valueint < child->next->valueint);
+        }
+    }
+    TEST_ASSERT_TRUE(object->child->prev == child);
+
+    cJSONUtils_SortObjectCaseSensitive(object);
+    for (child = object->child; child->next != NULL; child = child->next)
+    {
+        TEST_ASSERT_TRUE(strcmp(child->string, child->next->string) <= 0);
+    }
+    TEST_ASSERT_TRUE(object->child->prev == child);
+
+    cJSON_Delete(object);
+}
+
+static void utils_should_not_change_shared_items(void)
+{
+    cJSON *original = cJSON_Parse("{\"z\":{\"b\":1,\"a\":[1,2]},\"y\":true}");
+    cJSON *copy = cJSON_DuplicateShared(original);
+    cJSON *patches = cJSON_Parse("[{\"op\":\"add\",\"path\":\"/z/a/-\",\"value\":3},{\"op\":\"remove\",\"path\":\"/y\"}]");
+    cJSON *merge = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_NOT_NULL(patches);
+
+    TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesAtomic(copy, patches));
+    cJSONUtils_SortObject(original);
+
+    printed = cJSON_PrintUnformatted(original);
+    TEST_ASSERT_EQUAL_STRING("{\"y\":true,\"z\":{\"b\":1,\"a\":[1,2]}}", printed);
+    cJSON_free(printed);
+    printed = cJSON_PrintUnformatted(copy);
+    TEST_ASSERT_EQUAL_STRING("{\"z\":{\"b\":1,\"a\":[1,2,3]}}", printed);
+    cJSON_free(printed);
+
+    /* a consumed patch that shares its values with the original */
+    merge = cJSONUtils_MergePatchConsume(copy, cJSON_DuplicateShared(original));
+    printed = cJSON_PrintUnformatted(merge);
+    TEST_ASSERT_EQUAL_STRING("{\"y\":true,\"z\":{\"b\":1,\"a\":[1,2]}}", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(original);
+    printed = cJSON_PrintUnformatted(merge);
+    TEST_ASSERT_EQUAL_STRING("{\"y\":true,\"z\":{\"b\":1,\"a\":[1,2]}}", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(merge);
+    cJSON_Delete(patches);
+}
+
+static void utils_should_expand_deferred_items(void)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    const char from_json[] = "{\"a\":[1,2,3],\"o\":{\"x\":{\"y\":[4,5]}}}";
+    const char to_json[] = "{\"a\":[1,9,3,4],\"o\":{\"x\":{\"y\":[4,6]}}}";
+    cJSON *from = NULL;
+    cJSON *to = NULL;
+    cJSON *patched = NULL;
+    cJSON *patches = NULL;
+    cJSON *merge = NULL;
+    char *printed = NULL;
+    int minimal = 0;
+
+    options.defer_depth = 2;
+    for (minimal = 0; minimal < 2; minimal++)
+    {
+        from = parse_with_options(from_json, &options);
+        to = parse_with_options(to_json, &options);
+        patched = parse_with_options(from_json, &options);
+        TEST_ASSERT_NOT_NULL(from);
+        TEST_ASSERT_NOT_NULL(to);
+        TEST_ASSERT_NOT_NULL(patched);
+
+        patches = minimal ? cJSONUtils_GenerateMinimalPatchesCaseSensitive(from, to) : cJSONUtils_GeneratePatchesCaseSensitive(from, to);
+        TEST_ASSERT_NOT_NULL(patches);
+        TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatchesCaseSensitive(patched, patches));
+        TEST_ASSERT_TRUE(cJSON_Compare(patched, to, true));
+
+        cJSON_Delete(patches);
+        cJSON_Delete(patched);
+        cJSON_Delete(to);
+        cJSON_Delete(from);
+    }
+
+    options.defer_depth = 1;
+    from = parse_with_options("{\"o\":{\"y\":2,\"x\":1}}", &options);
+    to = parse_with_options("{\"o\":{\"x\":1,\"y\":3}}", &options);
+    TEST_ASSERT_NOT_NULL(from);
+    TEST_ASSERT_NOT_NULL(to);
+
+    cJSONUtils_SortObjectCaseSensitive(from->child);
+    printed = cJSON_PrintUnformatted(from);
+    TEST_ASSERT_EQUAL_STRING("{\"o\":{\"x\":1,\"y\":2}}", printed);
+    cJSON_free(printed);
+
+    merge = cJSONUtils_GenerateMergePatchCaseSensitive(from, to);
+    printed = cJSON_PrintUnformatted(merge);
+    TEST_ASSERT_EQUAL_STRING("{\"o\":{\"y\":3}}", printed);
+    cJSON_free(printed);
+    cJSON_Delete(merge);
+
+    /* a deferred patch is merged member by member */
+    merge = parse_with_options("{\"o\":{\"x\":null,\"z\":4}}", &options);
+    TEST_ASSERT_NOT_NULL(merge);
+    from = cJSONUtils_MergePatchCaseSensitive(from, merge);
+    printed = cJSON_PrintUnformatted(from);
+    TEST_ASSERT_EQUAL_STRING("{\"o\":{\"y\":2,\"z\":4}}", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(merge);
+    cJSON_Delete(to);
+    cJSON_Delete(from);
+}
+
+/* depth nested objects {"a":{"a":...{"a":number}}}, innermost is set to the number */
+static cJSON *create_deep_objects(const size_t depth, const double number, cJSON ** const innermost)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *object = root;
+    size_t level = 0;
+    TEST_ASSERT_NOT_NULL(root);
+
+    for (level = 1; level < depth; level++)
+    {
+        object = cJSON_AddObjectToObject(object, "a");
+        TEST_ASSERT_NOT_NULL(object);
+    }
+    *innermost = cJSON_AddNumberToObject(object, "a", number);
+    TEST_ASSERT_NOT_NULL(*innermost);
+
+    return root;
+}
+
+static void utils_should_handle_deep_documents(void)
+{
+    const size_t depth = CJSON_NESTING_LIMIT + 500;
+    cJSON *innermost = NULL;
+    cJSON *from = create_deep_objects(depth, 1, &innermost);
+    cJSON *to = create_deep_objects(depth, 2, &innermost);
+    cJSON *patched = NULL;
+    cJSON *patches = NULL;
+    char *pointer = NULL;
+    int minimal = 0;
+
+    /* searched without parent links */
+    pointer = cJSONUtils_FindPointerFromObjectTo(to, innermost);
+    TEST_ASSERT_NOT_NULL(pointer);
+    TEST_ASSERT_TRUE(strlen(pointer) == (2 * depth));
+    TEST_ASSERT_EQUAL_STRING_LEN("/a/a/a", pointer, 6);
+    TEST_ASSERT_TRUE(cJSONUtils_GetPointer(to, pointer) == innermost);
+    cJSON_free(pointer);
+
+    /* below the nesting limit the rest is replaced as a whole */
+    for (minimal = 0; minimal < 2; minimal++)
+    {
+        patched = create_deep_objects(depth, 1, &innermost);
+        patches = minimal ? cJSONUtils_GenerateMinimalPatches(from, to) : cJSONUtils_GeneratePatches(from, to);
+        TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(patches));
+        TEST_ASSERT_EQUAL_INT(0, cJSONUtils_ApplyPatches(patched, patches));
+        TEST_ASSERT_TRUE(cJSON_Compare(patched, to, true));
+        cJSON_Delete(patches);
+        cJSON_Delete(patched);
+    }
+
+    /* merge patches nested that deep are refused */
+    TEST_ASSERT_NULL(cJSONUtils_GenerateMergePatch(from, to));
+    TEST_ASSERT_NULL(cJSONUtils_MergePatch(from, to));
+
+    cJSON_Delete(to);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(cjson_utils_functions_shouldnt_crash_with_null_pointers);
+    RUN_TEST(find_pointer_should_use_parent_links);
+    RUN_TEST(patch_test_operation_should_not_reorder_objects);
+    RUN_TEST(generate_patches_should_skip_subtrees_with_equal_cached_hashes);
+    RUN_TEST(merge_patch_consume_should_move_values);
+    RUN_TEST(generate_merge_patch_move_should_move_values);
+    RUN_TEST(sort_object_should_sort_large_objects);
+    RUN_TEST(utils_should_not_change_shared_items);
+    RUN_TEST(utils_should_expand_deferred_items);
+    RUN_TEST(utils_should_handle_deep_documents);
 
     return UNITY_END();
 }
@@ -186,6 +186,14 @@ static void merge_tests(void)
         free(after);
         cJSON_Delete(object_to_be_merged);
         cJSON_Delete(patch);
+
+        /* same result when the values are moved out of the patch */
+        object_to_be_merged = cJSONUtils_MergePatchConsume(cJSON_Parse(merges[i][0]), cJSON_Parse(merges[i][1]));
+        after = cJSON_PrintUnformatted(object_to_be_merged);
+        TEST_ASSERT_EQUAL_STRING(merges[i][2], after);
+
+        free(after);
+        cJSON_Delete(object_to_be_merged);
     }
 }
 
@@ -208,6 +216,16 @@ static void generate_merge_tests(void)
         cJSON_Delete(to);
         cJSON_Delete(patch);
         free(patchedtext);
+
+        /* same result when the values are moved out of 'to' */
+        from = cJSON_Parse(merges[i][0]);
+        patch = cJSONUtils_GenerateMergePatchMove(from, cJSON_Parse(merges[i][2]));
+        from = cJSONUtils_MergePatchConsume(from, patch);
+        patchedtext = cJSON_PrintUnformatted(from);
+        TEST_ASSERT_EQUAL_STRING(merges[i][2], patchedtext);
+
+        cJSON_Delete(from);
+        free(patchedtext);
     }
 }
 
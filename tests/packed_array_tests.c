@@ -0,0 +1,299 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static const double numbers[] = { 1, -2.5, 0.1, 1e300, 3000000000.0 };
+
+static void assert_prints(const cJSON * const item, const char * const expected)
+{
+    char *printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+    cJSON_free(printed);
+}
+
+static cJSON *parse_packed(const char * const json)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    options.pack_numbers = true;
+
+    return parse_with_options(json, &options);
+}
+
+static void create_packed_array_should_store_numbers_packed(void)
+{
+    cJSON *array = cJSON_CreatePackedArray(numbers, 5);
+    const double *packed = NULL;
+    int count = 0;
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_TRUE(cJSON_IsArray(array));
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+    TEST_ASSERT_NULL(array->child);
+    TEST_ASSERT_EQUAL_INT(5, cJSON_GetArraySize(array));
+
+    packed = cJSON_GetDoubleArray(array, &count);
+    TEST_ASSERT_NOT_NULL(packed);
+    TEST_ASSERT_EQUAL_INT(5, count);
+    TEST_ASSERT_TRUE(packed != numbers);
+    TEST_ASSERT_EQUAL_MEMORY(numbers, packed, sizeof(numbers));
+
+    assert_prints(array, "[1,-2.5,0.1,1e+300,3000000000]");
+    printed = cJSON_Print(array);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING("[1, -2.5, 0.1, 1e+300, 3000000000]", printed);
+    cJSON_free(printed);
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+
+    cJSON_Delete(array);
+}
+
+static void create_packed_array_should_handle_edge_cases(void)
+{
+    cJSON *array = cJSON_CreatePackedArray(NULL, 0);
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_FALSE(array->type & cJSON_IsPacked);
+    assert_prints(array, "[]");
+    cJSON_Delete(array);
+
+    TEST_ASSERT_NULL(cJSON_CreatePackedArray(NULL, 1));
+    TEST_ASSERT_NULL(cJSON_CreatePackedArray(numbers, -1));
+    TEST_ASSERT_NULL(cJSON_GetDoubleArray(NULL, NULL));
+    TEST_ASSERT_NULL(cJSON_GetFirstChild(NULL));
+
+    array = cJSON_CreateDoubleArray(numbers, 5);
+    TEST_ASSERT_NULL(cJSON_GetDoubleArray(array, NULL));
+    cJSON_Delete(array);
+}
+
+static void packed_arrays_should_be_unpacked_for_items(void)
+{
+    cJSON *array = cJSON_CreatePackedArray(numbers, 5);
+    cJSON *element = NULL;
+    int index = 0;
+    TEST_ASSERT_NOT_NULL(array);
+
+    cJSON_ArrayForEach(element, array)
+    {
+        TEST_ASSERT_TRUE(cJSON_IsNumber(element));
+        TEST_ASSERT_TRUE(element->valuedouble == numbers[index]);
+        index++;
+    }
+    TEST_ASSERT_EQUAL_INT(5, index);
+    TEST_ASSERT_FALSE(array->type & cJSON_IsPacked);
+    TEST_ASSERT_NULL(array->valuestring);
+    TEST_ASSERT_EQUAL_INT(2147483647, cJSON_GetArrayItem(array, 4)->valueint);
+    TEST_ASSERT_TRUE(array->child->prev == cJSON_GetArrayItem(array, 4));
+    cJSON_Delete(array);
+
+    array = cJSON_CreatePackedArray(numbers, 2);
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_TRUE(cJSON_GetArrayItem(array, 1)->valuedouble == -2.5);
+    TEST_ASSERT_FALSE(array->type & cJSON_IsPacked);
+    cJSON_Delete(array);
+
+    array = cJSON_CreatePackedArray(numbers, 2);
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(array, cJSON_CreateString("x")));
+    assert_prints(array, "[1,-2.5,\"x\"]");
+    cJSON_Delete(array);
+}
+
+static void packed_arrays_should_be_duplicated_and_compared(void)
+{
+    cJSON *array = cJSON_CreatePackedArray(numbers, 5);
+    cJSON *copy = NULL;
+    cJSON *linked = cJSON_CreateDoubleArray(numbers, 5);
+    cJSON_HashValue array_hash;
+    cJSON_HashValue linked_hash;
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_NOT_NULL(linked);
+
+    copy = cJSON_Duplicate(array, true);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(copy->type & cJSON_IsPacked);
+    TEST_ASSERT_TRUE(copy->valuestring != array->valuestring);
+    TEST_ASSERT_TRUE(cJSON_Compare(array, copy, true));
+    TEST_ASSERT_TRUE(copy->type & cJSON_IsPacked);
+    cJSON_Delete(copy);
+
+    copy = cJSON_DuplicateShared(array);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(copy->type & cJSON_IsPacked);
+    TEST_ASSERT_FALSE(copy->type & cJSON_IsShared);
+    cJSON_Delete(copy);
+
+    /* packed and linked arrays with the same numbers are the same */
+    array_hash = cJSON_Hash(array);
+    linked_hash = cJSON_Hash(linked);
+    TEST_ASSERT_EQUAL_MEMORY(linked_hash.words, array_hash.words, sizeof(array_hash.words));
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+    TEST_ASSERT_TRUE(cJSON_Compare(linked, array, true));
+    TEST_ASSERT_TRUE(cJSON_Compare(array, linked, true));
+    /* comparing doesn't unpack */
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+
+    copy = cJSON_CreatePackedArray(numbers, 4);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_FALSE(cJSON_Compare(array, copy, true));
+    TEST_ASSERT_FALSE(cJSON_Compare(linked, copy, true));
+    TEST_ASSERT_FALSE(cJSON_Compare(copy, linked, true));
+    cJSON_Delete(copy);
+
+    cJSON_Delete(linked);
+    cJSON_Delete(array);
+}
+
+static void parse_with_pack_numbers_should_pack_number_arrays(void)
+{
+    cJSON *json = parse_packed("{\"a\":[1, 2.5 ,-3e2],\"b\":[1,\"two\"],\"c\":[],\"d\":[[4],[5,6]]}");
+    cJSON *a = NULL;
+    const double *packed = NULL;
+    int count = 0;
+    TEST_ASSERT_NOT_NULL(json);
+
+    a = cJSON_GetObjectItem(json, "a");
+    TEST_ASSERT_TRUE(a->type & cJSON_IsPacked);
+    packed = cJSON_GetDoubleArray(a, &count);
+    TEST_ASSERT_EQUAL_INT(3, count);
+    TEST_ASSERT_TRUE(packed[0] == 1);
+    TEST_ASSERT_TRUE(packed[1] == 2.5);
+    TEST_ASSERT_TRUE(packed[2] == -300);
+
+    TEST_ASSERT_FALSE(cJSON_GetObjectItem(json, "b")->type & cJSON_IsPacked);
+    TEST_ASSERT_FALSE(cJSON_GetObjectItem(json, "c")->type & cJSON_IsPacked);
+    TEST_ASSERT_FALSE(cJSON_GetObjectItem(json, "d")->type & cJSON_IsPacked);
+    TEST_ASSERT_TRUE(cJSON_GetArrayItem(cJSON_GetObjectItem(json, "d"), 1)->type & cJSON_IsPacked);
+
+    assert_prints(json, "{\"a\":[1,2.5,-300],\"b\":[1,\"two\"],\"c\":[],\"d\":[[4],[5,6]]}");
+    cJSON_Delete(json);
+
+    /* errors are still reported */
+    TEST_ASSERT_NULL(parse_packed("[1,2"));
+    TEST_ASSERT_NULL(parse_packed("[1,2,]"));
+    TEST_ASSERT_NULL(parse_packed("[1,-]"));
+}
+
+static void pack_array_should_pack_number_arrays(void)
+{
+    cJSON *array = cJSON_CreateDoubleArray(numbers, 5);
+    cJSON *mixed = cJSON_Parse("[1,true]");
+    cJSON *copy = NULL;
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_NOT_NULL(mixed);
+
+    copy = cJSON_DuplicateShared(array);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(cJSON_PackArray(array));
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+    TEST_ASSERT_NULL(array->child);
+    TEST_ASSERT_TRUE(cJSON_Compare(array, copy, true));
+    /* the copy kept the children */
+    TEST_ASSERT_EQUAL_INT(5, cJSON_GetArraySize(copy));
+    TEST_ASSERT_TRUE(cJSON_PackArray(array));
+
+    TEST_ASSERT_FALSE(cJSON_PackArray(mixed));
+    TEST_ASSERT_FALSE(cJSON_PackArray(NULL));
+    TEST_ASSERT_FALSE(cJSON_PackArray(cJSON_GetArrayItem(mixed, 0)));
+    assert_prints(mixed, "[1,true]");
+
+    cJSON_Delete(copy);
+    cJSON_Delete(mixed);
+    cJSON_Delete(array);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+static void packed_arrays_should_be_read_by_index(void)
+{
+    cJSON *array = cJSON_CreatePackedArray(numbers, 5);
+    cJSON *linked = cJSON_Parse("[1, \"two\"]");
+    double number = 0;
+    TEST_ASSERT_NOT_NULL(array);
+    TEST_ASSERT_NOT_NULL(linked);
+
+    TEST_ASSERT_TRUE(cJSON_GetPackedNumber(array, 1, &number));
+    TEST_ASSERT_EQUAL_DOUBLE(-2.5, number);
+    TEST_ASSERT_TRUE(cJSON_GetPackedNumber(array, 3, &number));
+    TEST_ASSERT_EQUAL_DOUBLE(1e300, number);
+    TEST_ASSERT_FALSE(cJSON_GetPackedNumber(array, 5, &number));
+    TEST_ASSERT_FALSE(cJSON_GetPackedNumber(array, -1, &number));
+    TEST_ASSERT_FALSE(cJSON_GetPackedNumber(array, 0, NULL));
+    TEST_ASSERT_FALSE(cJSON_GetPackedNumber(NULL, 0, &number));
+    /* no items were created */
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+    TEST_ASSERT_NULL(array->child);
+
+    /* normal arrays work too */
+    TEST_ASSERT_TRUE(cJSON_GetPackedNumber(linked, 0, &number));
+    TEST_ASSERT_EQUAL_DOUBLE(1, number);
+    TEST_ASSERT_FALSE(cJSON_GetPackedNumber(linked, 1, &number));
+
+    cJSON_Delete(linked);
+    cJSON_Delete(array);
+}
+
+static void packed_arrays_should_be_written_as_items(void)
+{
+    cJSON *array = cJSON_CreatePackedArray(numbers, 3);
+    cJSON *reference = NULL;
+    char *canonical = NULL;
+    TEST_ASSERT_NOT_NULL(array);
+
+    canonical = cJSON_PrintCanonical(array);
+    TEST_ASSERT_EQUAL_STRING("[1,-2.5,0.1]", canonical);
+    cJSON_free(canonical);
+
+    /* that doesn't unpack the array */
+    TEST_ASSERT_TRUE(array->type & cJSON_IsPacked);
+
+    /* references can't share the buffer */
+    reference = cJSON_CreateArray();
+    TEST_ASSERT_TRUE(cJSON_AddItemReferenceToArray(reference, array));
+    TEST_ASSERT_FALSE(array->type & cJSON_IsPacked);
+    assert_prints(reference, "[[1,-2.5,0.1]]");
+    cJSON_Delete(reference);
+    cJSON_Delete(array);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(create_packed_array_should_store_numbers_packed);
+    RUN_TEST(create_packed_array_should_handle_edge_cases);
+    RUN_TEST(packed_arrays_should_be_unpacked_for_items);
+    RUN_TEST(packed_arrays_should_be_duplicated_and_compared);
+    RUN_TEST(parse_with_pack_numbers_should_pack_number_arrays);
+    RUN_TEST(pack_array_should_pack_number_arrays);
+    RUN_TEST(packed_arrays_should_be_read_by_index);
+    RUN_TEST(packed_arrays_should_be_written_as_items);
+
+    return UNITY_END();
+}
@@ -0,0 +1,192 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static void parent_tracking_should_link_parsed_trees(void)
+{
+    cJSON *tree = cJSON_Parse("{\"a\":[1,{\"b\":true}],\"c\":null}");
+    cJSON *untracked = cJSON_Parse("[1]");
+    cJSON *a = NULL;
+    cJSON *inner = NULL;
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_NOT_NULL(untracked);
+
+    TEST_ASSERT_TRUE(cJSON_TrackParents(tree));
+    a = cJSON_GetObjectItem(tree, "a");
+    inner = cJSON_GetArrayItem(a, 1);
+
+    TEST_ASSERT_NULL(cJSON_GetParent(tree));
+    TEST_ASSERT_TRUE(cJSON_GetParent(a) == tree);
+    TEST_ASSERT_TRUE(cJSON_GetParent(cJSON_GetObjectItem(tree, "c")) == tree);
+    TEST_ASSERT_TRUE(cJSON_GetParent(cJSON_GetArrayItem(a, 0)) == a);
+    TEST_ASSERT_TRUE(cJSON_GetParent(inner) == a);
+    TEST_ASSERT_TRUE(cJSON_GetParent(cJSON_GetObjectItem(inner, "b")) == inner);
+
+    TEST_ASSERT_NULL(cJSON_GetParent(untracked->child));
+    TEST_ASSERT_FALSE(cJSON_TrackParents(NULL));
+    TEST_ASSERT_NULL(cJSON_GetParent(NULL));
+
+    cJSON_Delete(untracked);
+    cJSON_Delete(tree);
+    /* deleting the items drops their links */
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)node_info_count);
+    TEST_ASSERT_NULL(node_infos);
+}
+
+static void parent_tracking_should_follow_modifications(void)
+{
+    cJSON *tree = cJSON_Parse("{\"list\":[1,2]}");
+    cJSON *list = NULL;
+    cJSON *added = cJSON_CreateObject();
+    cJSON *nested = cJSON_AddArrayToObject(added, "nested");
+    cJSON *inserted = cJSON_CreateString("inserted");
+    cJSON *replacement = cJSON_CreateArray();
+    cJSON *replacement_child = cJSON_CreateNumber(3);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cJSON_TrackParents(tree));
+    list = cJSON_GetObjectItem(tree, "list");
+
+    /* not tracked until it is added to a tracked container */
+    TEST_ASSERT_NULL(cJSON_GetParent(nested));
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(tree, "added", added));
+    TEST_ASSERT_TRUE(cJSON_GetParent(added) == tree);
+    TEST_ASSERT_TRUE(cJSON_GetParent(nested) == added);
+
+    TEST_ASSERT_TRUE(cJSON_InsertItemInArray(list, 1, inserted));
+    TEST_ASSERT_TRUE(cJSON_GetParent(inserted) == list);
+
+    cJSON_AddItemToArray(replacement, replacement_child);
+    TEST_ASSERT_TRUE(cJSON_ReplaceItemInObject(tree, "added", replacement));
+    TEST_ASSERT_TRUE(cJSON_GetParent(replacement) == tree);
+    TEST_ASSERT_TRUE(cJSON_GetParent(replacement_child) == replacement);
+
+    /* a detached item becomes the root of its own tree */
+    list = cJSON_DetachItemFromObject(tree, "list");
+    TEST_ASSERT_NULL(cJSON_GetParent(list));
+    TEST_ASSERT_TRUE(cJSON_GetParent(inserted) == list);
+
+    cJSON_Delete(list);
+    cJSON_Delete(tree);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)node_info_count);
+}
+
+static void parent_tracking_should_link_while_parsing(void)
+{
+    const char json[] = "{\"a\":[1,{\"b\":true}],\"c\":{\"d\":[2]}}";
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON_Parser *parser = NULL;
+    cJSON *tree = NULL;
+    cJSON *a = NULL;
+    cJSON *c = NULL;
+    cJSON *d = NULL;
+
+    options.track_parents = true;
+    options.defer_depth = 2;
+    tree = parse_with_options(json, &options);
+    TEST_ASSERT_NOT_NULL(tree);
+
+    a = tree->child;
+    TEST_ASSERT_NULL(cJSON_GetParent(tree));
+    TEST_ASSERT_TRUE(cJSON_GetParent(a) == tree);
+    TEST_ASSERT_TRUE(cJSON_GetParent(a->child) == a);
+    TEST_ASSERT_TRUE(cJSON_GetParent(a->child->next) == a);
+    /* deferred items are linked when they are expanded */
+    c = cJSON_GetObjectItem(tree, "c");
+    d = cJSON_GetObjectItem(c, "d");
+    TEST_ASSERT_TRUE(cJSON_GetParent(d) == c);
+    TEST_ASSERT_TRUE(cJSON_GetParent(d->child) == d);
+
+    cJSON_Delete(tree);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)node_info_count);
+
+    /* reused items are linked again */
+    parser = cJSON_Parser_Create(&options);
+    TEST_ASSERT_NOT_NULL(parser);
+    tree = cJSON_Parser_Parse(parser, "[[1]]", sizeof("[[1]]"), NULL);
+    TEST_ASSERT_NOT_NULL(tree);
+    cJSON_Parser_Release(parser, tree);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)node_info_count);
+    tree = cJSON_Parser_Parse(parser, "{\"x\":[true]}", sizeof("{\"x\":[true]}"), NULL);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cJSON_GetParent(tree->child->child) == tree->child);
+    TEST_ASSERT_TRUE(cJSON_GetParent(tree->child) == tree);
+    cJSON_Parser_Release(parser, tree);
+    cJSON_Parser_Delete(parser);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)node_info_count);
+}
+
+static void parent_tracking_should_link_expanded_items(void)
+{
+    const char json[] = "{\"a\":{\"b\":[1]}}";
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *tree = NULL;
+    cJSON *a = NULL;
+    cJSON *b = NULL;
+
+    options.defer_depth = 1;
+    tree = parse_with_options(json, &options);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cJSON_TrackParents(tree));
+
+    a = cJSON_GetObjectItem(tree, "a");
+    b = cJSON_GetObjectItem(a, "b");
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(cJSON_GetParent(b) == a);
+    TEST_ASSERT_TRUE(cJSON_GetParent(cJSON_GetArrayItem(b, 0)) == b);
+
+    cJSON_Delete(tree);
+}
+
+static void parent_tracking_should_not_descend_into_references(void)
+{
+    cJSON *referenced = cJSON_Parse("[1,2]");
+    cJSON *tree = cJSON_CreateArray();
+    TEST_ASSERT_NOT_NULL(referenced);
+    TEST_ASSERT_TRUE(cJSON_TrackParents(tree));
+
+    TEST_ASSERT_TRUE(cJSON_AddItemReferenceToArray(tree, referenced));
+    TEST_ASSERT_TRUE(cJSON_GetParent(tree->child) == tree);
+    TEST_ASSERT_NULL(cJSON_GetParent(referenced->child));
+
+    cJSON_Delete(tree);
+    cJSON_Delete(referenced);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parent_tracking_should_link_parsed_trees);
+    RUN_TEST(parent_tracking_should_follow_modifications);
+    RUN_TEST(parent_tracking_should_link_while_parsing);
+    RUN_TEST(parent_tracking_should_link_expanded_items);
+    RUN_TEST(parent_tracking_should_not_descend_into_references);
+
+    return UNITY_END();
+}
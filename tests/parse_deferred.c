@@ -0,0 +1,270 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static const char json[] = "{\"name\": \"proxy\", \"headers\": {\"host\": \"example.com\", \"list\": [1, {\"x\": \"]}\\\"\"}]}, \"body\": [[1, 2], [3]]}";
+
+static cJSON *parse_deferred_string(const char *value, size_t defer_depth)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    options.require_null_terminated = true;
+    options.defer_depth = defer_depth;
+
+    return parse_with_options(value, &options);
+}
+
+static void parse_with_options_should_behave_like_parse_by_default(void)
+{
+    cJSON *tree = cJSON_ParseWithOptions(json, sizeof(json), NULL, NULL);
+    cJSON *expected = cJSON_Parse(json);
+
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cJSON_IsObject(cJSON_GetObjectItem(tree, "headers")));
+    TEST_ASSERT_TRUE(cJSON_Compare(tree, expected, true));
+
+    cJSON_Delete(tree);
+    cJSON_Delete(expected);
+}
+
+static void parse_deferred_should_keep_deep_containers_raw(void)
+{
+    cJSON *tree = parse_deferred_string(json, 1);
+    cJSON *headers = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(cJSON_IsObject(tree));
+    TEST_ASSERT_TRUE(cJSON_IsString(tree->child));
+
+    headers = tree->child->next;
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, headers->type);
+    /* the type checks look through the deferred text */
+    TEST_ASSERT_TRUE(cJSON_IsObject(headers));
+    TEST_ASSERT_FALSE(cJSON_IsArray(headers));
+    TEST_ASSERT_FALSE(cJSON_IsRaw(headers));
+    TEST_ASSERT_EQUAL_STRING("{\"host\": \"example.com\", \"list\": [1, {\"x\": \"]}\\\"\"}]}", headers->valuestring);
+    TEST_ASSERT_EQUAL_STRING("headers", headers->string);
+
+    TEST_ASSERT_TRUE(cJSON_IsArray(headers->next));
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, headers->next->type);
+    TEST_ASSERT_EQUAL_STRING("[[1, 2], [3]]", headers->next->valuestring);
+
+    cJSON_Delete(tree);
+}
+
+static void parse_deferred_should_expand_on_access(void)
+{
+    cJSON *tree = parse_deferred_string(json, 1);
+    cJSON *headers = NULL;
+    cJSON *list = NULL;
+    cJSON *inner = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    headers = cJSON_GetObjectItem(tree, "headers");
+    TEST_ASSERT_TRUE(cJSON_IsObject(headers));
+    TEST_ASSERT_NULL(headers->valuestring);
+    TEST_ASSERT_EQUAL_STRING("headers", headers->string);
+    /* the node keeps its place in the tree */
+    TEST_ASSERT_TRUE(headers == tree->child->next);
+
+    /* only one level is expanded */
+    list = headers->child->next;
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, list->type);
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(list));
+    TEST_ASSERT_TRUE(cJSON_IsArray(list));
+    TEST_ASSERT_BITS_LOW(cJSON_IsDeferred, list->type);
+
+    inner = cJSON_GetArrayItem(list, 1);
+    TEST_ASSERT_TRUE(cJSON_IsObject(inner));
+    TEST_ASSERT_EQUAL_STRING("]}\"", cJSON_GetStringValue(cJSON_GetObjectItem(inner, "x")));
+
+    cJSON_Delete(tree);
+}
+
+static void parse_deferred_should_print_untouched_subtrees_like_parsed_ones(void)
+{
+    cJSON *tree = parse_deferred_string("{\"a\":1,\"b\":{ \"c\" :  [ 1,\" 2 \" ] },\"d\":[ ]}", 1);
+    char *printed = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    printed = cJSON_PrintUnformatted(tree);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":{\"c\":[1,\" 2 \"]},\"d\":[]}", printed);
+    cJSON_free(printed);
+
+    printed = cJSON_Print(tree);
+    TEST_ASSERT_EQUAL_STRING("{\n\t\"a\":\t1,\n\t\"b\":\t{\n\t\t\"c\":\t[1, \" 2 \"]\n\t},\n\t\"d\":\t[]\n}", printed);
+    cJSON_free(printed);
+
+    /* printing doesn't expand anything */
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, tree->child->next->type);
+
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(cJSON_GetObjectItem(tree, "d"), cJSON_CreateNull()));
+    printed = cJSON_PrintUnformatted(tree);
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":{\"c\":[1,\" 2 \"]},\"d\":[null]}", printed);
+    cJSON_free(printed);
+
+    cJSON_Delete(tree);
+}
+
+static void parse_deferred_should_compare_by_content(void)
+{
+    cJSON *deferred = parse_deferred_string(json, 1);
+    cJSON *deferred_deeper = parse_deferred_string(json, 2);
+    cJSON *parsed = cJSON_Parse(json);
+
+    TEST_ASSERT_NOT_NULL(deferred);
+    TEST_ASSERT_NOT_NULL(deferred_deeper);
+    TEST_ASSERT_TRUE(cJSON_Compare(deferred, parsed, true));
+    TEST_ASSERT_TRUE(cJSON_Compare(parsed, deferred_deeper, true));
+
+    cJSON_Delete(deferred);
+    cJSON_Delete(deferred_deeper);
+    cJSON_Delete(parsed);
+}
+
+static void parse_deferred_should_reject_unbalanced_input(void)
+{
+    TEST_ASSERT_NULL(parse_deferred_string("[[1, 2]", 1));
+    TEST_ASSERT_NULL(parse_deferred_string("[\"]\"", 1));
+    TEST_ASSERT_NULL(parse_deferred_string("[[1]]]", 1));
+
+    /* the contents are checked while they are skipped */
+    TEST_ASSERT_NULL(parse_deferred_string("[[1, }]", 1));
+    TEST_ASSERT_NULL(parse_deferred_string("{\"a\":{\"b\":[1,,2]}}", 1));
+    TEST_ASSERT_NULL(parse_deferred_string("{\"a\":{\"b\" 1}}", 1));
+    TEST_ASSERT_NULL(parse_deferred_string("[[tru]]", 1));
+}
+
+static void parse_deferred_should_respect_the_nesting_limit(void)
+{
+    char deep[(CJSON_NESTING_LIMIT + 1) * 2 + 1];
+    cJSON *tree = NULL;
+
+    memset(deep, '[', CJSON_NESTING_LIMIT + 1);
+    memset(deep + CJSON_NESTING_LIMIT + 1, ']', CJSON_NESTING_LIMIT + 1);
+    deep[sizeof(deep) - 1] = '\0';
+    TEST_ASSERT_NULL(parse_deferred_string(deep, 1));
+
+    /* one level less is fine */
+    deep[sizeof(deep) - 2] = '\0';
+    tree = parse_deferred_string(deep + 1, 1);
+    TEST_ASSERT_NOT_NULL(tree);
+    cJSON_Delete(tree);
+}
+
+static void parse_deferred_should_keep_the_depth_of_the_tree(void)
+{
+    char deep[(CJSON_NESTING_LIMIT + 2) * 2 + 1];
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *tree = NULL;
+    cJSON *content = NULL;
+
+    memset(deep, '[', CJSON_NESTING_LIMIT + 2);
+    memset(deep + CJSON_NESTING_LIMIT + 2, ']', CJSON_NESTING_LIMIT + 2);
+    deep[sizeof(deep) - 1] = '\0';
+    options.require_null_terminated = true;
+    options.defer_depth = 1;
+    options.max_depth = CJSON_NESTING_LIMIT + 2;
+    tree = parse_with_options(deep, &options);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, tree->child->type);
+
+    /* a new tree of the whole content, the item stays deferred */
+    content = cJSON_ParseDeferred(tree->child, 0);
+    TEST_ASSERT_NOT_NULL(content);
+    TEST_ASSERT_TRUE(cJSON_IsArray(content));
+    TEST_ASSERT_BITS_LOW(cJSON_IsDeferred, content->child->type);
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, tree->child->type);
+    cJSON_Delete(content);
+    TEST_ASSERT_NULL(cJSON_ParseDeferred(tree->child, CJSON_NESTING_LIMIT));
+    TEST_ASSERT_NULL(cJSON_ParseDeferred(tree, 0));
+
+    /* expanding isn't limited by the default either */
+    TEST_ASSERT_TRUE(cJSON_Expand(tree->child));
+    TEST_ASSERT_TRUE(cJSON_Expand(tree->child->child));
+    TEST_ASSERT_TRUE(cJSON_IsArray(tree->child->child->child));
+
+    cJSON_Delete(tree);
+}
+
+static void expand_should_handle_non_deferred_items(void)
+{
+    cJSON *number = cJSON_CreateNumber(1);
+
+    TEST_ASSERT_FALSE(cJSON_Expand(NULL));
+    TEST_ASSERT_TRUE(cJSON_Expand(number));
+    TEST_ASSERT_TRUE(cJSON_IsNumber(number));
+
+    cJSON_Delete(number);
+}
+
+static void expand_should_work_on_duplicates_and_references(void)
+{
+    cJSON *tree = parse_deferred_string("[{\"a\": [true]}]", 1);
+    cJSON *duplicate = NULL;
+    cJSON *references = cJSON_CreateArray();
+    cJSON *reference = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    duplicate = cJSON_Duplicate(tree->child, true);
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, duplicate->type);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetArrayItem(cJSON_GetObjectItem(duplicate, "a"), 0)));
+
+    TEST_ASSERT_TRUE(cJSON_AddItemReferenceToArray(references, tree->child));
+    reference = references->child;
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, reference->type);
+    TEST_ASSERT_TRUE(cJSON_Expand(reference));
+    TEST_ASSERT_TRUE(cJSON_IsObject(reference));
+    TEST_ASSERT_BITS_LOW(cJSON_IsReference | cJSON_IsDeferred, reference->type);
+    TEST_ASSERT_BITS_HIGH(cJSON_IsDeferred, tree->child->type);
+
+    cJSON_Delete(references);
+    cJSON_Delete(duplicate);
+    cJSON_Delete(tree);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parse_with_options_should_behave_like_parse_by_default);
+    RUN_TEST(parse_deferred_should_keep_deep_containers_raw);
+    RUN_TEST(parse_deferred_should_expand_on_access);
+    RUN_TEST(parse_deferred_should_print_untouched_subtrees_like_parsed_ones);
+    RUN_TEST(parse_deferred_should_compare_by_content);
+    RUN_TEST(parse_deferred_should_reject_unbalanced_input);
+    RUN_TEST(parse_deferred_should_respect_the_nesting_limit);
+    RUN_TEST(parse_deferred_should_keep_the_depth_of_the_tree);
+    RUN_TEST(expand_should_handle_non_deferred_items);
+    RUN_TEST(expand_should_work_on_duplicates_and_references);
+
+    return UNITY_END();
+}
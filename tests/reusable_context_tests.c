@@ -0,0 +1,166 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static const char message[] = "{\"id\":1,\"values\":[1.5,-2,3000],\"ok\":true,\"error\":null}";
+
+static void parser_should_reuse_released_nodes(void)
+{
+    cJSON_Parser *parser = cJSON_Parser_Create(NULL);
+    cJSON_Stats stats;
+    cJSON *first = NULL;
+    cJSON *second = NULL;
+    char *printed = NULL;
+    TEST_ASSERT_NOT_NULL(parser);
+
+    first = cJSON_Parser_Parse(parser, message, sizeof(message), NULL);
+    TEST_ASSERT_NOT_NULL(first);
+    printed = cJSON_PrintUnformatted(first);
+    TEST_ASSERT_EQUAL_STRING(message, printed);
+    cJSON_free(printed);
+    cJSON_Parser_Release(parser, first);
+
+    /* only the keys have to be allocated again */
+    cJSON_StartStats(&stats);
+    second = cJSON_Parser_Parse(parser, message, sizeof(message), NULL);
+    cJSON_StopStats();
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_TRUE(second == first);
+    TEST_ASSERT_EQUAL_UINT(8U, (unsigned int)stats.nodes_created);
+    TEST_ASSERT_EQUAL_UINT(4U, (unsigned int)stats.allocations);
+    printed = cJSON_PrintUnformatted(second);
+    TEST_ASSERT_EQUAL_STRING(message, printed);
+    cJSON_free(printed);
+
+    /* trees of a parser can be deleted as usual */
+    cJSON_Delete(second);
+    cJSON_Parser_Delete(parser);
+}
+
+static void parser_should_use_its_options(void)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON_Parser *parser = NULL;
+    const char *end = NULL;
+    cJSON *tree = NULL;
+
+    options.require_null_terminated = true;
+    options.pack_numbers = true;
+    parser = cJSON_Parser_Create(&options);
+    TEST_ASSERT_NOT_NULL(parser);
+
+    /* the options were copied */
+    options.require_null_terminated = 0;
+    TEST_ASSERT_NULL(cJSON_Parser_Parse(parser, "[1] x", sizeof("[1] x"), &end));
+    TEST_ASSERT_EQUAL_STRING("x", end);
+    TEST_ASSERT_NULL(cJSON_Parser_Parse(parser, "[1,", sizeof("[1,"), NULL));
+
+    tree = cJSON_Parser_Parse(parser, "[1, 2]", sizeof("[1, 2]"), NULL);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_TRUE(tree->type & cJSON_IsPacked);
+    cJSON_Parser_Release(parser, tree);
+
+    /* released items don't have to come from the parser */
+    cJSON_Parser_Release(parser, cJSON_CreateString("not parsed"));
+    cJSON_Parser_Release(parser, NULL);
+
+    TEST_ASSERT_NULL(cJSON_Parser_Parse(NULL, "1", 1, NULL));
+    cJSON_Parser_Delete(parser);
+    cJSON_Parser_Delete(NULL);
+}
+
+static void printer_should_reuse_its_buffer(void)
+{
+    cJSON_Printer *printer = cJSON_Printer_Create(false);
+    cJSON *tree = cJSON_Parse(message);
+    cJSON *large = cJSON_CreateArray();
+    const char *first = NULL;
+    const char *second = NULL;
+    char *expected = NULL;
+    size_t length = 0;
+    int i = 0;
+    TEST_ASSERT_NOT_NULL(printer);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_NOT_NULL(large);
+
+    first = cJSON_Printer_Print(printer, tree, &length);
+    TEST_ASSERT_EQUAL_STRING(message, first);
+    TEST_ASSERT_TRUE(length == strlen(message));
+    second = cJSON_Printer_Print(printer, tree, NULL);
+    TEST_ASSERT_TRUE(first == second);
+    TEST_ASSERT_EQUAL_STRING(message, second);
+
+    /* the buffer grows for large documents */
+    for (i = 0; i < 1000; i++)
+    {
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(large, cJSON_CreateString("grow")));
+    }
+    expected = cJSON_PrintUnformatted(large);
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_EQUAL_STRING(expected, cJSON_Printer_Print(printer, large, &length));
+    TEST_ASSERT_TRUE(length == strlen(expected));
+    cJSON_free(expected);
+
+    TEST_ASSERT_NULL(cJSON_Printer_Print(printer, NULL, NULL));
+    TEST_ASSERT_NULL(cJSON_Printer_Print(NULL, tree, NULL));
+
+    cJSON_Delete(large);
+    cJSON_Delete(tree);
+    cJSON_Printer_Delete(printer);
+    cJSON_Printer_Delete(NULL);
+}
+
+static void printer_should_format_like_print(void)
+{
+    cJSON_Printer *printer = cJSON_Printer_Create(true);
+    cJSON *tree = cJSON_Parse(message);
+    char *expected = NULL;
+    TEST_ASSERT_NOT_NULL(printer);
+    TEST_ASSERT_NOT_NULL(tree);
+
+    expected = cJSON_Print(tree);
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_EQUAL_STRING(expected, cJSON_Printer_Print(printer, tree, NULL));
+
+    cJSON_free(expected);
+    cJSON_Delete(tree);
+    cJSON_Printer_Delete(printer);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(parser_should_reuse_released_nodes);
+    RUN_TEST(parser_should_use_its_options);
+    RUN_TEST(printer_should_reuse_its_buffer);
+    RUN_TEST(printer_should_format_like_print);
+
+    return UNITY_END();
+}
@@ -0,0 +1,262 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static const char document[] = "{\"name\":\"state\",\"config\":{\"limits\":[1,2,3],\"flags\":{\"debug\":false}},\"users\":[{\"id\":1},{\"id\":2}]}";
+
+static void assert_prints(const cJSON * const item, const char * const expected)
+{
+    char *printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+    cJSON_free(printed);
+}
+
+static void duplicate_shared_should_share_children(void)
+{
+    cJSON *original = cJSON_Parse(document);
+    cJSON *copy = NULL;
+    TEST_ASSERT_NOT_NULL(original);
+
+    copy = cJSON_DuplicateShared(original);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(copy->type & cJSON_IsShared);
+    TEST_ASSERT_TRUE(original->type & cJSON_IsShared);
+    TEST_ASSERT_TRUE(copy->child == original->child);
+
+    assert_prints(copy, document);
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetArraySize(copy));
+    TEST_ASSERT_TRUE(cJSON_Compare(original, copy, true));
+
+    cJSON_Delete(copy);
+    cJSON_Delete(original);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+static void duplicate_shared_should_copy_values(void)
+{
+    cJSON *string = cJSON_CreateString("value");
+    cJSON *copy = cJSON_DuplicateShared(string);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(cJSON_IsString(copy));
+    TEST_ASSERT_FALSE(copy->type & cJSON_IsShared);
+    TEST_ASSERT_TRUE(copy->valuestring != string->valuestring);
+    TEST_ASSERT_EQUAL_STRING("value", copy->valuestring);
+    cJSON_Delete(copy);
+    cJSON_Delete(string);
+
+    TEST_ASSERT_NULL(cJSON_DuplicateShared(NULL));
+    TEST_ASSERT_FALSE(cJSON_Unshare(NULL));
+}
+
+static void reading_a_copy_should_not_copy_anything(void)
+{
+    cJSON *original = cJSON_Parse(document);
+    cJSON *copy = NULL;
+    const cJSON *users = NULL;
+    TEST_ASSERT_NOT_NULL(original);
+
+    copy = cJSON_DuplicateShared(original);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    users = cJSON_GetObjectItemCaseSensitive(copy, "users");
+    TEST_ASSERT_TRUE(users == cJSON_GetObjectItem(original, "users"));
+    TEST_ASSERT_TRUE(cJSON_GetArrayItem(users, 1) == cJSON_GetArrayItem(cJSON_GetObjectItem(original, "users"), 1));
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetObjectItem(cJSON_GetArrayItem(users, 1), "id")->valueint);
+    TEST_ASSERT_TRUE(copy->type & cJSON_IsShared);
+    TEST_ASSERT_TRUE(copy->child == original->child);
+
+    cJSON_Delete(original);
+    assert_prints(copy, document);
+    cJSON_Delete(copy);
+}
+
+static void changing_a_copy_should_only_copy_the_path(void)
+{
+    cJSON *original = cJSON_Parse(document);
+    cJSON *copy = NULL;
+    cJSON *config = NULL;
+    cJSON *limits = NULL;
+    TEST_ASSERT_NOT_NULL(original);
+
+    copy = cJSON_DuplicateShared(original);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    TEST_ASSERT_TRUE(cJSON_Unshare(copy));
+    TEST_ASSERT_FALSE(copy->type & cJSON_IsShared);
+    config = cJSON_GetObjectItem(copy, "config");
+    TEST_ASSERT_NOT_NULL(config);
+    TEST_ASSERT_TRUE(config != cJSON_GetObjectItem(original, "config"));
+    TEST_ASSERT_TRUE(config->type & cJSON_IsShared);
+
+    TEST_ASSERT_TRUE(cJSON_Unshare(config));
+    limits = cJSON_GetObjectItem(config, "limits");
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(limits, cJSON_CreateNumber(4)));
+    cJSON_SetNumberValue(cJSON_GetArrayItem(limits, 0), 0);
+
+    assert_prints(original, document);
+    assert_prints(copy, "{\"name\":\"state\",\"config\":{\"limits\":[0,2,3,4],\"flags\":{\"debug\":false}},\"users\":[{\"id\":1},{\"id\":2}]}");
+
+    /* the siblings on the path were copied, but not below them */
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(config, "flags")->child == cJSON_GetObjectItem(cJSON_GetObjectItem(original, "config"), "flags")->child);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(copy, "users")->child == cJSON_GetObjectItem(original, "users")->child);
+
+    cJSON_Delete(original);
+    assert_prints(copy, "{\"name\":\"state\",\"config\":{\"limits\":[0,2,3,4],\"flags\":{\"debug\":false}},\"users\":[{\"id\":1},{\"id\":2}]}");
+    cJSON_Delete(copy);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+static void changing_the_original_should_not_change_copies(void)
+{
+    cJSON *original = cJSON_Parse(document);
+    cJSON *copy = NULL;
+    TEST_ASSERT_NOT_NULL(original);
+
+    copy = cJSON_DuplicateShared(original);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    TEST_ASSERT_NOT_NULL(cJSON_AddTrueToObject(original, "new"));
+    cJSON_DeleteItemFromObject(original, "name");
+    TEST_ASSERT_TRUE(copy->type & cJSON_IsShared);
+    TEST_ASSERT_TRUE(copy->child != original->child);
+
+    assert_prints(original, "{\"config\":{\"limits\":[1,2,3],\"flags\":{\"debug\":false}},\"users\":[{\"id\":1},{\"id\":2}],\"new\":true}");
+    assert_prints(copy, document);
+
+    /* the original gave the children up, so the copy owns them without copying */
+    TEST_ASSERT_TRUE(cJSON_Unshare(copy));
+    TEST_ASSERT_FALSE(copy->type & cJSON_IsShared);
+
+    cJSON_Delete(copy);
+    cJSON_Delete(original);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+static void shared_items_should_be_deleted_by_the_last_owner(void)
+{
+    cJSON *original = cJSON_Parse(document);
+    cJSON *first = NULL;
+    cJSON *second = NULL;
+    cJSON *third = NULL;
+    TEST_ASSERT_NOT_NULL(original);
+
+    first = cJSON_DuplicateShared(original);
+    second = cJSON_DuplicateShared(original);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+
+    /* a copy of a partially copied tree */
+    TEST_ASSERT_TRUE(cJSON_Unshare(first));
+    TEST_ASSERT_TRUE(cJSON_ReplaceItemInObject(cJSON_GetObjectItem(first, "config"), "flags", cJSON_CreateNull()));
+    third = cJSON_DuplicateShared(first);
+    TEST_ASSERT_NOT_NULL(third);
+
+    cJSON_Delete(original);
+    assert_prints(second, document);
+    cJSON_Delete(first);
+    assert_prints(third, "{\"name\":\"state\",\"config\":{\"limits\":[1,2,3],\"flags\":null},\"users\":[{\"id\":1},{\"id\":2}]}");
+    assert_prints(second, document);
+
+    TEST_ASSERT_TRUE(cJSON_Unshare(second));
+    cJSON_DeleteItemFromArray(cJSON_GetObjectItem(second, "users"), 0);
+    assert_prints(second, "{\"name\":\"state\",\"config\":{\"limits\":[1,2,3],\"flags\":{\"debug\":false}},\"users\":[{\"id\":2}]}");
+    cJSON_Delete(second);
+    assert_prints(third, "{\"name\":\"state\",\"config\":{\"limits\":[1,2,3],\"flags\":null},\"users\":[{\"id\":1},{\"id\":2}]}");
+    cJSON_Delete(third);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+static void functions_taking_a_shared_child_should_change_the_own_copy(void)
+{
+    cJSON *original = cJSON_Parse("[1,2,3]");
+    cJSON *copy = NULL;
+    cJSON *detached = NULL;
+    cJSON *shared = NULL;
+    TEST_ASSERT_NOT_NULL(original);
+
+    copy = cJSON_DuplicateShared(original);
+    TEST_ASSERT_NOT_NULL(copy);
+
+    /* pointers found by walking child point to the shared items */
+    shared = copy->child->next;
+    detached = cJSON_DetachItemViaPointer(copy, shared);
+    TEST_ASSERT_NOT_NULL(detached);
+    TEST_ASSERT_TRUE(detached != shared);
+    TEST_ASSERT_EQUAL_INT(2, detached->valueint);
+    cJSON_Delete(detached);
+
+    TEST_ASSERT_TRUE(cJSON_ReplaceItemViaPointer(original, original->child, cJSON_CreateString("one")));
+    TEST_ASSERT_TRUE(cJSON_InsertItemInArray(copy, 0, cJSON_CreateNull()));
+
+    assert_prints(original, "[\"one\",2,3]");
+    assert_prints(copy, "[null,1,3]");
+
+    cJSON_Delete(original);
+    cJSON_Delete(copy);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+static void duplicate_shared_should_own_referenced_children(void)
+{
+    cJSON *array = cJSON_Parse("[{\"a\":1},2]");
+    cJSON *reference = NULL;
+    cJSON *copy = NULL;
+    TEST_ASSERT_NOT_NULL(array);
+
+    reference = cJSON_CreateArrayReference(array->child);
+    TEST_ASSERT_NOT_NULL(reference);
+    copy = cJSON_DuplicateShared(reference);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_FALSE(copy->type & cJSON_IsReference);
+    cJSON_Delete(reference);
+
+    /* the copy keeps the children alive */
+    cJSON_Delete(array);
+    assert_prints(copy, "[{\"a\":1},2]");
+    TEST_ASSERT_TRUE(cJSON_Unshare(copy));
+    cJSON_Delete(copy);
+    TEST_ASSERT_EQUAL_UINT(0, node_info_count);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(duplicate_shared_should_share_children);
+    RUN_TEST(duplicate_shared_should_copy_values);
+    RUN_TEST(reading_a_copy_should_not_copy_anything);
+    RUN_TEST(changing_a_copy_should_only_copy_the_path);
+    RUN_TEST(changing_the_original_should_not_change_copies);
+    RUN_TEST(shared_items_should_be_deleted_by_the_last_owner);
+    RUN_TEST(functions_taking_a_shared_child_should_change_the_own_copy);
+    RUN_TEST(duplicate_shared_should_own_referenced_children);
+
+    return UNITY_END();
+}
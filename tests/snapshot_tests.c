@@ -0,0 +1,343 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_Snapshot.h"
+
+#define SNAPSHOT_FILE "snapshot_tests.snapshot"
+
+static void assert_same(const cJSON * const item, const cJSON_SnapshotItem * const snapshot_item)
+{
+    const cJSON *child = NULL;
+    const cJSON_SnapshotItem *snapshot_child = NULL;
+
+    TEST_ASSERT_NOT_NULL(snapshot_item);
+    TEST_ASSERT_EQUAL_INT(item->type & 0xFF, cJSON_SnapshotType(snapshot_item));
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_Number:
+            TEST_ASSERT_TRUE(item->valuedouble == cJSON_SnapshotNumber(snapshot_item));
+            break;
+
+        case cJSON_String:
+        case cJSON_Raw:
+            TEST_ASSERT_EQUAL_STRING(item->valuestring, cJSON_SnapshotString(snapshot_item));
+            break;
+
+        case cJSON_Array:
+        case cJSON_Object:
+            TEST_ASSERT_EQUAL_INT(cJSON_GetArraySize(item), cJSON_SnapshotGetArraySize(snapshot_item));
+            snapshot_child = cJSON_SnapshotChild(snapshot_item);
+            cJSON_ArrayForEach(child, item)
+            {
+                if (cJSON_IsObject(item))
+                {
+                    TEST_ASSERT_EQUAL_STRING(child->string, cJSON_SnapshotKey(snapshot_child));
+                }
+                else
+                {
+                    TEST_ASSERT_NULL(cJSON_SnapshotKey(snapshot_child));
+                }
+                assert_same(child, snapshot_child);
+                snapshot_child = cJSON_SnapshotNext(snapshot_child);
+            }
+            TEST_ASSERT_NULL(snapshot_child);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static cJSON_Snapshot *save_and_map(const cJSON * const item)
+{
+    TEST_ASSERT_TRUE(cJSON_SaveSnapshot(item, SNAPSHOT_FILE));
+    return cJSON_MapSnapshot(SNAPSHOT_FILE);
+}
+
+static void snapshots_should_support_lookup_and_iteration(void)
+{
+    cJSON *item = cJSON_Parse("{\"name\":\"cJSON\",\"numbers\":[1,-2.5,1e300],\"nested\":{\"empty\":{},\"list\":[[],[true,false,null]]},\"Last\":\"\"}");
+    cJSON_Snapshot *snapshot = NULL;
+    const cJSON_SnapshotItem *root = NULL;
+    const cJSON_SnapshotItem *element = NULL;
+    double sum = 0;
+    TEST_ASSERT_NOT_NULL(item);
+
+    snapshot = save_and_map(item);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    root = cJSON_SnapshotRoot(snapshot);
+    assert_same(item, root);
+
+    TEST_ASSERT_EQUAL_STRING("cJSON", cJSON_SnapshotString(cJSON_SnapshotGetObjectItem(root, "name")));
+    TEST_ASSERT_EQUAL_STRING("", cJSON_SnapshotString(cJSON_SnapshotGetObjectItem(root, "last")));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetObjectItemCaseSensitive(root, "last"));
+    TEST_ASSERT_NOT_NULL(cJSON_SnapshotGetObjectItemCaseSensitive(root, "Last"));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetObjectItem(root, "missing"));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetObjectItem(cJSON_SnapshotGetObjectItem(root, "numbers"), "0"));
+
+    /* siblings after containers are found without walking their children */
+    element = cJSON_SnapshotGetObjectItem(cJSON_SnapshotGetObjectItem(root, "nested"), "list");
+    TEST_ASSERT_EQUAL_INT(cJSON_True, cJSON_SnapshotType(cJSON_SnapshotGetArrayItem(cJSON_SnapshotGetArrayItem(element, 1), 0)));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetArrayItem(element, 2));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetArrayItem(element, -1));
+    TEST_ASSERT_NULL(cJSON_SnapshotChild(cJSON_SnapshotGetArrayItem(element, 0)));
+
+    cJSON_SnapshotForEach(element, cJSON_SnapshotGetObjectItem(root, "numbers"))
+    {
+        sum += cJSON_SnapshotNumber(element);
+    }
+    TEST_ASSERT_TRUE(sum == (1 - 2.5 + 1e300));
+    TEST_ASSERT_TRUE(cJSON_SnapshotNumber(root) != cJSON_SnapshotNumber(root));
+    TEST_ASSERT_NULL(cJSON_SnapshotString(cJSON_SnapshotGetObjectItem(root, "numbers")));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_SnapshotGetArraySize(cJSON_SnapshotGetObjectItem(root, "name")));
+
+    cJSON_UnmapSnapshot(snapshot);
+    cJSON_Delete(item);
+    remove(SNAPSHOT_FILE);
+}
+
+static void snapshots_should_store_the_test_inputs(void)
+{
+    static const char * const inputs[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t index = 0;
+
+    for (index = 0; index < (sizeof(inputs) / sizeof(inputs[0])); index++)
+    {
+        char *json = read_file(inputs[index]);
+        cJSON *item = NULL;
+        cJSON_Snapshot *snapshot = NULL;
+        TEST_ASSERT_NOT_NULL(json);
+
+        item = cJSON_Parse(json);
+        free(json);
+        if (item == NULL)
+        {
+            /* some inputs are HTML */
+            continue;
+        }
+
+        snapshot = save_and_map(item);
+        TEST_ASSERT_NOT_NULL_MESSAGE(snapshot, inputs[index]);
+        assert_same(item, cJSON_SnapshotRoot(snapshot));
+
+        cJSON_UnmapSnapshot(snapshot);
+        cJSON_Delete(item);
+    }
+    remove(SNAPSHOT_FILE);
+}
+
+static void snapshots_should_store_scalars_raw_and_deferred_items(void)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *item = cJSON_CreateRaw("{\"raw\":true}");
+    cJSON_Snapshot *snapshot = NULL;
+    TEST_ASSERT_NOT_NULL(item);
+
+    snapshot = save_and_map(item);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    TEST_ASSERT_EQUAL_INT(cJSON_Raw, cJSON_SnapshotType(cJSON_SnapshotRoot(snapshot)));
+    TEST_ASSERT_EQUAL_STRING("{\"raw\":true}", cJSON_SnapshotString(cJSON_SnapshotRoot(snapshot)));
+    TEST_ASSERT_NULL(cJSON_SnapshotNext(cJSON_SnapshotRoot(snapshot)));
+    cJSON_UnmapSnapshot(snapshot);
+    cJSON_Delete(item);
+
+    options.defer_depth = 1;
+    item = parse_with_options("{\"a\":{\"b\":[1,2]}}", &options);
+    TEST_ASSERT_NOT_NULL(item);
+    snapshot = save_and_map(item);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    TEST_ASSERT_EQUAL_INT(cJSON_Array, cJSON_SnapshotType(cJSON_SnapshotGetObjectItem(cJSON_SnapshotGetObjectItem(cJSON_SnapshotRoot(snapshot), "a"), "b")));
+    /* saving doesn't expand the item */
+    TEST_ASSERT_TRUE(item->child->type & cJSON_IsDeferred);
+    cJSON_UnmapSnapshot(snapshot);
+    cJSON_Delete(item);
+
+    remove(SNAPSHOT_FILE);
+}
+
+static void snapshots_should_store_packed_arrays(void)
+{
+    static const double numbers[] = { 1, -2.5, 0.1 };
+    cJSON *item = cJSON_CreateObject();
+    cJSON_Snapshot *snapshot = NULL;
+    const cJSON_SnapshotItem *array = NULL;
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(item, "numbers", cJSON_CreatePackedArray(numbers, 3)));
+    TEST_ASSERT_NOT_NULL(cJSON_AddTrueToObject(item, "after"));
+
+    snapshot = save_and_map(item);
+    TEST_ASSERT_NOT_NULL(snapshot);
+    TEST_ASSERT_TRUE(cJSON_GetObjectItem(item, "numbers")->type & cJSON_IsPacked);
+    array = cJSON_SnapshotGetObjectItem(cJSON_SnapshotRoot(snapshot), "numbers");
+    TEST_ASSERT_EQUAL_INT(3, cJSON_SnapshotGetArraySize(array));
+    TEST_ASSERT_EQUAL_DOUBLE(-2.5, cJSON_SnapshotNumber(cJSON_SnapshotGetArrayItem(array, 1)));
+    TEST_ASSERT_EQUAL_DOUBLE(0.1, cJSON_SnapshotNumber(cJSON_SnapshotGetArrayItem(array, 2)));
+    TEST_ASSERT_NULL(cJSON_SnapshotGetArrayItem(array, 3));
+    TEST_ASSERT_EQUAL_INT(cJSON_True, cJSON_SnapshotType(cJSON_SnapshotGetObjectItem(cJSON_SnapshotRoot(snapshot), "after")));
+
+    cJSON_UnmapSnapshot(snapshot);
+    cJSON_Delete(item);
+}
+
+static void write_file(const unsigned char * const data, const size_t length)
+{
+    FILE *file = fopen(SNAPSHOT_FILE, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL_UINT(length, fwrite(data, 1, length, file));
+    fclose(file);
+}
+
+static void snapshots_should_reject_invalid_files(void)
+{
+    cJSON *item = cJSON_Parse("{\"key\":[\"value\",1]}");
+    unsigned char *image = NULL;
+    unsigned char *corrupted = NULL;
+    size_t length = 0;
+    TEST_ASSERT_NOT_NULL(item);
+
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(NULL));
+    TEST_ASSERT_NULL(cJSON_MapSnapshot("inputs/does_not_exist"));
+    TEST_ASSERT_NULL(cJSON_MapSnapshot("inputs/test1"));
+    TEST_ASSERT_NULL(cJSON_SnapshotRoot(NULL));
+    cJSON_UnmapSnapshot(NULL);
+
+    TEST_ASSERT_TRUE(cJSON_SaveSnapshot(item, SNAPSHOT_FILE));
+    image = (unsigned char*)read_file(SNAPSHOT_FILE);
+    TEST_ASSERT_NOT_NULL(image);
+    /* header, 4 nodes and "key", "value" */
+    length = 24 + 4 * 24 + 10;
+    corrupted = (unsigned char*)malloc(length);
+    TEST_ASSERT_NOT_NULL(corrupted);
+
+    /* truncated */
+    write_file(image, length - 1);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* key offset pointing past the end */
+    memcpy(corrupted, image, length);
+    corrupted[24 + 24 + 6] = 0x10;
+    write_file(corrupted, length);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* string offset pointing into the nodes */
+    memcpy(corrupted, image, length);
+    corrupted[24 + 48 + 15] = 0x01;
+    write_file(corrupted, length);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* next node after the last one */
+    memcpy(corrupted, image, length);
+    corrupted[24 + 48 + 11] = 0x02;
+    write_file(corrupted, length);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* more entries than nodes */
+    memcpy(corrupted, image, length);
+    corrupted[24 + 24 + 15] = 0x03;
+    write_file(corrupted, length);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* unknown type */
+    memcpy(corrupted, image, length);
+    corrupted[24 + 3] = 0x03;
+    write_file(corrupted, length);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* string pool without terminating zero */
+    memcpy(corrupted, image, length);
+    corrupted[length - 1] = 'x';
+    write_file(corrupted, length);
+    TEST_ASSERT_NULL(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    /* the unmodified image is fine */
+    write_file(image, length);
+    cJSON_UnmapSnapshot(cJSON_MapSnapshot(SNAPSHOT_FILE));
+
+    free(corrupted);
+    free(image);
+    cJSON_Delete(item);
+    remove(SNAPSHOT_FILE);
+}
+
+static void save_snapshot_should_fail_on_invalid_trees(void)
+{
+    char deep[(CJSON_NESTING_LIMIT + 1) * 2 + 1];
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *item = cJSON_CreateArray();
+    cJSON *innermost = item;
+    int index = 0;
+    TEST_ASSERT_NOT_NULL(item);
+
+    TEST_ASSERT_FALSE(cJSON_SaveSnapshot(NULL, SNAPSHOT_FILE));
+    TEST_ASSERT_FALSE(cJSON_SaveSnapshot(item, NULL));
+
+    for (index = 0; index < CJSON_NESTING_LIMIT; index++)
+    {
+        cJSON *array = cJSON_CreateArray();
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(innermost, array));
+        innermost = array;
+    }
+    TEST_ASSERT_FALSE(cJSON_SaveSnapshot(item, SNAPSHOT_FILE));
+    cJSON_Delete(item);
+
+    /* the content of deferred items counts towards the limit as well */
+    memset(deep, '[', CJSON_NESTING_LIMIT + 1);
+    memset(deep + CJSON_NESTING_LIMIT + 1, ']', CJSON_NESTING_LIMIT + 1);
+    deep[sizeof(deep) - 1] = '\0';
+    options.defer_depth = 1;
+    options.max_depth = CJSON_NESTING_LIMIT + 1;
+    item = parse_with_options(deep, &options);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_FALSE(cJSON_SaveSnapshot(item, SNAPSHOT_FILE));
+    TEST_ASSERT_TRUE(item->child->type & cJSON_IsDeferred);
+    cJSON_Delete(item);
+
+    item = cJSON_CreateObject();
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(item, "invalid", cJSON_CreateNull()));
+    cJSON_GetObjectItem(item, "invalid")->type = cJSON_Invalid;
+    TEST_ASSERT_FALSE(cJSON_SaveSnapshot(item, SNAPSHOT_FILE));
+    cJSON_Delete(item);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(snapshots_should_support_lookup_and_iteration);
+    RUN_TEST(snapshots_should_store_the_test_inputs);
+    RUN_TEST(snapshots_should_store_scalars_raw_and_deferred_items);
+    RUN_TEST(snapshots_should_store_packed_arrays);
+    RUN_TEST(snapshots_should_reject_invalid_files);
+    RUN_TEST(save_snapshot_should_fail_on_invalid_trees);
+
+    return UNITY_END();
+}
@@ -0,0 +1,229 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static cJSON *parse_tracked(const char *value)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    options.require_null_terminated = true;
+    options.track_source = true;
+
+    return parse_with_options(value, &options);
+}
+
+static void assert_printed(const cJSON *item, const char *expected)
+{
+    char *printed = cJSON_PrintUnformatted(item);
+    TEST_ASSERT_EQUAL_STRING(expected, printed);
+    cJSON_free(printed);
+}
+
+static void assert_range(const cJSON *item, size_t expected_start, size_t expected_end)
+{
+    size_t start = 0;
+    size_t end = 0;
+
+    TEST_ASSERT_TRUE(cJSON_GetSourceRange(item, &start, &end));
+    TEST_ASSERT_EQUAL_UINT((unsigned int)expected_start, (unsigned int)start);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)expected_end, (unsigned int)end);
+}
+
+static void source_tracking_should_record_ranges(void)
+{
+    cJSON *tree = parse_tracked(" {\"a\": [1, 2], \"b\" : \"x\"} ");
+    cJSON *untracked = cJSON_Parse("[1]");
+
+    TEST_ASSERT_NOT_NULL(tree);
+    assert_range(tree, 1, 25);
+    assert_range(cJSON_GetObjectItem(tree, "a"), 7, 13);
+    assert_range(cJSON_GetArrayItem(cJSON_GetObjectItem(tree, "a"), 1), 11, 12);
+    assert_range(cJSON_GetObjectItem(tree, "b"), 21, 24);
+
+    TEST_ASSERT_FALSE(cJSON_GetSourceRange(untracked, NULL, NULL));
+    TEST_ASSERT_FALSE(cJSON_GetSourceRange(NULL, NULL, NULL));
+
+    cJSON_Delete(untracked);
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_copy_unchanged_documents(void)
+{
+    cJSON *tree = parse_tracked("{\"a\" : [1.0, 2e0] ,\"b\":\"\\u0041\"}");
+    char buffer[64];
+
+    TEST_ASSERT_NOT_NULL(tree);
+    assert_printed(tree, "{\"a\":[1.0,2e0],\"b\":\"\\u0041\"}");
+    assert_printed(cJSON_GetObjectItem(tree, "a"), "[1.0,2e0]");
+
+    TEST_ASSERT_TRUE(cJSON_PrintPreallocated(tree, buffer, sizeof(buffer), false));
+    TEST_ASSERT_EQUAL_STRING("{\"a\":[1.0,2e0],\"b\":\"\\u0041\"}", buffer);
+
+    /* formatted printing doesn't use the input */
+    {
+        char *printed = cJSON_Print(tree);
+        TEST_ASSERT_EQUAL_STRING("{\n\t\"a\":\t[1, 2],\n\t\"b\":\t\"A\"\n}", printed);
+        cJSON_free(printed);
+    }
+    cJSON_Delete(tree);
+
+    /* the whitespace of the input isn't copied, so the output stays on one line */
+    tree = parse_tracked("[1,\n\t\"a b\" ,\r\n{ }\n]");
+    TEST_ASSERT_NOT_NULL(tree);
+    assert_printed(tree, "[1,\"a b\",{}]");
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_reprint_changed_values(void)
+{
+    cJSON *tree = parse_tracked("{\"keep\": [1, 2], \"name\": \"x\", \"count\": 1, \"nested\": {\"deep\":[true]}}");
+    cJSON *nested = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    TEST_ASSERT_NOT_NULL(cJSON_SetValuestring(cJSON_GetObjectItem(tree, "name"), "a longer name"));
+    assert_printed(tree, "{\"keep\":[1,2],\"name\":\"a longer name\",\"count\":1,\"nested\":{\"deep\":[true]}}");
+
+    cJSON_SetNumberValue(cJSON_GetObjectItem(tree, "count"), 2);
+    assert_printed(tree, "{\"keep\":[1,2],\"name\":\"a longer name\",\"count\":2,\"nested\":{\"deep\":[true]}}");
+
+    nested = cJSON_GetObjectItem(tree, "nested");
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(cJSON_GetObjectItem(nested, "deep"), cJSON_CreateFalse()));
+    assert_printed(tree, "{\"keep\":[1,2],\"name\":\"a longer name\",\"count\":2,\"nested\":{\"deep\":[true,false]}}");
+
+    TEST_ASSERT_TRUE(cJSON_ReplaceItemInObject(tree, "keep", cJSON_CreateString("replaced")));
+    assert_printed(tree, "{\"keep\":\"replaced\",\"name\":\"a longer name\",\"count\":2,\"nested\":{\"deep\":[true,false]}}");
+
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_not_reuse_ranges_of_deleted_items(void)
+{
+    cJSON *tree = parse_tracked("[[1], [2], [3]]");
+    int i = 0;
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    /* new items may get the addresses of the deleted ones */
+    for (i = 0; i < 3; i++)
+    {
+        cJSON_DeleteItemFromArray(cJSON_GetArrayItem(tree, i), 0);
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(cJSON_GetArrayItem(tree, i), cJSON_CreateNumber(i)));
+    }
+    assert_printed(tree, "[[0],[1],[2]]");
+
+    cJSON_DeleteItemFromArray(tree, 0);
+    TEST_ASSERT_TRUE(cJSON_AddItemToArray(tree, cJSON_CreateArray()));
+    assert_printed(tree, "[[1],[2],[]]");
+
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_handle_moved_items(void)
+{
+    cJSON *tree = parse_tracked("{\"from\": {\"x\": [ 1 ]}, \"to\": {}}");
+    cJSON *moved = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    moved = cJSON_DetachItemFromObject(cJSON_GetObjectItem(tree, "from"), "x");
+    TEST_ASSERT_TRUE(cJSON_AddItemToObject(cJSON_GetObjectItem(tree, "to"), "y", moved));
+    assert_printed(tree, "{\"from\":{},\"to\":{\"y\":[1]}}");
+
+    cJSON_SetNumberValue(moved->child, 5);
+    assert_printed(tree, "{\"from\":{},\"to\":{\"y\":[5]}}");
+
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_notice_expanded_items(void)
+{
+    cJSON_ParseOptions options = default_parse_options();
+    cJSON *tree = NULL;
+    cJSON *inner = NULL;
+    options.defer_depth = 1;
+    options.track_source = true;
+
+    tree = parse_with_options("{\"a\": {\"b\": { \"c\": 1 }, \"d\": 2}}", &options);
+    TEST_ASSERT_NOT_NULL(tree);
+    assert_printed(tree, "{\"a\":{\"b\":{\"c\":1},\"d\":2}}");
+
+    inner = cJSON_GetObjectItem(cJSON_GetObjectItem(tree, "a"), "b");
+    cJSON_SetNumberValue(cJSON_GetObjectItem(inner, "c"), 3);
+    assert_printed(tree, "{\"a\":{\"b\":{\"c\":3},\"d\":2}}");
+
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_accept_explicit_marks(void)
+{
+    cJSON *tree = parse_tracked("[1, true]");
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    tree->child->valueint = 7;
+    tree->child->valuedouble = 7;
+    tree->child->next->type = cJSON_False;
+    assert_printed(tree, "[1,true]");
+
+    cJSON_MarkDirty(tree->child);
+    cJSON_MarkDirty(tree->child->next);
+    assert_printed(tree, "[7,false]");
+
+    cJSON_Delete(tree);
+}
+
+static void source_tracking_should_not_track_duplicates(void)
+{
+    cJSON *tree = parse_tracked("{\"a\" : 1}");
+    cJSON *duplicate = NULL;
+
+    TEST_ASSERT_NOT_NULL(tree);
+    duplicate = cJSON_Duplicate(tree, true);
+    TEST_ASSERT_FALSE(cJSON_GetSourceRange(duplicate, NULL, NULL));
+    assert_printed(duplicate, "{\"a\":1}");
+
+    cJSON_Delete(duplicate);
+    cJSON_Delete(tree);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(source_tracking_should_record_ranges);
+    RUN_TEST(source_tracking_should_copy_unchanged_documents);
+    RUN_TEST(source_tracking_should_reprint_changed_values);
+    RUN_TEST(source_tracking_should_not_reuse_ranges_of_deleted_items);
+    RUN_TEST(source_tracking_should_handle_moved_items);
+    RUN_TEST(source_tracking_should_notice_expanded_items);
+    RUN_TEST(source_tracking_should_accept_explicit_marks);
+    RUN_TEST(source_tracking_should_not_track_duplicates);
+
+    return UNITY_END();
+}
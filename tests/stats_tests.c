@@ -0,0 +1,201 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t custom_allocations = 0;
+
+static void * CJSON_CDECL custom_malloc(size_t size)
+{
+    custom_allocations++;
+    return malloc(size);
+}
+
+static void CJSON_CDECL custom_free(void *pointer)
+{
+    free(pointer);
+}
+
+static void stats_should_count_parsing(void)
+{
+    cJSON_Stats stats;
+    cJSON *tree = NULL;
+
+    cJSON_StartStats(&stats);
+    tree = cJSON_Parse("{\"a\": [1, \"b\", null]}");
+    TEST_ASSERT_NOT_NULL(tree);
+
+    TEST_ASSERT_EQUAL_UINT(5U, (unsigned int)stats.nodes_created);
+    TEST_ASSERT_TRUE(stats.allocations >= stats.nodes_created);
+    TEST_ASSERT_TRUE(stats.allocated_bytes >= 5 * sizeof(cJSON));
+    TEST_ASSERT_TRUE(stats.peak_live_bytes >= stats.live_bytes);
+    TEST_ASSERT_TRUE(stats.live_bytes > 0);
+
+    cJSON_Delete(tree);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.live_bytes);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)stats.allocations, (unsigned int)stats.deallocations);
+    cJSON_StopStats();
+}
+
+static void stats_should_count_print_buffer_growth(void)
+{
+    cJSON_Stats stats;
+    cJSON *array = cJSON_CreateArray();
+    char *printed = NULL;
+    int i = 0;
+
+    for (i = 0; i < 200; i++)
+    {
+        cJSON_AddItemToArray(array, cJSON_CreateString("a string that needs some space"));
+    }
+
+    cJSON_StartStats(&stats);
+    printed = cJSON_PrintUnformatted(array);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_TRUE(stats.buffer_reallocations > 0);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.nodes_created);
+    TEST_ASSERT_TRUE(stats.live_bytes > strlen(printed));
+    TEST_ASSERT_TRUE(stats.peak_live_bytes >= stats.live_bytes);
+    cJSON_free(printed);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.live_bytes);
+    cJSON_StopStats();
+
+    cJSON_Delete(array);
+}
+
+static void stats_should_ignore_memory_from_before(void)
+{
+    cJSON_Stats stats;
+    cJSON *tree = cJSON_Parse("[1, 2, 3]");
+
+    TEST_ASSERT_NOT_NULL(tree);
+
+    cJSON_StartStats(&stats);
+    cJSON_Delete(tree);
+    TEST_ASSERT_EQUAL_UINT(4U, (unsigned int)stats.deallocations);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.live_bytes);
+    cJSON_StopStats();
+}
+
+static void stats_should_stop_counting(void)
+{
+    cJSON_Stats stats;
+    cJSON *item = NULL;
+
+    cJSON_StartStats(&stats);
+    cJSON_StopStats();
+
+    item = cJSON_CreateNull();
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.allocations);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.nodes_created);
+    cJSON_Delete(item);
+
+    /* stopping twice is fine */
+    cJSON_StopStats();
+    cJSON_StartStats(NULL);
+}
+
+static void stats_should_remove_the_counting_functions(void)
+{
+    cJSON_Hooks hooks = { custom_malloc, custom_free };
+    cJSON_Stats stats;
+
+    cJSON_InitHooks(&hooks);
+    cJSON_StartStats(&stats);
+    TEST_ASSERT_TRUE(global_hooks.allocate != custom_malloc);
+    cJSON_StartStats(&stats);
+    cJSON_StopStats();
+
+    /* the allocator is called directly again */
+    TEST_ASSERT_TRUE(global_hooks.allocate == custom_malloc);
+    TEST_ASSERT_TRUE(global_hooks.deallocate == custom_free);
+    TEST_ASSERT_EQUAL_INT(0, (int)counting_threads);
+
+    cJSON_InitHooks(NULL);
+    TEST_ASSERT_TRUE(global_hooks.allocate == malloc);
+}
+
+static void stats_should_keep_custom_hooks(void)
+{
+    cJSON_Hooks hooks = { custom_malloc, custom_free };
+    cJSON_Stats stats;
+    cJSON *item = NULL;
+
+    cJSON_StartStats(&stats);
+    cJSON_InitHooks(&hooks);
+    custom_allocations = 0;
+
+    item = cJSON_CreateString("custom string");
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)custom_allocations);
+    TEST_ASSERT_EQUAL_UINT(2U, (unsigned int)stats.allocations);
+    cJSON_Delete(item);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.live_bytes);
+
+    cJSON_StopStats();
+    cJSON_InitHooks(NULL);
+}
+
+static void stats_should_track_many_allocations(void)
+{
+    cJSON_Stats stats;
+    cJSON *array = NULL;
+    int i = 0;
+
+    cJSON_StartStats(&stats);
+    array = cJSON_CreateArray();
+    for (i = 0; i < 1000; i++)
+    {
+        cJSON_AddItemToArray(array, cJSON_CreateString("not inline"));
+    }
+    for (i = 0; i < 500; i++)
+    {
+        cJSON_DeleteItemFromArray(array, i);
+    }
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(1 + 1000 * 2), (unsigned int)stats.allocations);
+    TEST_ASSERT_EQUAL_UINT(1000U, (unsigned int)stats.deallocations);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(stats.allocated_bytes - stats.live_bytes), (unsigned int)(500 * (sizeof(cJSON) + sizeof("not inline"))));
+
+    cJSON_Delete(array);
+    TEST_ASSERT_EQUAL_UINT(0U, (unsigned int)stats.live_bytes);
+    cJSON_StopStats();
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(stats_should_count_parsing);
+    RUN_TEST(stats_should_count_print_buffer_growth);
+    RUN_TEST(stats_should_ignore_memory_from_before);
+    RUN_TEST(stats_should_stop_counting);
+    RUN_TEST(stats_should_remove_the_counting_functions);
+    RUN_TEST(stats_should_keep_custom_hooks);
+    RUN_TEST(stats_should_track_many_allocations);
+
+    return UNITY_END();
+}
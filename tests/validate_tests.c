@@ -0,0 +1,183 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static cJSON_bool validate_string_literal(const char *json)
+{
+    return cJSON_Validate(json, strlen(json), NULL);
+}
+
+static void assert_error_at(const char *json, size_t expected_position)
+{
+    const char *error_at = NULL;
+
+    TEST_ASSERT_FALSE_MESSAGE(cJSON_Validate(json, strlen(json), &error_at), json);
+    TEST_ASSERT_EQUAL_PTR_MESSAGE(json + expected_position, error_at, json);
+}
+
+static void validate_should_handle_null_and_empty_input(void)
+{
+    const char *error_at = "not reset";
+
+    TEST_ASSERT_FALSE(cJSON_Validate(NULL, 10, &error_at));
+    TEST_ASSERT_NULL(error_at);
+    TEST_ASSERT_FALSE(cJSON_Validate("{}", 0, NULL));
+    TEST_ASSERT_FALSE(validate_string_literal(""));
+    TEST_ASSERT_FALSE(validate_string_literal(" \n\t"));
+}
+
+static void validate_should_accept_well_formed_json(void)
+{
+    const char *error_at = "not reset";
+
+    TEST_ASSERT_TRUE(cJSON_Validate("{\"a\": [1, -2.5e+3, true, false, null, \"x\"]}", 43, &error_at));
+    TEST_ASSERT_NULL(error_at);
+
+    TEST_ASSERT_TRUE(validate_string_literal("null"));
+    TEST_ASSERT_TRUE(validate_string_literal(" \r\n\t[ ] "));
+    TEST_ASSERT_TRUE(validate_string_literal("{}"));
+    TEST_ASSERT_TRUE(validate_string_literal("0"));
+    TEST_ASSERT_TRUE(validate_string_literal("-0.0e-0"));
+    TEST_ASSERT_TRUE(validate_string_literal("1E10"));
+    TEST_ASSERT_TRUE(validate_string_literal("\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u00e4\\uD83D\\uDE00\""));
+    TEST_ASSERT_TRUE(validate_string_literal("\xEF\xBB\xBF{\"bom\":1}"));
+    /* a zero terminator included in the length ends the input */
+    TEST_ASSERT_TRUE(cJSON_Validate("[1]", sizeof("[1]"), NULL));
+}
+
+static void validate_should_reject_malformed_numbers(void)
+{
+    assert_error_at("01", 1);
+    assert_error_at("-", 0);
+    assert_error_at("1.", 1);
+    assert_error_at(".5", 0);
+    assert_error_at("+1", 0);
+    assert_error_at("1e", 1);
+    assert_error_at("1e+", 2);
+    assert_error_at("[1,]", 3);
+}
+
+static void validate_should_reject_malformed_structures(void)
+{
+    assert_error_at("[1 2]", 3);
+    assert_error_at("{\"a\" 1}", 5);
+    assert_error_at("{\"a\":1,}", 7);
+    assert_error_at("{1:1}", 1);
+    assert_error_at("[", 0);
+    assert_error_at("{\"a\":", 4);
+    assert_error_at("nul", 0);
+    assert_error_at("truex", 4);
+    assert_error_at("{} {}", 3);
+    /* cJSON_Parse treats every control character as whitespace */
+    assert_error_at("\v[]", 0);
+}
+
+static void validate_should_reject_invalid_strings(void)
+{
+    assert_error_at("\"abc", 3);
+    assert_error_at("\"a\tb\"", 2);
+    assert_error_at("\"\\x\"", 1);
+    assert_error_at("\"\\u12G4\"", 1);
+    /* lone surrogates */
+    assert_error_at("\"\\uDE00\"", 1);
+    assert_error_at("\"\\uD83D\"", 1);
+    assert_error_at("\"\\uD83D\\u0041\"", 1);
+}
+
+static void validate_should_reject_invalid_utf8(void)
+{
+    TEST_ASSERT_TRUE(validate_string_literal("\"\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80\""));
+
+    /* unexpected continuation byte */
+    assert_error_at("\"\x80\"", 1);
+    /* overlong encodings */
+    assert_error_at("\"\xC0\xAF\"", 1);
+    assert_error_at("\"\xE0\x80\xAF\"", 1);
+    assert_error_at("\"\xF0\x80\x80\xAF\"", 1);
+    /* encoded UTF-16 surrogate */
+    assert_error_at("\"\xED\xA0\x80\"", 1);
+    /* beyond U+10FFFF */
+    assert_error_at("\"\xF4\x90\x80\x80\"", 1);
+    assert_error_at("\"\xF5\x80\x80\x80\"", 1);
+    /* truncated sequence */
+    assert_error_at("\"\xE2\x82\"", 1);
+}
+
+static void validate_should_respect_the_nesting_limit(void)
+{
+    char deep[CJSON_NESTING_LIMIT + 2];
+    size_t i = 0;
+
+    for (i = 0; i < CJSON_NESTING_LIMIT; i++)
+    {
+        deep[i] = '[';
+    }
+    deep[CJSON_NESTING_LIMIT] = '\0';
+    /* nesting of CJSON_NESTING_LIMIT is only incomplete, not too deep */
+    assert_error_at(deep, CJSON_NESTING_LIMIT - 1);
+
+    deep[CJSON_NESTING_LIMIT] = '[';
+    deep[CJSON_NESTING_LIMIT + 1] = '\0';
+    TEST_ASSERT_FALSE(validate_string_literal(deep));
+}
+
+static void validate_should_agree_with_the_parser_on_test_inputs(void)
+{
+    const char *files[] = { "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5", "inputs/test6", "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11" };
+    size_t i = 0;
+
+    for (i = 0; i < (sizeof(files) / sizeof(files[0])); i++)
+    {
+        char *content = read_file(files[i]);
+        cJSON *tree = NULL;
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+
+        tree = cJSON_ParseWithOpts(content, NULL, true);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(tree != NULL, cJSON_Validate(content, strlen(content), NULL), files[i]);
+
+        cJSON_Delete(tree);
+        free(content);
+    }
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(validate_should_handle_null_and_empty_input);
+    RUN_TEST(validate_should_accept_well_formed_json);
+    RUN_TEST(validate_should_reject_malformed_numbers);
+    RUN_TEST(validate_should_reject_malformed_structures);
+    RUN_TEST(validate_should_reject_invalid_strings);
+    RUN_TEST(validate_should_reject_invalid_utf8);
+    RUN_TEST(validate_should_respect_the_nesting_limit);
+    RUN_TEST(validate_should_agree_with_the_parser_on_test_inputs);
+
+    return UNITY_END();
+}
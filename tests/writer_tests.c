@@ -0,0 +1,275 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+#include "../cJSON_Writer.h"
+
+static const char document[] = "{\"name\":\"a \\\"quoted\\\" name\",\"id\":12,\"ratio\":-0.25,\"flags\":[true,false,null],\"empty\":{},\"none\":[],\"nested\":[{\"x\":1,\"y\":[2,3]},[[]],{}]}";
+
+static void write_tree(cJSON_Writer * const writer, const cJSON * const item)
+{
+    const cJSON *child = NULL;
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_False:
+        case cJSON_True:
+            TEST_ASSERT_TRUE(cJSON_Writer_Bool(writer, cJSON_IsTrue(item)));
+            break;
+        case cJSON_NULL:
+            TEST_ASSERT_TRUE(cJSON_Writer_Null(writer));
+            break;
+        case cJSON_Number:
+            TEST_ASSERT_TRUE(cJSON_Writer_Number(writer, item->valuedouble));
+            break;
+        case cJSON_String:
+            TEST_ASSERT_TRUE(cJSON_Writer_String(writer, item->valuestring));
+            break;
+        case cJSON_Array:
+            TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+            cJSON_ArrayForEach(child, item)
+            {
+                write_tree(writer, child);
+            }
+            TEST_ASSERT_TRUE(cJSON_Writer_EndArray(writer));
+            break;
+        case cJSON_Object:
+            TEST_ASSERT_TRUE(cJSON_Writer_BeginObject(writer));
+            cJSON_ArrayForEach(child, item)
+            {
+                TEST_ASSERT_TRUE(cJSON_Writer_Key(writer, child->string));
+                write_tree(writer, child);
+            }
+            TEST_ASSERT_TRUE(cJSON_Writer_EndObject(writer));
+            break;
+        default:
+            TEST_FAIL();
+    }
+}
+
+static void assert_writes_like_print(const cJSON_bool format)
+{
+    cJSON *tree = cJSON_Parse(document);
+    cJSON_Writer *writer = cJSON_Writer_Create(format);
+    char *printed = NULL;
+    const char *written = NULL;
+    size_t length = 0;
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_NOT_NULL(writer);
+
+    write_tree(writer, tree);
+    TEST_ASSERT_TRUE(cJSON_Writer_Finish(writer));
+    written = cJSON_Writer_GetString(writer, &length);
+    printed = format ? cJSON_Print(tree) : cJSON_PrintUnformatted(tree);
+    TEST_ASSERT_NOT_NULL(written);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(printed, written);
+    TEST_ASSERT_TRUE(strlen(printed) == length);
+
+    cJSON_free(printed);
+    cJSON_Writer_Delete(writer);
+    cJSON_Delete(tree);
+}
+
+static void writer_should_write_like_print(void)
+{
+    assert_writes_like_print(false);
+}
+
+static void writer_should_write_formatted_like_print(void)
+{
+    assert_writes_like_print(true);
+}
+
+static void writer_should_write_items_and_raw_text(void)
+{
+    cJSON *item = cJSON_Parse("{\"inner\":{\"a\":[1,2]}}");
+    cJSON_Writer *writer = cJSON_Writer_Create(true);
+    TEST_ASSERT_NOT_NULL(item);
+    TEST_ASSERT_NOT_NULL(writer);
+
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Raw(writer, "{\"raw\": 1}"));
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginObject(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Key(writer, "item"));
+    TEST_ASSERT_TRUE(cJSON_Writer_Item(writer, item));
+    TEST_ASSERT_TRUE(cJSON_Writer_EndObject(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_EndArray(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Finish(writer));
+    TEST_ASSERT_EQUAL_STRING("[{\"raw\": 1}, {\n\t\t\"item\":\t{\n\t\t\t\"inner\":\t{\n\t\t\t\t\"a\":\t[1, 2]\n\t\t\t}\n\t\t}\n\t}]", cJSON_Writer_GetString(writer, NULL));
+
+    cJSON_Writer_Delete(writer);
+    cJSON_Delete(item);
+}
+
+static void writer_should_reject_misplaced_values(void)
+{
+    cJSON_Writer *writer = cJSON_Writer_Create(false);
+    TEST_ASSERT_NOT_NULL(writer);
+
+    /* a value in an object without key */
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginObject(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_Number(writer, 1));
+    /* the writer stays failed */
+    TEST_ASSERT_FALSE(cJSON_Writer_Key(writer, "a"));
+    TEST_ASSERT_FALSE(cJSON_Writer_Finish(writer));
+    TEST_ASSERT_NULL(cJSON_Writer_GetString(writer, NULL));
+
+    /* a key in an array */
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_Key(writer, "a"));
+
+    /* closing the wrong container */
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_EndObject(writer));
+
+    /* a key without value */
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginObject(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Key(writer, "a"));
+    TEST_ASSERT_FALSE(cJSON_Writer_EndObject(writer));
+
+    /* two values at the top level, closing too much, unfinished values */
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Null(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_Null(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_EndArray(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_Finish(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_Finish(writer));
+
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_String(writer, NULL));
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_FALSE(cJSON_Writer_Item(writer, NULL));
+
+    /* a reset writer is as good as new */
+    TEST_ASSERT_TRUE(cJSON_Writer_Reset(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_String(writer, "ok"));
+    TEST_ASSERT_TRUE(cJSON_Writer_EndArray(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Finish(writer));
+    TEST_ASSERT_EQUAL_STRING("[\"ok\"]", cJSON_Writer_GetString(writer, NULL));
+
+    cJSON_Writer_Delete(writer);
+
+    TEST_ASSERT_FALSE(cJSON_Writer_BeginObject(NULL));
+    TEST_ASSERT_FALSE(cJSON_Writer_String(NULL, "a"));
+    TEST_ASSERT_FALSE(cJSON_Writer_Finish(NULL));
+    TEST_ASSERT_FALSE(cJSON_Writer_Reset(NULL));
+    TEST_ASSERT_NULL(cJSON_Writer_CreateToCallback(false, NULL, NULL));
+    cJSON_Writer_Delete(NULL);
+}
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t calls;
+} collected_text;
+
+static cJSON_bool CJSON_CDECL collect(void *context, const char *data, size_t length)
+{
+    collected_text *text = (collected_text*)context;
+    char *grown = (char*)realloc(text->data, text->length + length + 1);
+    if (grown == NULL)
+    {
+        return false;
+    }
+    memcpy(grown + text->length, data, length);
+    text->data = grown;
+    text->length += length;
+    text->data[text->length] = '\0';
+    text->calls++;
+
+    return true;
+}
+
+static cJSON_bool CJSON_CDECL refuse(void *context, const char *data, size_t length)
+{
+    (void)context;
+    (void)data;
+    (void)length;
+
+    return false;
+}
+
+static void writer_should_hand_chunks_to_the_callback(void)
+{
+    collected_text text = { NULL, 0, 0 };
+    cJSON_Writer *writer = cJSON_Writer_CreateToCallback(false, collect, &text);
+    cJSON *expected = cJSON_CreateArray();
+    char *printed = NULL;
+    int i = 0;
+    TEST_ASSERT_NOT_NULL(writer);
+    TEST_ASSERT_NOT_NULL(expected);
+
+    TEST_ASSERT_TRUE(cJSON_Writer_BeginArray(writer));
+    for (i = 0; i < 2000; i++)
+    {
+        TEST_ASSERT_TRUE(cJSON_Writer_String(writer, "chunk"));
+        TEST_ASSERT_TRUE(cJSON_AddItemToArray(expected, cJSON_CreateString("chunk")));
+    }
+    TEST_ASSERT_TRUE(cJSON_Writer_EndArray(writer));
+    TEST_ASSERT_TRUE(cJSON_Writer_Finish(writer));
+    /* the text is only handed to the callback */
+    TEST_ASSERT_NULL(cJSON_Writer_GetString(writer, NULL));
+    TEST_ASSERT_TRUE(text.calls > 1);
+
+    printed = cJSON_PrintUnformatted(expected);
+    TEST_ASSERT_NOT_NULL(printed);
+    TEST_ASSERT_EQUAL_STRING(printed, text.data);
+    cJSON_free(printed);
+    cJSON_Delete(expected);
+    cJSON_Writer_Delete(writer);
+    free(text.data);
+
+    writer = cJSON_Writer_CreateToCallback(false, refuse, NULL);
+    TEST_ASSERT_NOT_NULL(writer);
+    TEST_ASSERT_TRUE(cJSON_Writer_Number(writer, 1));
+    TEST_ASSERT_FALSE(cJSON_Writer_Finish(writer));
+    cJSON_Writer_Delete(writer);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(writer_should_write_like_print);
+    RUN_TEST(writer_should_write_formatted_like_print);
+    RUN_TEST(writer_should_write_items_and_raw_text);
+    RUN_TEST(writer_should_reject_misplaced_values);
+    RUN_TEST(writer_should_hand_chunks_to_the_callback);
+
+    return UNITY_END();
+}